@@ -0,0 +1,638 @@
+/**
+ * @file abondance.c
+ * @brief Implémentation du mode abondance (compteurs flottants)
+ *
+ * La dynamique est celle du moteur mensuel (reproduction puis vieillissement):
+ * - Petites cellules (< seuil_gaussien): tirages individuels, effectifs entiers
+ * - Grandes cellules: tirages gaussiens calculés en long double
+ *
+ * En logarithmes, un tirage binomial de n épreuves se partage en
+ * log(np + d) et log(nq - d), où d est l'écart gaussien: les deux parts
+ * s'écrivent avec log1p sans jamais former n, qui dépasserait les long double.
+ */
+
+#include "abondance.h"
+#include "config.h"
+#include "population.h"
+#include "reproduction.h"
+#include <float.h>
+#include <math.h>
+
+#define ARRONDIS_PAR_MOIS 4   // Arrondis successifs subis par un compteur en un mois
+#define ENTIER_EXACT 0x1p64L  // Au-delà, un long double ne représente plus tous les entiers
+
+/**
+ * @brief Options par défaut du mode abondance
+ *
+ * Jusqu'à 2^64 (≈ 1,8·10^19), un long double représente exactement tout
+ * effectif entier: basculer à 10^18 lapins au total ne change donc rien à
+ * la loi simulée, seul le coût des calculs diminue.
+ *
+ * @return Bascule à 10^18 lapins, logarithmes à 10^4000
+ */
+options_abondance options_abondance_defaut()
+{
+    options_abondance opt = {1e18, 1e4000L};
+    return opt;
+}
+
+/**
+ * @brief Valeur d'une cellule vide dans la représentation courante
+ *
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return 0 ou -INFINITY
+ */
+static long double vide(int en_log)
+{
+    return en_log ? -INFINITY : 0.0L;
+}
+
+/**
+ * @brief Convertit un effectif en valeur de cellule
+ *
+ * @param x Effectif
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return Valeur de cellule
+ */
+static long double depuis_effectif(long double x, int en_log)
+{
+    if (!en_log)
+        return x;
+    return x > 0 ? logl(x) : -INFINITY;
+}
+
+/**
+ * @brief Indique si une cellule relève des tirages individuels
+ *
+ * @param t Tables de transition (seuil gaussien)
+ * @param v Valeur de cellule
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return 1 si l'effectif est inférieur à t->seuil_gaussien
+ */
+static int petit(const tables_transition *t, long double v, int en_log)
+{
+    return en_log ? v < logl(t->seuil_gaussien) : v < t->seuil_gaussien;
+}
+
+/**
+ * @brief Effectif entier d'une petite cellule
+ *
+ * @param v Valeur de cellule (effectif < seuil_gaussien)
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return Effectif arrondi
+ */
+static unsigned long effectif_entier(long double v, int en_log)
+{
+    long double x = en_log ? expl(v) : v;
+    return x > 0 ? (unsigned long)llroundl(x) : 0;
+}
+
+/**
+ * @brief Somme de deux valeurs de cellule
+ *
+ * @param a Première valeur
+ * @param b Seconde valeur
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return a + b (log(e^a + e^b) en logarithmes)
+ */
+static long double ajouter(long double a, long double b, int en_log)
+{
+    if (!en_log)
+        return a + b;
+    if (a == -INFINITY)
+        return b;
+    if (b == -INFINITY)
+        return a;
+    if (a < b)
+    {
+        long double tmp = a;
+        a = b;
+        b = tmp;
+    }
+    return a + log1pl(expl(b - a));
+}
+
+/**
+ * @brief Partage une cellule par un tirage binomial
+ *
+ * @param t Tables de transition (seuil gaussien)
+ * @param n Valeur de la cellule à partager
+ * @param p Probabilité de succès
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @param succes Valeur où stocker les succès
+ * @param echecs Valeur où stocker les échecs
+ */
+static void partager(const tables_transition *t, long double n, double p, int en_log, long double *succes,
+                     long double *echecs)
+{
+    if (p <= 0 || n == vide(en_log))
+    {
+        *succes = vide(en_log);
+        *echecs = n;
+        return;
+    }
+    if (p >= 1)
+    {
+        *succes = n;
+        *echecs = vide(en_log);
+        return;
+    }
+
+    if (petit(t, n, en_log))
+    {
+        // Tirage individuel de chaque lapin
+        unsigned long nb = effectif_entier(n, en_log);
+        uint64_t seuil = seuil_probabilite(p);
+        unsigned long k = 0;
+        for (unsigned long i = 0; i < nb; i++)
+            k += bernoulli_seuil(seuil);
+        *succes = depuis_effectif(k, en_log);
+        *echecs = depuis_effectif(nb - k, en_log);
+        return;
+    }
+
+    double z = normal_centree_reduite();
+    if (!en_log)
+    {
+        long double k = n * p + sqrtl(n * p * (1 - p)) * z;
+        if (n < ENTIER_EXACT)
+            k = rintl(k);
+        if (k < 0)
+            k = 0;
+        if (k > n)
+            k = n;
+        *succes = k;
+        *echecs = n - k;
+        return;
+    }
+
+    // d / (np) = z·sqrt(q / (np)) et -d / (nq) = -z·sqrt(p / (nq))
+    long double inv_racine_n = expl(-n / 2);
+    long double rs = z * sqrtl((1 - p) / p) * inv_racine_n;
+    long double re = -z * sqrtl(p / (1 - p)) * inv_racine_n;
+    if (rs <= -1)
+    {
+        *succes = -INFINITY;
+        *echecs = n;
+    }
+    else if (re <= -1)
+    {
+        *succes = n;
+        *echecs = -INFINITY;
+    }
+    else
+    {
+        *succes = n + logl(p) + log1pl(rs);
+        *echecs = n + logl(1 - p) + log1pl(re);
+    }
+}
+
+/**
+ * @brief Répartit une cellule de femelles selon leur nombre de portées
+ *
+ * Suite de tirages binomiaux conditionnels (loi multinomiale).
+ *
+ * @param t Tables de transition
+ * @param n Valeur de la cellule à répartir
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @param parts Tableau où stocker les 10 parts
+ */
+static void repartir_portees(const tables_transition *t, long double n, int en_log, long double parts[10])
+{
+    double reste = 1.0;
+    for (int i = 0; i < 10; i++)
+    {
+        double p_i = t->portees_cumul[i] - (i ? t->portees_cumul[i - 1] : 0.0);
+        if (i == 9 || reste <= 0)
+        {
+            parts[i] = n;
+            n = vide(en_log);
+            continue;
+        }
+        partager(t, n, p_i / reste, en_log, &parts[i], &n);
+        reste -= p_i;
+    }
+}
+
+/**
+ * @brief Nombre total de bébés nés de plusieurs portées
+ *
+ * Une portée compte 3 à 6 bébés avec probabilités égales: moyenne 4,5
+ * et variance 1,25 par portée.
+ *
+ * @param t Tables de transition (seuil gaussien)
+ * @param portees Valeur de la cellule des portées
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ * @return Valeur de cellule du nombre de bébés
+ */
+static long double bebes_portees(const tables_transition *t, long double portees, int en_log)
+{
+    if (portees == vide(en_log))
+        return vide(en_log);
+
+    if (petit(t, portees, en_log))
+    {
+        unsigned long nb = effectif_entier(portees, en_log);
+        unsigned long bebes = 0;
+        for (unsigned long i = 0; i < nb; i++)
+            bebes += accouchement();
+        return depuis_effectif(bebes, en_log);
+    }
+
+    double z = normal_centree_reduite();
+    if (!en_log)
+    {
+        long double b = 4.5L * portees + sqrtl(1.25L * portees) * z;
+        if (portees < ENTIER_EXACT)
+            b = rintl(b);
+        if (b < 3 * portees)
+            b = 3 * portees;
+        if (b > 6 * portees)
+            b = 6 * portees;
+        return b;
+    }
+    long double r = z * (sqrtl(1.25L) / 4.5L) * expl(-portees / 2);
+    if (r < -1.0L / 3)
+        r = -1.0L / 3; // au moins 3 bébés par portée
+    return portees + logl(4.5L) + log1pl(r);
+}
+
+/**
+ * @brief Reproduction du mois: mises bas de toutes les femelles
+ *
+ * @param pa Population
+ * @return Valeur de cellule des nouveaux-nés
+ */
+static long double reproduction_abondance(population_abondance *pa)
+{
+    const tables_transition *t = &pa->params->transitions;
+    int en_log = pa->en_log;
+    long double nouveaux = vide(en_log);
+
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            cellule_abondance *c = &pa->cellules[age][month];
+            for (int acc_rest = 1; acc_rest <= 9; acc_rest++)
+            {
+                long double portees, reste;
+                partager(t, c->femelles[acc_rest], t->accouchement[month][acc_rest], en_log, &portees, &reste);
+                c->femelles[acc_rest] = reste;
+                c->femelles[acc_rest - 1] = ajouter(c->femelles[acc_rest - 1], portees, en_log);
+                nouveaux = ajouter(nouveaux, bebes_portees(t, portees, en_log), en_log);
+            }
+        }
+    }
+    return nouveaux;
+}
+
+/**
+ * @brief Fait passer une cellule au mois suivant
+ *
+ * @param t Tables de transition
+ * @param dest Cellule de destination
+ * @param prev Cellule source (mois précédent)
+ * @param age Âge en années de la destination
+ * @param month Mois de la destination
+ * @param en_log 1 si les cellules contiennent des logarithmes
+ */
+static void vieillir_cellule(const tables_transition *t, cellule_abondance *dest, cellule_abondance prev,
+                             int age, int month, int en_log)
+{
+    long double morts;
+    double survie = t->survie_adulte[age];
+
+    partager(t, prev.males, survie, en_log, &dest->males, &morts);
+    dest->bebes = vide(en_log);
+
+    if (month == 0)
+    {
+        // Anniversaire: seules les femelles sans portée restante continuent
+        long double survivantes;
+        partager(t, prev.femelles[0], survie, en_log, &survivantes, &morts);
+        repartir_portees(t, survivantes, en_log, dest->femelles);
+    }
+    else
+    {
+        for (int acc_rest = 0; acc_rest < 10; acc_rest++)
+            partager(t, prev.femelles[acc_rest], survie, en_log, &dest->femelles[acc_rest], &morts);
+    }
+
+    if (age == 0 && month <= 10)
+    {
+        // Bébés: survie, maturité, sexe et portées restantes de l'année
+        long double survivants, matures, males, femelles, parts[10];
+        partager(t, prev.bebes, t->survie_bebe, en_log, &survivants, &morts);
+        partager(t, survivants, t->maturite[month], en_log, &matures, &dest->bebes);
+        partager(t, matures, t->proba_male, en_log, &males, &femelles);
+        dest->males = ajouter(dest->males, males, en_log);
+        repartir_portees(t, femelles, en_log, parts);
+        for (int i = 0; i < 10; i++)
+        {
+            int acc = i > month ? i - month : 0;
+            dest->femelles[acc] = ajouter(dest->femelles[acc], parts[i], en_log);
+        }
+    }
+}
+
+/**
+ * @brief Passe toutes les cellules d'une population flottante en logarithmes
+ *
+ * @param pa Population
+ */
+static void passer_en_log(population_abondance *pa)
+{
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            cellule_abondance *c = &pa->cellules[age][month];
+            c->bebes = depuis_effectif(c->bebes, 1);
+            c->males = depuis_effectif(c->males, 1);
+            for (int i = 0; i < 10; i++)
+                c->femelles[i] = depuis_effectif(c->femelles[i], 1);
+        }
+    }
+    pa->en_log = 1;
+}
+
+/**
+ * @brief Calcule la population totale d'une population flottante
+ *
+ * @param pa Population
+ * @return Logarithme népérien du total (-INFINITY si vide)
+ */
+long double log_total_abondance(const population_abondance *pa)
+{
+    long double total = vide(pa->en_log);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            const cellule_abondance *c = &pa->cellules[age][month];
+            total = ajouter(total, c->bebes, pa->en_log);
+            total = ajouter(total, c->males, pa->en_log);
+            for (int i = 0; i < 10; i++)
+                total = ajouter(total, c->femelles[i], pa->en_log);
+        }
+    }
+    return pa->en_log ? total : depuis_effectif(total, 1);
+}
+
+/**
+ * @brief Simule un mois de vie d'une population flottante
+ *
+ * Mêmes étapes que simulate_month(): reproduction, vieillissement (en sens
+ * inverse pour ne pas écraser les sources), puis ajout des nouveaux-nés.
+ * La borne d'erreur d'arrondi est mise à jour: en logarithmes, l'erreur
+ * absolue sur log(n) devient une erreur relative sur n.
+ *
+ * @param pa Population à faire évoluer
+ */
+void simulate_month_abondance(population_abondance *pa)
+{
+    const tables_transition *t = &pa->params->transitions;
+
+    long double nouveaux = reproduction_abondance(pa);
+
+    for (int age = AGE_MAX - 1; age >= 0; age--)
+    {
+        for (int month = NB_MONTHS - 1; month >= 0; month--)
+        {
+            if (!(age || month))
+                break;
+            cellule_abondance prev = month ? pa->cellules[age][month - 1] : pa->cellules[age - 1][NB_MONTHS - 1];
+            vieillir_cellule(t, &pa->cellules[age][month], prev, age, month, pa->en_log);
+        }
+    }
+
+    cellule_abondance *naissance = &pa->cellules[0][0];
+    naissance->bebes = nouveaux;
+    naissance->males = vide(pa->en_log);
+    for (int i = 0; i < 10; i++)
+        naissance->femelles[i] = vide(pa->en_log);
+
+    long double log_total = log_total_abondance(pa);
+    long double arrondi = LDBL_EPSILON / 2;
+    if (pa->en_log)
+    {
+        pa->mois_log++;
+        arrondi *= fabsl(log_total);
+    }
+    else
+    {
+        pa->mois_lineaires++;
+    }
+    pa->erreur_arrondi += ARRONDIS_PAR_MOIS * arrondi;
+    long double bruit = expl(-log_total / 2);
+    if (bruit < pa->bruit_min)
+        pa->bruit_min = bruit;
+}
+
+/**
+ * @brief Convertit un entier GMP en long double (64 bits de mantisse)
+ *
+ * @param n Entier à convertir
+ * @return Valeur arrondie par troncature
+ */
+static long double mpz_vers_reel(mpz_t n)
+{
+    if (mpz_fits_ulong_p(n))
+        return (long double)mpz_get_ui(n);
+
+    size_t bits = mpz_sizeinbase(n, 2);
+    mpz_t haut;
+    mpz_init(haut);
+    mpz_tdiv_q_2exp(haut, n, bits - 64);
+    long double x = ldexpl((long double)mpz_get_ui(haut), (int)(bits - 64));
+    mpz_clear(haut);
+    return x;
+}
+
+/**
+ * @brief Convertit une population GMP en population flottante
+ *
+ * @param pop Population GMP (libérée par l'appel)
+ * @return Population flottante
+ */
+population_abondance *abondance_depuis_population(population *pop)
+{
+    population_abondance *pa = malloc(sizeof(population_abondance));
+    pa->params = pop->params;
+    pa->en_log = 0;
+    pa->mois_gmp = 0;
+    pa->mois_lineaires = 0;
+    pa->mois_log = 0;
+    pa->erreur_arrondi = 0;
+    pa->bruit_min = INFINITY;
+
+    eclater_classe(pop);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *m = &pop->lapins_par_age[age][month];
+            cellule_abondance *c = &pa->cellules[age][month];
+            c->bebes = mpz_vers_reel(m->nb_babies);
+            c->males = mpz_vers_reel(m->nb_male);
+            for (int i = 0; i < 10; i++)
+                c->femelles[i] = mpz_vers_reel(m->femelles_par_accouchements_restants[i]);
+        }
+    }
+    liberer_population(pop);
+    return pa;
+}
+
+/**
+ * @brief Simule une population, GMP puis flottante au-delà des seuils
+ *
+ * Le total est comparé aux seuils avant chaque pas: compteurs GMP (pas
+ * mensuels ou sauts), puis long double, puis logarithmes. Une fois
+ * flottante, la population coûte le même temps par mois quel que soit
+ * son effectif.
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Seuils de bascule
+ * @param saut Réglage du mode saut pendant la phase GMP (NULL: pas mensuel)
+ * @return Population finale (toujours flottante)
+ */
+population_abondance *simulate_population_abondance(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                                    const options_abondance *opt, const options_saut *saut)
+{
+    population *pop = initialize_population(params, nbFemale, nbMale);
+    population_abondance *pa = NULL;
+    long double log_seuil = logl(opt->seuil_log);
+    int mois_gmp = 0;
+
+    mpz_t total;
+    mpz_init(total);
+    int mois_restants = years * NB_MONTHS;
+    while (mois_restants > 0)
+    {
+        if (!pa)
+        {
+            population_totale(pop, total);
+            if (mpz_get_d(total) > opt->seuil)
+            {
+                pa = abondance_depuis_population(pop);
+                continue;
+            }
+            int pas = saut ? choisir_pas(pop, saut, mois_restants) : 1;
+            if (pas == 1)
+                simulate_month(pop);
+            else
+                avancer_saut(pop, pas);
+            mois_gmp += pas;
+            mois_restants -= pas;
+        }
+        else
+        {
+            if (!pa->en_log && log_total_abondance(pa) > log_seuil)
+                passer_en_log(pa);
+            simulate_month_abondance(pa);
+            mois_restants--;
+        }
+    }
+    mpz_clear(total);
+
+    if (!pa)
+        pa = abondance_depuis_population(pop);
+    pa->mois_gmp = mois_gmp;
+    return pa;
+}
+
+/**
+ * @brief Écrit une valeur de cellule en notation scientifique
+ *
+ * Les logarithmes dépassent la plage des long double: la mantisse et
+ * l'exposant décimal sont calculés séparément.
+ *
+ * @param v Valeur de cellule
+ * @param en_log 1 si la valeur est un logarithme
+ * @param chiffres Nombre de chiffres après la virgule
+ */
+static void afficher_valeur(long double v, int en_log, int chiffres)
+{
+    if (!en_log)
+    {
+        printf("%.*Le", chiffres, v);
+        return;
+    }
+    if (v == -INFINITY)
+    {
+        printf("0");
+        return;
+    }
+    long double x = v / logl(10.0L);
+    long double exposant = floorl(x);
+    printf("%.*Lfe+%.0Lf", chiffres, powl(10.0L, x - exposant), exposant);
+}
+
+/**
+ * @brief Affiche les totaux et la précision perdue par les compteurs flottants
+ *
+ * La précision perdue se lit à trois niveaux:
+ * - Chiffres significatifs conservés face au nombre de chiffres du total
+ * - Borne de l'erreur relative d'arrondi cumulée sur les mois flottants
+ * - Bruit relatif de la dynamique (1/sqrt(total)): en dessous de la
+ *   résolution des compteurs, les fluctuations aléatoires sont absorbées
+ *
+ * @param pa Population à afficher
+ */
+void afficher_abondance(const population_abondance *pa)
+{
+    long double bebes = vide(pa->en_log), males = vide(pa->en_log), femelles = vide(pa->en_log);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            const cellule_abondance *c = &pa->cellules[age][month];
+            bebes = ajouter(bebes, c->bebes, pa->en_log);
+            males = ajouter(males, c->males, pa->en_log);
+            for (int i = 0; i < 10; i++)
+                femelles = ajouter(femelles, c->femelles[i], pa->en_log);
+        }
+    }
+    long double log_total = log_total_abondance(pa);
+
+    // Résolution relative d'un compteur et chiffres significatifs associés
+    long double resolution = LDBL_EPSILON / 2;
+    if (pa->en_log)
+        resolution *= fabsl(log_total);
+    int chiffres = (int)floorl(-log10l(resolution));
+    int chiffres_total = log_total > 0 ? (int)floorl(log_total / logl(10.0L)) + 1 : 1;
+    if (chiffres > chiffres_total)
+        chiffres = chiffres_total;
+
+    printf("babies = ");
+    afficher_valeur(bebes, pa->en_log, chiffres - 1);
+    printf(", male = ");
+    afficher_valeur(males, pa->en_log, chiffres - 1);
+    printf(", females = ");
+    afficher_valeur(femelles, pa->en_log, chiffres - 1);
+    printf("\n");
+
+    printf("Mois simulés : %d en GMP, %d en long double, %d en logarithmes\n",
+           pa->mois_gmp, pa->mois_lineaires, pa->mois_log);
+    printf("Chiffres significatifs conservés : %d sur %d\n", chiffres, chiffres_total);
+    printf("Erreur relative d'arrondi cumulée (borne) : %.2Le\n", pa->erreur_arrondi);
+    if (pa->mois_lineaires + pa->mois_log > 0)
+    {
+        printf("Bruit relatif mensuel le plus faible : %.2Le%s\n", pa->bruit_min,
+               pa->bruit_min < resolution ? " (sous la résolution des compteurs)" : "");
+    }
+}
+
+/**
+ * @brief Libère une population flottante
+ *
+ * @param pa Population à libérer
+ */
+void liberer_abondance(population_abondance *pa)
+{
+    free(pa);
+}
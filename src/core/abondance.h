@@ -0,0 +1,111 @@
+/**
+ * @file abondance.h
+ * @brief Fichier d'en-tête du mode abondance (compteurs flottants)
+ *
+ * Au-delà de quelques milliards de milliards de lapins, les compteurs GMP
+ * occupent plusieurs limbes alors que le bruit relatif de la dynamique est
+ * inférieur à la précision d'un long double. Le mode abondance poursuit la
+ * simulation sur une grille de long double (tirages gaussiens identiques,
+ * tirages individuels pour les petites cellules), puis en logarithmes
+ * lorsque les effectifs dépassent la plage des long double.
+ */
+
+#ifndef ABONDANCE_H
+#define ABONDANCE_H
+
+#include "simulation.h"
+#include "saut.h"
+
+/**
+ * @struct options_abondance
+ * @brief Seuils de bascule vers les compteurs flottants
+ */
+typedef struct options_abondance
+{
+    double seuil;          // Population totale au-delà de laquelle on quitte GMP
+    long double seuil_log; // Population totale au-delà de laquelle on passe en logarithmes
+} options_abondance;
+
+/**
+ * @struct cellule_abondance
+ * @brief Équivalent flottant de mois_lapin (effectifs ou logarithmes)
+ */
+typedef struct cellule_abondance
+{
+    long double bebes;        // Bébés (non-matures)
+    long double males;        // Mâles adultes
+    long double femelles[10]; // Femelles par nombre d'accouchements restants
+} cellule_abondance;
+
+/**
+ * @struct population_abondance
+ * @brief Population à compteurs flottants, âges détaillés
+ */
+typedef struct population_abondance
+{
+    cellule_abondance cellules[AGE_MAX][NB_MONTHS]; // Population organisée par âge et mois
+    const params_t *params;                         // Paramètres biologiques de la simulation
+    int en_log;                                     // 1: les cellules contiennent des logarithmes népériens
+    int mois_gmp;                                   // Mois simulés avec les compteurs GMP
+    int mois_lineaires;                             // Mois simulés en long double
+    int mois_log;                                   // Mois simulés en logarithmes
+    long double erreur_arrondi;                     // Borne de l'erreur relative d'arrondi cumulée
+    long double bruit_min;                          // Plus petit bruit relatif mensuel rencontré (1/sqrt(total))
+} population_abondance;
+
+/**
+ * @brief Options par défaut du mode abondance
+ * @return Bascule à 10^18 lapins (effectifs entiers exacts en long double),
+ *         logarithmes à 10^4000
+ */
+options_abondance options_abondance_defaut();
+
+/**
+ * @brief Convertit une population GMP en population flottante
+ *
+ * La classe adulte regroupée est d'abord répartie par âge.
+ *
+ * @param pop Population GMP (libérée par l'appel)
+ * @return Population flottante
+ */
+population_abondance *abondance_depuis_population(population *pop);
+
+/**
+ * @brief Simule un mois de vie d'une population flottante
+ * @param pa Population à faire évoluer
+ */
+void simulate_month_abondance(population_abondance *pa);
+
+/**
+ * @brief Calcule la population totale d'une population flottante
+ * @param pa Population
+ * @return Logarithme népérien du total (-INFINITY si vide)
+ */
+long double log_total_abondance(const population_abondance *pa);
+
+/**
+ * @brief Simule une population, GMP puis flottante au-delà des seuils
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Seuils de bascule
+ * @param saut Réglage du mode saut pendant la phase GMP (NULL: pas mensuel)
+ * @return Population finale (toujours flottante)
+ */
+population_abondance *simulate_population_abondance(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                                    const options_abondance *opt, const options_saut *saut);
+
+/**
+ * @brief Affiche les totaux et la précision perdue par les compteurs flottants
+ * @param pa Population à afficher
+ */
+void afficher_abondance(const population_abondance *pa);
+
+/**
+ * @brief Libère une population flottante
+ * @param pa Population à libérer
+ */
+void liberer_abondance(population_abondance *pa);
+
+#endif // ABONDANCE_H
@@ -11,15 +11,12 @@
 
 #include "aging.h"
 #include "config.h"
+#include "population.h"
 #include "reproduction.h"
+#include "planning.h"
 #include "mt19937ar-cok.h"
 #include "gmp.h"
 
-#define GRAND_NB 10000 // Seuil pour utiliser l'approximation gaussienne
-
-extern double prob_maturity[];
-extern double survival_rate_month_baby;
-
 /**
  * @brief Retourne l'état de la population au mois précédent
  *
@@ -50,29 +47,32 @@ mois_lapin prev_month(population *pop, int year, int month)
  * - Simulation individuelle pour les petites populations
  * - Approximation binomiale gaussienne pour les grandes populations
  *
+ * @param t Tables de transition
  * @param pop_month Pointeur vers le mois de destination
  * @param pop_month_prev Mois source (mois précédent)
  * @param age Âge en années
  */
-void male_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age)
+void male_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int age)
 {
     mpz_set_ui(pop_month->nb_male, 0);
     mpz_t nb_male;
     mpz_init(nb_male);
     mpz_set(nb_male, pop_month_prev.nb_male);
-    if (mpz_cmp_ui(nb_male, GRAND_NB) < 0)
+    if (mpz_cmp_ui(nb_male, t->seuil_gaussien) < 0)
     {
         unsigned long n_male = mpz_get_ui(nb_male);
+        uint64_t seuil = t->seuil_survie_adulte[age];
+        unsigned long survivants = 0;
         for (unsigned long i = 0; i < n_male; i++)
         {
-            if (genrand_real1() < survival_rate_adult(age))
-                mpz_add_ui(pop_month->nb_male, pop_month->nb_male, 1);
+            survivants += bernoulli_seuil(seuil);
         }
+        mpz_set_ui(pop_month->nb_male, survivants);
     }
     else
     {
 
-        binomial_gaussian(pop_month->nb_male, nb_male, survival_rate_adult(age));
+        binomial_gaussian(pop_month->nb_male, nb_male, t->survie_adulte[age]);
     }
     mpz_clear(nb_male);
 }
@@ -84,12 +84,13 @@ void male_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age)
  * Traitement spécial au début de l'année (month == 0) où les femelles
  * reçoivent un nouveau nombre de portées pour l'année.
  *
+ * @param t Tables de transition
  * @param pop_month Pointeur vers le mois de destination
  * @param pop_month_prev Mois source (mois précédent)
  * @param age Âge en années
  * @param month Mois actuel (0-11)
  */
-void female_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int month)
+void female_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int month)
 {
     for (int i = 0; i < 10; i++)
     {
@@ -101,15 +102,17 @@ void female_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int
         mpz_t nb_female;
         mpz_init(nb_female);
         mpz_set(nb_female, pop_month_prev.femelles_par_accouchements_restants[0]);
-        if (mpz_cmp_ui(nb_female, GRAND_NB) < 0)
+        if (mpz_cmp_ui(nb_female, t->seuil_gaussien) < 0)
         {
 
             unsigned long n_female_ul = mpz_get_ui(nb_female);
+            uint64_t seuil = t->seuil_survie_adulte[age];
             for (unsigned long i = 0; i < n_female_ul; i++)
             {
-                if (genrand_real1() < survival_rate_adult(age))
+                if (bernoulli_seuil(seuil))
                 {
-                    mpz_add_ui(pop_month->femelles_par_accouchements_restants[litter_per_year()], pop_month->femelles_par_accouchements_restants[litter_per_year()], 1);
+                    int nb_litter = litter_per_year(t);
+                    mpz_add_ui(pop_month->femelles_par_accouchements_restants[nb_litter], pop_month->femelles_par_accouchements_restants[nb_litter], 1);
                 }
             }
         }
@@ -117,8 +120,8 @@ void female_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int
         {
             mpz_t nb_female;
             mpz_init(nb_female);
-            binomial_gaussian(nb_female, pop_month_prev.femelles_par_accouchements_restants[0], survival_rate_adult(age));
-            mpz_t *counts = multinomial_gaussian(nb_female, prob_litter, 10);
+            binomial_gaussian(nb_female, pop_month_prev.femelles_par_accouchements_restants[0], t->survie_adulte[age]);
+            mpz_t *counts = multinomial_gaussian(nb_female, t->portees_cumul, 10);
             for (int i = 0; i < 10; i++)
             {
                 mpz_set(pop_month->femelles_par_accouchements_restants[i], counts[i]);
@@ -134,18 +137,20 @@ void female_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int
             mpz_init(nb_females);
             mpz_set(nb_females, pop_month_prev.femelles_par_accouchements_restants[acc_rest]);
 
-            if (mpz_cmp_ui(nb_females, GRAND_NB) < 0)
+            if (mpz_cmp_ui(nb_females, t->seuil_gaussien) < 0)
             {
                 unsigned long n_females_ul = mpz_get_ui(nb_females);
+                uint64_t seuil = t->seuil_survie_adulte[age];
+                unsigned long survivantes = 0;
                 for (unsigned long i = 0; i < n_females_ul; i++)
                 {
-                    if (genrand_real1() < survival_rate_adult(age))
-                        mpz_add_ui(pop_month->femelles_par_accouchements_restants[acc_rest], pop_month->femelles_par_accouchements_restants[acc_rest], 1);
+                    survivantes += bernoulli_seuil(seuil);
                 }
+                mpz_set_ui(pop_month->femelles_par_accouchements_restants[acc_rest], survivantes);
             }
             else
             {
-                binomial_gaussian(pop_month->femelles_par_accouchements_restants[acc_rest], nb_females, survival_rate_adult(age));
+                binomial_gaussian(pop_month->femelles_par_accouchements_restants[acc_rest], nb_females, t->survie_adulte[age]);
             }
             mpz_clear(nb_females);
         }
@@ -156,40 +161,41 @@ void female_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int
  * @brief Simule le vieillissement et la maturation des bébés
  *
  * Les bébés peuvent:
- * 1. Mourir (selon survival_rate_month_baby)
- * 2. Devenir matures (selon prob_maturity[month])
+ * 1. Mourir (selon t->survie_bebe)
+ * 2. Devenir matures (selon t->maturite[month])
  *    - Devenir mâle (50% de chance)
  *    - Devenir femelle (50% de chance) avec attribution du nombre de portées
  * 3. Rester bébé un mois de plus
  *
+ * @param t Tables de transition
  * @param pop_month Pointeur vers le mois de destination
  * @param pop_month_prev Mois source (mois précédent)
  * @param month Mois d'âge du bébé (0-10)
  */
-void babies_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int month)
+void babies_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int month)
 {
     mpz_set_ui(pop_month->nb_babies, 0);
     mpz_t n_babies;
     mpz_init(n_babies);
     mpz_set(n_babies, pop_month_prev.nb_babies);
-    if (mpz_cmp_ui(n_babies, GRAND_NB) < 0)
+    if (mpz_cmp_ui(n_babies, t->seuil_gaussien) < 0)
     {
 
         unsigned long n_babies_ul = mpz_get_ui(n_babies);
         for (unsigned long i = 0; i < n_babies_ul; i++)
         {
-            if (genrand_real1() < survival_rate_month_baby)
+            if (bernoulli_seuil(t->seuil_survie_bebe))
             {
 
-                if (genrand_real1() < prob_maturity[month])
+                if (bernoulli_seuil(t->seuil_maturite[month]))
                 {
-                    if (genrand_real1() < 0.5)
+                    if (bernoulli_seuil(t->seuil_male))
                     {
                         mpz_add_ui(pop_month->nb_male, pop_month->nb_male, 1);
                     }
                     else
                     {
-                        int nb_litter = litter_per_year();
+                        int nb_litter = litter_per_year(t);
                         if (nb_litter < month)
                             mpz_add_ui(pop_month->femelles_par_accouchements_restants[0], pop_month->femelles_par_accouchements_restants[0], 1);
                         else
@@ -207,19 +213,18 @@ void babies_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int month)
     {
         mpz_t n_babies_survived;
         mpz_init(n_babies_survived);
-        binomial_gaussian(n_babies_survived, n_babies, survival_rate_month_baby); // survie
+        binomial_gaussian(n_babies_survived, n_babies, t->survie_bebe); // survie
         mpz_t n_mature;
         mpz_init(n_mature);
-        binomial_gaussian(n_mature, n_babies_survived, prob_maturity[month]); // maturité
+        binomial_gaussian(n_mature, n_babies_survived, t->maturite[month]); // maturité
         mpz_t n_male;
         mpz_init(n_male);
-        binomial_gaussian(n_male, n_mature, 0.5);
-        mpz_set(pop_month->nb_male, n_male);
+        binomial_gaussian(n_male, n_mature, t->proba_male);
+        mpz_add(pop_month->nb_male, pop_month->nb_male, n_male);
         mpz_t n_female;
         mpz_init(n_female);
         mpz_sub(n_female, n_mature, n_male);
-        mpz_t *counts = multinomial_gaussian(n_female, prob_litter, 10);
-        mpz_set_ui(pop_month->femelles_par_accouchements_restants[0], 0);
+        mpz_t *counts = multinomial_gaussian(n_female, t->portees_cumul, 10);
         for (int i = 0; i <= month; i++)
         {
             mpz_add(pop_month->femelles_par_accouchements_restants[0], pop_month->femelles_par_accouchements_restants[0], counts[i]);
@@ -248,10 +253,21 @@ void babies_aging(mois_lapin *pop_month, mois_lapin pop_month_prev, int month)
  * 2. Applique le vieillissement des femelles
  * 3. Applique la maturation des bébés (uniquement pour l'âge 0)
  *
+ * Les lignes vides de la classe adulte regroupée ne coûtent aucun tirage.
+ * En mode planning, le planning suit les survivantes et les femelles qui
+ * reçoivent leurs portées (anniversaire, maturité) sont planifiées. Les
+ * totaux de la population sont recalculés au fil du parcours, chaque
+ * cellule étant ajoutée dès qu'elle est produite.
+ *
  * @param pop Pointeur vers la population à faire vieillir
  */
 void aging(population *pop)
 {
+    const tables_transition *t = &pop->params->transitions;
+    planning *pl = pop->planning;
+    mpz_t anciennes;
+    mpz_init(anciennes);
+    totaux_effacer(&pop->totaux);
     mois_lapin pop_month;
     mois_lapin pop_month_prev = pop->lapins_par_age[AGE_MAX - 1][NB_MONTHS - 1];
     for (int age = AGE_MAX - 1; age >= 0; age--)
@@ -264,11 +280,29 @@ void aging(population *pop)
 
             pop_month_prev = prev_month(pop, age, month);
 
-            male_aging(&pop_month, pop_month_prev, age);
-            female_aging(&pop_month, pop_month_prev, age, month);
+            male_aging(t, &pop_month, pop_month_prev, age);
+            female_aging(t, &pop_month, pop_month_prev, age, month);
+            if (pl)
+            {
+                // Au mois 0, toutes les survivantes reçoivent de nouvelles portées
+                avancer_planning(pl, age, month);
+                mpz_set_ui(anciennes, 0);
+                if (month)
+                    mpz_set(anciennes, pop_month.femelles_par_accouchements_restants[0]);
+            }
             if ((age == 0) && (month <= 10))
-                babies_aging(&pop_month, pop_month_prev, month);
+                babies_aging(t, &pop_month, pop_month_prev, month);
+            if (pl)
+                planifier_cellule(pl, &pop_month, age, month, anciennes, t->seuil_gaussien);
             pop->lapins_par_age[age][month] = pop_month;
+            totaux_ajouter(&pop->totaux, &pop_month, age);
         }
     }
+    mpz_clear(anciennes);
+
+    // Les bébés de la cellule (0, 0) sont passés au mois 1: elle attend les naissances
+    mpz_set_ui(pop->lapins_par_age[0][0].nb_babies, 0);
+
+    // Classe adulte regroupée: répartition par âge à l'anniversaire
+    anniversaire_classe(pop);
 }
@@ -10,6 +10,35 @@
 #define AGING_H
 
 #include "simulation.h"
+#include "config.h"
+
+/**
+ * @brief Survie des mâles de pop_month_prev vers pop_month
+ * @param t Tables de transition
+ * @param pop_month Mois de destination
+ * @param pop_month_prev Mois source (mois précédent)
+ * @param age Âge en années
+ */
+void male_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int age);
+
+/**
+ * @brief Survie des femelles (et nouvelles portées en début d'année) vers pop_month
+ * @param t Tables de transition
+ * @param pop_month Mois de destination
+ * @param pop_month_prev Mois source (mois précédent)
+ * @param age Âge en années
+ * @param month Mois (0-11)
+ */
+void female_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int age, int month);
+
+/**
+ * @brief Survie et maturation des bébés vers pop_month
+ * @param t Tables de transition
+ * @param pop_month Mois de destination (mâles et femelles déjà vieillis)
+ * @param pop_month_prev Mois source (mois précédent)
+ * @param month Mois d'âge du bébé (0-10)
+ */
+void babies_aging(const tables_transition *t, mois_lapin *pop_month, mois_lapin pop_month_prev, int month);
 
 /**
  * @brief Simule le vieillissement de toute la population d'un mois
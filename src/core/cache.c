@@ -0,0 +1,377 @@
+/**
+ * @file cache.c
+ * @brief Implémentation du cache persistant des résultats de simulation
+ *
+ * Le fichier commence par un en-tête (format, nombre de cases, horloge LRU)
+ * suivi des cases, toutes de même taille. Chaque accès est protégé par un
+ * verrou fcntl sur le fichier, qui exclut les autres processus et disparaît
+ * avec un processus qui plante, et par un mutex qui exclut les autres
+ * threads (un verrou fcntl appartient au processus entier). Une somme de
+ * contrôle par case écarte une entrée à moitié écrite.
+ */
+
+#define _DEFAULT_SOURCE // pread, pwrite, flock
+
+#include "cache.h"
+#include "config.h"
+#include "hachage.h"
+#include "population.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIQUE_CACHE 0x3143434e4950414cULL // "LAPINCC1"
+#define TAILLE_ENTETE 64                    // Octets réservés à l'en-tête
+
+/**
+ * @struct entete_cache
+ * @brief En-tête du fichier de cache
+ */
+typedef struct entete_cache
+{
+    uint64_t magique;       // MAGIQUE_CACHE
+    uint32_t taille_entree; // sizeof(entree_cache): détecte un changement de format
+    uint32_t nb_cases;      // Nombre de cases (multiple de ASSOCIATIVITE_CACHE)
+    uint64_t horloge;       // Horloge logique des accès (LRU)
+} entete_cache;
+
+/**
+ * @struct entree_cache
+ * @brief Case du cache: une simulation et ses effectifs annuels
+ */
+typedef struct entree_cache
+{
+    uint64_t empreinte;      // Empreinte de la clé (0: case vide)
+    uint64_t graine;         // Graine de la simulation
+    int32_t nb_femelles;     // Condition initiale
+    int32_t nb_males;
+    int32_t antithetique;    // 1: flux antithétique
+    int32_t nb_annees;       // Dernière année enregistrée
+    uint64_t dernier_acces;  // Horloge du dernier accès (hors somme de contrôle)
+    uint64_t controle;       // Somme de contrôle de la clé et des effectifs
+    double effectifs[ANNEES_MAX_CACHE + 1][3]; // Bébés, mâles, femelles à la fin de chaque année
+} entree_cache;
+
+_Static_assert(sizeof(entete_cache) <= TAILLE_ENTETE, "en-tête du cache trop grand");
+
+/**
+ * @struct cache_resultats
+ * @brief Cache ouvert: projection du fichier et compteurs du processus
+ */
+struct cache_resultats
+{
+    int fd;                 // Descripteur du fichier (verrous fcntl)
+    void *base;             // Projection du fichier
+    size_t taille;          // Taille de la projection
+    entete_cache *entete;   // En-tête projeté
+    entree_cache *cases;    // Cases projetées
+    int nb_ensembles;       // nb_cases / ASSOCIATIVITE_CACHE
+    atomic_long succes;     // Simulations trouvées
+    atomic_long echecs;     // Simulations absentes
+};
+
+// Exclusion entre threads d'un même processus (le verrou fcntl ne les distingue pas)
+static pthread_mutex_t verrou_threads = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t fork_enregistre = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Avant un fork: attend la fin de l'accès en cours pour que le fils hérite d'un mutex libre
+ */
+static void avant_fork(void)
+{
+    pthread_mutex_lock(&verrou_threads);
+}
+
+/**
+ * @brief Après un fork (père et fils): libère le mutex pris par avant_fork
+ */
+static void apres_fork(void)
+{
+    pthread_mutex_unlock(&verrou_threads);
+}
+
+/**
+ * @brief Enregistre les gestionnaires de fork (processus fils des shards)
+ */
+static void enregistrer_fork(void)
+{
+    pthread_atfork(avant_fork, apres_fork, apres_fork);
+}
+
+/**
+ * @brief Pose ou lève le verrou fcntl sur tout le fichier
+ *
+ * @param fd Descripteur du fichier
+ * @param type F_WRLCK ou F_UNLCK
+ */
+static void verrou_fichier(int fd, short type)
+{
+    struct flock fl = {.l_type = type, .l_whence = SEEK_SET, .l_start = 0, .l_len = 0};
+    while (fcntl(fd, F_SETLKW, &fl) == -1 && errno == EINTR)
+        ;
+}
+
+/**
+ * @brief Prend le cache pour un accès exclusif (threads et processus)
+ */
+static void verrouiller(cache_resultats *cache)
+{
+    pthread_mutex_lock(&verrou_threads);
+    verrou_fichier(cache->fd, F_WRLCK);
+}
+
+/**
+ * @brief Rend le cache pris par verrouiller()
+ */
+static void deverrouiller(cache_resultats *cache)
+{
+    verrou_fichier(cache->fd, F_UNLCK);
+    pthread_mutex_unlock(&verrou_threads);
+}
+
+/**
+ * @brief Empreinte de la clé d'une simulation (jamais nulle)
+ *
+ * @param sc Scénario (la durée n'est pas prise en compte)
+ * @param seed Graine
+ * @param antithetic 1 pour le flux antithétique
+ * @return Empreinte de 64 bits
+ */
+static uint64_t empreinte_cle(scenario sc, unsigned long seed, int antithetic)
+{
+    uint64_t h = melanger(params_empreinte(sc.params) ^ VERSION_MOTEUR);
+    h = melanger(h ^ sc.params->seuil_gaussien);
+    h = melanger(h ^ seed);
+    h = melanger(h ^ ((uint64_t)(uint32_t)sc.nb_femelles << 32 | (uint32_t)sc.nb_males));
+    h = melanger(h ^ (uint64_t)antithetic);
+    return h ? h : 1;
+}
+
+/**
+ * @brief Somme de contrôle FNV-1a de la clé et des effectifs d'une case
+ */
+static uint64_t controle_entree(const entree_cache *e)
+{
+    uint64_t h = fnv1a(FNV1A_DEPART, e, offsetof(entree_cache, dernier_acces));
+    if (e->nb_annees < 0 || e->nb_annees > ANNEES_MAX_CACHE)
+        return h ^ 1;
+    return fnv1a(h, e->effectifs, (e->nb_annees + 1) * sizeof(e->effectifs[0]));
+}
+
+/**
+ * @brief Indique si une case contient la simulation cherchée
+ */
+static int meme_cle(const entree_cache *e, uint64_t empreinte, scenario sc, unsigned long seed, int antithetic)
+{
+    return e->empreinte == empreinte && e->graine == seed && e->nb_femelles == sc.nb_femelles &&
+           e->nb_males == sc.nb_males && e->antithetique == antithetic && e->controle == controle_entree(e);
+}
+
+/**
+ * @brief Ouvre un fichier de cache, en le créant s'il n'existe pas
+ *
+ * La création est faite sous flock: deux processus qui ouvrent le même
+ * nouveau fichier en même temps ne l'initialisent qu'une fois.
+ *
+ * @param chemin Chemin du fichier
+ * @param nb_cases Nombre de cases d'un nouveau fichier
+ * @return Cache, NULL en cas d'erreur
+ */
+cache_resultats *cache_ouvrir(const char *chemin, int nb_cases)
+{
+    pthread_once(&fork_enregistre, enregistrer_fork);
+
+    int fd = open(chemin, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Erreur : impossible d'ouvrir le cache %s\n", chemin);
+        return NULL;
+    }
+    flock(fd, LOCK_EX);
+
+    struct stat st;
+    fstat(fd, &st);
+    entete_cache entete;
+    if (st.st_size == 0)
+    {
+        if (nb_cases < ASSOCIATIVITE_CACHE)
+            nb_cases = ASSOCIATIVITE_CACHE;
+        entete = (entete_cache){MAGIQUE_CACHE, sizeof(entree_cache),
+                                (uint32_t)(nb_cases / ASSOCIATIVITE_CACHE * ASSOCIATIVITE_CACHE), 0};
+        size_t taille = TAILLE_ENTETE + (size_t)entete.nb_cases * sizeof(entree_cache);
+        // Cases vides: le fichier étendu est rempli de zéros
+        if (ftruncate(fd, taille) != 0 || pwrite(fd, &entete, sizeof(entete), 0) != sizeof(entete))
+        {
+            fprintf(stderr, "Erreur : impossible de créer le cache %s\n", chemin);
+            flock(fd, LOCK_UN);
+            close(fd);
+            return NULL;
+        }
+        st.st_size = taille;
+    }
+    else if (pread(fd, &entete, sizeof(entete), 0) != sizeof(entete) || entete.magique != MAGIQUE_CACHE ||
+             entete.taille_entree != sizeof(entree_cache) || entete.nb_cases % ASSOCIATIVITE_CACHE != 0 ||
+             (size_t)st.st_size != TAILLE_ENTETE + (size_t)entete.nb_cases * sizeof(entree_cache))
+    {
+        fprintf(stderr, "Erreur : %s n'est pas un cache de ce format (à supprimer)\n", chemin);
+        flock(fd, LOCK_UN);
+        close(fd);
+        return NULL;
+    }
+    flock(fd, LOCK_UN);
+
+    void *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "Erreur : impossible de projeter le cache %s\n", chemin);
+        close(fd);
+        return NULL;
+    }
+
+    cache_resultats *cache = calloc(1, sizeof(cache_resultats));
+    cache->fd = fd;
+    cache->base = base;
+    cache->taille = st.st_size;
+    cache->entete = base;
+    cache->cases = (entree_cache *)((char *)base + TAILLE_ENTETE);
+    cache->nb_ensembles = entete.nb_cases / ASSOCIATIVITE_CACHE;
+    atomic_init(&cache->succes, 0);
+    atomic_init(&cache->echecs, 0);
+    return cache;
+}
+
+/**
+ * @brief Ferme un cache
+ *
+ * @param cache Cache
+ */
+void cache_fermer(cache_resultats *cache)
+{
+    if (!cache)
+        return;
+    munmap(cache->base, cache->taille);
+    close(cache->fd);
+    free(cache);
+}
+
+/**
+ * @brief Cherche une simulation dans le cache
+ *
+ * @param cache Cache
+ * @param sc Scénario
+ * @param seed Graine
+ * @param antithetic 1 pour le flux antithétique
+ * @param res Population finale
+ * @param totaux_annuels Population totale à la fin des années 0 à sc.annees (NULL accepté)
+ * @return 1 si la simulation est en cache, 0 sinon
+ */
+int cache_chercher(cache_resultats *cache, scenario sc, unsigned long seed, int antithetic,
+                   resultat_simulation *res, double *totaux_annuels)
+{
+    if (sc.annees < 0 || sc.annees > ANNEES_MAX_CACHE)
+    {
+        atomic_fetch_add(&cache->echecs, 1);
+        return 0;
+    }
+
+    uint64_t empreinte = empreinte_cle(sc, seed, antithetic);
+    entree_cache *ensemble = &cache->cases[(empreinte >> 8) % cache->nb_ensembles * ASSOCIATIVITE_CACHE];
+    int trouve = 0;
+    verrouiller(cache);
+    for (int i = 0; i < ASSOCIATIVITE_CACHE && !trouve; i++)
+    {
+        entree_cache *e = &ensemble[i];
+        if (!meme_cle(e, empreinte, sc, seed, antithetic) || e->nb_annees < sc.annees)
+            continue;
+        trouve = 1;
+        e->dernier_acces = ++cache->entete->horloge;
+        const double *fin = e->effectifs[sc.annees];
+        res->bebes = fin[0];
+        res->males = fin[1];
+        res->femelles = fin[2];
+        res->total = fin[0] + fin[1] + fin[2];
+        if (totaux_annuels)
+            for (int a = 0; a <= sc.annees; a++)
+                totaux_annuels[a] = e->effectifs[a][0] + e->effectifs[a][1] + e->effectifs[a][2];
+    }
+    deverrouiller(cache);
+    atomic_fetch_add(trouve ? &cache->succes : &cache->echecs, 1);
+    return trouve;
+}
+
+/**
+ * @brief Enregistre une simulation dans le cache
+ *
+ * La case choisie est, dans l'ordre: celle de la même simulation, une case
+ * vide ou invalide, la case la moins récemment utilisée de l'ensemble.
+ *
+ * @param cache Cache
+ * @param sc Scénario
+ * @param seed Graine
+ * @param antithetic 1 pour le flux antithétique
+ * @param annuels Effectifs à la fin des années 0 à sc.annees
+ */
+void cache_enregistrer(cache_resultats *cache, scenario sc, unsigned long seed, int antithetic,
+                       const resultat_simulation *annuels)
+{
+    if (sc.annees < 0 || sc.annees > ANNEES_MAX_CACHE)
+        return;
+
+    uint64_t empreinte = empreinte_cle(sc, seed, antithetic);
+    entree_cache *ensemble = &cache->cases[(empreinte >> 8) % cache->nb_ensembles * ASSOCIATIVITE_CACHE];
+    verrouiller(cache);
+    entree_cache *cible = NULL, *libre = NULL, *ancienne = NULL;
+    for (int i = 0; i < ASSOCIATIVITE_CACHE && !cible; i++)
+    {
+        entree_cache *e = &ensemble[i];
+        if (meme_cle(e, empreinte, sc, seed, antithetic))
+            cible = e;
+        else if (e->empreinte == 0 || e->controle != controle_entree(e))
+            libre = libre ? libre : e;
+        else if (!ancienne || e->dernier_acces < ancienne->dernier_acces)
+            ancienne = e;
+    }
+
+    // Une entrée de la même simulation au moins aussi longue est gardée telle quelle
+    if (!cible || cible->nb_annees < sc.annees)
+    {
+        cible = cible ? cible : (libre ? libre : ancienne);
+        cible->empreinte = empreinte;
+        cible->graine = seed;
+        cible->nb_femelles = sc.nb_femelles;
+        cible->nb_males = sc.nb_males;
+        cible->antithetique = antithetic;
+        cible->nb_annees = sc.annees;
+        for (int a = 0; a <= sc.annees; a++)
+        {
+            cible->effectifs[a][0] = annuels[a].bebes;
+            cible->effectifs[a][1] = annuels[a].males;
+            cible->effectifs[a][2] = annuels[a].femelles;
+        }
+        cible->controle = controle_entree(cible);
+    }
+    cible->dernier_acces = ++cache->entete->horloge;
+    deverrouiller(cache);
+}
+
+/**
+ * @brief Compteurs de consultation du cache depuis son ouverture par ce processus
+ *
+ * @param cache Cache
+ * @param succes Nombre de simulations trouvées
+ * @param echecs Nombre de simulations absentes
+ */
+void cache_statistiques(const cache_resultats *cache, long *succes, long *echecs)
+{
+    *succes = atomic_load(&cache->succes);
+    *echecs = atomic_load(&cache->echecs);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file cache.h
+ * @brief Fichier d'en-tête du cache persistant des résultats de simulation
+ *
+ * Le cache garde, pour chaque simulation du moteur mensuel déjà faite, les
+ * effectifs (bébés, mâles, femelles) à la fin de chaque année. Une entrée est
+ * désignée par une empreinte de sa condition initiale, de sa graine, du flux
+ * antithétique, des valeurs des paramètres, du seuil gaussien et de
+ * VERSION_MOTEUR. La durée n'en fait pas partie: une simulation de n ans est
+ * le début d'une simulation plus longue de même graine, et une entrée de
+ * n ans répond à toute durée d'au plus n ans.
+ *
+ * Les entrées sont rangées dans un fichier projeté en mémoire (mmap) et
+ * partagé entre threads et processus. Le fichier est découpé en ensembles de
+ * ASSOCIATIVITE_CACHE cases: une entrée ne peut occuper qu'une case de
+ * l'ensemble désigné par son empreinte, et l'entrée la moins récemment
+ * utilisée de l'ensemble est remplacée (LRU par ensemble).
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "replication.h"
+
+#define VERSION_MOTEUR 1          // À incrémenter dès qu'une modification change les trajectoires
+#define ANNEES_MAX_CACHE 127      // Durée maximale d'une simulation mise en cache (années)
+#define ASSOCIATIVITE_CACHE 8     // Cases par ensemble
+#define CASES_CACHE_DEFAUT 4096   // Nombre de cases d'un nouveau fichier (environ 12 Mo)
+
+/**
+ * @brief Cache ouvert (opaque)
+ */
+typedef struct cache_resultats cache_resultats;
+
+/**
+ * @brief Ouvre un fichier de cache, en le créant s'il n'existe pas
+ *
+ * @param chemin Chemin du fichier
+ * @param nb_cases Nombre de cases d'un nouveau fichier (arrondi à un multiple de ASSOCIATIVITE_CACHE)
+ * @return Cache à fermer avec cache_fermer, NULL en cas d'erreur (message sur stderr)
+ */
+cache_resultats *cache_ouvrir(const char *chemin, int nb_cases);
+
+/**
+ * @brief Ferme un cache
+ * @param cache Cache (NULL accepté)
+ */
+void cache_fermer(cache_resultats *cache);
+
+/**
+ * @brief Cherche une simulation dans le cache
+ *
+ * @param cache Cache
+ * @param sc Scénario
+ * @param seed Graine
+ * @param antithetic 1 pour le flux antithétique
+ * @param res Population finale (après sc.annees années), remplie en cas de succès
+ * @param totaux_annuels Population totale à la fin des années 0 à sc.annees (NULL accepté)
+ * @return 1 si la simulation est en cache, 0 sinon
+ */
+int cache_chercher(cache_resultats *cache, scenario sc, unsigned long seed, int antithetic,
+                   resultat_simulation *res, double *totaux_annuels);
+
+/**
+ * @brief Enregistre une simulation dans le cache
+ *
+ * Une entrée existante plus courte est prolongée; une entrée au moins aussi
+ * longue est gardée.
+ *
+ * @param cache Cache
+ * @param sc Scénario (sc.annees au plus ANNEES_MAX_CACHE)
+ * @param seed Graine
+ * @param antithetic 1 pour le flux antithétique
+ * @param annuels Effectifs à la fin des années 0 à sc.annees
+ */
+void cache_enregistrer(cache_resultats *cache, scenario sc, unsigned long seed, int antithetic,
+                       const resultat_simulation *annuels);
+
+/**
+ * @brief Compteurs de consultation du cache depuis son ouverture par ce processus
+ *
+ * @param cache Cache
+ * @param succes Nombre de simulations trouvées
+ * @param echecs Nombre de simulations absentes
+ */
+void cache_statistiques(const cache_resultats *cache, long *succes, long *echecs);
+
+#endif // CACHE_H
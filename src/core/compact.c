@@ -0,0 +1,350 @@
+/**
+ * @file compact.c
+ * @brief Implémentation du moteur compact (grille en tableaux d'entiers de 64 bits)
+ *
+ * Un mois se déroule en quelques passes linéaires sur les tableaux:
+ * 1. Reproduction: une passe par nombre d'accouchements restants, les
+ *    portées de tout le mois étant sommées avant le tirage des bébés
+ * 2. Vieillissement: décalage d'une case des mâles et de chaque tableau de
+ *    femelles, les survivantes des cellules de janvier recevant leurs
+ *    portées de l'année; puis passe des bébés (survie, maturité, sexe)
+ * 3. Nouveau-nés rangés dans bebes[0]
+ *
+ * Les tirages sont ceux du moteur mensuel: épreuves de Bernoulli sous
+ * t->seuil_gaussien individus, approximation gaussienne calculée en double
+ * au-delà (exacte tant que l'effectif reste sous LIMITE_COMPACTE).
+ */
+
+#include "compact.h"
+#include "config.h"
+#include "population.h"
+#include "reproduction.h"
+#include "mt19937ar-cok.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROBA_RARE 0.1 // En deçà, les épreuves sont sautées jusqu'à la prochaine issue rare
+
+/**
+ * @brief Tire une binomiale B(n, p): épreuves individuelles ou approximation gaussienne
+ *
+ * Quand l'issue rare (succès ou échec) a une probabilité q < PROBA_RARE, les
+ * épreuves ne sont pas tirées une à une: l'écart entre deux issues rares suit
+ * une loi géométrique de paramètre q, tirée par inversion. La loi est exacte
+ * et il ne faut qu'environ n * q tirages (une survie mensuelle ne laisse
+ * mourir que 2 à 5% des adultes).
+ *
+ * @param t Tables de transition (seuil gaussien)
+ * @param n Nombre d'épreuves
+ * @param seuil Seuil entier associé à p
+ * @param p Probabilité de succès
+ * @return Nombre de succès
+ */
+static uint64_t binomiale(const tables_transition *t, uint64_t n, uint64_t seuil, double p)
+{
+    if (n < t->seuil_gaussien)
+    {
+        double q = (p < 0.5) ? p : 1 - p;
+        if (q < PROBA_RARE && n > 8)
+        {
+            if (q <= 0)
+                return (p < 0.5) ? 0 : n;
+            double log_echec = log1p(-q);
+            uint64_t rares = 0;
+            double position = 0;
+            for (;;)
+            {
+                // Uniforme dans ]0, 1]
+                double u = (genrand_int32() + 1.0) * (1.0 / 4294967296.0);
+                position += floor(log(u) / log_echec) + 1;
+                if (position > (double)n)
+                    break;
+                rares++;
+            }
+            return (p < 0.5) ? rares : n - rares;
+        }
+        uint64_t k = 0;
+        for (uint64_t i = 0; i < n; i++)
+            k += bernoulli_seuil(seuil);
+        return k;
+    }
+    if (p <= 0)
+        return 0;
+    if (p >= 1)
+        return n;
+    double x = floor(n * p + sqrt(n * p * (1 - p)) * normal_centree_reduite() + 0.5);
+    if (x <= 0)
+        return 0;
+    if (x >= (double)n)
+        return n;
+    return (uint64_t)x;
+}
+
+/**
+ * @brief Répartit n femelles selon leur nombre de portées de l'année
+ *
+ * @param t Tables de transition
+ * @param n Nombre de femelles
+ * @param compte Tableau de 10 effectifs (0 à 9 portées)
+ */
+static void repartir_portees(const tables_transition *t, uint64_t n, uint64_t compte[])
+{
+    memset(compte, 0, 10 * sizeof(uint64_t));
+    if (n < t->seuil_gaussien)
+    {
+        for (uint64_t i = 0; i < n; i++)
+            compte[litter_per_year(t)]++;
+        return;
+    }
+
+    // Binomiales conditionnelles successives (comme multinomial_gaussian)
+    double cumul_prec = 0;
+    for (int j = 0; j < 9 && n > 0; j++)
+    {
+        double p = (cumul_prec < 1) ? (t->portees_cumul[j] - cumul_prec) / (1 - cumul_prec) : 1;
+        compte[j] = binomiale(t, n, seuil_probabilite(p), p);
+        n -= compte[j];
+        cumul_prec = t->portees_cumul[j];
+    }
+    compte[9] += n;
+}
+
+/**
+ * @brief Tire le nombre de bébés de k portées
+ *
+ * @param t Tables de transition (seuil gaussien)
+ * @param k Nombre de portées
+ * @return Nombre de bébés (moyenne 4,5 k, variance 1,25 k au-delà du seuil gaussien)
+ */
+static uint64_t bebes_compacts(const tables_transition *t, uint64_t k)
+{
+    if (k < t->seuil_gaussien)
+        return bebes_des_portees(k);
+    double x = floor(4.5 * k + sqrt(1.25 * k) * normal_centree_reduite() + 0.5);
+    return (x < 3.0 * k) ? 3 * k : (x > 6.0 * k) ? 6 * k : (uint64_t)x;
+}
+
+/**
+ * @brief Crée une grille avec la population initiale du moteur mensuel
+ *
+ * @param params Jeu de paramètres biologiques (sans planning des mises bas)
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @return Grille à libérer avec free
+ */
+grille_compacte *grille_compacte_creer(const params_t *params, uint64_t nb_femelles, uint64_t nb_males)
+{
+    const tables_transition *t = &params->transitions;
+    grille_compacte *g = calloc(1, sizeof(grille_compacte));
+    g->params = params;
+    for (int c = 0; c < NB_CELLULES; c++)
+    {
+        g->survie[c] = t->survie_adulte[c / NB_MONTHS];
+        g->seuil_survie[c] = t->seuil_survie_adulte[c / NB_MONTHS];
+    }
+
+    // Âge 1, mois 0
+    uint64_t compte[10];
+    g->males[NB_MONTHS] = nb_males;
+    repartir_portees(t, nb_femelles, compte);
+    for (int i = 0; i < 10; i++)
+        g->femelles[i][NB_MONTHS] = compte[i];
+    return g;
+}
+
+/**
+ * @brief Reproduction du mois: une passe par nombre d'accouchements restants
+ *
+ * @param g Grille
+ * @return Nombre de nouveau-nés
+ */
+static uint64_t reproduction_compacte(grille_compacte *g)
+{
+    const tables_transition *t = &g->params->transitions;
+    uint64_t portees = 0;
+    for (int acc_rest = 1; acc_rest <= 9; acc_rest++)
+    {
+        uint64_t *femelles = g->femelles[acc_rest];
+        uint64_t *apres = g->femelles[acc_rest - 1];
+        for (int c = 0; c < NB_CELLULES; c++)
+        {
+            if (!femelles[c])
+                continue;
+            int month = c % NB_MONTHS;
+            uint64_t k = binomiale(t, femelles[c], t->seuil_accouchement[month][acc_rest],
+                                   t->accouchement[month][acc_rest]);
+            femelles[c] -= k;
+            apres[c] += k;
+            portees += k;
+        }
+    }
+
+    // Les portées des classes sont indépendantes: un seul tirage pour leur somme
+    return bebes_compacts(t, portees);
+}
+
+/**
+ * @brief Décale un tableau d'une case: chaque cellule reçoit les survivants de la précédente
+ *
+ * Parcours des plus vieux aux plus jeunes, en place. La cellule (0, 0) est
+ * vidée; les cellules de janvier sont laissées à l'appelant si demandé.
+ *
+ * @param g Grille (probabilités de survie)
+ * @param v Tableau de NB_CELLULES compteurs
+ * @param sauf_janvier 1 pour ne pas écrire les cellules de mois 0
+ */
+static void decaler(const grille_compacte *g, uint64_t *v, int sauf_janvier)
+{
+    const tables_transition *t = &g->params->transitions;
+    for (int c = NB_CELLULES - 1; c > 0; c--)
+    {
+        if (sauf_janvier && c % NB_MONTHS == 0)
+            continue;
+        v[c] = v[c - 1] ? binomiale(t, v[c - 1], g->seuil_survie[c], g->survie[c]) : 0;
+    }
+    v[0] = 0;
+}
+
+/**
+ * @brief Vieillissement du mois: décalage des tableaux puis maturation des bébés
+ *
+ * @param g Grille
+ */
+static void vieillissement_compact(grille_compacte *g)
+{
+    const tables_transition *t = &g->params->transitions;
+    uint64_t compte[10];
+
+    // Janvier: les survivantes sans portée restante du mois 11 reçoivent celles de l'année
+    uint64_t janvier[AGE_MAX] = {0};
+    for (int age = 1; age < AGE_MAX; age++)
+    {
+        int c = age * NB_MONTHS;
+        uint64_t n = g->femelles[0][c - 1];
+        janvier[age] = n ? binomiale(t, n, g->seuil_survie[c], g->survie[c]) : 0;
+    }
+
+    decaler(g, g->males, 0);
+    for (int acc_rest = 0; acc_rest < 10; acc_rest++)
+        decaler(g, g->femelles[acc_rest], 1);
+
+    for (int age = 1; age < AGE_MAX; age++)
+    {
+        repartir_portees(t, janvier[age], compte);
+        for (int i = 0; i < 10; i++)
+            g->femelles[i][age * NB_MONTHS] = compte[i];
+    }
+    for (int i = 0; i < 10; i++)
+        g->femelles[i][0] = 0;
+
+    // Bébés: survie, maturité, sexe puis portées restantes de l'année
+    for (int month = NB_MONTHS - 2; month >= 1; month--)
+    {
+        uint64_t n = g->bebes[month - 1];
+        if (!n)
+        {
+            g->bebes[month] = 0;
+            continue;
+        }
+        uint64_t survivants = binomiale(t, n, t->seuil_survie_bebe, t->survie_bebe);
+        uint64_t matures = binomiale(t, survivants, t->seuil_maturite[month], t->maturite[month]);
+        uint64_t males = binomiale(t, matures, t->seuil_male, t->proba_male);
+        repartir_portees(t, matures - males, compte);
+
+        g->bebes[month] = survivants - matures;
+        g->males[month] += males;
+        for (int i = 0; i < 10; i++)
+            g->femelles[(i > month) ? i - month : 0][month] += compte[i];
+    }
+    g->bebes[0] = 0;
+}
+
+/**
+ * @brief Simule un mois de vie de la population compacte
+ *
+ * @param g Grille à faire évoluer
+ */
+void simulate_month_compact(grille_compacte *g)
+{
+    uint64_t nes = reproduction_compacte(g);
+    vieillissement_compact(g);
+    g->bebes[0] = nes;
+}
+
+/**
+ * @brief Effectif total de la grille (sommes de tableaux)
+ *
+ * @param g Grille
+ * @return Nombre de bébés, mâles et femelles
+ */
+uint64_t grille_compacte_total(const grille_compacte *g)
+{
+    uint64_t total = 0;
+    for (int m = 0; m < NB_MONTHS; m++)
+        total += g->bebes[m];
+    for (int c = 0; c < NB_CELLULES; c++)
+        total += g->males[c];
+    for (int i = 0; i < 10; i++)
+        for (int c = 0; c < NB_CELLULES; c++)
+            total += g->femelles[i][c];
+    return total;
+}
+
+/**
+ * @brief Convertit une grille compacte en population GMP
+ *
+ * @param g Grille à convertir
+ * @return Population à libérer avec liberer_population
+ */
+population *population_depuis_grille(const grille_compacte *g)
+{
+    mpz_t zero;
+    mpz_init(zero);
+    population *pop = initialize_population(g->params, zero, zero);
+    for (int c = 0; c < NB_CELLULES; c++)
+    {
+        mois_lapin *m = &pop->lapins_par_age[c / NB_MONTHS][c % NB_MONTHS];
+        mpz_set_ui(m->nb_male, g->males[c]);
+        for (int i = 0; i < 10; i++)
+            mpz_set_ui(m->femelles_par_accouchements_restants[i], g->femelles[i][c]);
+    }
+    for (int month = 0; month < NB_MONTHS; month++)
+        mpz_set_ui(pop->lapins_par_age[0][month].nb_babies, g->bebes[month]);
+    regrouper_classe(pop);
+    population_recompter(pop);
+    mpz_clear(zero);
+    return pop;
+}
+
+/**
+ * @brief Lance la simulation complète avec le moteur compact
+ *
+ * @param params Jeu de paramètres biologiques (sans planning des mises bas)
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_compacte(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years)
+{
+    mpz_t initial;
+    mpz_init(initial);
+    mpz_add(initial, nbFemale, nbMale);
+    int trop_grande = mpz_cmp_d(initial, LIMITE_COMPACTE) > 0;
+    mpz_clear(initial);
+    if (trop_grande)
+        return simulate_population(params, nbFemale, nbMale, years);
+
+    grille_compacte *g = grille_compacte_creer(params, mpz_get_ui(nbFemale), mpz_get_ui(nbMale));
+    int mois = 0;
+    for (; mois < years * NB_MONTHS && grille_compacte_total(g) <= LIMITE_COMPACTE; mois++)
+        simulate_month_compact(g);
+
+    // Relais du moteur GMP au-delà de LIMITE_COMPACTE
+    population *pop = population_depuis_grille(g);
+    free(g);
+    for (; mois < years * NB_MONTHS; mois++)
+        simulate_month(pop);
+    return pop;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file compact.h
+ * @brief Fichier d'en-tête du moteur compact (grille en tableaux d'entiers de 64 bits)
+ *
+ * Dans la grille GMP, chaque cellule (âge, mois) range côte à côte ses douze
+ * compteurs mpz_t, dont les limbes sont dispersés sur le tas, et porte un
+ * compteur de bébés que seule la ligne d'âge 0 utilise. Le moteur compact
+ * range un tableau contigu d'entiers de 64 bits par sorte de compteur:
+ * bebes[mois], males[âge][mois] et femelles[acc][âge][mois].
+ *
+ * Les cellules sont numérotées âge * NB_MONTHS + mois: la cellule qui
+ * précède une autre d'un mois est la case précédente du tableau. Le
+ * vieillissement d'un mois est donc un décalage d'une case de chaque
+ * tableau, parcouru linéairement, et les totaux sont des sommes de
+ * tableaux que le compilateur vectorise.
+ *
+ * Les âges sont détaillés (comme dans le moteur ensemble): la loi des
+ * effectifs est celle du moteur mensuel, la trajectoire en diffère. Au-delà
+ * de LIMITE_COMPACTE lapins, la grille est convertie en population GMP et
+ * le moteur mensuel prend le relais.
+ */
+
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stdint.h>
+#include "simulation.h"
+
+#define NB_CELLULES (AGE_MAX * NB_MONTHS) // Cellules (âge, mois), numérotées âge * NB_MONTHS + mois
+#define LIMITE_COMPACTE 0x1p50            // Effectif au-delà duquel le moteur GMP prend le relais
+
+/**
+ * @struct grille_compacte
+ * @brief Population en tableaux contigus d'entiers de 64 bits, âges détaillés
+ */
+typedef struct grille_compacte
+{
+    uint64_t bebes[NB_MONTHS];              // Bébés selon leur mois d'âge (âge 0)
+    uint64_t males[NB_CELLULES];            // Mâles adultes de chaque cellule
+    uint64_t femelles[10][NB_CELLULES];     // Femelles de chaque cellule par accouchements restants
+    uint64_t seuil_survie[NB_CELLULES];     // Seuil entier de survie mensuelle de chaque cellule
+    double survie[NB_CELLULES];             // Survie mensuelle de chaque cellule
+    const params_t *params;                 // Paramètres biologiques de la simulation
+} grille_compacte;
+
+/**
+ * @brief Crée une grille avec la population initiale du moteur mensuel
+ *
+ * Comme initialize_population: mâles et femelles à l'âge de 1 an, chaque
+ * femelle recevant son nombre de portées de l'année.
+ *
+ * @param params Jeu de paramètres biologiques (sans planning des mises bas)
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @return Grille à libérer avec free
+ */
+grille_compacte *grille_compacte_creer(const params_t *params, uint64_t nb_femelles, uint64_t nb_males);
+
+/**
+ * @brief Simule un mois de vie de la population compacte
+ * @param g Grille à faire évoluer
+ */
+void simulate_month_compact(grille_compacte *g);
+
+/**
+ * @brief Effectif total de la grille
+ * @param g Grille
+ * @return Nombre de bébés, mâles et femelles
+ */
+uint64_t grille_compacte_total(const grille_compacte *g);
+
+/**
+ * @brief Convertit une grille compacte en population GMP
+ *
+ * La classe adulte est regroupée selon les paramètres.
+ *
+ * @param g Grille à convertir
+ * @return Population à libérer avec liberer_population
+ */
+population *population_depuis_grille(const grille_compacte *g);
+
+/**
+ * @brief Lance la simulation complète avec le moteur compact
+ *
+ * Le moteur mensuel GMP prend le relais dès que l'effectif dépasse
+ * LIMITE_COMPACTE (ou d'emblée si la population initiale la dépasse).
+ *
+ * @param params Jeu de paramètres biologiques (sans planning des mises bas)
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_compacte(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years);
+
+#endif // COMPACT_H
@@ -2,85 +2,444 @@
  * @file config.c
  * @brief Implémentation de la configuration des paramètres de simulation
  *
- * Ce fichier contient les paramètres biologiques de la simulation et les fonctions
- * pour initialiser les probabilités et taux de survie.
+ * Ce fichier contient les paramètres biologiques par défaut de la simulation,
+ * la lecture et la validation d'un jeu de paramètres depuis un fichier, et le
+ * calcul des tables de transition dérivées.
  */
 
 #include "simulation.h"
 #include "config.h"
+#include "hachage.h"
+#include <limits.h>
 #include <math.h>
+#include <string.h>
 
-// Poids initiaux pour le nombre de portées par an (indices 0 à 9)
-double prob_litter[] = {0, 0, 0, 1, 1, 2, 2, 2, 1, 1};
+#define TAILLE_LIGNE 512
 
-// Probabilités de maturité des bébés par mois d'âge (0 à 10 mois)
-double prob_maturity[] = {0, 0, 0, 0, 0, 0.2, 0.4, 0.6, 0.8, 1, 1};
+/**
+ * @brief Valeurs par défaut du modèle
+ */
+static const params_t PARAMS_DEFAUT = {
+    // Poids pour le nombre de portées par an (indices 0 à 9)
+    .poids_portees = {0, 0, 0, 1, 1, 2, 2, 2, 1, 1},
+    // Probabilités de maturité des bébés par mois d'âge (0 à 10 mois)
+    .maturite = {0, 0, 0, 0, 0, 0.2, 0.4, 0.6, 0.8, 1, 1},
+    // Taux de survie annuels: 60% jusqu'à 10 ans, puis 50%, ..., 0%
+    .survie_annuelle_adulte = {0.6, 0.5, 0.4, 0.3, 0.2, 0.1, 0},
+    .age_declin = 10,
+    // 35% des bébés survivent sur 8 mois
+    .survie_bebe = 0.35,
+    .duree_survie_bebe = 8,
+    .proba_male = 0.5,
+    // Âges adultes de même dynamique regroupés en une classe
+    .detail_ages = 0,
+    // Mises bas tirées chaque mois (pas de planning à l'année)
+    .planning_portees = 0,
+    // Tirages individuels sous 10000 individus, gaussiens au-delà
+    .seuil_gaussien = SEUIL_GAUSSIEN_DEFAUT,
+};
 
-// Taux de survie mensuels des adultes selon leur âge (7 tranches d'âge)
-double survival_rate_month_adult[7];
+/**
+ * @brief Crée un jeu de paramètres avec les valeurs par défaut du modèle
+ *
+ * @return Jeu de paramètres finalisé (à libérer avec params_liberer)
+ */
+params_t *params_defaut()
+{
+    params_t *params = params_copier(NULL);
+    params_finaliser(params);
+    return params;
+}
 
-// Taux de survie mensuel des bébés
-double survival_rate_month_baby;
+/**
+ * @brief Copie un jeu de paramètres pour en créer une variante
+ *
+ * @param source Jeu à copier (NULL: valeurs par défaut)
+ * @return Copie modifiable, à finaliser par params_finaliser()
+ */
+params_t *params_copier(const params_t *source)
+{
+    params_t *params = malloc(sizeof(params_t));
+    *params = source ? *source : PARAMS_DEFAUT;
+    return params;
+}
 
 /**
- * @brief Initialise le tableau des probabilités de portées par an
+ * @brief Libère un jeu de paramètres
  *
- * Transforme les poids initiaux en probabilités cumulatives.
- * Par exemple, si les poids sont [0,0,0,1,1,2,2,2,1,1], la somme est 10
- * et on obtient des probabilités cumulatives pour tirer aléatoirement.
+ * @param params Jeu à libérer
  */
-void init_prob_litter()
+void params_liberer(const params_t *params)
 {
-    float somme = 0;
-    // Calcul de la somme des poids (indices 3 à 9 correspondent aux portées possibles)
-    for (int i = 3; i <= 9; i++)
+    free((void *)params);
+}
+
+/**
+ * @brief Empreinte des valeurs d'un jeu de paramètres
+ *
+ * Seules les valeurs biologiques saisies sont prises en compte: les tables
+ * de transition en sont déduites, et seuil_gaussien, réglage du moteur, est
+ * haché à part par les clés qui en dépendent (cache, journal). Deux jeux de
+ * mêmes valeurs ont la même empreinte, quel que soit le fichier dont ils
+ * viennent.
+ *
+ * @param params Jeu de paramètres
+ * @return Empreinte FNV-1a de 64 bits
+ */
+uint64_t params_empreinte(const params_t *params)
+{
+    uint64_t h = fnv1a(FNV1A_DEPART, params->poids_portees, sizeof(params->poids_portees));
+    h = fnv1a(h, params->maturite, sizeof(params->maturite));
+    h = fnv1a(h, params->survie_annuelle_adulte, sizeof(params->survie_annuelle_adulte));
+    h = fnv1a(h, &params->age_declin, sizeof(params->age_declin));
+    h = fnv1a(h, &params->survie_bebe, sizeof(params->survie_bebe));
+    h = fnv1a(h, &params->duree_survie_bebe, sizeof(params->duree_survie_bebe));
+    h = fnv1a(h, &params->proba_male, sizeof(params->proba_male));
+    h = fnv1a(h, &params->detail_ages, sizeof(params->detail_ages));
+    h = fnv1a(h, &params->planning_portees, sizeof(params->planning_portees));
+    return h;
+}
+
+/**
+ * @brief Adresse du réel d'indice j d'un jeu de paramètres
+ *
+ * @param params Jeu de paramètres
+ * @param j Indice (0 à NB_PARAMETRES - 1)
+ * @return Adresse de la valeur
+ */
+double *params_adresse(params_t *params, int j)
+{
+    if (j < 10)
+        return &params->poids_portees[j];
+    j -= 10;
+    if (j < NB_MOIS_MATURITE - 1)
+        return &params->maturite[j];
+    j -= NB_MOIS_MATURITE - 1;
+    if (j < NB_TRANCHES_SURVIE)
+        return &params->survie_annuelle_adulte[j];
+    return (j == NB_TRANCHES_SURVIE) ? &params->survie_bebe : &params->proba_male;
+}
+
+/**
+ * @brief Nom du réel d'indice j, avec la clé du fichier de paramètres
+ *
+ * @param j Indice (0 à NB_PARAMETRES - 1)
+ * @param nom Tampon de destination
+ * @param taille Taille du tampon
+ */
+void params_nom(int j, char *nom, size_t taille)
+{
+    if (j < 10)
+        snprintf(nom, taille, "poids_portees[%d]", j);
+    else if (j < 10 + NB_MOIS_MATURITE - 1)
+        snprintf(nom, taille, "maturite[%d]", j - 10);
+    else if (j < 10 + NB_MOIS_MATURITE - 1 + NB_TRANCHES_SURVIE)
+        snprintf(nom, taille, "survie_adulte[%d]", j - 10 - (NB_MOIS_MATURITE - 1));
+    else
+        snprintf(nom, taille, "%s", (j == NB_PARAMETRES - 2) ? "survie_bebe" : "proba_male");
+}
+
+/**
+ * @brief Indice d'un réel d'après son nom
+ *
+ * @param nom Nom (ex. « survie_adulte[0] »)
+ * @return Indice, -1 si le nom est inconnu
+ */
+int params_indice(const char *nom)
+{
+    char candidat[32];
+    for (int j = 0; j < NB_PARAMETRES; j++)
     {
-        somme += prob_litter[i];
+        params_nom(j, candidat, sizeof(candidat));
+        if (strcmp(candidat, nom) == 0)
+            return j;
     }
-    // Conversion en probabilités cumulatives
-    for (int i = 1; i <= 9; i++)
+    return -1;
+}
+
+/**
+ * @brief Lit une liste de réels après le signe '='
+ *
+ * @return Nombre de valeurs lues, -1 si une valeur n'est pas un nombre ou s'il y en a trop
+ */
+static int lire_valeurs(char *texte, double *valeurs, int max)
+{
+    int n = 0;
+    char *fin;
+    for (;;)
     {
-        prob_litter[i] = prob_litter[i] / somme + prob_litter[i - 1];
+        while (*texte == ' ' || *texte == '\t')
+            texte++;
+        if (*texte == '\0' || *texte == '\n' || *texte == '#')
+            return n;
+        if (n == max)
+            return -1;
+        valeurs[n++] = strtod(texte, &fin);
+        if (fin == texte)
+            return -1;
+        texte = fin;
     }
 }
 
 /**
- * @brief Initialise les taux de survie mensuels
+ * @brief Charge un jeu de paramètres depuis un fichier « cle = valeurs »
  *
- * Calcule les taux de survie mensuels à partir des taux annuels:
- * - Adultes: 7 tranches d'âge avec des taux décroissants (60%, 50%, ..., 0%)
- * - Bébés: taux de survie global de 35% sur 8 mois
+ * Format: une clé par ligne, suivie de '=' et des valeurs séparées par des
+ * espaces; '#' commence un commentaire. Clés reconnues: poids_portees (10),
+ * maturite (11), survie_adulte (7), age_declin, survie_bebe,
+ * duree_survie_bebe, proba_male, detail_ages, planning_portees,
+ * seuil_gaussien. Les clés absentes gardent leur valeur par défaut.
+ *
+ * @param chemin Chemin du fichier
+ * @return Jeu de paramètres finalisé, NULL si le fichier est invalide
  */
-void init_survival_rate()
+params_t *params_charger(const char *chemin)
 {
-    // Calcul des taux de survie mensuels pour les adultes selon leur âge
-    for (int i = 0; i < 7; i++)
+    FILE *f = fopen(chemin, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Erreur : impossible d'ouvrir %s\n", chemin);
+        return NULL;
+    }
+
+    params_t *params = params_copier(NULL);
+    char ligne[TAILLE_LIGNE];
+    int num_ligne = 0;
+    int erreur = 0;
+
+    while (!erreur && fgets(ligne, sizeof(ligne), f))
+    {
+        num_ligne++;
+        char *egal = strchr(ligne, '=');
+        char cle[64];
+        if (sscanf(ligne, " %63[a-z_]", cle) != 1)
+            continue; // Ligne vide ou commentaire
+        if (!egal)
+        {
+            erreur = 1;
+            break;
+        }
+
+        double valeurs[NB_MOIS_MATURITE];
+        int n = lire_valeurs(egal + 1, valeurs, NB_MOIS_MATURITE);
+        if (strcmp(cle, "poids_portees") == 0 && n == 10)
+            memcpy(params->poids_portees, valeurs, sizeof(params->poids_portees));
+        else if (strcmp(cle, "maturite") == 0 && n == NB_MOIS_MATURITE)
+            memcpy(params->maturite, valeurs, sizeof(params->maturite));
+        else if (strcmp(cle, "survie_adulte") == 0 && n == NB_TRANCHES_SURVIE)
+            memcpy(params->survie_annuelle_adulte, valeurs, sizeof(params->survie_annuelle_adulte));
+        else if (strcmp(cle, "age_declin") == 0 && n == 1)
+            params->age_declin = (int)valeurs[0];
+        else if (strcmp(cle, "survie_bebe") == 0 && n == 1)
+            params->survie_bebe = valeurs[0];
+        else if (strcmp(cle, "duree_survie_bebe") == 0 && n == 1)
+            params->duree_survie_bebe = (int)valeurs[0];
+        else if (strcmp(cle, "proba_male") == 0 && n == 1)
+            params->proba_male = valeurs[0];
+        else if (strcmp(cle, "detail_ages") == 0 && n == 1)
+            params->detail_ages = (valeurs[0] != 0);
+        else if (strcmp(cle, "planning_portees") == 0 && n == 1)
+            params->planning_portees = (valeurs[0] != 0);
+        else if (strcmp(cle, "seuil_gaussien") == 0 && n == 1)
+            params->seuil_gaussien = (valeurs[0] >= 1 && valeurs[0] < ULONG_MAX) ? (unsigned long)valeurs[0] : 0;
+        else
+            erreur = 1;
+    }
+    fclose(f);
+
+    if (erreur)
+    {
+        fprintf(stderr, "Erreur : %s, ligne %d : clé inconnue ou nombre de valeurs incorrect\n", chemin, num_ligne);
+        params_liberer(params);
+        return NULL;
+    }
+    if (params_finaliser(params) != 0)
     {
-        double rate = 0.6 - i * 0.1; // Taux annuel: 60% -> 50% -> ... -> 0%
-        if (rate < 0)
-            rate = 0;
-        // Conversion en taux mensuel (racine 12ème du taux annuel)
-        survival_rate_month_adult[i] = pow(rate, 1.0 / 12.0);
+        fprintf(stderr, "Erreur : jeu de paramètres %s invalide\n", chemin);
+        params_liberer(params);
+        return NULL;
     }
-    // Taux de survie mensuel des bébés (35% de survie sur 8 mois)
-    survival_rate_month_baby = pow(0.35, 1.0 / 8.0);
+    return params;
+}
+
+/**
+ * @brief Vérifie qu'une valeur est une probabilité
+ */
+static int est_probabilite(double p)
+{
+    return p >= 0 && p <= 1;
+}
+
+/**
+ * @brief Vérifie la cohérence d'un jeu de paramètres
+ *
+ * @return 0 si le jeu est valide, -1 sinon (message sur stderr)
+ */
+static int params_valider(const params_t *params)
+{
+    double somme = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        if (params->poids_portees[i] < 0)
+        {
+            fprintf(stderr, "Erreur : poids_portees[%d] négatif\n", i);
+            return -1;
+        }
+        somme += params->poids_portees[i];
+    }
+    if (somme <= 0)
+    {
+        fprintf(stderr, "Erreur : poids_portees tous nuls\n");
+        return -1;
+    }
+    for (int i = 0; i < NB_MOIS_MATURITE; i++)
+    {
+        if (!est_probabilite(params->maturite[i]))
+        {
+            fprintf(stderr, "Erreur : maturite[%d] hors de [0, 1]\n", i);
+            return -1;
+        }
+    }
+    if (params->maturite[NB_MOIS_MATURITE - 1] != 1)
+    {
+        fprintf(stderr, "Erreur : tous les bébés doivent être matures à %d mois\n", NB_MOIS_MATURITE - 1);
+        return -1;
+    }
+    for (int i = 0; i < NB_TRANCHES_SURVIE; i++)
+    {
+        if (!est_probabilite(params->survie_annuelle_adulte[i]))
+        {
+            fprintf(stderr, "Erreur : survie_adulte[%d] hors de [0, 1]\n", i);
+            return -1;
+        }
+    }
+    if (params->age_declin < 0 || params->age_declin > AGE_MAX)
+    {
+        fprintf(stderr, "Erreur : age_declin hors de [0, %d]\n", AGE_MAX);
+        return -1;
+    }
+    if (!est_probabilite(params->survie_bebe) || params->duree_survie_bebe < 1)
+    {
+        fprintf(stderr, "Erreur : survie_bebe ou duree_survie_bebe invalide\n");
+        return -1;
+    }
+    if (!est_probabilite(params->proba_male))
+    {
+        fprintf(stderr, "Erreur : proba_male hors de [0, 1]\n");
+        return -1;
+    }
+    if (params->seuil_gaussien < 1)
+    {
+        fprintf(stderr, "Erreur : seuil_gaussien doit être un entier positif\n");
+        return -1;
+    }
+    return 0;
 }
 
 /**
  * @brief Retourne le taux de survie mensuel d'un adulte selon son âge
  *
+ * @param params Jeu de paramètres
  * @param year Âge du lapin en années
  * @return Taux de survie mensuel (probabilité entre 0 et 1)
  *
- * Les lapins de moins de 10 ans ont le meilleur taux de survie.
- * Au-delà, le taux diminue progressivement jusqu'à 0 après 16 ans.
+ * Les lapins jusqu'à age_declin ont le meilleur taux de survie.
+ * Au-delà, le taux diminue d'une tranche par année jusqu'à la dernière.
+ */
+double survival_rate_adult(const params_t *params, int year)
+{
+    int index = year - params->age_declin;
+    if (index < 0)
+        index = 0; // Jeunes adultes (meilleur taux)
+    if (index >= NB_TRANCHES_SURVIE)
+        index = NB_TRANCHES_SURVIE - 1; // Adultes très âgés (taux minimum)
+    // Conversion en taux mensuel (racine 12ème du taux annuel)
+    return pow(params->survie_annuelle_adulte[index], 1.0 / 12.0);
+}
+
+/**
+ * @brief Convertit une probabilité en seuil entier sur 32 bits
+ *
+ * @param p Probabilité (bornée à [0, 1])
+ * @return Seuil s tel que P(genrand_int32() < s) = p, à 2^-32 près
+ */
+uint64_t seuil_probabilite(double p)
+{
+    if (p <= 0)
+        return 0;
+    if (p >= 1)
+        return SEUIL_CERTAIN;
+    return (uint64_t)(p * 4294967296.0 + 0.5);
+}
+
+/**
+ * @brief Valide un jeu de paramètres et calcule ses tables de transition
+ *
+ * Évalue une seule fois toutes les probabilités utilisées dans les boucles
+ * de simulation (survie par âge, maturité, accouchement selon le mois et
+ * le nombre de portées restantes, nombre de portées par an) ainsi que
+ * leurs seuils entiers, et détermine les âges adultes regroupables.
+ *
+ * @param params Jeu de paramètres à finaliser
+ * @return 0 si le jeu est valide, -1 sinon (message sur stderr)
  */
-double survival_rate_adult(int year)
+int params_finaliser(params_t *params)
 {
-    if (year < 10)
-        return survival_rate_month_adult[0]; // Jeunes adultes (meilleur taux)
-    int index = year - 10;
-    if (index >= 7)
-        index = 6; // Adultes très âgés (taux minimum)
-    return survival_rate_month_adult[index];
+    if (params_valider(params) != 0)
+        return -1;
+
+    tables_transition *t = &params->transitions;
+
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        t->survie_adulte[age] = survival_rate_adult(params, age);
+        t->seuil_survie_adulte[age] = seuil_probabilite(t->survie_adulte[age]);
+    }
+
+    // Taux de survie mensuel des bébés (racine de la survie globale)
+    t->survie_bebe = pow(params->survie_bebe, 1.0 / params->duree_survie_bebe);
+    t->seuil_survie_bebe = seuil_probabilite(t->survie_bebe);
+
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        t->maturite[month] = (month < NB_MOIS_MATURITE) ? params->maturite[month] : 1;
+        t->seuil_maturite[month] = seuil_probabilite(t->maturite[month]);
+
+        // Une femelle accouche avec probabilité acc_rest / (nombre de mois restants)
+        for (int acc_rest = 0; acc_rest < 10; acc_rest++)
+        {
+            double p = (double)acc_rest / (NB_MONTHS - month);
+            t->accouchement[month][acc_rest] = (p > 1) ? 1 : p;
+            t->seuil_accouchement[month][acc_rest] = seuil_probabilite(p);
+        }
+    }
+
+    t->proba_male = params->proba_male;
+    t->seuil_male = seuil_probabilite(params->proba_male);
+
+    // Conversion des poids en probabilités cumulées (les poids ne sont pas modifiés)
+    double somme = 0;
+    for (int i = 0; i < 10; i++)
+        somme += params->poids_portees[i];
+    double cumul = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        cumul += params->poids_portees[i] / somme;
+        t->portees_cumul[i] = (i == 9) ? 1 : cumul;
+        t->seuil_portees[i] = seuil_probabilite(t->portees_cumul[i]);
+    }
+
+    // Classe adulte: âges 1 à age_classe, tous au taux de survie de l'âge 1
+    t->age_classe = 0;
+    if (!params->detail_ages)
+    {
+        int age = 1;
+        while (age + 1 < AGE_MAX && t->survie_adulte[age + 1] == t->survie_adulte[1])
+            age++;
+        if (age >= 2)
+            t->age_classe = age;
+    }
+
+    t->seuil_gaussien = params->seuil_gaussien;
+    return 0;
 }
@@ -2,34 +2,158 @@
  * @file config.h
  * @brief Fichier d'en-tête pour la configuration des paramètres de simulation
  *
- * Ce fichier déclare les fonctions d'initialisation et de calcul des paramètres
- * biologiques de la simulation (probabilités de portée, taux de survie).
+ * Ce fichier déclare le jeu de paramètres biologiques params_t (probabilités
+ * de portée, maturité, taux de survie) et les tables de transition qui en
+ * sont dérivées. Un jeu de paramètres est immuable une fois finalisé: plusieurs
+ * jeux peuvent être utilisés côte à côte dans un même processus.
  */
 
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+#include "simulation.h"
+
+#define SEUIL_CERTAIN 4294967296ULL // Seuil d'une probabilité 1 (2^32)
+#define NB_TRANCHES_SURVIE 7        // Tranches d'âge du taux de survie adulte
+#define NB_MOIS_MATURITE 11         // Mois d'âge 0 à 10 pour la maturité des bébés
+#define SEUIL_GAUSSIEN_DEFAUT 10000 // Effectif à partir duquel le moteur mensuel tire en gaussien
+#define NB_PARAMETRES (10 + NB_MOIS_MATURITE - 1 + NB_TRANCHES_SURVIE + 2) // Réels accessibles par indice
+
+/**
+ * @struct tables_transition
+ * @brief Probabilités de transition précalculées et seuils entiers associés
+ *
+ * Chaque probabilité p est accompagnée d'un seuil entier s = p * 2^32:
+ * une épreuve de Bernoulli se réduit alors à genrand_int32() < s.
+ * Les probabilités (double) alimentent les approximations gaussiennes.
+ */
+typedef struct tables_transition
+{
+    double survie_adulte[AGE_MAX + 1];            // Survie mensuelle selon l'âge en années
+    uint64_t seuil_survie_adulte[AGE_MAX + 1];    // Seuils entiers associés
+    double survie_bebe;                           // Survie mensuelle des bébés
+    uint64_t seuil_survie_bebe;                   // Seuil entier associé
+    double maturite[NB_MONTHS];                   // Probabilité de maturité selon le mois d'âge
+    uint64_t seuil_maturite[NB_MONTHS];           // Seuils entiers associés
+    double proba_male;                            // Probabilité qu'un bébé mature soit un mâle
+    uint64_t seuil_male;                          // Seuil entier associé
+    double accouchement[NB_MONTHS][10];           // Probabilité d'accoucher selon (mois, portées restantes)
+    uint64_t seuil_accouchement[NB_MONTHS][10];   // Seuils entiers associés
+    double portees_cumul[10];                     // Probabilités cumulées du nombre de portées par an
+    uint64_t seuil_portees[10];                   // Seuils entiers associés
+    int age_classe;                               // Dernier âge regroupé dans la classe adulte (0: âges détaillés)
+    unsigned long seuil_gaussien;                 // Effectif à partir duquel les tirages sont gaussiens
+} tables_transition;
+
+/**
+ * @struct params_t
+ * @brief Jeu de paramètres biologiques et tables dérivées
+ */
+struct params_t
+{
+    double poids_portees[10];                         // Poids du nombre de portées par an (0 à 9)
+    double maturite[NB_MOIS_MATURITE];                // Probabilité de maturité par mois d'âge
+    double survie_annuelle_adulte[NB_TRANCHES_SURVIE]; // Survie annuelle: âge <= age_declin, puis +1 an, ...
+    int age_declin;                                   // Dernier âge (années) au taux de survie maximal
+    double survie_bebe;                               // Survie globale des bébés sur duree_survie_bebe mois
+    int duree_survie_bebe;                            // Durée (mois) associée à survie_bebe
+    double proba_male;                                // Probabilité qu'un bébé mature soit un mâle
+    int detail_ages;                                  // 1: un compteur par âge adulte, sans regroupement
+    int planning_portees;                             // 1: mois de mise bas tirés à l'attribution des portées
+    unsigned long seuil_gaussien;                     // Effectif à partir duquel le moteur mensuel tire en gaussien
+    tables_transition transitions;                    // Tables dérivées (remplies par params_finaliser)
+};
+
+/**
+ * @brief Crée un jeu de paramètres avec les valeurs par défaut du modèle
+ * @return Jeu de paramètres finalisé (à libérer avec params_liberer)
+ */
+params_t *params_defaut();
+
 /**
- * @brief Initialise le tableau des probabilités de portées par an
+ * @brief Charge un jeu de paramètres depuis un fichier « cle = valeurs »
+ *
+ * Les clés absentes gardent leur valeur par défaut.
  *
- * Transforme les poids en probabilités cumulatives pour permettre
- * un tirage aléatoire du nombre de portées.
+ * @param chemin Chemin du fichier
+ * @return Jeu de paramètres finalisé, NULL si le fichier est invalide
  */
-void init_prob_litter();
+params_t *params_charger(const char *chemin);
 
 /**
- * @brief Initialise les taux de survie mensuels pour adultes et bébés
+ * @brief Copie un jeu de paramètres pour en créer une variante
  *
- * Calcule les taux de survie mensuels à partir des taux annuels en utilisant
- * une formule de racine 12ème pour les adultes et 8ème pour les bébés.
+ * La copie doit être finalisée par params_finaliser() après modification.
+ *
+ * @param source Jeu à copier (NULL: valeurs par défaut)
+ * @return Copie modifiable
+ */
+params_t *params_copier(const params_t *source);
+
+/**
+ * @brief Valide un jeu de paramètres et calcule ses tables de transition
+ * @param params Jeu de paramètres à finaliser
+ * @return 0 si le jeu est valide, -1 sinon (message sur stderr)
+ */
+int params_finaliser(params_t *params);
+
+/**
+ * @brief Libère un jeu de paramètres
+ * @param params Jeu à libérer
  */
-void init_survival_rate();
+void params_liberer(const params_t *params);
+
+/**
+ * @brief Empreinte des valeurs d'un jeu de paramètres (tables dérivées exclues)
+ * @param params Jeu de paramètres
+ * @return Empreinte FNV-1a de 64 bits
+ */
+uint64_t params_empreinte(const params_t *params);
+
+/**
+ * @brief Adresse du réel d'indice j d'un jeu de paramètres
+ *
+ * Indices: poids_portees[0..9], maturite[0..9] (maturite[10] vaut toujours
+ * 1), survie_adulte[0..6], survie_bebe, proba_male. Le jeu modifié doit être
+ * finalisé de nouveau.
+ *
+ * @param params Jeu de paramètres
+ * @param j Indice (0 à NB_PARAMETRES - 1)
+ * @return Adresse de la valeur
+ */
+double *params_adresse(params_t *params, int j);
+
+/**
+ * @brief Nom du réel d'indice j, avec la clé du fichier de paramètres
+ *
+ * @param j Indice (0 à NB_PARAMETRES - 1)
+ * @param nom Tampon de destination (« survie_adulte[0] »...)
+ * @param taille Taille du tampon
+ */
+void params_nom(int j, char *nom, size_t taille);
+
+/**
+ * @brief Indice d'un réel d'après son nom (params_nom)
+ *
+ * @param nom Nom (ex. « survie_adulte[0] »)
+ * @return Indice, -1 si le nom est inconnu
+ */
+int params_indice(const char *nom);
 
 /**
  * @brief Calcule le taux de survie mensuel d'un adulte selon son âge
+ * @param params Jeu de paramètres
  * @param year Âge du lapin en années
  * @return Taux de survie mensuel (probabilité entre 0 et 1)
  */
-double survival_rate_adult(int year);
+double survival_rate_adult(const params_t *params, int year);
+
+/**
+ * @brief Convertit une probabilité en seuil entier sur 32 bits
+ * @param p Probabilité (bornée à [0, 1])
+ * @return Seuil s tel que P(genrand_int32() < s) = p
+ */
+uint64_t seuil_probabilite(double p);
 
 #endif // CONFIG_H
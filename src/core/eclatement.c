@@ -0,0 +1,383 @@
+/**
+ * @file eclatement.c
+ * @brief Implémentation de l'estimation de la probabilité d'extinction par éclatement multiniveau
+ *
+ * Une étape simule ses trajectoires sur plusieurs threads: chacune part d'un
+ * état franchi à l'étape précédente (copié, l'original restant partagé en
+ * lecture) ou, à la première étape, d'une population initiale tirée avec
+ * son propre flux. Le Monte-Carlo direct est une étape unique dont le seuil
+ * est l'extinction.
+ */
+
+#include "eclatement.h"
+#include "population.h"
+#include "config.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#define RAPPORT_NIVEAUX 0.75 // Rapport entre deux seuils successifs par défaut
+#define EXTINCTION (-1L)     // Seuil de la dernière étape: population totale nulle
+
+/**
+ * @struct etape_eclatement
+ * @brief Trajectoires d'une étape, partagées entre les threads de calcul
+ */
+typedef struct etape_eclatement
+{
+    scenario sc;              // Condition initiale, horizon et paramètres
+    long seuil;               // Seuil d'effectif à franchir, EXTINCTION pour la dernière étape
+    population **departs;     // État de départ de chaque trajectoire (NULL: population initiale)
+    int *mois_departs;        // Mois de départ de chaque trajectoire
+    population **arrivees;    // État au franchissement (NULL: horizon atteint ou état non gardé)
+    int *mois_arrivees;       // Mois du franchissement
+    char *franchi;            // 1 si la trajectoire a franchi le seuil
+    int effort;               // Nombre de trajectoires
+    unsigned long cle[4];     // Clé du flux: graine, répétition, étape, trajectoire
+    atomic_int prochaine;     // Prochaine trajectoire à simuler
+    atomic_long mois;         // Mois simulés par l'étape
+} etape_eclatement;
+
+/**
+ * @brief Réglages par défaut pour une population initiale donnée
+ *
+ * @param adultes_initiaux Nombre initial d'adultes
+ * @return Réglages
+ */
+options_eclatement options_eclatement_defaut(long adultes_initiaux)
+{
+    options_eclatement opt = {0};
+    opt.effort = 1000;
+    opt.nb_repetitions = 10;
+    long seuil = adultes_initiaux;
+    while (seuil > 1 && opt.nb_niveaux < NIVEAUX_MAX)
+    {
+        long suivant = (long)(seuil * RAPPORT_NIVEAUX);
+        seuil = (suivant < seuil - 1) ? suivant : seuil - 1;
+        opt.niveaux[opt.nb_niveaux++] = (seuil > 1) ? seuil : 1;
+    }
+    return opt;
+}
+
+/**
+ * @brief Indique si une population a franchi un seuil
+ *
+ * L'effectif comparé au seuil est adultes + survie_bebe * bébés.
+ *
+ * @param pop Population
+ * @param seuil Effectif à atteindre par le bas, EXTINCTION pour une population éteinte
+ * @return 1 si le seuil est franchi
+ */
+static int seuil_franchi(const population *pop, long seuil)
+{
+    const totaux_population *tot = &pop->totaux;
+    if (seuil == EXTINCTION)
+    {
+        int eteinte = mpz_sgn(tot->bebes) == 0 && mpz_sgn(tot->males) == 0;
+        for (int i = 0; i < 10 && eteinte; i++)
+            eteinte = mpz_sgn(tot->femelles[i]) == 0;
+        return eteinte;
+    }
+    double adultes = mpz_get_d(tot->males);
+    for (int i = 0; i < 10; i++)
+        adultes += mpz_get_d(tot->femelles[i]);
+    return adultes + pop->params->survie_bebe * mpz_get_d(tot->bebes) <= seuil;
+}
+
+/**
+ * @brief Thread de calcul: simule les trajectoires de l'étape jusqu'à épuisement
+ */
+static void *thread_etape(void *arg)
+{
+    etape_eclatement *e = arg;
+    int mois_max = e->sc.annees * NB_MONTHS;
+    int i;
+    while ((i = atomic_fetch_add(&e->prochaine, 1)) < e->effort)
+    {
+        unsigned long cle[4] = {e->cle[0], e->cle[1], e->cle[2], (unsigned long)i};
+        init_by_array(cle, 4);
+
+        population *pop;
+        int mois = 0;
+        if (e->departs)
+        {
+            pop = copier_population(e->departs[i]);
+            mois = e->mois_departs[i];
+        }
+        else
+        {
+            mpz_t nbFemale, nbMale;
+            mpz_init_set_ui(nbFemale, e->sc.nb_femelles);
+            mpz_init_set_ui(nbMale, e->sc.nb_males);
+            pop = initialize_population(e->sc.params, nbFemale, nbMale);
+            mpz_clears(nbFemale, nbMale, NULL);
+        }
+
+        int debut = mois;
+        int franchi;
+        while (!(franchi = seuil_franchi(pop, e->seuil)) && mois < mois_max)
+        {
+            simulate_month(pop);
+            mois++;
+        }
+        atomic_fetch_add(&e->mois, mois - debut);
+
+        e->franchi[i] = (char)franchi;
+        if (franchi && e->arrivees)
+        {
+            e->arrivees[i] = pop;
+            e->mois_arrivees[i] = mois;
+        }
+        else
+        {
+            liberer_population(pop);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Simule toutes les trajectoires d'une étape sur plusieurs threads
+ *
+ * @param e Étape (departs, arrivees et franchi alloués)
+ * @param nb_threads Nombre de threads de calcul
+ * @return Nombre de trajectoires qui ont franchi le seuil
+ */
+static int simuler_etape(etape_eclatement *e, int nb_threads)
+{
+    atomic_init(&e->prochaine, 0);
+    atomic_init(&e->mois, 0);
+    int t_lances = (e->effort < nb_threads) ? e->effort : nb_threads;
+    pthread_t *threads = malloc(t_lances * sizeof(pthread_t));
+    for (int t = 0; t < t_lances; t++)
+        pthread_create(&threads[t], NULL, thread_etape, e);
+    for (int t = 0; t < t_lances; t++)
+        pthread_join(threads[t], NULL);
+    free(threads);
+
+    int nb = 0;
+    for (int i = 0; i < e->effort; i++)
+        nb += e->franchi[i];
+    return nb;
+}
+
+/**
+ * @brief Répartit les trajectoires d'une étape entre les états franchis (rééchantillonnage résiduel)
+ *
+ * Chaque état est repris effort / nb fois; les effort % nb départs restants
+ * vont à des états distincts tirés uniformément. Chaque état est ainsi
+ * repris effort / nb fois en moyenne.
+ *
+ * @param etats États franchis à l'étape précédente
+ * @param mois Mois de franchissement de ces états
+ * @param nb Nombre d'états
+ * @param e Étape dont les départs sont à remplir
+ */
+static void repartir_departs(population **etats, const int *mois, int nb, etape_eclatement *e)
+{
+    int *ordre = malloc(nb * sizeof(int));
+    for (int k = 0; k < nb; k++)
+        ordre[k] = k;
+    int reste = e->effort % nb;
+    for (int k = 0; k < reste; k++)
+    {
+        int j = k + (int)(genrand_int32() % (unsigned long)(nb - k));
+        int t = ordre[k];
+        ordre[k] = ordre[j];
+        ordre[j] = t;
+    }
+
+    int i = 0;
+    for (int k = 0; k < nb; k++)
+    {
+        int copies = e->effort / nb + (k < reste);
+        for (int c = 0; c < copies; c++, i++)
+        {
+            e->departs[i] = etats[ordre[k]];
+            e->mois_departs[i] = mois[ordre[k]];
+        }
+    }
+    free(ordre);
+}
+
+/**
+ * @brief Une répétition de l'éclatement multiniveau
+ *
+ * @param sc Scénario
+ * @param opt Réglages
+ * @param seed Graine
+ * @param r Numéro de la répétition
+ * @param nb_threads Nombre de threads de calcul
+ * @param passage Probabilité de passage de chaque étape (remplie jusqu'à la dernière étape simulée)
+ * @param nb_etapes Nombre d'étapes simulées
+ * @param mois Mois simulés (ajoutés)
+ * @return Probabilité d'extinction estimée par cette répétition
+ */
+static double repetition_eclatement(scenario sc, const options_eclatement *opt, unsigned long seed, int r,
+                                    int nb_threads, double passage[], int *nb_etapes, double *mois)
+{
+    int effort = opt->effort;
+    etape_eclatement e;
+    e.sc = sc;
+    e.effort = effort;
+    e.cle[0] = seed;
+    e.cle[1] = (unsigned long)r;
+    e.departs = NULL;
+    e.mois_departs = malloc(effort * sizeof(int));
+    e.arrivees = malloc(effort * sizeof(population *));
+    e.mois_arrivees = malloc(effort * sizeof(int));
+    e.franchi = malloc(effort);
+    population **departs = malloc(effort * sizeof(population *));
+
+    // États franchis à l'étape précédente
+    population **etats = malloc(effort * sizeof(population *));
+    int *mois_etats = malloc(effort * sizeof(int));
+    int nb_etats = 0;
+
+    double proba = 1;
+    *nb_etapes = 0;
+    for (int k = 0; k <= opt->nb_niveaux && proba > 0; k++)
+    {
+        int derniere = (k == opt->nb_niveaux);
+        e.seuil = derniere ? EXTINCTION : opt->niveaux[k];
+        e.cle[2] = (unsigned long)k;
+        if (k > 0)
+        {
+            // Tirage des départs dans un flux propre à l'étape; le flux de l'appelant est rétabli
+            etat_genrand appelant;
+            lire_etat_genrand(&appelant);
+            unsigned long cle[4] = {seed, (unsigned long)r, (unsigned long)k, ~0UL};
+            init_by_array(cle, 4);
+            e.departs = departs;
+            repartir_departs(etats, mois_etats, nb_etats, &e);
+            ecrire_etat_genrand(&appelant);
+        }
+        population **arrivees = e.arrivees;
+        if (derniere)
+            e.arrivees = NULL;
+        for (int i = 0; i < effort; i++)
+            if (e.arrivees)
+                e.arrivees[i] = NULL;
+
+        int nb = simuler_etape(&e, nb_threads);
+        *mois += atomic_load(&e.mois);
+        e.arrivees = arrivees;
+        passage[k] = (double)nb / effort;
+        proba *= passage[k];
+        (*nb_etapes)++;
+
+        // Les états franchis remplacent ceux de l'étape précédente
+        for (int j = 0; j < nb_etats; j++)
+            liberer_population(etats[j]);
+        nb_etats = 0;
+        if (!derniere)
+        {
+            for (int i = 0; i < effort; i++)
+            {
+                if (e.franchi[i])
+                {
+                    etats[nb_etats] = e.arrivees[i];
+                    mois_etats[nb_etats++] = e.mois_arrivees[i];
+                }
+            }
+        }
+    }
+
+    for (int j = 0; j < nb_etats; j++)
+        liberer_population(etats[j]);
+    free(etats);
+    free(mois_etats);
+    free(departs);
+    free(e.mois_departs);
+    free(e.arrivees);
+    free(e.mois_arrivees);
+    free(e.franchi);
+    return proba;
+}
+
+/**
+ * @brief Estime la probabilité d'extinction avant sc.annees années par éclatement multiniveau
+ *
+ * @param sc Scénario
+ * @param opt Réglages
+ * @param seed Graine
+ * @param res Estimation
+ */
+void extinction_eclatement(scenario sc, const options_eclatement *opt, unsigned long seed,
+                           estimation_extinction *res)
+{
+    int nb_threads = (opt->nb_threads > 0) ? opt->nb_threads : nb_threads_defaut();
+    int nb_rep = opt->nb_repetitions;
+    double *probas = malloc(nb_rep * sizeof(double));
+    double somme_passage[NIVEAUX_MAX + 1] = {0};
+    int nb_passage[NIVEAUX_MAX + 1] = {0};
+
+    memset(res, 0, sizeof(*res));
+    res->nb_niveaux = opt->nb_niveaux + 1;
+    for (int r = 0; r < nb_rep; r++)
+    {
+        double passage[NIVEAUX_MAX + 1];
+        int nb_etapes;
+        probas[r] = repetition_eclatement(sc, opt, seed, r, nb_threads, passage, &nb_etapes, &res->mois_simules);
+        for (int k = 0; k < nb_etapes; k++)
+        {
+            somme_passage[k] += passage[k];
+            nb_passage[k]++;
+        }
+    }
+
+    double variance = 0;
+    for (int r = 0; r < nb_rep; r++)
+        res->proba += probas[r] / nb_rep;
+    for (int r = 0; r < nb_rep; r++)
+        variance += (probas[r] - res->proba) * (probas[r] - res->proba) / ((nb_rep > 1) ? nb_rep - 1 : 1);
+    res->demi_largeur = (nb_rep > 1) ? quantile_student_95(nb_rep - 1) * sqrt(variance / nb_rep) : INFINITY;
+    res->borne_basse = fmax(res->proba - res->demi_largeur, 0);
+    res->borne_haute = fmin(res->proba + res->demi_largeur, 1);
+    for (int k = 0; k < res->nb_niveaux; k++)
+        res->passage[k] = nb_passage[k] ? somme_passage[k] / nb_passage[k] : 0;
+    free(probas);
+}
+
+/**
+ * @brief Estime la probabilité d'extinction par Monte-Carlo direct (référence)
+ *
+ * @param sc Scénario
+ * @param nb_replications Nombre de réplications
+ * @param nb_threads Threads de calcul (0: nombre de cœurs)
+ * @param seed Graine
+ * @param res Estimation
+ */
+void extinction_naive(scenario sc, int nb_replications, int nb_threads, unsigned long seed,
+                      estimation_extinction *res)
+{
+    etape_eclatement e;
+    e.sc = sc;
+    e.seuil = EXTINCTION;
+    e.departs = NULL;
+    e.mois_departs = NULL;
+    e.arrivees = NULL;
+    e.mois_arrivees = NULL;
+    e.franchi = malloc(nb_replications);
+    e.effort = nb_replications;
+    e.cle[0] = seed;
+    e.cle[1] = ~0UL; // Flux distincts de ceux de l'éclatement
+    e.cle[2] = 0;
+
+    int nb = simuler_etape(&e, (nb_threads > 0) ? nb_threads : nb_threads_defaut());
+    memset(res, 0, sizeof(*res));
+    res->nb_niveaux = 1;
+    res->proba = (double)nb / nb_replications;
+
+    // IC de Wilson: reste informatif quand aucune (ou chaque) réplication ne s'éteint
+    double z2 = 1.96 * 1.96, n = nb_replications, p = res->proba;
+    double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double ecart = 1.96 * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+    res->borne_basse = fmax(centre - ecart, 0);
+    res->borne_haute = fmin(centre + ecart, 1);
+    res->demi_largeur = (res->borne_haute - res->borne_basse) / 2;
+    res->passage[0] = res->proba;
+    res->mois_simules = atomic_load(&e.mois);
+    free(e.franchi);
+}
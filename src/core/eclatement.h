@@ -0,0 +1,108 @@
+/**
+ * @file eclatement.h
+ * @brief Fichier d'en-tête de l'estimation de la probabilité d'extinction par éclatement multiniveau
+ *
+ * L'extinction d'un petit groupe fondateur avant un horizon donné peut être
+ * trop rare pour être estimée par des réplications indépendantes: il en
+ * faudrait des millions pour l'observer quelques fois. L'éclatement
+ * multiniveau (splitting à effort fixe) la décompose en passages
+ * successifs de seuils décroissants de l'effectif, le dernier niveau étant
+ * l'extinction (population totale nulle). L'effectif compte les adultes et
+ * les bébés pondérés par leur survie jusqu'à la maturité (survie_bebe): une
+ * portée de bébés, dont la plupart mourront, ne l'éloigne pas autant de
+ * l'extinction que le même nombre d'adultes.
+ *
+ * - l'étape k simule effort trajectoires depuis les états qui ont franchi
+ *   le seuil k - 1, jusqu'à ce qu'elles franchissent le seuil k ou
+ *   atteignent l'horizon
+ * - la proportion p_k de trajectoires qui franchissent le seuil estime la
+ *   probabilité conditionnelle de passage; les états au franchissement,
+ *   copiés avec copier_population(), sont les départs de l'étape suivante
+ *   (avec leur mois: l'horizon reste le même)
+ * - la probabilité d'extinction est estimée par le produit des p_k
+ *
+ * Les départs sont répartis entre les états par rééchantillonnage résiduel
+ * (chaque état est repris effort / n fois, le reste est tiré sans remise),
+ * ce qui garde l'estimateur sans biais. L'IC à 95% est calculé sur des
+ * répétitions indépendantes de tout l'algorithme.
+ */
+
+#ifndef ECLATEMENT_H
+#define ECLATEMENT_H
+
+#include "replication.h"
+
+#define NIVEAUX_MAX 32 // Nombre maximal de seuils intermédiaires
+
+/**
+ * @struct options_eclatement
+ * @brief Réglages de l'éclatement multiniveau
+ */
+typedef struct options_eclatement
+{
+    int nb_niveaux;            // Nombre de seuils intermédiaires (l'extinction est le dernier niveau)
+    long niveaux[NIVEAUX_MAX]; // Seuils décroissants de l'effectif (franchi: effectif <= seuil)
+    int effort;                // Trajectoires simulées à chaque étape
+    int nb_repetitions;        // Répétitions indépendantes de l'algorithme (au moins 2 pour l'IC)
+    int nb_threads;            // Threads de calcul (0: nombre de cœurs)
+} options_eclatement;
+
+/**
+ * @struct estimation_extinction
+ * @brief Probabilité d'extinction estimée et coût de l'estimation
+ */
+typedef struct estimation_extinction
+{
+    double proba;                          // Probabilité d'extinction avant l'horizon
+    double demi_largeur;                   // Demi-largeur de l'IC à 95%
+    double borne_basse;                    // Borne basse de l'IC à 95%
+    double borne_haute;                    // Borne haute de l'IC à 95%
+    int nb_niveaux;                        // Étapes de l'estimation (1 pour le Monte-Carlo direct)
+    double passage[NIVEAUX_MAX + 1];       // Probabilité moyenne de passage de chaque étape
+    double mois_simules;                   // Coût: nombre total de mois simulés
+} estimation_extinction;
+
+/**
+ * @brief Réglages par défaut pour une population initiale donnée
+ *
+ * Seuils géométriques (rapport 0,75) sous le nombre initial d'adultes,
+ * jusqu'à 1; 1000 trajectoires par étape, 10 répétitions.
+ *
+ * @param adultes_initiaux Nombre initial d'adultes
+ * @return Réglages
+ */
+options_eclatement options_eclatement_defaut(long adultes_initiaux);
+
+/**
+ * @brief Estime la probabilité d'extinction avant sc.annees années par éclatement multiniveau
+ *
+ * Les trajectoires d'une étape sont réparties entre les threads; chacune a
+ * son propre flux MT19937, tiré de (seed, répétition, étape, trajectoire):
+ * le résultat ne dépend pas du nombre de threads. Le générateur du thread
+ * appelant est rendu dans l'état où il a été trouvé.
+ *
+ * @param sc Scénario (condition initiale, horizon, paramètres)
+ * @param opt Réglages
+ * @param seed Graine
+ * @param res Estimation
+ */
+void extinction_eclatement(scenario sc, const options_eclatement *opt, unsigned long seed,
+                           estimation_extinction *res);
+
+/**
+ * @brief Estime la probabilité d'extinction par Monte-Carlo direct (référence)
+ *
+ * Chaque réplication s'arrête à l'extinction ou à l'horizon. L'IC est celui
+ * de Wilson, qui ne se réduit pas à un point quand aucune réplication ne
+ * s'éteint; demi_largeur est la moitié de sa largeur.
+ *
+ * @param sc Scénario
+ * @param nb_replications Nombre de réplications
+ * @param nb_threads Threads de calcul (0: nombre de cœurs)
+ * @param seed Graine (flux de chaque réplication tiré de la graine et de son numéro)
+ * @param res Estimation
+ */
+void extinction_naive(scenario sc, int nb_replications, int nb_threads, unsigned long seed,
+                      estimation_extinction *res);
+
+#endif // ECLATEMENT_H
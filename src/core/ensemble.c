@@ -0,0 +1,568 @@
+/**
+ * @file ensemble.c
+ * @brief Implémentation du moteur ensemble (réplications en voies vectorielles)
+ *
+ * Les étapes sont celles du moteur mensuel (reproduction puis vieillissement),
+ * chaque tirage étant fait pour toutes les voies à la fois:
+ * - Binomiale: une épreuve par comparaison vectorielle, jusqu'au plus grand
+ *   effectif des voies; les voies sans épreuve restante sont masquées
+ * - Nombre de portées (loi catégorielle): l'indice est le nombre de seuils
+ *   cumulés dépassés, compté par comparaisons vectorielles
+ * - Voie d'au moins seuil_gaussien individus: tirage gaussien propre à la voie,
+ *   calculé en double (exact tant que l'effectif reste sous LIMITE_VOIE)
+ *
+ * Le tirage des bébés d'une femelle est remplacé par la chaîne équivalente
+ * survie -> maturité -> sexe -> portées de binomiales successives.
+ */
+
+#include "ensemble.h"
+#include "config.h"
+#include "population.h"
+#include "planning.h"
+#include <math.h>
+#include <string.h>
+
+#define DECALAGE_RELAIS 0x5DEECE6DUL // Décalage de la graine du moteur GMP qui reprend une voie
+
+/* Paramètres du MT19937 (voir mt19937ar-cok.c) */
+#define N 624
+#define M 397
+#define MATRIX_A 0x9908b0dfU
+#define UPPER_MASK 0x80000000U
+#define LOWER_MASK 0x7fffffffU
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @brief Initialise chaque voie comme init_genrand(graines[i])
+ *
+ * @param g Générateur à initialiser
+ * @param graines Graine de chaque voie (NB_VOIES valeurs)
+ */
+static void init_voies(generateur_voies *g, const unsigned long graines[])
+{
+    for (int i = 0; i < NB_VOIES; i++)
+        g->mt[0][i] = (uint32_t)(graines[i] & 0xffffffffUL);
+    for (int k = 1; k < N; k++)
+        g->mt[k] = 1812433253U * (g->mt[k - 1] ^ (g->mt[k - 1] >> 30)) + (uint32_t)k;
+    g->mti = N;
+}
+
+/**
+ * @brief Régénère les N mots de toutes les voies
+ *
+ * @param g Générateur
+ */
+static void regenerer_voies(generateur_voies *g)
+{
+    voies_u32 y;
+    int kk;
+    for (kk = 0; kk < N - M; kk++)
+    {
+        y = (g->mt[kk] & UPPER_MASK) | (g->mt[kk + 1] & LOWER_MASK);
+        g->mt[kk] = g->mt[kk + M] ^ (y >> 1) ^ (-(y & 1U) & MATRIX_A);
+    }
+    for (; kk < N - 1; kk++)
+    {
+        y = (g->mt[kk] & UPPER_MASK) | (g->mt[kk + 1] & LOWER_MASK);
+        g->mt[kk] = g->mt[kk + (M - N)] ^ (y >> 1) ^ (-(y & 1U) & MATRIX_A);
+    }
+    y = (g->mt[N - 1] & UPPER_MASK) | (g->mt[0] & LOWER_MASK);
+    g->mt[N - 1] = g->mt[M - 1] ^ (y >> 1) ^ (-(y & 1U) & MATRIX_A);
+    g->mti = 0;
+}
+
+/**
+ * @brief Tire un entier de 32 bits par voie (équivalent de genrand_int32)
+ *
+ * Les vecteurs passent par pointeur: leur passage par valeur dépend des
+ * extensions du processeur activées à la compilation.
+ *
+ * @param g Générateur
+ * @param u Un tirage par voie, étendu à 64 bits pour la comparaison aux seuils
+ */
+static void tirage_voies(generateur_voies *g, voies_u64 *u)
+{
+    if (g->mti >= N)
+        regenerer_voies(g);
+
+    voies_u32 y = g->mt[g->mti++];
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680U;
+    y ^= (y << 15) & 0xefc60000U;
+    y ^= (y >> 18);
+    *u = __builtin_convertvector(y, voies_u64);
+}
+
+/**
+ * @brief Tire une loi normale centrée réduite par voie (Box-Muller)
+ *
+ * @param g Générateur
+ * @param z Tableau de NB_VOIES valeurs
+ */
+static void normales_voies(generateur_voies *g, double z[])
+{
+    voies_u64 a, b;
+    tirage_voies(g, &a);
+    tirage_voies(g, &b);
+    for (int i = 0; i < NB_VOIES; i++)
+    {
+        double u1 = (a[i] + 0.5) / 4294967296.0;
+        double u2 = b[i] / 4294967296.0;
+        z[i] = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    }
+}
+
+/**
+ * @brief Plus grande valeur des voies
+ */
+static uint64_t max_voies(const voies_u64 *v)
+{
+    uint64_t max = 0;
+    for (int i = 0; i < NB_VOIES; i++)
+        if ((*v)[i] > max)
+            max = (*v)[i];
+    return max;
+}
+
+/**
+ * @brief Tirage gaussien d'une binomiale B(n, p), borné à [0, n]
+ *
+ * @param n Nombre d'épreuves
+ * @param p Probabilité de succès
+ * @param z Tirage normal centré réduit
+ * @return Nombre de succès
+ */
+static uint64_t binomiale_gaussienne(uint64_t n, double p, double z)
+{
+    if (p <= 0)
+        return 0;
+    if (p >= 1)
+        return n;
+    double x = floor(n * p + sqrt(n * p * (1 - p)) * z + 0.5);
+    if (x <= 0)
+        return 0;
+    if (x >= (double)n)
+        return n;
+    return (uint64_t)x;
+}
+
+/**
+ * @brief Tire une binomiale B(n[i], p) dans chaque voie
+ *
+ * @param g Générateur
+ * @param t Tables de transition (seuil gaussien)
+ * @param n Nombre d'épreuves de chaque voie
+ * @param seuil Seuil entier associé à p
+ * @param p Probabilité de succès (tirages gaussiens)
+ * @param succes Nombre de succès de chaque voie
+ */
+static void binomiale_voies(generateur_voies *g, const tables_transition *t, const voies_u64 *n, uint64_t seuil,
+                            double p, voies_u64 *succes)
+{
+    voies_u64 petit = (voies_u64)(*n < t->seuil_gaussien);
+    voies_u64 n_petit = *n & petit;
+    voies_u64 n_grand = *n & ~petit;
+    voies_u64 k = {0};
+
+    // Voies peu peuplées: une épreuve de Bernoulli par individu
+    uint64_t max = max_voies(&n_petit);
+    for (uint64_t i = 0; i < max; i++)
+    {
+        voies_u64 u;
+        tirage_voies(g, &u);
+        k -= (voies_u64)((u < seuil) & (i < n_petit));
+    }
+
+    // Voies très peuplées: approximation gaussienne
+    if (max_voies(&n_grand))
+    {
+        double z[NB_VOIES];
+        normales_voies(g, z);
+        for (int i = 0; i < NB_VOIES; i++)
+            if (!petit[i])
+                k[i] = binomiale_gaussienne(n_grand[i], p, z[i]);
+    }
+    *succes = k;
+}
+
+/**
+ * @brief Répartit n[i] femelles de chaque voie selon leur nombre de portées de l'année
+ *
+ * @param g Générateur
+ * @param t Tables de transition
+ * @param n Nombre de femelles de chaque voie
+ * @param compte Tableau de 10 vecteurs où stocker l'effectif de chaque nombre de portées
+ */
+static void portees_voies(generateur_voies *g, const tables_transition *t, const voies_u64 *n, voies_u64 compte[])
+{
+    voies_u64 petit = (voies_u64)(*n < t->seuil_gaussien);
+    voies_u64 n_petit = *n & petit;
+    voies_u64 reste = *n & ~petit;
+    memset(compte, 0, 10 * sizeof(voies_u64));
+
+    // Voies peu peuplées: litter_per_year() pour chaque femelle
+    uint64_t max = max_voies(&n_petit);
+    for (uint64_t i = 0; i < max; i++)
+    {
+        voies_u64 u;
+        tirage_voies(g, &u);
+        voies_u64 indice = {0};
+        for (int j = 0; j < 9; j++)
+            indice -= (voies_u64)(u >= t->seuil_portees[j]);
+        voies_u64 actif = (voies_u64)(i < n_petit);
+        for (int j = 0; j < 10; j++)
+            compte[j] -= (voies_u64)(indice == (uint64_t)j) & actif;
+    }
+
+    // Voies très peuplées: binomiales gaussiennes conditionnelles successives
+    if (max_voies(&reste))
+    {
+        double cumul_prec = 0;
+        for (int j = 0; j < 9; j++)
+        {
+            double z[NB_VOIES];
+            normales_voies(g, z);
+            double p = (cumul_prec < 1) ? (t->portees_cumul[j] - cumul_prec) / (1 - cumul_prec) : 1;
+            for (int i = 0; i < NB_VOIES; i++)
+            {
+                if (petit[i])
+                    continue;
+                uint64_t k = binomiale_gaussienne(reste[i], p, z[i]);
+                compte[j][i] = k;
+                reste[i] -= k;
+            }
+            cumul_prec = t->portees_cumul[j];
+        }
+        compte[9] += reste;
+    }
+}
+
+/**
+ * @brief Tire le nombre total de bébés de k[i] portées dans chaque voie
+ *
+ * Chaque portée compte 3 à 6 bébés (2 bits de poids fort d'un tirage);
+ * au-delà de seuil_gaussien portées, la somme suit une loi normale de moyenne
+ * 4,5 k et de variance 1,25 k.
+ *
+ * @param g Générateur
+ * @param t Tables de transition (seuil gaussien)
+ * @param k Nombre de portées de chaque voie
+ * @param bebes Vecteur auquel ajouter le nombre de bébés de chaque voie
+ */
+static void bebes_voies(generateur_voies *g, const tables_transition *t, const voies_u64 *k, voies_u64 *bebes)
+{
+    voies_u64 petit = (voies_u64)(*k < t->seuil_gaussien);
+    voies_u64 k_petit = *k & petit;
+    voies_u64 k_grand = *k & ~petit;
+
+    uint64_t max = max_voies(&k_petit);
+    for (uint64_t i = 0; i < max; i++)
+    {
+        voies_u64 u;
+        tirage_voies(g, &u);
+        *bebes += (3 + (u >> 30)) & (voies_u64)(i < k_petit);
+    }
+
+    if (max_voies(&k_grand))
+    {
+        double z[NB_VOIES];
+        normales_voies(g, z);
+        for (int i = 0; i < NB_VOIES; i++)
+        {
+            if (petit[i])
+                continue;
+            uint64_t n = k_grand[i];
+            double x = floor(4.5 * n + sqrt(1.25 * n) * z[i] + 0.5);
+            (*bebes)[i] += (x < 3.0 * n) ? 3 * n : (x > 6.0 * n) ? 6 * n : (uint64_t)x;
+        }
+    }
+}
+
+/**
+ * @brief Reproduction de toutes les voies pour un mois
+ *
+ * @param e Groupe de réplications
+ * @param nes Nombre de nouveaux-nés de chaque voie
+ */
+static void reproduction_voies(ensemble *e, voies_u64 *nes)
+{
+    const tables_transition *t = &e->params->transitions;
+    *nes = (voies_u64){0};
+
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            cellule_voies *c = &e->cellules[age][month];
+            for (int acc_rest = 1; acc_rest <= 9; acc_rest++)
+            {
+                if (!max_voies(&c->femelles[acc_rest]))
+                    continue;
+
+                voies_u64 k;
+                binomiale_voies(&e->gen, t, &c->femelles[acc_rest], t->seuil_accouchement[month][acc_rest],
+                                t->accouchement[month][acc_rest], &k);
+                c->femelles[acc_rest] -= k;
+                c->femelles[acc_rest - 1] += k;
+                bebes_voies(&e->gen, t, &k, nes);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Vieillissement d'une cellule: dest reçoit les survivants de prev
+ *
+ * @param e Groupe de réplications
+ * @param dest Cellule (age, month)
+ * @param prev Cellule du mois précédent
+ * @param age Âge en années
+ * @param month Mois (0-11)
+ */
+static void vieillir_cellule_voies(ensemble *e, cellule_voies *dest, const cellule_voies *prev, int age, int month)
+{
+    const tables_transition *t = &e->params->transitions;
+    generateur_voies *g = &e->gen;
+    uint64_t seuil = t->seuil_survie_adulte[age];
+    double p = t->survie_adulte[age];
+
+    // Mâles
+    binomiale_voies(g, t, &prev->males, seuil, p, &dest->males);
+
+    // Femelles: nouvelles portées au début de l'année
+    if (month == 0)
+    {
+        voies_u64 survivantes;
+        binomiale_voies(g, t, &prev->femelles[0], seuil, p, &survivantes);
+        portees_voies(g, t, &survivantes, dest->femelles);
+    }
+    else
+    {
+        for (int acc_rest = 0; acc_rest < 10; acc_rest++)
+            binomiale_voies(g, t, &prev->femelles[acc_rest], seuil, p, &dest->femelles[acc_rest]);
+    }
+
+    // Bébés: survie, maturité, sexe puis portées de l'année
+    dest->bebes = (voies_u64){0};
+    if (age == 0 && month <= 10)
+    {
+        voies_u64 survivants, matures, males, femelles, compte[10];
+        binomiale_voies(g, t, &prev->bebes, t->seuil_survie_bebe, t->survie_bebe, &survivants);
+        binomiale_voies(g, t, &survivants, t->seuil_maturite[month], t->maturite[month], &matures);
+        binomiale_voies(g, t, &matures, t->seuil_male, t->proba_male, &males);
+        femelles = matures - males;
+        portees_voies(g, t, &femelles, compte);
+
+        dest->bebes = survivants - matures;
+        dest->males += males;
+        for (int i = 0; i < 10; i++)
+            dest->femelles[(i > month) ? i - month : 0] += compte[i];
+    }
+}
+
+/**
+ * @brief Vieillissement de toutes les voies, des plus vieux aux plus jeunes
+ *
+ * @param e Groupe de réplications
+ */
+static void vieillir_voies(ensemble *e)
+{
+    for (int age = AGE_MAX - 1; age >= 0; age--)
+    {
+        for (int month = NB_MONTHS - 1; month >= 0; month--)
+        {
+            if (!(age || month))
+                break;
+            const cellule_voies *prev = month ? &e->cellules[age][month - 1] : &e->cellules[age - 1][NB_MONTHS - 1];
+            vieillir_cellule_voies(e, &e->cellules[age][month], prev, age, month);
+        }
+    }
+}
+
+/**
+ * @brief Confie au moteur GMP les voies dont l'effectif dépasse LIMITE_VOIE
+ *
+ * La voie est copiée dans une population aux âges détaillés, regroupée selon
+ * les paramètres, puis vidée: elle ne coûte plus aucun tirage au groupe.
+ *
+ * @param e Groupe de réplications
+ */
+static void relayer_voies(ensemble *e)
+{
+    voies_u64 total = {0};
+    for (int age = 0; age < AGE_MAX; age++)
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            cellule_voies *c = &e->cellules[age][month];
+            total += c->bebes + c->males;
+            for (int i = 0; i < 10; i++)
+                total += c->femelles[i];
+        }
+
+    for (int v = 0; v < e->nb_voies; v++)
+    {
+        if (e->relais[v] || total[v] <= LIMITE_VOIE)
+            continue;
+
+        // Flux propre au relais, la voie vectorielle n'étant plus tirée
+        init_genrand(e->graines[v] + DECALAGE_RELAIS);
+
+        mpz_t zero;
+        mpz_init(zero);
+        population *pop = initialize_population(e->params, zero, zero);
+        for (int age = 0; age < AGE_MAX; age++)
+            for (int month = 0; month < NB_MONTHS; month++)
+            {
+                cellule_voies *c = &e->cellules[age][month];
+                mois_lapin *m = &pop->lapins_par_age[age][month];
+                mpz_set_ui(m->nb_babies, c->bebes[v]);
+                mpz_set_ui(m->nb_male, c->males[v]);
+                c->bebes[v] = c->males[v] = 0;
+                for (int i = 0; i < 10; i++)
+                {
+                    mpz_set_ui(m->femelles_par_accouchements_restants[i], c->femelles[i][v]);
+                    c->femelles[i][v] = 0;
+                }
+            }
+        regrouper_classe(pop);
+        population_recompter(pop);
+        if (pop->planning)
+            planifier_population(pop);
+        mpz_clear(zero);
+        e->relais[v] = pop;
+    }
+}
+
+/**
+ * @brief Crée un groupe de réplications avec la population initiale du moteur mensuel
+ *
+ * Comme initialize_population: mâles et femelles à l'âge de 1 an, chaque
+ * femelle recevant son nombre de portées de l'année.
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param graines Graine de chaque réplication
+ * @param nb_voies Nombre de réplications (1 à NB_VOIES)
+ * @return Groupe à libérer avec liberer_ensemble
+ */
+ensemble *ensemble_creer(const params_t *params, int nb_femelles, int nb_males,
+                         const unsigned long graines[], int nb_voies)
+{
+    // Les vecteurs exigent un alignement que malloc ne garantit pas
+    ensemble *e = aligned_alloc(_Alignof(ensemble), sizeof(ensemble));
+    memset(e, 0, sizeof(ensemble));
+    e->params = params;
+    e->nb_voies = nb_voies;
+
+    // Les voies inutilisées restent vides et ne consomment donc aucun tirage utile
+    for (int i = 0; i < NB_VOIES; i++)
+        e->graines[i] = (i < nb_voies) ? graines[i] : graines[0] + i;
+    init_voies(&e->gen, e->graines);
+
+    voies_u64 males = {0}, femelles = {0};
+    for (int i = 0; i < nb_voies; i++)
+    {
+        males[i] = nb_males;
+        femelles[i] = nb_femelles;
+    }
+    e->cellules[1][0].males = males;
+    portees_voies(&e->gen, &params->transitions, &femelles, e->cellules[1][0].femelles);
+    return e;
+}
+
+/**
+ * @brief Simule un mois de vie de toutes les réplications du groupe
+ *
+ * Les voies reprises par le moteur GMP avancent avec simulate_month, les
+ * autres avec les tirages vectoriels.
+ *
+ * @param e Groupe à faire évoluer
+ */
+void simulate_month_ensemble(ensemble *e)
+{
+    for (int v = 0; v < e->nb_voies; v++)
+        if (e->relais[v])
+            simulate_month(e->relais[v]);
+
+    voies_u64 nes;
+    reproduction_voies(e, &nes);
+    vieillir_voies(e);
+    e->cellules[0][0].bebes = nes;
+
+    relayer_voies(e);
+}
+
+/**
+ * @brief Population finale de chaque réplication du groupe
+ *
+ * @param e Groupe
+ * @param res Tableau de nb_voies résultats
+ */
+void ensemble_resultats(ensemble *e, resultat_simulation res[])
+{
+    voies_u64 bebes = {0}, males = {0}, femelles = {0};
+    for (int age = 0; age < AGE_MAX; age++)
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            cellule_voies *c = &e->cellules[age][month];
+            bebes += c->bebes;
+            males += c->males;
+            for (int i = 0; i < 10; i++)
+                femelles += c->femelles[i];
+        }
+
+    for (int v = 0; v < e->nb_voies; v++)
+    {
+        if (e->relais[v])
+        {
+            mpz_t b, m, f;
+            mpz_inits(b, m, f, NULL);
+            population_totaux(e->relais[v], b, m, f);
+            res[v].bebes = mpz_get_d(b);
+            res[v].males = mpz_get_d(m);
+            res[v].femelles = mpz_get_d(f);
+            mpz_clears(b, m, f, NULL);
+        }
+        else
+        {
+            res[v].bebes = (double)bebes[v];
+            res[v].males = (double)males[v];
+            res[v].femelles = (double)femelles[v];
+        }
+        res[v].total = res[v].bebes + res[v].males + res[v].femelles;
+    }
+}
+
+/**
+ * @brief Libère un groupe de réplications
+ *
+ * @param e Groupe à libérer
+ */
+void liberer_ensemble(ensemble *e)
+{
+    for (int v = 0; v < NB_VOIES; v++)
+        if (e->relais[v])
+            liberer_population(e->relais[v]);
+    free(e);
+}
+
+/**
+ * @brief Simule jusqu'à NB_VOIES réplications d'un scénario en un seul groupe
+ *
+ * @param sc Scénario à simuler
+ * @param graines Graine de chaque réplication
+ * @param nb Nombre de réplications (1 à NB_VOIES)
+ * @param res Tableau de nb résultats
+ */
+void simuler_ensemble(scenario sc, const unsigned long graines[], int nb, resultat_simulation res[])
+{
+    ensemble *e = ensemble_creer(sc.params, sc.nb_femelles, sc.nb_males, graines, nb);
+    for (int m = 0; m < sc.annees * NB_MONTHS; m++)
+        simulate_month_ensemble(e);
+    ensemble_resultats(e, res);
+    liberer_ensemble(e);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file ensemble.h
+ * @brief Fichier d'en-tête du moteur ensemble (réplications en voies vectorielles)
+ *
+ * Le moteur ensemble simule NB_VOIES réplications d'un même scénario à la
+ * fois. Chaque compteur de la grille est un vecteur dont la voie i appartient
+ * à la réplication i (indice de réplication le plus interne), et chaque
+ * voie a son propre flux MT19937: un tirage produit NB_VOIES nombres d'un
+ * coup et les épreuves de Bernoulli se font par comparaisons vectorielles.
+ *
+ * Les voies avancent au même pas: une cellule coûte autant de tirages que
+ * la plus peuplée des voies, les voies plus petites ignorent les tirages
+ * en trop. Le résultat d'une réplication dépend donc des autres
+ * réplications de son groupe, mais chaque voie suit la même loi que le
+ * moteur mensuel. Une voie dont l'effectif dépasse LIMITE_VOIE est reprise
+ * par le moteur GMP jusqu'à la fin de la simulation.
+ */
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdint.h>
+#include "simulation.h"
+#include "replication.h"
+
+#define NB_VOIES 8             // Réplications simulées ensemble
+#define LIMITE_VOIE 0x1p50     // Effectif d'une voie au-delà duquel le moteur GMP prend le relais
+
+// Vecteurs d'une valeur par voie (extensions vectorielles de GCC)
+typedef uint32_t voies_u32 __attribute__((vector_size(NB_VOIES * sizeof(uint32_t))));
+typedef uint64_t voies_u64 __attribute__((vector_size(NB_VOIES * sizeof(uint64_t))));
+
+/**
+ * @struct generateur_voies
+ * @brief MT19937 à NB_VOIES flux: la voie i reproduit init_genrand(graine i)
+ */
+typedef struct generateur_voies
+{
+    voies_u32 mt[624]; // États des NB_VOIES générateurs, voie la plus interne
+    int mti;           // Prochain mot à tempérer
+} generateur_voies;
+
+/**
+ * @struct cellule_voies
+ * @brief Équivalent vectoriel de mois_lapin: une valeur par réplication
+ */
+typedef struct cellule_voies
+{
+    voies_u64 bebes;        // Bébés (non-matures)
+    voies_u64 males;        // Mâles adultes
+    voies_u64 femelles[10]; // Femelles par nombre d'accouchements restants
+} cellule_voies;
+
+/**
+ * @struct ensemble
+ * @brief Groupe de réplications simulées en voies, âges détaillés
+ */
+typedef struct ensemble
+{
+    cellule_voies cellules[AGE_MAX][NB_MONTHS]; // Population organisée par âge et mois
+    const params_t *params;                     // Paramètres biologiques de la simulation
+    generateur_voies gen;                       // Générateur de chaque voie
+    int nb_voies;                               // Voies utilisées (les suivantes restent vides)
+    unsigned long graines[NB_VOIES];            // Graine de chaque voie
+    population *relais[NB_VOIES];               // Voies reprises par le moteur GMP (NULL sinon)
+} ensemble;
+
+/**
+ * @brief Crée un groupe de réplications avec la population initiale du moteur mensuel
+ * @param params Jeu de paramètres biologiques
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param graines Graine de chaque réplication
+ * @param nb_voies Nombre de réplications (1 à NB_VOIES)
+ * @return Groupe à libérer avec liberer_ensemble
+ */
+ensemble *ensemble_creer(const params_t *params, int nb_femelles, int nb_males,
+                         const unsigned long graines[], int nb_voies);
+
+/**
+ * @brief Simule un mois de vie de toutes les réplications du groupe
+ * @param e Groupe à faire évoluer
+ */
+void simulate_month_ensemble(ensemble *e);
+
+/**
+ * @brief Population finale de chaque réplication du groupe
+ * @param e Groupe
+ * @param res Tableau de nb_voies résultats
+ */
+void ensemble_resultats(ensemble *e, resultat_simulation res[]);
+
+/**
+ * @brief Libère un groupe de réplications
+ * @param e Groupe à libérer
+ */
+void liberer_ensemble(ensemble *e);
+
+/**
+ * @brief Simule jusqu'à NB_VOIES réplications d'un scénario en un seul groupe
+ * @param sc Scénario à simuler
+ * @param graines Graine de chaque réplication
+ * @param nb Nombre de réplications (1 à NB_VOIES)
+ * @param res Tableau de nb résultats
+ */
+void simuler_ensemble(scenario sc, const unsigned long graines[], int nb, resultat_simulation res[]);
+
+#endif // ENSEMBLE_H
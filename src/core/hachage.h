@@ -0,0 +1,64 @@
+/**
+ * @file hachage.h
+ * @brief Mélange de 64 bits, générateur splitmix64 et empreinte FNV-1a partagés
+ *
+ * Le finaliseur de splitmix64 sert aux clés du cache et du journal et aux
+ * flux auxiliaires des programmes (propositions de la calibration, points
+ * de Sobol de la sensibilité), distincts des flux MT19937 des simulations.
+ * FNV-1a donne l'empreinte des paramètres et les sommes de contrôle des
+ * fichiers de cache et de journal: une seule définition garde ces formats
+ * sur disque identiques.
+ */
+
+#ifndef HACHAGE_H
+#define HACHAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FNV1A_DEPART 0xcbf29ce484222325ULL // Empreinte FNV-1a de 64 bits d'une suite vide
+
+/**
+ * @brief Mélange de 64 bits (finaliseur de splitmix64)
+ *
+ * @param z Valeur à mélanger
+ * @return Valeur mélangée
+ */
+static inline uint64_t melanger(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Générateur splitmix64: réel uniforme suivant
+ *
+ * @param etat État du générateur
+ * @return Réel uniforme dans [0, 1)
+ */
+static inline double uniforme_splitmix(uint64_t *etat)
+{
+    return (melanger(*etat += 0x9E3779B97F4A7C15ULL) >> 11) * 0x1p-53;
+}
+
+/**
+ * @brief Ajoute des octets à une empreinte FNV-1a de 64 bits
+ *
+ * @param h Empreinte courante (FNV1A_DEPART pour commencer)
+ * @param donnees Octets à ajouter
+ * @param taille Nombre d'octets
+ * @return Nouvelle empreinte
+ */
+static inline uint64_t fnv1a(uint64_t h, const void *donnees, size_t taille)
+{
+    const unsigned char *o = donnees;
+    for (size_t i = 0; i < taille; i++)
+    {
+        h ^= o[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#endif // HACHAGE_H
@@ -0,0 +1,511 @@
+/**
+ * @file historique.c
+ * @brief Implémentation de l'historique compact des grilles de population
+ *
+ * Codage d'un mois: pour chaque compteur, l'écart avec sa source du mois
+ * précédent (la cellule d'où il vient par vieillissement, ou zéro pour une
+ * image clé), en zigzag puis en varint (7 bits par octet, bit de poids fort:
+ * octet suivant). Les grands écarts sont découpés directement par mpz_export
+ * avec un bit de « nails »; les séries d'écarts nuls (lignes vides de la
+ * grille, cellules inchangées) sont regroupées.
+ */
+
+#include "historique.h"
+#include "population.h"
+#include <string.h>
+
+#define INDICE_GRILLE(age, month, champ) ((((age) * NB_MONTHS) + (month)) * 12 + (champ))
+#define DEBUT_COMPOSITIONS ((AGE_MAX + 1) * NB_MONTHS * 12)
+
+static const char MAGIQUE[4] = {'H', 'L', 'A', 'P'};
+
+/**
+ * @brief Rassemble les compteurs d'une population dans l'ordre de l'historique
+ *
+ * @param pop Population
+ * @param v Tableau où stocker les NB_VALEURS_HISTORIQUE compteurs
+ */
+static void valeurs(population *pop, mpz_ptr v[])
+{
+    int i = 0;
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *c = &pop->lapins_par_age[age][month];
+            v[i++] = c->nb_babies;
+            v[i++] = c->nb_male;
+            for (int acc = 0; acc < 10; acc++)
+                v[i++] = c->femelles_par_accouchements_restants[acc];
+        }
+    }
+    for (int month = 0; month < NB_MONTHS; month++)
+        for (int age = 0; age < AGE_MAX; age++)
+            v[i++] = pop->composition_males[month][age];
+    for (int month = 0; month < NB_MONTHS; month++)
+        for (int age = 0; age < AGE_MAX; age++)
+            v[i++] = pop->composition_femelles[month][age];
+}
+
+/**
+ * @brief Calcule la source de chaque compteur au mois précédent
+ *
+ * Une cellule (âge, mois) provient de la cellule du mois d'avant; les
+ * nouveau-nés sont comparés aux nouveau-nés précédents. Les compositions de
+ * la classe adulte tournent d'un mois à chaque mois.
+ *
+ * @param src Tableau où stocker l'indice source de chaque compteur
+ */
+static void indices_sources(int src[])
+{
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            int age_src = month ? age : age - 1;
+            int month_src = month ? month - 1 : NB_MONTHS - 1;
+            if (!(age || month))
+                age_src = month_src = 0;
+            for (int champ = 0; champ < 12; champ++)
+                src[INDICE_GRILLE(age, month, champ)] = INDICE_GRILLE(age_src, month_src, champ);
+        }
+    }
+    for (int sexe = 0; sexe < 2; sexe++)
+    {
+        int debut = DEBUT_COMPOSITIONS + sexe * NB_MONTHS * AGE_MAX;
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            for (int age = 0; age < AGE_MAX; age++)
+            {
+                int month_src = month, age_src = age;
+                if (month)
+                    month_src = month - 1;
+                else if (age >= 2)
+                {
+                    month_src = NB_MONTHS - 1;
+                    age_src = age - 1;
+                }
+                src[debut + month * AGE_MAX + age] = debut + month_src * AGE_MAX + age_src;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Crée un historique vide
+ *
+ * @param intervalle_cle Nombre de mois entre deux images clés (>= 1)
+ * @return Historique à libérer avec historique_liberer
+ */
+historique *historique_creer(int intervalle_cle)
+{
+    historique *h = malloc(sizeof(historique));
+    h->intervalle_cle = intervalle_cle < 1 ? 1 : intervalle_cle;
+    h->nb_mois = 0;
+    h->capacite_mois = 256;
+    h->positions = malloc(h->capacite_mois * sizeof(size_t));
+    h->positions[0] = 0;
+    h->capacite_octets = 1 << 16;
+    h->octets = malloc(h->capacite_octets);
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+        mpz_init(h->precedent[i]);
+    return h;
+}
+
+/**
+ * @brief Garantit la place d'au moins nb octets après la fin du codage
+ *
+ * positions[nb_mois + 1] sert de curseur d'écriture pendant le codage
+ * du mois nb_mois.
+ *
+ * @param h Historique
+ * @param nb Nombre d'octets nécessaires
+ */
+static void reserver(historique *h, size_t nb)
+{
+    size_t fin = h->positions[h->nb_mois + 1];
+    if (fin + nb <= h->capacite_octets)
+        return;
+    while (fin + nb > h->capacite_octets)
+        h->capacite_octets *= 2;
+    h->octets = realloc(h->octets, h->capacite_octets);
+}
+
+/**
+ * @brief Écrit un entier positif en varint à la fin du codage
+ *
+ * @param h Historique
+ * @param n Entier à écrire
+ */
+static void ecrire_varint(historique *h, mpz_t n)
+{
+    size_t nb = (mpz_sizeinbase(n, 2) + 6) / 7;
+    reserver(h, nb);
+    unsigned char *p = h->octets + h->positions[h->nb_mois + 1];
+    if (!mpz_sgn(n))
+    {
+        p[0] = 0;
+        nb = 1;
+    }
+    else
+    {
+        // 7 bits utiles par octet, poids faibles en premier
+        mpz_export(p, &nb, -1, 1, 0, 1, n);
+        for (size_t k = 0; k + 1 < nb; k++)
+            p[k] |= 0x80;
+    }
+    h->positions[h->nb_mois + 1] += nb;
+}
+
+/**
+ * @brief Lit un entier positif codé en varint
+ *
+ * @param p Début du codage
+ * @param n Variable où stocker l'entier
+ * @return Début du codage suivant
+ */
+static const unsigned char *lire_varint(const unsigned char *p, mpz_t n)
+{
+    size_t nb = 1;
+    while (p[nb - 1] & 0x80)
+        nb++;
+    mpz_import(n, nb, -1, 1, 0, 1, p);
+    return p + nb;
+}
+
+/**
+ * @struct suite_ecarts
+ * @brief Écriture d'une suite d'écarts dont les zéros sont regroupés
+ *
+ * Chaque écart non nul est précédé du nombre de zéros qui le séparent du
+ * précédent: les lignes vides de la grille coûtent un octet par série.
+ */
+typedef struct suite_ecarts
+{
+    historique *h;
+    unsigned long zeros; // Zéros en attente d'écriture
+    mpz_t tmp;           // Variable de travail
+} suite_ecarts;
+
+/**
+ * @brief Ajoute un écart à la suite
+ *
+ * @param s Suite en cours d'écriture
+ * @param ecart Écart à écrire
+ */
+static void ecrire_ecart(suite_ecarts *s, mpz_t ecart)
+{
+    if (!mpz_sgn(ecart))
+    {
+        s->zeros++;
+        return;
+    }
+    mpz_set_ui(s->tmp, s->zeros);
+    ecrire_varint(s->h, s->tmp);
+    s->zeros = 0;
+
+    // zigzag: 2|d| - 2 si d > 0, 2|d| - 1 si d < 0 (le zéro n'est jamais écrit)
+    mpz_abs(s->tmp, ecart);
+    mpz_mul_2exp(s->tmp, s->tmp, 1);
+    mpz_sub_ui(s->tmp, s->tmp, mpz_sgn(ecart) > 0 ? 2 : 1);
+    ecrire_varint(s->h, s->tmp);
+}
+
+/**
+ * @brief Écrit les zéros restants en fin de suite
+ *
+ * @param s Suite en cours d'écriture
+ */
+static void terminer_suite(suite_ecarts *s)
+{
+    if (s->zeros)
+    {
+        mpz_set_ui(s->tmp, s->zeros);
+        ecrire_varint(s->h, s->tmp);
+    }
+    s->zeros = 0;
+}
+
+/**
+ * @brief Lit une suite de NB_VALEURS_HISTORIQUE écarts
+ *
+ * @param p Début du codage de la suite
+ * @param ecarts Tableau où stocker les écarts
+ * @return Début du codage suivant
+ */
+static const unsigned char *lire_suite(const unsigned char *p, mpz_ptr ecarts[])
+{
+    mpz_t zeros;
+    mpz_init(zeros);
+    int i = 0;
+    while (i < NB_VALEURS_HISTORIQUE)
+    {
+        p = lire_varint(p, zeros);
+        for (unsigned long z = mpz_get_ui(zeros); z > 0 && i < NB_VALEURS_HISTORIQUE; z--)
+            mpz_set_ui(ecarts[i++], 0);
+        if (i == NB_VALEURS_HISTORIQUE)
+            break;
+
+        mpz_ptr e = ecarts[i++];
+        p = lire_varint(p, e);
+        int negatif = mpz_odd_p(e);
+        mpz_add_ui(e, e, negatif ? 1 : 2);
+        mpz_tdiv_q_2exp(e, e, 1);
+        if (negatif)
+            mpz_neg(e, e);
+    }
+    mpz_clear(zeros);
+    return p;
+}
+
+/**
+ * @brief Enregistre l'état courant d'une population comme mois suivant
+ *
+ * @param h Historique
+ * @param pop Population à enregistrer
+ */
+void historique_ajouter(historique *h, population *pop)
+{
+    mpz_ptr v[NB_VALEURS_HISTORIQUE];
+    int src[NB_VALEURS_HISTORIQUE];
+    valeurs(pop, v);
+    indices_sources(src);
+
+    if ((size_t)h->nb_mois + 2 > h->capacite_mois)
+    {
+        h->capacite_mois *= 2;
+        h->positions = realloc(h->positions, h->capacite_mois * sizeof(size_t));
+    }
+    h->positions[h->nb_mois + 1] = h->positions[h->nb_mois];
+
+    suite_ecarts s = {.h = h, .zeros = 0};
+    mpz_t ecart;
+    mpz_inits(s.tmp, ecart, NULL);
+    int cle = h->nb_mois % h->intervalle_cle == 0;
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+    {
+        if (cle)
+            mpz_set(ecart, v[i]);
+        else
+            mpz_sub(ecart, v[i], h->precedent[src[i]]);
+        ecrire_ecart(&s, ecart);
+    }
+    terminer_suite(&s);
+    mpz_clears(s.tmp, ecart, NULL);
+
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+        mpz_set(h->precedent[i], v[i]);
+    h->nb_mois++;
+}
+
+/**
+ * @brief Décode les compteurs d'un mois
+ *
+ * @param h Historique
+ * @param mois Indice du mois (doit exister)
+ * @param res Tableau de NB_VALEURS_HISTORIQUE entiers initialisés où stocker les compteurs
+ */
+static void decoder(const historique *h, int mois, mpz_ptr res[])
+{
+    int src[NB_VALEURS_HISTORIQUE];
+    indices_sources(src);
+    mpz_t *prec = malloc(NB_VALEURS_HISTORIQUE * sizeof(mpz_t));
+    mpz_t *ecarts = malloc(NB_VALEURS_HISTORIQUE * sizeof(mpz_t));
+    mpz_ptr e[NB_VALEURS_HISTORIQUE];
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+    {
+        mpz_inits(prec[i], ecarts[i], NULL);
+        e[i] = ecarts[i];
+    }
+
+    // Image clé, puis différences jusqu'au mois demandé
+    int cle = mois - mois % h->intervalle_cle;
+    const unsigned char *p = lire_suite(h->octets + h->positions[cle], res);
+    for (int m = cle + 1; m <= mois; m++)
+    {
+        for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+            mpz_swap(prec[i], res[i]);
+        p = lire_suite(p, e);
+        for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+            mpz_add(res[i], prec[src[i]], ecarts[i]);
+    }
+
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+        mpz_clears(prec[i], ecarts[i], NULL);
+    free(prec);
+    free(ecarts);
+}
+
+/**
+ * @brief Relit un mois quelconque de l'historique
+ *
+ * Au plus intervalle_cle mois sont décodés, quel que soit le mois demandé.
+ *
+ * @param h Historique
+ * @param mois Indice du mois (0: premier mois enregistré)
+ * @param pop Population initialisée où écrire la grille et les compositions
+ * @return 0 en cas de succès, -1 si le mois n'existe pas
+ */
+int historique_lire(const historique *h, int mois, population *pop)
+{
+    if (mois < 0 || mois >= h->nb_mois)
+        return -1;
+
+    mpz_ptr v[NB_VALEURS_HISTORIQUE];
+    valeurs(pop, v);
+    decoder(h, mois, v);
+    population_recompter(pop);
+    return 0;
+}
+
+/**
+ * @brief Taille du codage en octets
+ *
+ * @param h Historique
+ * @return Nombre d'octets utilisés par les mois enregistrés
+ */
+size_t historique_taille(const historique *h)
+{
+    return h->positions[h->nb_mois];
+}
+
+/**
+ * @brief Écrit l'historique dans un fichier binaire
+ *
+ * Format: « HLAP », intervalle_cle et nb_mois (int), positions des mois
+ * (uint64_t, nb_mois + 1 entrées), puis les octets du codage.
+ *
+ * @param h Historique
+ * @param chemin Chemin du fichier
+ * @return 0 en cas de succès, -1 sinon
+ */
+int historique_sauver(const historique *h, const char *chemin)
+{
+    FILE *f = fopen(chemin, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Impossible d'écrire l'historique %s\n", chemin);
+        return -1;
+    }
+
+    int ok = fwrite(MAGIQUE, 1, sizeof(MAGIQUE), f) == sizeof(MAGIQUE);
+    ok = ok && fwrite(&h->intervalle_cle, sizeof(int), 1, f) == 1;
+    ok = ok && fwrite(&h->nb_mois, sizeof(int), 1, f) == 1;
+    for (int m = 0; ok && m <= h->nb_mois; m++)
+    {
+        uint64_t position = h->positions[m];
+        ok = fwrite(&position, sizeof(uint64_t), 1, f) == 1;
+    }
+    ok = ok && fwrite(h->octets, 1, historique_taille(h), f) == historique_taille(h);
+
+    if (fclose(f) != 0 || !ok)
+    {
+        fprintf(stderr, "Erreur d'écriture de l'historique %s\n", chemin);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Charge un historique écrit par historique_sauver
+ *
+ * Le dernier mois est décodé afin que l'historique puisse être prolongé.
+ *
+ * @param chemin Chemin du fichier
+ * @return Historique chargé, NULL si le fichier est invalide
+ */
+historique *historique_charger(const char *chemin)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "Impossible d'ouvrir l'historique %s\n", chemin);
+        return NULL;
+    }
+
+    char magique[sizeof(MAGIQUE)];
+    int intervalle_cle, nb_mois;
+    int ok = fread(magique, 1, sizeof(magique), f) == sizeof(magique) && memcmp(magique, MAGIQUE, sizeof(MAGIQUE)) == 0;
+    ok = ok && fread(&intervalle_cle, sizeof(int), 1, f) == 1 && intervalle_cle >= 1;
+    ok = ok && fread(&nb_mois, sizeof(int), 1, f) == 1 && nb_mois >= 0;
+    if (!ok)
+    {
+        fprintf(stderr, "Historique %s invalide\n", chemin);
+        fclose(f);
+        return NULL;
+    }
+
+    historique *h = historique_creer(intervalle_cle);
+    while (h->capacite_mois < (size_t)nb_mois + 2)
+        h->capacite_mois *= 2;
+    h->positions = realloc(h->positions, h->capacite_mois * sizeof(size_t));
+    for (int m = 0; ok && m <= nb_mois; m++)
+    {
+        uint64_t position;
+        ok = fread(&position, sizeof(uint64_t), 1, f) == 1;
+        h->positions[m] = position;
+        ok = ok && (m == 0 || h->positions[m] >= h->positions[m - 1]);
+    }
+    if (ok)
+    {
+        size_t taille = h->positions[nb_mois];
+        while (h->capacite_octets < taille)
+            h->capacite_octets *= 2;
+        h->octets = realloc(h->octets, h->capacite_octets);
+        ok = fread(h->octets, 1, taille, f) == taille;
+    }
+    fclose(f);
+    if (!ok)
+    {
+        fprintf(stderr, "Historique %s tronqué\n", chemin);
+        historique_liberer(h);
+        return NULL;
+    }
+
+    h->nb_mois = nb_mois;
+    if (nb_mois > 0)
+    {
+        mpz_ptr v[NB_VALEURS_HISTORIQUE];
+        for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+            v[i] = h->precedent[i];
+        decoder(h, nb_mois - 1, v);
+    }
+    return h;
+}
+
+/**
+ * @brief Libère un historique
+ *
+ * @param h Historique à libérer
+ */
+void historique_liberer(historique *h)
+{
+    for (int i = 0; i < NB_VALEURS_HISTORIQUE; i++)
+        mpz_clear(h->precedent[i]);
+    free(h->positions);
+    free(h->octets);
+    free(h);
+}
+
+/**
+ * @brief Simule une population en enregistrant chaque mois dans un historique
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param h Historique où enregistrer l'état initial puis chaque mois
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_historique(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                           historique *h)
+{
+    population *pop = initialize_population(params, nbFemale, nbMale);
+    historique_ajouter(h, pop);
+    for (int m = 0; m < years * NB_MONTHS; m++)
+    {
+        simulate_month(pop);
+        historique_ajouter(h, pop);
+    }
+    return pop;
+}
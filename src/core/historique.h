@@ -0,0 +1,105 @@
+/**
+ * @file historique.h
+ * @brief Fichier d'en-tête de l'historique compact des grilles de population
+ *
+ * L'historique conserve la grille lapins_par_age complète (et la composition
+ * de la classe adulte) de chaque mois d'une simulation. Chaque mois est codé
+ * en différences avec le mois précédent, cohortes alignées: une cellule est
+ * comparée à la cellule dont elle provient par vieillissement. Les écarts sont
+ * écrits en varint zigzag; une image clé complète tous les intervalle_cle mois
+ * permet de relire n'importe quel mois sans tout décoder.
+ */
+
+#ifndef HISTORIQUE_H
+#define HISTORIQUE_H
+
+#include "simulation.h"
+
+#define INTERVALLE_CLE_DEFAUT 120 // Mois entre deux images clés (10 ans)
+
+// Compteurs enregistrés par mois: grille (bébés, mâles, 10 classes de femelles) et compositions
+#define NB_VALEURS_HISTORIQUE ((AGE_MAX + 1) * NB_MONTHS * 12 + 2 * NB_MONTHS * AGE_MAX)
+
+/**
+ * @struct historique
+ * @brief Historique codé d'une simulation
+ */
+typedef struct historique
+{
+    int intervalle_cle;                     // Nombre de mois entre deux images clés
+    int nb_mois;                            // Nombre de mois enregistrés
+    size_t *positions;                      // Début du codage de chaque mois (nb_mois + 1 entrées)
+    unsigned char *octets;                  // Codage de tous les mois
+    size_t capacite_mois;                   // Taille allouée pour positions
+    size_t capacite_octets;                 // Taille allouée pour octets
+    mpz_t precedent[NB_VALEURS_HISTORIQUE]; // Dernier mois enregistré (codage des différences)
+} historique;
+
+/**
+ * @brief Crée un historique vide
+ * @param intervalle_cle Nombre de mois entre deux images clés (>= 1)
+ * @return Historique à libérer avec historique_liberer
+ */
+historique *historique_creer(int intervalle_cle);
+
+/**
+ * @brief Enregistre l'état courant d'une population comme mois suivant
+ * @param h Historique
+ * @param pop Population à enregistrer
+ */
+void historique_ajouter(historique *h, population *pop);
+
+/**
+ * @brief Relit un mois quelconque de l'historique
+ *
+ * Décode l'image clé qui précède le mois demandé puis les différences
+ * jusqu'à ce mois.
+ *
+ * @param h Historique
+ * @param mois Indice du mois (0: premier mois enregistré)
+ * @param pop Population initialisée où écrire la grille et les compositions
+ * @return 0 en cas de succès, -1 si le mois n'existe pas
+ */
+int historique_lire(const historique *h, int mois, population *pop);
+
+/**
+ * @brief Taille du codage en octets
+ * @param h Historique
+ * @return Nombre d'octets utilisés par les mois enregistrés
+ */
+size_t historique_taille(const historique *h);
+
+/**
+ * @brief Écrit l'historique dans un fichier binaire
+ * @param h Historique
+ * @param chemin Chemin du fichier
+ * @return 0 en cas de succès, -1 sinon
+ */
+int historique_sauver(const historique *h, const char *chemin);
+
+/**
+ * @brief Charge un historique écrit par historique_sauver
+ * @param chemin Chemin du fichier
+ * @return Historique chargé, NULL si le fichier est invalide
+ */
+historique *historique_charger(const char *chemin);
+
+/**
+ * @brief Libère un historique
+ * @param h Historique à libérer
+ */
+void historique_liberer(historique *h);
+
+/**
+ * @brief Simule une population en enregistrant chaque mois dans un historique
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param h Historique où enregistrer l'état initial puis chaque mois
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_historique(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                           historique *h);
+
+#endif // HISTORIQUE_H
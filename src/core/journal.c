@@ -0,0 +1,381 @@
+/**
+ * @file journal.c
+ * @brief Implémentation du journal des réplications terminées
+ *
+ * Le fichier commence par un en-tête (format, taille d'un enregistrement)
+ * suivi des enregistrements, tous de même taille, dans l'ordre où ils ont
+ * été ajoutés. Le fichier est ouvert en ajout seul: un enregistrement déjà
+ * écrit n'est jamais réécrit. À l'ouverture, tous les enregistrements sont
+ * relus dans une table de hachage en mémoire; le premier dont la somme de
+ * contrôle est fausse (écriture interrompue) marque la fin du journal, et
+ * le fichier est tronqué à cet endroit avant tout nouvel ajout.
+ */
+
+#define _DEFAULT_SOURCE // flock, fdatasync
+
+#include "journal.h"
+#include "cache.h"
+#include "config.h"
+#include "hachage.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIQUE_JOURNAL 0x314e4a4e4950414cULL // "LAPINJN1"
+#define LECTURE_JOURNAL 4096                  // Enregistrements lus à la fois à l'ouverture
+
+/**
+ * @struct entete_journal
+ * @brief En-tête du fichier journal
+ */
+typedef struct entete_journal
+{
+    uint64_t magique;               // MAGIQUE_JOURNAL
+    uint32_t taille_enregistrement; // sizeof(enregistrement_journal): détecte un changement de format
+    uint32_t reserve;               // Zéro
+} entete_journal;
+
+/**
+ * @struct enregistrement_journal
+ * @brief Réplication terminée d'une série
+ */
+typedef struct enregistrement_journal
+{
+    uint64_t cle;            // Clé de la série (journal_cle_serie)
+    int64_t indice;          // Indice de la réplication dans la série
+    resultat_simulation res; // Population finale de la réplication
+    uint64_t controle;       // Somme de contrôle des champs précédents
+} enregistrement_journal;
+
+/**
+ * @struct journal_replications
+ * @brief Journal ouvert: fichier, table des réplications relues et lot en attente
+ */
+struct journal_replications
+{
+    int fd;                            // Descripteur du fichier (ouvert en ajout)
+    enregistrement_journal *table;     // Table de hachage (cle, indice) -> résultat
+    size_t capacite;                   // Taille de la table (puissance de 2)
+    size_t nb_entrees;                 // Cases occupées
+    enregistrement_journal attente[LOT_JOURNAL]; // Enregistrements pas encore écrits
+    int nb_attente;                    // Nombre d'enregistrements en attente
+    pthread_mutex_t verrou;            // Exclusion entre threads
+    long reprises;                     // Réplications relues
+    long ajoutees;                     // Réplications ajoutées
+};
+
+/**
+ * @brief Somme de contrôle FNV-1a d'un enregistrement (champ controle exclu)
+ */
+static uint64_t controle_enregistrement(const enregistrement_journal *e)
+{
+    return fnv1a(FNV1A_DEPART, e, offsetof(enregistrement_journal, controle));
+}
+
+/**
+ * @brief Case de la table où se trouve (ou irait) une réplication
+ *
+ * Sondage linéaire; une case vide a un indice négatif.
+ */
+static enregistrement_journal *case_table(const journal_replications *j, uint64_t cle, int64_t indice)
+{
+    size_t masque = j->capacite - 1;
+    size_t k = melanger(cle ^ melanger((uint64_t)indice)) & masque;
+    while (j->table[k].indice >= 0 && (j->table[k].cle != cle || j->table[k].indice != indice))
+        k = (k + 1) & masque;
+    return &j->table[k];
+}
+
+/**
+ * @brief Range un enregistrement dans la table, en l'agrandissant au-delà d'un taux de remplissage de 1/2
+ */
+static void inserer(journal_replications *j, const enregistrement_journal *e)
+{
+    if (2 * (j->nb_entrees + 1) > j->capacite)
+    {
+        enregistrement_journal *ancienne = j->table;
+        size_t ancienne_capacite = j->capacite;
+        j->capacite = ancienne_capacite ? 2 * ancienne_capacite : 1024;
+        j->table = malloc(j->capacite * sizeof(enregistrement_journal));
+        for (size_t k = 0; k < j->capacite; k++)
+            j->table[k].indice = -1;
+        for (size_t k = 0; k < ancienne_capacite; k++)
+            if (ancienne[k].indice >= 0)
+                *case_table(j, ancienne[k].cle, ancienne[k].indice) = ancienne[k];
+        free(ancienne);
+    }
+
+    enregistrement_journal *c = case_table(j, e->cle, e->indice);
+    if (c->indice < 0)
+        j->nb_entrees++;
+    *c = *e;
+}
+
+/**
+ * @brief Relit les enregistrements du fichier et écarte une fin incomplète
+ *
+ * @param j Journal dont le descripteur est placé après l'en-tête
+ * @param taille Taille du fichier
+ * @param chemin Chemin du fichier (messages)
+ * @return 0, -1 si la fin incomplète n'a pas pu être écartée
+ */
+static int relire(journal_replications *j, off_t taille, const char *chemin)
+{
+    enregistrement_journal *tampon = malloc(LECTURE_JOURNAL * sizeof(enregistrement_journal));
+    off_t fin_valide = sizeof(entete_journal);
+    int intact = 1;
+    while (intact)
+    {
+        ssize_t lus = read(j->fd, tampon, LECTURE_JOURNAL * sizeof(enregistrement_journal));
+        if (lus < 0 && errno == EINTR)
+            continue;
+        if (lus <= 0)
+            break;
+        size_t complets = lus / sizeof(enregistrement_journal);
+        for (size_t i = 0; i < complets && intact; i++)
+        {
+            intact = tampon[i].indice >= 0 && tampon[i].controle == controle_enregistrement(&tampon[i]);
+            if (intact)
+            {
+                inserer(j, &tampon[i]);
+                fin_valide += sizeof(enregistrement_journal);
+            }
+        }
+        intact &= (size_t)lus == complets * sizeof(enregistrement_journal);
+    }
+    free(tampon);
+
+    if (fin_valide < taille)
+    {
+        fprintf(stderr, "Journal %s : fin incomplète écartée (%lld octets)\n", chemin,
+                (long long)(taille - fin_valide));
+        if (ftruncate(j->fd, fin_valide) != 0)
+        {
+            fprintf(stderr, "Erreur : impossible de tronquer le journal %s\n", chemin);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Ouvre un journal et relit ses enregistrements, en le créant s'il n'existe pas
+ *
+ * @param chemin Chemin du fichier
+ * @return Journal, NULL en cas d'erreur
+ */
+journal_replications *journal_ouvrir(const char *chemin)
+{
+    int fd = open(chemin, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Erreur : impossible d'ouvrir le journal %s\n", chemin);
+        return NULL;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        fprintf(stderr, "Erreur : le journal %s est utilisé par un autre processus\n", chemin);
+        close(fd);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        fprintf(stderr, "Erreur : impossible de lire la taille du journal %s\n", chemin);
+        close(fd);
+        return NULL;
+    }
+    entete_journal entete = {MAGIQUE_JOURNAL, sizeof(enregistrement_journal), 0};
+    if (st.st_size == 0)
+    {
+        if (write(fd, &entete, sizeof(entete)) != sizeof(entete) || fdatasync(fd) != 0)
+        {
+            fprintf(stderr, "Erreur : impossible de créer le journal %s\n", chemin);
+            close(fd);
+            return NULL;
+        }
+        st.st_size = sizeof(entete);
+    }
+    else
+    {
+        entete_journal lu;
+        if (read(fd, &lu, sizeof(lu)) != sizeof(lu) || lu.magique != entete.magique ||
+            lu.taille_enregistrement != entete.taille_enregistrement)
+        {
+            fprintf(stderr, "Erreur : %s n'est pas un journal de ce format\n", chemin);
+            close(fd);
+            return NULL;
+        }
+    }
+
+    journal_replications *j = calloc(1, sizeof(journal_replications));
+    j->fd = fd;
+    pthread_mutex_init(&j->verrou, NULL);
+    if (relire(j, st.st_size, chemin) != 0)
+    {
+        journal_fermer(j);
+        return NULL;
+    }
+    return j;
+}
+
+/**
+ * @brief Écrit les enregistrements en attente et ferme le journal
+ *
+ * @param journal Journal
+ */
+void journal_fermer(journal_replications *journal)
+{
+    if (!journal)
+        return;
+    journal_synchroniser(journal);
+    close(journal->fd); // Lève aussi le flock
+    pthread_mutex_destroy(&journal->verrou);
+    free(journal->table);
+    free(journal);
+}
+
+/**
+ * @brief Clé d'une série de réplications
+ *
+ * @param sc Scénario
+ * @param seed Graine de base
+ * @param ensemble 1 pour le moteur ensemble
+ * @return Clé de 64 bits
+ */
+uint64_t journal_cle_serie(scenario sc, unsigned long seed, int ensemble)
+{
+    uint64_t h = melanger(params_empreinte(sc.params) ^ VERSION_MOTEUR);
+    h = melanger(h ^ sc.params->seuil_gaussien);
+    h = melanger(h ^ seed);
+    h = melanger(h ^ ((uint64_t)(uint32_t)sc.nb_femelles << 32 | (uint32_t)sc.nb_males));
+    h = melanger(h ^ ((uint64_t)(uint32_t)sc.annees << 1 | (ensemble != 0)));
+    return h;
+}
+
+/**
+ * @brief Cherche une réplication dans le journal
+ *
+ * @param journal Journal
+ * @param cle Clé de la série
+ * @param indice Indice de la réplication
+ * @param res Résultat
+ * @return 1 si la réplication est journalisée, 0 sinon
+ */
+int journal_chercher(journal_replications *journal, uint64_t cle, long indice, resultat_simulation *res)
+{
+    int trouve = 0;
+    pthread_mutex_lock(&journal->verrou);
+    if (journal->capacite > 0)
+    {
+        const enregistrement_journal *c = case_table(journal, cle, indice);
+        trouve = c->indice >= 0;
+        if (trouve)
+            *res = c->res;
+    }
+    pthread_mutex_unlock(&journal->verrou);
+    return trouve;
+}
+
+/**
+ * @brief Compte des réplications relues dans le journal
+ *
+ * @param journal Journal
+ * @param nb Réplications reprises
+ */
+void journal_compter_reprises(journal_replications *journal, long nb)
+{
+    pthread_mutex_lock(&journal->verrou);
+    journal->reprises += nb;
+    pthread_mutex_unlock(&journal->verrou);
+}
+
+/**
+ * @brief Écrit et force sur disque le lot en attente (verrou pris)
+ */
+static int ecrire_attente(journal_replications *journal)
+{
+    const char *o = (const char *)journal->attente;
+    size_t reste = journal->nb_attente * sizeof(enregistrement_journal);
+    int erreur = 0;
+    while (reste > 0 && !erreur)
+    {
+        ssize_t ecrits = write(journal->fd, o, reste);
+        if (ecrits < 0 && errno == EINTR)
+            continue;
+        erreur = ecrits <= 0;
+        if (!erreur)
+        {
+            o += ecrits;
+            reste -= ecrits;
+        }
+    }
+    journal->nb_attente = 0;
+    if (erreur || fdatasync(journal->fd) != 0)
+    {
+        fprintf(stderr, "Erreur : écriture du journal impossible, réplications du lot non journalisées\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ajoute une réplication terminée au journal
+ *
+ * @param journal Journal
+ * @param cle Clé de la série
+ * @param indice Indice de la réplication
+ * @param res Résultat de la réplication
+ */
+void journal_ajouter(journal_replications *journal, uint64_t cle, long indice, const resultat_simulation *res)
+{
+    enregistrement_journal e;
+    memset(&e, 0, sizeof(e)); // Octets de remplissage déterministes pour la somme de contrôle
+    e.cle = cle;
+    e.indice = indice;
+    e.res = *res;
+    e.controle = controle_enregistrement(&e);
+
+    pthread_mutex_lock(&journal->verrou);
+    inserer(journal, &e);
+    journal->attente[journal->nb_attente++] = e;
+    journal->ajoutees++;
+    if (journal->nb_attente == LOT_JOURNAL)
+        ecrire_attente(journal);
+    pthread_mutex_unlock(&journal->verrou);
+}
+
+/**
+ * @brief Écrit les enregistrements en attente et les force sur disque
+ *
+ * @param journal Journal
+ * @return 0, -1 en cas d'erreur d'écriture
+ */
+int journal_synchroniser(journal_replications *journal)
+{
+    pthread_mutex_lock(&journal->verrou);
+    int r = (journal->nb_attente > 0) ? ecrire_attente(journal) : 0;
+    pthread_mutex_unlock(&journal->verrou);
+    return r;
+}
+
+/**
+ * @brief Compteurs du journal depuis son ouverture par ce processus
+ *
+ * @param journal Journal
+ * @param reprises Réplications relues
+ * @param ajoutees Réplications ajoutées
+ */
+void journal_statistiques(const journal_replications *journal, long *reprises, long *ajoutees)
+{
+    *reprises = journal->reprises;
+    *ajoutees = journal->ajoutees;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file journal.h
+ * @brief Fichier d'en-tête du journal des réplications terminées
+ *
+ * Le journal garde, dans un fichier où l'on ne fait qu'ajouter, le résultat
+ * de chaque réplication terminée d'une série (replications_sequentielles).
+ * Une campagne interrompue (processus tué, machine arrêtée) reprend avec le
+ * même journal: les réplications déjà journalisées sont relues au lieu
+ * d'être simulées, et la série retrouve exactement les résultats, les tests
+ * d'arrêt et les statistiques qu'elle aurait eus sans interruption.
+ *
+ * Les écritures sont regroupées: les enregistrements s'accumulent en mémoire
+ * et sont écrits puis forcés sur disque (fdatasync) par lot, à la fin de
+ * chaque lot de réplications ou tous les LOT_JOURNAL enregistrements. Une
+ * interruption perd au plus les réplications du lot en cours. Un
+ * enregistrement à moitié écrit en fin de fichier est écarté à la reprise.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include "replication.h"
+
+#define LOT_JOURNAL 256 // Enregistrements en attente au plus avant une écriture forcée
+
+/**
+ * @brief Journal ouvert (opaque)
+ */
+typedef struct journal_replications journal_replications;
+
+/**
+ * @brief Ouvre un journal et relit ses enregistrements, en le créant s'il n'existe pas
+ *
+ * Le journal est réservé au processus qui l'ouvre (flock): deux campagnes ne
+ * peuvent pas y écrire en même temps.
+ *
+ * @param chemin Chemin du fichier
+ * @return Journal à fermer avec journal_fermer, NULL en cas d'erreur (message sur stderr)
+ */
+journal_replications *journal_ouvrir(const char *chemin);
+
+/**
+ * @brief Écrit les enregistrements en attente et ferme le journal
+ * @param journal Journal (NULL accepté)
+ */
+void journal_fermer(journal_replications *journal);
+
+/**
+ * @brief Clé d'une série de réplications
+ *
+ * La clé couvre la condition initiale, la durée, les valeurs des paramètres,
+ * la graine de base, le moteur (mensuel ou ensemble), le seuil gaussien et
+ * VERSION_MOTEUR.
+ *
+ * @param sc Scénario
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ * @param ensemble 1 pour le moteur ensemble
+ * @return Clé de 64 bits
+ */
+uint64_t journal_cle_serie(scenario sc, unsigned long seed, int ensemble);
+
+/**
+ * @brief Cherche une réplication dans le journal
+ *
+ * @param journal Journal
+ * @param cle Clé de la série (journal_cle_serie)
+ * @param indice Indice de la réplication dans la série
+ * @param res Résultat, rempli en cas de succès
+ * @return 1 si la réplication est journalisée, 0 sinon
+ */
+int journal_chercher(journal_replications *journal, uint64_t cle, long indice, resultat_simulation *res);
+
+/**
+ * @brief Compte des réplications relues dans le journal
+ *
+ * journal_chercher() ne compte rien: l'appelant compte les réplications
+ * qu'il reprend effectivement (un lot incomplet est simulé de nouveau).
+ *
+ * @param journal Journal
+ * @param nb Réplications reprises
+ */
+void journal_compter_reprises(journal_replications *journal, long nb);
+
+/**
+ * @brief Ajoute une réplication terminée au journal
+ *
+ * L'enregistrement est mis en attente; il est écrit par journal_synchroniser()
+ * ou dès que LOT_JOURNAL enregistrements attendent.
+ *
+ * @param journal Journal
+ * @param cle Clé de la série
+ * @param indice Indice de la réplication
+ * @param res Résultat de la réplication
+ */
+void journal_ajouter(journal_replications *journal, uint64_t cle, long indice, const resultat_simulation *res);
+
+/**
+ * @brief Écrit les enregistrements en attente et les force sur disque
+ *
+ * @param journal Journal
+ * @return 0, -1 en cas d'erreur d'écriture (message sur stderr)
+ */
+int journal_synchroniser(journal_replications *journal);
+
+/**
+ * @brief Compteurs du journal depuis son ouverture par ce processus
+ *
+ * @param journal Journal
+ * @param reprises Réplications relues dans le journal
+ * @param ajoutees Réplications ajoutées au journal
+ */
+void journal_statistiques(const journal_replications *journal, long *reprises, long *ajoutees);
+
+#endif // JOURNAL_H
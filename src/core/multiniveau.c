@@ -0,0 +1,384 @@
+/**
+ * @file multiniveau.c
+ * @brief Implémentation de l'estimateur Monte-Carlo multiniveau de la population moyenne
+ *
+ * Les simulations d'un tour sont réparties entre les threads, groupe de
+ * seuil gaussien après groupe, chaque seuil ayant sa copie finalisée du jeu
+ * de paramètres; chacune tire ses flux de (graine, niveau, indice), si bien
+ * que l'échantillon i d'un niveau est le même quel que soit le thread qui le
+ * simule. Le coût d'une simulation est mesuré en temps de calcul du thread.
+ */
+
+#include "multiniveau.h"
+#include "population.h"
+#include "config.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#define Z_95 1.96                  // Quantile normal de l'IC à 95% (échantillons nombreux)
+#define NIVEAU_REFERENCE 0xffffUL  // Niveau des flux de estimer_reference()
+#define CROISSANCE_MIN 1.1         // Croissance minimale des effectifs d'un tour à l'autre
+
+/**
+ * @struct echantillon_mlmc
+ * @brief Un échantillon: P_0, ou paire couplée (P_l, P_(l-1))
+ */
+typedef struct echantillon_mlmc
+{
+    int niveau;           // Niveau de l'échantillon
+    long indice;          // Indice dans le niveau
+    double fin;           // P_l
+    double grossier;      // P_(l-1) (0 au niveau 0)
+    double cout_fin;      // Temps de calcul de P_l
+    double cout_grossier; // Temps de calcul de P_(l-1)
+} echantillon_mlmc;
+
+/**
+ * @struct tache_mlmc
+ * @brief Une simulation: l'un des deux membres d'un échantillon
+ */
+typedef struct tache_mlmc
+{
+    echantillon_mlmc *ech; // Échantillon
+    int grossier;          // 1: membre P_(l-1), 0: membre P_l
+} tache_mlmc;
+
+/**
+ * @struct groupe_mlmc
+ * @brief Simulations d'un même seuil gaussien, partagées entre les threads de calcul
+ */
+typedef struct groupe_mlmc
+{
+    scenario sc;          // Scénario
+    unsigned long seed;   // Graine
+    int reference;        // 1: flux de estimer_reference()
+    tache_mlmc *taches;   // Simulations à faire
+    long nb;              // Nombre de simulations
+    atomic_long prochain; // Prochaine simulation à prendre
+} groupe_mlmc;
+
+/**
+ * @brief Réglages par défaut
+ *
+ * @return Réglages
+ */
+options_mlmc options_mlmc_defaut()
+{
+    options_mlmc opt = {0};
+    opt.nb_grossiers = 1;
+    opt.seuils[0] = 300;
+    opt.demi_largeur_relative = 0.03;
+    opt.nb_initial = 16;
+    opt.budget = 1000000;
+    return opt;
+}
+
+/**
+ * @brief Temps de calcul du thread appelant (secondes)
+ */
+static double temps_thread()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Simule la population finale au seuil gaussien du jeu de paramètres du scénario
+ *
+ * Le flux est réinitialisé par (clé, mois) avant chaque mois, et par
+ * (clé, ~0) avant le placement de la population initiale.
+ *
+ * @param sc Scénario
+ * @param cle Graine, niveau et indice de l'échantillon
+ * @return Population finale totale
+ */
+static double simuler_niveau(scenario sc, const unsigned long cle[3])
+{
+    unsigned long cle_mois[4] = {cle[0], cle[1], cle[2], ~0UL};
+    init_by_array(cle_mois, 4);
+    mpz_t nbFemale, nbMale, total;
+    mpz_init_set_ui(nbFemale, sc.nb_femelles);
+    mpz_init_set_ui(nbMale, sc.nb_males);
+    mpz_init(total);
+    population *pop = initialize_population(sc.params, nbFemale, nbMale);
+
+    for (int m = 0; m < sc.annees * NB_MONTHS; m++)
+    {
+        cle_mois[3] = m;
+        init_by_array(cle_mois, 4);
+        simulate_month(pop);
+    }
+    population_totale(pop, total);
+    double res = mpz_get_d(total);
+
+    liberer_population(pop);
+    mpz_clears(nbFemale, nbMale, total, NULL);
+    return res;
+}
+
+/**
+ * @brief Thread de calcul: simule les membres du groupe jusqu'à épuisement
+ */
+static void *thread_mlmc(void *arg)
+{
+    groupe_mlmc *g = arg;
+    for (;;)
+    {
+        long i = atomic_fetch_add(&g->prochain, 1);
+        if (i >= g->nb)
+            return NULL;
+
+        echantillon_mlmc *e = g->taches[i].ech;
+        unsigned long cle[3] = {g->seed, g->reference ? NIVEAU_REFERENCE : (unsigned long)e->niveau,
+                                (unsigned long)e->indice};
+        double debut = temps_thread();
+        double total = simuler_niveau(g->sc, cle);
+        double cout = temps_thread() - debut;
+        if (g->taches[i].grossier)
+            e->grossier = total, e->cout_grossier = cout;
+        else
+            e->fin = total, e->cout_fin = cout;
+    }
+}
+
+/**
+ * @brief Simule les membres d'un groupe sur plusieurs threads, avec le jeu de paramètres donné
+ */
+static void simuler_groupe(groupe_mlmc *g, const params_t *params, int nb_threads)
+{
+    if (g->nb == 0)
+        return;
+    g->sc.params = params;
+    atomic_init(&g->prochain, 0);
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    for (int k = 0; k < nb_threads; k++)
+        pthread_create(&threads[k], NULL, thread_mlmc, g);
+    for (int k = 0; k < nb_threads; k++)
+        pthread_join(threads[k], NULL);
+    free(threads);
+}
+
+/**
+ * @struct valeurs_niveau
+ * @brief Valeurs accumulées d'un niveau
+ */
+typedef struct valeurs_niveau
+{
+    double *y;          // P_l - P_(l-1), ou P_0
+    double *fin;        // P_l (pour la variance du niveau le plus fin seul)
+    long nb, capacite;  // Échantillons accumulés et place allouée
+    double cout;        // Temps de calcul total des échantillons
+    double cout_fin;    // Temps de calcul total des P_l
+} valeurs_niveau;
+
+/**
+ * @brief Moyenne et variance d'une série (deux passes)
+ */
+static void moyenne_variance_serie(const double *x, long n, double *moyenne, double *variance)
+{
+    double somme = 0, somme_carres = 0;
+    for (long i = 0; i < n; i++)
+        somme += x[i];
+    *moyenne = somme / n;
+    for (long i = 0; i < n; i++)
+        somme_carres += (x[i] - *moyenne) * (x[i] - *moyenne);
+    *variance = (n > 1) ? somme_carres / (n - 1) : 0;
+}
+
+/**
+ * @brief Ajoute les échantillons d'un tour aux valeurs des niveaux
+ */
+static void accumuler(valeurs_niveau v[], const echantillon_mlmc *ech, long nb)
+{
+    for (long i = 0; i < nb; i++)
+    {
+        valeurs_niveau *n = &v[ech[i].niveau];
+        if (n->nb == n->capacite)
+        {
+            n->capacite = n->capacite ? 2 * n->capacite : 64;
+            n->y = realloc(n->y, n->capacite * sizeof(double));
+            n->fin = realloc(n->fin, n->capacite * sizeof(double));
+        }
+        n->y[n->nb] = ech[i].fin - ech[i].grossier;
+        n->fin[n->nb] = ech[i].fin;
+        n->nb++;
+        n->cout += ech[i].cout_fin + ech[i].cout_grossier;
+        n->cout_fin += ech[i].cout_fin;
+    }
+}
+
+/**
+ * @brief Simule les échantillons manquants de chaque niveau
+ *
+ * Les membres sont regroupés par seuil gaussien: le groupe k réunit les
+ * P_l du niveau k et les P_(l-1) du niveau k + 1.
+ *
+ * @param g Groupe (scénario, graine, flux)
+ * @param v Valeurs des niveaux
+ * @param cibles Effectif visé de chaque niveau
+ * @param niveaux Jeu de paramètres de chaque niveau (seuil gaussien du niveau)
+ * @param nb_niveaux Nombre de niveaux
+ * @param nb_threads Nombre de threads de calcul
+ */
+static void completer(groupe_mlmc *g, valeurs_niveau v[], const long cibles[], const params_t *const niveaux[],
+                      int nb_niveaux, int nb_threads)
+{
+    long nb = 0;
+    for (int l = 0; l < nb_niveaux; l++)
+        nb += cibles[l] - v[l].nb;
+    echantillon_mlmc *ech = calloc(nb, sizeof(echantillon_mlmc));
+    g->taches = malloc(2 * nb * sizeof(tache_mlmc));
+    nb = 0;
+    for (int l = 0; l < nb_niveaux; l++)
+        for (long i = v[l].nb; i < cibles[l]; i++)
+            ech[nb++] = (echantillon_mlmc){l, i, 0, 0, 0, 0};
+
+    for (int k = 0; k < nb_niveaux; k++)
+    {
+        g->nb = 0;
+        for (long i = 0; i < nb; i++)
+        {
+            if (ech[i].niveau == k)
+                g->taches[g->nb++] = (tache_mlmc){&ech[i], 0};
+            else if (ech[i].niveau == k + 1)
+                g->taches[g->nb++] = (tache_mlmc){&ech[i], 1};
+        }
+        simuler_groupe(g, niveaux[k], nb_threads);
+    }
+
+    // Échantillons rangés par niveau puis par indice: accumulation indépendante des threads
+    accumuler(v, ech, nb);
+    free(g->taches);
+    free(ech);
+}
+
+/**
+ * @brief Remplit les statistiques de l'estimation à partir des valeurs des niveaux
+ */
+static void resumer(const valeurs_niveau v[], int nb_niveaux, estimation_mlmc *res)
+{
+    res->nb_niveaux = nb_niveaux;
+    res->moyenne = 0;
+    res->cout = 0;
+    double variance_moyenne = 0;
+    for (int l = 0; l < nb_niveaux; l++)
+    {
+        niveau_mlmc *n = &res->niveaux[l];
+        n->nb = v[l].nb;
+        moyenne_variance_serie(v[l].y, v[l].nb, &n->moyenne, &n->variance);
+        n->cout = v[l].cout / v[l].nb;
+        res->moyenne += n->moyenne;
+        res->cout += v[l].cout;
+        variance_moyenne += n->variance / n->nb;
+    }
+    res->demi_largeur = Z_95 * sqrt(variance_moyenne);
+    const valeurs_niveau *fin = &v[nb_niveaux - 1];
+    double moyenne_fin;
+    moyenne_variance_serie(fin->fin, fin->nb, &moyenne_fin, &res->variance_fine);
+    res->cout_fin = fin->cout_fin / fin->nb;
+}
+
+/**
+ * @brief Estime la population finale moyenne du moteur mensuel par Monte-Carlo multiniveau
+ *
+ * Chaque niveau grossier simule avec une copie de sc.params dont seul
+ * seuil_gaussien change. Après nb_initial échantillons par niveau, chaque
+ * tour calcule les effectifs optimaux
+ * N_l = (z / h)^2 sqrt(V_l / C_l) somme_k sqrt(V_k C_k) pour la demi-largeur
+ * h visée, et simule les échantillons manquants.
+ *
+ * @param sc Scénario
+ * @param opt Réglages
+ * @param seed Graine
+ * @param res Estimation
+ */
+void estimer_mlmc(scenario sc, const options_mlmc *opt, unsigned long seed, estimation_mlmc *res)
+{
+    int nb_niveaux = opt->nb_grossiers + 1;
+    int nb_threads = (opt->nb_threads > 0) ? opt->nb_threads : nb_threads_defaut();
+    groupe_mlmc g = {sc, seed, 0, NULL, 0, 0};
+    valeurs_niveau v[NIVEAUX_MLMC_MAX];
+    memset(v, 0, sizeof(v));
+    long cibles[NIVEAUX_MLMC_MAX];
+    const params_t *niveaux[NIVEAUX_MLMC_MAX];
+    for (int l = 0; l < nb_niveaux; l++)
+    {
+        cibles[l] = opt->nb_initial;
+        niveaux[l] = sc.params;
+        if (l < opt->nb_grossiers)
+        {
+            params_t *grossier = params_copier(sc.params);
+            grossier->seuil_gaussien = opt->seuils[l];
+            params_finaliser(grossier);
+            niveaux[l] = grossier;
+        }
+    }
+
+    memset(res, 0, sizeof(estimation_mlmc));
+    for (;;)
+    {
+        completer(&g, v, cibles, niveaux, nb_niveaux, nb_threads);
+        resumer(v, nb_niveaux, res);
+        double h = opt->demi_largeur_relative * fabs(res->moyenne);
+        if (res->demi_largeur <= h)
+        {
+            res->precision_atteinte = 1;
+            break;
+        }
+
+        double somme = 0;
+        for (int l = 0; l < nb_niveaux; l++)
+            somme += sqrt(res->niveaux[l].variance * res->niveaux[l].cout);
+        int ajout = 0;
+        for (int l = 0; l < nb_niveaux; l++)
+        {
+            const niveau_mlmc *n = &res->niveaux[l];
+            double optimal = (n->cout > 0) ? pow(Z_95 / h, 2) * sqrt(n->variance / n->cout) * somme : 0;
+            // Effectifs arrondis déjà atteints sans la précision: croissance minimale
+            long cible = (long)ceil(fmax(optimal, 0));
+            if (cible <= v[l].nb && n->variance > 0)
+                cible = (long)ceil(v[l].nb * CROISSANCE_MIN);
+            if (cible > opt->budget)
+                cible = opt->budget;
+            if (cible > v[l].nb)
+                cibles[l] = cible, ajout = 1;
+        }
+        if (!ajout)
+            break;
+    }
+
+    for (int l = 0; l < nb_niveaux; l++)
+    {
+        free(v[l].y);
+        free(v[l].fin);
+    }
+    for (int l = 0; l < opt->nb_grossiers; l++)
+        params_liberer(niveaux[l]);
+}
+
+/**
+ * @brief Estime la même moyenne par des simulations indépendantes du niveau le plus fin (référence)
+ *
+ * @param sc Scénario
+ * @param nb_replications Nombre de simulations
+ * @param nb_threads Threads de calcul (0: nombre de cœurs)
+ * @param seed Graine
+ * @param res Estimation
+ */
+void estimer_reference(scenario sc, long nb_replications, int nb_threads, unsigned long seed,
+                       estimation_mlmc *res)
+{
+    groupe_mlmc g = {sc, seed, 1, NULL, 0, 0};
+    valeurs_niveau v = {0};
+    long cible = nb_replications;
+    const params_t *niveau = sc.params;
+    completer(&g, &v, &cible, &niveau, 1, (nb_threads > 0) ? nb_threads : nb_threads_defaut());
+    memset(res, 0, sizeof(estimation_mlmc));
+    resumer(&v, 1, res);
+    free(v.y);
+    free(v.fin);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file multiniveau.h
+ * @brief Fichier d'en-tête de l'estimateur Monte-Carlo multiniveau (MLMC) de la population moyenne
+ *
+ * La population finale moyenne du moteur mensuel (niveau le plus fin) est
+ * écrite comme une somme télescopique:
+ *
+ *     E[P_L] = E[P_0] + somme sur l de E[P_l - P_(l-1)]
+ *
+ * où P_l est la population finale simulée au niveau l. Les niveaux diffèrent
+ * par le seuil des approximations gaussiennes (seuil_gaussien de params_t):
+ * le niveau le plus fin tire lapin par lapin jusqu'au seuil du scénario, les
+ * niveaux grossiers passent aux tirages gaussiens dès quelques centaines
+ * d'individus et coûtent plusieurs fois moins. P_0 est estimé sur beaucoup
+ * de simulations bon marché; chaque différence P_l - P_(l-1) est estimée sur
+ * des paires couplées, de faible variance, et demande peu de simulations
+ * coûteuses. L'estimateur n'a pas de biais par rapport au niveau le plus
+ * fin: les approximations des niveaux grossiers sont corrigées par les
+ * différences.
+ *
+ * Couplage: les deux simulations d'une paire partent de la même population
+ * initiale et réinitialisent leur flux MT19937 au début de chaque mois par
+ * la même clé (graine, niveau, paire, mois). Elles restent identiques tant
+ * qu'aucune cellule n'atteint le seuil gaussien du niveau grossier, c'est-à-
+ * dire pendant la phase où les effectifs sont petits et où naît l'essentiel
+ * de la variabilité. Les deux membres d'une paire n'ayant pas besoin d'être
+ * simulés ensemble, les simulations sont regroupées par seuil, chaque
+ * niveau grossier simulant avec sa propre copie du jeu de paramètres.
+ *
+ * Le nombre de simulations de chaque niveau est choisi comme dans Giles
+ * (2008): N_l proportionnel à sqrt(V_l / C_l), où V_l est la variance et
+ * C_l le coût mesuré d'un échantillon du niveau, jusqu'à la demi-largeur
+ * d'IC à 95% visée.
+ */
+
+#ifndef MULTINIVEAU_H
+#define MULTINIVEAU_H
+
+#include "replication.h"
+
+#define NIVEAUX_MLMC_MAX 8 // Niveaux au plus (le niveau le plus fin compris)
+
+/**
+ * @struct options_mlmc
+ * @brief Réglages de l'estimateur multiniveau
+ */
+typedef struct options_mlmc
+{
+    int nb_grossiers;                           // Niveaux grossiers, sous le niveau le plus fin
+    unsigned long seuils[NIVEAUX_MLMC_MAX - 1]; // Seuil gaussien de chaque niveau grossier (croissants)
+    double demi_largeur_relative;               // Demi-largeur d'IC à 95% visée, relative à l'estimation
+    int nb_initial;                             // Échantillons de chaque niveau avant le premier ajustement
+    long budget;                                // Échantillons au plus par niveau
+    int nb_threads;                             // Threads de calcul (0: nombre de cœurs)
+} options_mlmc;
+
+/**
+ * @struct niveau_mlmc
+ * @brief Statistiques d'un niveau: P_0, ou différence P_l - P_(l-1)
+ */
+typedef struct niveau_mlmc
+{
+    long nb;             // Échantillons simulés
+    double moyenne;      // Moyenne de l'échantillon
+    double variance;     // Variance d'un échantillon
+    double cout;         // Coût moyen d'un échantillon (secondes de calcul)
+} niveau_mlmc;
+
+/**
+ * @struct estimation_mlmc
+ * @brief Population finale moyenne estimée et coût de l'estimation
+ */
+typedef struct estimation_mlmc
+{
+    double moyenne;                            // Population finale moyenne
+    double demi_largeur;                       // Demi-largeur de l'IC à 95%
+    int nb_niveaux;                            // Niveaux (grossiers et le plus fin)
+    niveau_mlmc niveaux[NIVEAUX_MLMC_MAX];     // Statistiques de chaque niveau
+    double cout;                               // Coût total (secondes de calcul, tous threads)
+    double variance_fine;                      // Variance de P_L seul (simulations du niveau le plus fin)
+    double cout_fin;                           // Coût moyen d'une simulation du niveau le plus fin seule
+    int precision_atteinte;                    // 1 si la précision visée a été atteinte avant le budget
+} estimation_mlmc;
+
+/**
+ * @brief Réglages par défaut
+ *
+ * Un niveau grossier (tirages gaussiens dès 300 individus), demi-largeur
+ * relative de 3%, 16 échantillons initiaux par niveau. Des niveaux
+ * intermédiaires n'apportent rien tant que leur coût reste proche de celui
+ * du niveau grossier.
+ *
+ * @return Réglages
+ */
+options_mlmc options_mlmc_defaut();
+
+/**
+ * @brief Estime la population finale moyenne du moteur mensuel par Monte-Carlo multiniveau
+ *
+ * Le niveau le plus fin utilise sc.params->seuil_gaussien, qui doit
+ * dépasser les seuils des niveaux grossiers; sc.params n'est pas modifié et
+ * d'autres simulations peuvent tourner en même temps. Le résultat ne dépend
+ * pas du nombre de threads pour des effectifs d'échantillons donnés; ces
+ * effectifs dépendent des coûts mesurés.
+ *
+ * @param sc Scénario
+ * @param opt Réglages
+ * @param seed Graine
+ * @param res Estimation
+ */
+void estimer_mlmc(scenario sc, const options_mlmc *opt, unsigned long seed, estimation_mlmc *res);
+
+/**
+ * @brief Estime la même moyenne par des simulations indépendantes du niveau le plus fin (référence)
+ *
+ * Seuls moyenne, demi_largeur, cout, variance_fine et cout_fin sont
+ * remplis.
+ *
+ * @param sc Scénario
+ * @param nb_replications Nombre de simulations
+ * @param nb_threads Threads de calcul (0: nombre de cœurs)
+ * @param seed Graine (flux distincts de ceux de estimer_mlmc)
+ * @param res Estimation
+ */
+void estimer_reference(scenario sc, long nb_replications, int nb_threads, unsigned long seed,
+                       estimation_mlmc *res);
+
+#endif // MULTINIVEAU_H
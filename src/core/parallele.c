@@ -0,0 +1,359 @@
+/**
+ * @file parallele.c
+ * @brief Implémentation du moteur mensuel parallèle
+ *
+ * Un mois se déroule en deux phases réparties sur l'équipe de threads:
+ * 1. Reproduction: chaque classe (âge, mois, acc_rest) tire ses mises bas
+ *    à partir de son effectif de début de mois; les déplacements vers
+ *    acc_rest - 1 et la somme des naissances sont faits ensuite, dans
+ *    l'ordre du moteur séquentiel
+ * 2. Vieillissement: chaque cellule de destination est calculée à partir
+ *    de la cellule du mois précédent dans une grille séparée, puis les
+ *    deux grilles sont échangées
+ * L'anniversaire de la classe adulte regroupée est tiré ensuite par le
+ * thread appelant, dans son propre sous-flux.
+ *
+ * Les threads auxiliaires restent en attente entre deux phases: une phase
+ * ne coûte qu'un réveil, et le thread appelant prend sa part des tâches.
+ */
+
+#include "parallele.h"
+#include "aging.h"
+#include "config.h"
+#include "population.h"
+#include "replication.h"
+#include "reproduction.h"
+
+#define FLUX_ANNIVERSAIRE (NB_FLUX - 1) // Sous-flux de anniversaire_classe
+
+/**
+ * @brief Active le sous-flux d'une tâche dans le générateur du thread courant
+ *
+ * Le sous-flux est créé au premier tirage de la tâche par init_by_array
+ * avec la clé (graine, tâche): les tâches vides ne coûtent pas d'état.
+ *
+ * @param mp Moteur parallèle
+ * @param tache Indice du sous-flux
+ */
+static void entrer_flux(moteur_parallele *mp, int tache)
+{
+    if (mp->flux[tache])
+    {
+        ecrire_etat_genrand(mp->flux[tache]);
+        return;
+    }
+    unsigned long cle[2] = {mp->graine, (unsigned long)tache};
+    init_by_array(cle, 2);
+    mp->flux[tache] = malloc(sizeof(etat_genrand));
+}
+
+/**
+ * @brief Sauvegarde le sous-flux d'une tâche après ses tirages
+ *
+ * @param mp Moteur parallèle
+ * @param tache Indice du sous-flux
+ */
+static void sortir_flux(moteur_parallele *mp, int tache)
+{
+    lire_etat_genrand(mp->flux[tache]);
+}
+
+/**
+ * @brief Indique si une cellule ne contient aucun lapin
+ */
+static int cellule_vide(const mois_lapin *c)
+{
+    if (mpz_sgn(c->nb_babies) || mpz_sgn(c->nb_male))
+        return 0;
+    for (int i = 0; i < 10; i++)
+        if (mpz_sgn(c->femelles_par_accouchements_restants[i]))
+            return 0;
+    return 1;
+}
+
+/**
+ * @brief Tâche de reproduction: mises bas du mois d'une classe (âge, mois, acc_rest)
+ *
+ * @param mp Moteur parallèle
+ * @param tache Indice de la classe: (âge * NB_MONTHS + mois) * 9 + acc_rest - 1
+ */
+static void tache_reproduction(moteur_parallele *mp, int tache)
+{
+    int acc_rest = tache % 9 + 1;
+    int month = (tache / 9) % NB_MONTHS;
+    int age = tache / 9 / NB_MONTHS;
+    mpz_ptr femelles = mp->pop->lapins_par_age[age][month].femelles_par_accouchements_restants[acc_rest];
+
+    if (mpz_sgn(femelles) == 0)
+    {
+        mpz_set_ui(mp->accouchements[tache], 0);
+        mpz_set_ui(mp->naissances[tache], 0);
+        return;
+    }
+
+    entrer_flux(mp, tache);
+    accouchements_classe(&mp->pop->params->transitions, femelles, month, acc_rest,
+                         mp->accouchements[tache], mp->naissances[tache]);
+    sortir_flux(mp, tache);
+}
+
+/**
+ * @brief Tâche de vieillissement: cellule (âge, mois) calculée depuis le mois précédent
+ *
+ * @param mp Moteur parallèle
+ * @param tache Indice de la cellule de destination: âge * NB_MONTHS + mois (> 0)
+ */
+static void tache_vieillissement(moteur_parallele *mp, int tache)
+{
+    if (tache == 0) // La cellule (0, 0) reçoit les nouveaux-nés
+        return;
+
+    const tables_transition *t = &mp->pop->params->transitions;
+    int age = tache / NB_MONTHS;
+    int month = tache % NB_MONTHS;
+    mois_lapin *dest = &mp->suivant[age][month];
+    mois_lapin prev = month ? mp->pop->lapins_par_age[age][month - 1]
+                            : mp->pop->lapins_par_age[age - 1][NB_MONTHS - 1];
+
+    if (cellule_vide(&prev))
+    {
+        mpz_set_ui(dest->nb_babies, 0);
+        mpz_set_ui(dest->nb_male, 0);
+        for (int i = 0; i < 10; i++)
+            mpz_set_ui(dest->femelles_par_accouchements_restants[i], 0);
+        return;
+    }
+
+    int flux = NB_TACHES_REPRODUCTION + tache;
+    entrer_flux(mp, flux);
+    male_aging(t, dest, prev, age);
+    female_aging(t, dest, prev, age, month);
+    if (age == 0 && month <= 10)
+        babies_aging(t, dest, prev, month);
+    else
+        mpz_set_ui(dest->nb_babies, 0);
+    sortir_flux(mp, flux);
+}
+
+/**
+ * @brief Prend les tâches de la phase en cours jusqu'à épuisement
+ */
+static void executer_taches(moteur_parallele *mp)
+{
+    int i;
+    while ((i = atomic_fetch_add(&mp->prochaine, 1)) < mp->fin)
+        mp->tache(mp, i);
+}
+
+/**
+ * @brief Boucle d'un thread auxiliaire: attend une phase, y participe, recommence
+ */
+static void *thread_auxiliaire(void *arg)
+{
+    moteur_parallele *mp = arg;
+    unsigned long vue = 0;
+
+    pthread_mutex_lock(&mp->verrou);
+    for (;;)
+    {
+        while (mp->generation == vue && !mp->arret)
+            pthread_cond_wait(&mp->reveil, &mp->verrou);
+        if (mp->arret)
+            break;
+        vue = mp->generation;
+        pthread_mutex_unlock(&mp->verrou);
+
+        executer_taches(mp);
+
+        pthread_mutex_lock(&mp->verrou);
+        if (--mp->actifs == 0)
+            pthread_cond_signal(&mp->fin_phase);
+    }
+    pthread_mutex_unlock(&mp->verrou);
+    return NULL;
+}
+
+/**
+ * @brief Exécute nb tâches sur toute l'équipe et attend leur fin
+ *
+ * @param mp Moteur parallèle
+ * @param tache Fonction de tâche
+ * @param nb Nombre de tâches (indices 0 à nb - 1)
+ */
+static void lancer_phase(moteur_parallele *mp, void (*tache)(moteur_parallele *, int), int nb)
+{
+    mp->tache = tache;
+    mp->fin = nb;
+    atomic_store(&mp->prochaine, 0);
+
+    pthread_mutex_lock(&mp->verrou);
+    mp->actifs = mp->nb_threads - 1;
+    mp->generation++;
+    pthread_cond_broadcast(&mp->reveil);
+    pthread_mutex_unlock(&mp->verrou);
+
+    executer_taches(mp);
+
+    pthread_mutex_lock(&mp->verrou);
+    while (mp->actifs > 0)
+        pthread_cond_wait(&mp->fin_phase, &mp->verrou);
+    pthread_mutex_unlock(&mp->verrou);
+}
+
+/**
+ * @brief Crée un moteur parallèle et démarre ses threads
+ *
+ * @param nb_threads Nombre de threads de calcul (0: nombre de cœurs)
+ * @param graine Graine dont dérivent les sous-flux des tâches
+ * @return Moteur à libérer avec liberer_moteur_parallele
+ */
+moteur_parallele *moteur_parallele_creer(int nb_threads, unsigned long graine)
+{
+    moteur_parallele *mp = malloc(sizeof(moteur_parallele));
+    mp->nb_threads = (nb_threads > 0) ? nb_threads : nb_threads_defaut();
+    mp->graine = graine;
+    mp->pop = NULL;
+    for (int i = 0; i < NB_FLUX; i++)
+        mp->flux[i] = NULL;
+
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *c = &mp->suivant[age][month];
+            mpz_inits(c->nb_babies, c->nb_male, NULL);
+            for (int i = 0; i < 10; i++)
+                mpz_init(c->femelles_par_accouchements_restants[i]);
+        }
+    }
+    for (int i = 0; i < NB_TACHES_REPRODUCTION; i++)
+        mpz_inits(mp->accouchements[i], mp->naissances[i], NULL);
+
+    pthread_mutex_init(&mp->verrou, NULL);
+    pthread_cond_init(&mp->reveil, NULL);
+    pthread_cond_init(&mp->fin_phase, NULL);
+    mp->generation = 0;
+    mp->actifs = 0;
+    mp->arret = 0;
+    mp->threads = malloc(mp->nb_threads * sizeof(pthread_t));
+    for (int t = 0; t < mp->nb_threads - 1; t++)
+        pthread_create(&mp->threads[t], NULL, thread_auxiliaire, mp);
+    return mp;
+}
+
+/**
+ * @brief Simule un mois de vie de la population sur les threads du moteur
+ *
+ * Mêmes étapes que simulate_month: reproduction, vieillissement puis ajout
+ * des nouveaux-nés.
+ *
+ * @param pop Pointeur vers la population à simuler
+ * @param mp Moteur parallèle
+ */
+void simulate_month_parallele(population *pop, moteur_parallele *mp)
+{
+    // Le thread appelant prend part aux tâches: son propre flux est mis de côté
+    etat_genrand appelant;
+    lire_etat_genrand(&appelant);
+    mp->pop = pop;
+
+    // Étape 1: Reproduction, classe par classe
+    lancer_phase(mp, tache_reproduction, NB_TACHES_REPRODUCTION);
+    mpz_t new_babies;
+    mpz_init(new_babies);
+    for (int tache = 0; tache < NB_TACHES_REPRODUCTION; tache++)
+    {
+        int acc_rest = tache % 9 + 1;
+        mois_lapin *c = &pop->lapins_par_age[tache / 9 / NB_MONTHS][(tache / 9) % NB_MONTHS];
+        mpz_sub(c->femelles_par_accouchements_restants[acc_rest], c->femelles_par_accouchements_restants[acc_rest],
+                mp->accouchements[tache]);
+        mpz_add(c->femelles_par_accouchements_restants[acc_rest - 1],
+                c->femelles_par_accouchements_restants[acc_rest - 1], mp->accouchements[tache]);
+        mpz_sub(pop->totaux.femelles[acc_rest], pop->totaux.femelles[acc_rest], mp->accouchements[tache]);
+        mpz_add(pop->totaux.femelles[acc_rest - 1], pop->totaux.femelles[acc_rest - 1], mp->accouchements[tache]);
+        mpz_add(new_babies, new_babies, mp->naissances[tache]);
+    }
+
+    // Étape 2: Vieillissement vers la grille de destination (la cellule (0, 0) est exclue)
+    lancer_phase(mp, tache_vieillissement, NB_TACHES_VIEILLISSEMENT);
+    totaux_effacer(&pop->totaux);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = (age == 0); month < NB_MONTHS; month++)
+        {
+            mois_lapin tmp = pop->lapins_par_age[age][month];
+            pop->lapins_par_age[age][month] = mp->suivant[age][month];
+            mp->suivant[age][month] = tmp;
+            totaux_ajouter(&pop->totaux, &pop->lapins_par_age[age][month], age);
+        }
+    }
+    mpz_set_ui(pop->lapins_par_age[0][0].nb_babies, 0);
+    entrer_flux(mp, FLUX_ANNIVERSAIRE);
+    anniversaire_classe(pop);
+    sortir_flux(mp, FLUX_ANNIVERSAIRE);
+
+    // Étape 3: Ajout des nouveaux-nés
+    population_naissances(pop, new_babies);
+    mpz_clear(new_babies);
+
+    ecrire_etat_genrand(&appelant);
+}
+
+/**
+ * @brief Arrête les threads et libère un moteur parallèle
+ *
+ * @param mp Moteur à libérer
+ */
+void liberer_moteur_parallele(moteur_parallele *mp)
+{
+    pthread_mutex_lock(&mp->verrou);
+    mp->arret = 1;
+    pthread_cond_broadcast(&mp->reveil);
+    pthread_mutex_unlock(&mp->verrou);
+    for (int t = 0; t < mp->nb_threads - 1; t++)
+        pthread_join(mp->threads[t], NULL);
+
+    pthread_mutex_destroy(&mp->verrou);
+    pthread_cond_destroy(&mp->reveil);
+    pthread_cond_destroy(&mp->fin_phase);
+    free(mp->threads);
+
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *c = &mp->suivant[age][month];
+            mpz_clears(c->nb_babies, c->nb_male, NULL);
+            for (int i = 0; i < 10; i++)
+                mpz_clear(c->femelles_par_accouchements_restants[i]);
+        }
+    }
+    for (int i = 0; i < NB_TACHES_REPRODUCTION; i++)
+        mpz_clears(mp->accouchements[i], mp->naissances[i], NULL);
+    for (int i = 0; i < NB_FLUX; i++)
+        free(mp->flux[i]);
+    free(mp);
+}
+
+/**
+ * @brief Lance la simulation complète avec le moteur mensuel parallèle
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param nb_threads Nombre de threads de calcul (0: nombre de cœurs)
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_parallele(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                          int nb_threads)
+{
+    population *pop = initialize_population(params, nbFemale, nbMale);
+    moteur_parallele *mp = moteur_parallele_creer(nb_threads, genrand_int32());
+
+    for (int m = 0; m < years * NB_MONTHS; m++)
+        simulate_month_parallele(pop, mp);
+
+    liberer_moteur_parallele(mp);
+    return pop;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file parallele.h
+ * @brief Fichier d'en-tête du moteur mensuel parallèle (une seule simulation)
+ *
+ * Les réplications parallèles n'accélèrent pas une trajectoire unique. Le
+ * moteur parallèle répartit le travail d'un mois sur plusieurs threads:
+ * chaque classe de femelles (âge, mois, accouchements restants) pour la
+ * reproduction, chaque cellule (âge, mois) pour le vieillissement.
+ *
+ * Chaque tâche tire dans son propre sous-flux MT19937, dérivé de la graine
+ * du moteur et de l'indice de la tâche, et les naissances sont sommées dans
+ * un ordre fixe: la trajectoire ne dépend pas du nombre de threads.
+ */
+
+#ifndef PARALLELE_H
+#define PARALLELE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "simulation.h"
+
+#define NB_TACHES_REPRODUCTION (AGE_MAX * NB_MONTHS * 9) // Une par classe (âge, mois, acc_rest >= 1)
+#define NB_TACHES_VIEILLISSEMENT (AGE_MAX * NB_MONTHS)  // Une par cellule de destination
+#define NB_FLUX (NB_TACHES_REPRODUCTION + NB_TACHES_VIEILLISSEMENT + 1) // + anniversaire de la classe adulte
+
+/**
+ * @struct moteur_parallele
+ * @brief Équipe de threads et sous-flux aléatoires d'une simulation
+ */
+typedef struct moteur_parallele
+{
+    int nb_threads;                              // Threads de calcul, appelant compris
+    unsigned long graine;                        // Graine dont dérivent les sous-flux
+    etat_genrand *flux[NB_FLUX];                 // Sous-flux de chaque tâche (créé à son premier tirage)
+    population *pop;                             // Population du mois en cours
+    mois_lapin suivant[AGE_MAX][NB_MONTHS];      // Grille de destination du vieillissement
+    mpz_t accouchements[NB_TACHES_REPRODUCTION]; // Mises bas du mois de chaque classe
+    mpz_t naissances[NB_TACHES_REPRODUCTION];    // Bébés nés de chaque classe
+
+    // Équipe de threads
+    pthread_t *threads;          // nb_threads - 1 threads auxiliaires
+    pthread_mutex_t verrou;      // Protège generation, actifs et arret
+    pthread_cond_t reveil;       // Signale une nouvelle phase
+    pthread_cond_t fin_phase;    // Signale la fin du dernier thread auxiliaire
+    unsigned long generation;    // Numéro de la phase en cours
+    int actifs;                  // Threads auxiliaires encore au travail
+    int arret;                   // 1: les threads auxiliaires doivent se terminer
+    void (*tache)(struct moteur_parallele *, int); // Tâche de la phase en cours
+    atomic_int prochaine;        // Prochaine tâche à prendre
+    int fin;                     // Nombre de tâches de la phase
+} moteur_parallele;
+
+/**
+ * @brief Crée un moteur parallèle et démarre ses threads
+ * @param nb_threads Nombre de threads de calcul (0: nombre de cœurs)
+ * @param graine Graine dont dérivent les sous-flux des tâches
+ * @return Moteur à libérer avec liberer_moteur_parallele
+ */
+moteur_parallele *moteur_parallele_creer(int nb_threads, unsigned long graine);
+
+/**
+ * @brief Simule un mois de vie de la population sur les threads du moteur
+ *
+ * Le générateur du thread appelant est rendu dans l'état où il a été trouvé.
+ *
+ * @param pop Pointeur vers la population à simuler
+ * @param mp Moteur parallèle
+ */
+void simulate_month_parallele(population *pop, moteur_parallele *mp);
+
+/**
+ * @brief Arrête les threads et libère un moteur parallèle
+ * @param mp Moteur à libérer
+ */
+void liberer_moteur_parallele(moteur_parallele *mp);
+
+/**
+ * @brief Lance la simulation complète avec le moteur mensuel parallèle
+ *
+ * La graine des sous-flux est tirée dans le générateur du thread appelant.
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param nb_threads Nombre de threads de calcul (0: nombre de cœurs)
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_parallele(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                          int nb_threads);
+
+#endif // PARALLELE_H
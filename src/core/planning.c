@@ -0,0 +1,361 @@
+/**
+ * @file planning.c
+ * @brief Implémentation du planning des mises bas
+ *
+ * Les mois de mise bas d'un groupe de femelles sont tirés quand il reçoit
+ * ses portées:
+ * - Petit groupe (< seuil_gaussien): chaque femelle tire d'un coup son ensemble
+ *   de mois parmi les mois restants
+ * - Grand groupe: répartition hypergéométrique multivariée des mises bas
+ *   sur les mois restants
+ *
+ * Les tirages de mois se répartissent ainsi sur l'année au lieu d'être
+ * refaits chaque mois pour chaque classe de portées restantes.
+ */
+
+#include "planning.h"
+#include "population.h"
+#include "reproduction.h"
+#include "config.h"
+
+/**
+ * @brief Crée un planning vide
+ *
+ * @return Planning à libérer avec liberer_planning
+ */
+planning *planning_creer()
+{
+    planning *pl = malloc(sizeof(planning));
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mpz_init(pl->base[age][month]);
+            for (int j = 0; j < NB_MONTHS; j++)
+                mpz_init(pl->prevues[age][month][j]);
+        }
+    }
+    return pl;
+}
+
+/**
+ * @brief Libère un planning
+ *
+ * @param pl Planning à libérer
+ */
+void liberer_planning(planning *pl)
+{
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mpz_clear(pl->base[age][month]);
+            for (int j = 0; j < NB_MONTHS; j++)
+                mpz_clear(pl->prevues[age][month][j]);
+        }
+    }
+    free(pl);
+}
+
+/**
+ * @brief Vide le planning d'une cellule
+ */
+static void vider_cellule(planning *pl, int age, int month)
+{
+    mpz_set_ui(pl->base[age][month], 0);
+    for (int j = 0; j < NB_MONTHS; j++)
+        mpz_set_ui(pl->prevues[age][month][j], 0);
+}
+
+/**
+ * @brief Tirage hypergéométrique avec le plus petit de (succes, n) comme nombre de tirages
+ *
+ * La loi est symétrique en (succes, n). Les petites urnes sont tirées en
+ * entiers machine: la probabilité de chaque tirage est un seuil exact
+ * reste_succes * 2^32 / reste_total.
+ */
+static void hypergeometrique_court(mpz_t res, mpz_t total, mpz_t succes, mpz_t n, unsigned long seuil_gaussien)
+{
+    mpz_ptr petit = (mpz_cmp(succes, n) < 0) ? succes : n;
+    mpz_ptr grand = (petit == succes) ? n : succes;
+    if (mpz_cmp_ui(petit, seuil_gaussien) >= 0 || mpz_cmp_ui(total, UINT32_MAX) > 0 || mpz_cmp(grand, total) >= 0)
+    {
+        hypergeometrique(res, total, grand, petit, seuil_gaussien);
+        return;
+    }
+
+    unsigned long reste_total = mpz_get_ui(total);
+    unsigned long reste_succes = mpz_get_ui(grand);
+    unsigned long nb_tirages = mpz_get_ui(petit);
+    unsigned long tires = 0;
+    for (unsigned long i = 0; i < nb_tirages && reste_succes > 0; i++, reste_total--)
+    {
+        if (genrand_int32() < ((uint64_t)reste_succes << 32) / reste_total)
+        {
+            reste_succes--;
+            tires++;
+        }
+    }
+    mpz_set_ui(res, tires);
+}
+
+/**
+ * @brief Mises bas prévues qui reviennent aux survivantes
+ *
+ * Les mortes sont un sous-ensemble uniforme des femelles planifiées: leurs
+ * mises bas prévues suivent une loi hypergéométrique.
+ *
+ * @param res Variable où stocker les mises bas des survivantes
+ * @param base Femelles planifiées
+ * @param prevues Mises bas prévues de ces femelles
+ * @param mortes Femelles mortes depuis le planning
+ * @param seuil_gaussien Effectif à partir duquel le tirage est gaussien
+ */
+static void prevues_survivantes(mpz_t res, mpz_t base, mpz_t prevues, mpz_t mortes, unsigned long seuil_gaussien)
+{
+    hypergeometrique_court(res, base, prevues, mortes, seuil_gaussien);
+    mpz_sub(res, prevues, res);
+}
+
+/**
+ * @brief Répartit les mises bas d'un groupe de femelles sur les mois restants
+ *
+ * Chaque femelle a nb_portees mois de mise bas, distincts et uniformes parmi
+ * les mois month à 11.
+ *
+ * @param prevues Mises bas prévues par mois d'âge (incrémentées)
+ * @param femelles Effectif du groupe
+ * @param nb_portees Portées restantes de chaque femelle
+ * @param month Premier mois possible (0-11)
+ * @param seuil_gaussien Effectif à partir duquel la répartition est hypergéométrique
+ */
+static void planifier_groupe(mpz_t prevues[], mpz_t femelles, int nb_portees, int month, unsigned long seuil_gaussien)
+{
+    int restants = NB_MONTHS - month;
+    if (nb_portees >= restants)
+    {
+        for (int j = month; j < NB_MONTHS; j++)
+            mpz_add(prevues[j], prevues[j], femelles);
+        return;
+    }
+
+    if (mpz_cmp_ui(femelles, seuil_gaussien) < 0)
+    {
+        // Un tirage par femelle: rang de son ensemble de mois parmi les
+        // C(restants, nb_portees) possibles, décodé dans l'ordre lexicographique
+        unsigned long comb[NB_MONTHS + 1][NB_MONTHS + 1] = {{0}};
+        for (int r = 0; r <= restants; r++)
+        {
+            comb[r][0] = 1;
+            for (int k = 1; k <= r; k++)
+                comb[r][k] = comb[r - 1][k - 1] + comb[r - 1][k];
+        }
+
+        unsigned long n = mpz_get_ui(femelles);
+        unsigned long compte[NB_MONTHS] = {0};
+        for (unsigned long f = 0; f < n; f++)
+        {
+            uint64_t rang = ((uint64_t)genrand_int32() * comb[restants][nb_portees]) >> 32;
+            int a_placer = nb_portees;
+            for (int j = 0; a_placer > 0; j++)
+            {
+                uint64_t avec_j = comb[restants - 1 - j][a_placer - 1];
+                if (rang < avec_j)
+                {
+                    compte[j]++;
+                    a_placer--;
+                }
+                else
+                {
+                    rang -= avec_j;
+                }
+            }
+        }
+        for (int j = 0; j < restants; j++)
+            mpz_add_ui(prevues[month + j], prevues[month + j], compte[j]);
+        return;
+    }
+
+    // Urne de femelles boules par mois restant, femelles * nb_portees tirées sans remise
+    mpz_t urne, reste, tirage;
+    mpz_inits(urne, reste, tirage, NULL);
+    mpz_mul_ui(urne, femelles, restants);
+    mpz_mul_ui(reste, femelles, nb_portees);
+    for (int j = month; j < NB_MONTHS - 1; j++)
+    {
+        hypergeometrique(tirage, urne, femelles, reste, seuil_gaussien);
+        mpz_add(prevues[j], prevues[j], tirage);
+        mpz_sub(reste, reste, tirage);
+        mpz_sub(urne, urne, femelles);
+    }
+    mpz_add(prevues[NB_MONTHS - 1], prevues[NB_MONTHS - 1], reste);
+    mpz_clears(urne, reste, tirage, NULL);
+}
+
+/**
+ * @brief Planifie toutes les cellules d'une population à partir de leurs portées restantes
+ *
+ * @param pop Pointeur vers une population dotée d'un planning
+ */
+void planifier_population(population *pop)
+{
+    mpz_t zero;
+    mpz_init(zero);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            vider_cellule(pop->planning, age, month);
+            planifier_cellule(pop->planning, &pop->lapins_par_age[age][month], age, month, zero,
+                              pop->params->transitions.seuil_gaussien);
+        }
+    }
+    mpz_clear(zero);
+
+    // Les femelles planifiées sont passées en [0]: totaux par portées restantes
+    population_recompter(pop);
+}
+
+/**
+ * @brief Fait suivre le planning d'une cellule par ses survivantes
+ *
+ * Le vieillissement parcourt les cellules des plus vieilles aux plus jeunes:
+ * l'échange avec la cellule précédente lui laisse un planning périmé qui
+ * sera remplacé à son tour. La cellule (0, 0) n'a pas de femelles.
+ *
+ * @param pl Planning
+ * @param age Âge en années de la cellule de destination
+ * @param month Mois de la cellule de destination (0-11)
+ */
+void avancer_planning(planning *pl, int age, int month)
+{
+    if (month == 0 || (age == 0 && month == 1))
+    {
+        vider_cellule(pl, age, month);
+        return;
+    }
+    mpz_swap(pl->base[age][month], pl->base[age][month - 1]);
+    for (int j = month; j < NB_MONTHS; j++)
+        mpz_swap(pl->prevues[age][month][j], pl->prevues[age][month - 1][j]);
+}
+
+/**
+ * @brief Planifie les femelles qui viennent de recevoir leurs portées
+ *
+ * Le planning des anciennes est d'abord ramené à leur effectif actuel, afin
+ * que toutes les femelles de la cellule partagent la même base.
+ *
+ * @param pl Planning
+ * @param cell Cellule de destination du vieillissement
+ * @param age Âge en années de la cellule
+ * @param month Mois de la cellule (0-11)
+ * @param anciennes Femelles de la cellule déjà planifiées
+ * @param seuil_gaussien Effectif à partir duquel les tirages sont gaussiens
+ */
+void planifier_cellule(planning *pl, mois_lapin *cell, int age, int month, mpz_t anciennes,
+                       unsigned long seuil_gaussien)
+{
+    mpz_t *femelles = cell->femelles_par_accouchements_restants;
+    int arrivees = mpz_cmp(femelles[0], anciennes) != 0;
+    for (int acc = 1; acc < 10; acc++)
+        arrivees |= mpz_sgn(femelles[acc]) != 0;
+    if (!arrivees)
+        return;
+
+    mpz_ptr base = pl->base[age][month];
+    mpz_t *prevues = pl->prevues[age][month];
+    if (mpz_cmp(base, anciennes) != 0)
+    {
+        mpz_t mortes, survivantes;
+        mpz_inits(mortes, survivantes, NULL);
+        mpz_sub(mortes, base, anciennes);
+        for (int j = month; j < NB_MONTHS; j++)
+        {
+            prevues_survivantes(survivantes, base, prevues[j], mortes, seuil_gaussien);
+            mpz_set(prevues[j], survivantes);
+        }
+        mpz_set(base, anciennes);
+        mpz_clears(mortes, survivantes, NULL);
+    }
+
+    for (int acc = 1; acc < 10; acc++)
+    {
+        if (mpz_sgn(femelles[acc]) == 0)
+            continue;
+        planifier_groupe(prevues, femelles[acc], acc, month, seuil_gaussien);
+        mpz_add(femelles[0], femelles[0], femelles[acc]);
+        mpz_set_ui(femelles[acc], 0);
+    }
+    mpz_set(base, femelles[0]);
+}
+
+/**
+ * @brief Reproduction d'un mois par lecture du planning
+ *
+ * Les mises bas du mois de chaque cellule sont celles prévues pour son mois
+ * d'âge, moins celles des femelles mortes depuis le planning. Les femelles
+ * ne changent pas de classe.
+ *
+ * @param pop Pointeur vers la population
+ * @param new_babies Variable où stocker le nombre total de nouveaux bébés
+ */
+void reproduction_planifiee(population *pop, mpz_t new_babies)
+{
+    planning *pl = pop->planning;
+    unsigned long seuil_gaussien = pop->params->transitions.seuil_gaussien;
+    mpz_set_ui(new_babies, 0);
+
+    mpz_t mortes, nb_accouchements, bebes;
+    mpz_inits(mortes, nb_accouchements, bebes, NULL);
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mpz_ptr prevues = pl->prevues[age][month][month];
+            if (mpz_sgn(prevues) == 0)
+                continue;
+
+            mpz_sub(mortes, pl->base[age][month], pop->lapins_par_age[age][month].femelles_par_accouchements_restants[0]);
+            prevues_survivantes(nb_accouchements, pl->base[age][month], prevues, mortes, seuil_gaussien);
+            total_bebes(bebes, nb_accouchements, seuil_gaussien);
+            mpz_add(new_babies, new_babies, bebes);
+        }
+    }
+    mpz_clears(mortes, nb_accouchements, bebes, NULL);
+}
+
+/**
+ * @brief Partage le planning de la classe adulte à l'anniversaire
+ *
+ * La classe vient d'être planifiée (toutes ses femelles sont vivantes): les
+ * sortantes, sous-ensemble uniforme de la classe, emportent une part
+ * hypergéométrique des mises bas prévues de chaque mois.
+ *
+ * @param pl Planning
+ * @param age_classe Dernier âge de la classe adulte
+ * @param sortantes Nombre de femelles qui quittent la classe
+ * @param seuil_gaussien Effectif à partir duquel les tirages sont gaussiens
+ */
+void anniversaire_planning(planning *pl, int age_classe, mpz_t sortantes, unsigned long seuil_gaussien)
+{
+    mpz_ptr base = pl->base[2][0];
+    mpz_t *prevues = pl->prevues[2][0];
+    int sortie = age_classe + 1 < AGE_MAX;
+
+    mpz_t part;
+    mpz_init(part);
+    for (int j = 0; j < NB_MONTHS; j++)
+    {
+        hypergeometrique_court(part, base, prevues[j], sortantes, seuil_gaussien);
+        mpz_sub(prevues[j], prevues[j], part);
+        if (sortie)
+            mpz_add(pl->prevues[age_classe + 1][0][j], pl->prevues[age_classe + 1][0][j], part);
+        mpz_add(pl->prevues[1][0][j], pl->prevues[1][0][j], prevues[j]);
+    }
+    if (sortie)
+        mpz_add(pl->base[age_classe + 1][0], pl->base[age_classe + 1][0], sortantes);
+    mpz_sub(base, base, sortantes);
+    mpz_add(pl->base[1][0], pl->base[1][0], base);
+    vider_cellule(pl, 2, 0);
+    mpz_clear(part);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file planning.h
+ * @brief Fichier d'en-tête du planning des mises bas
+ *
+ * Dans le moteur mensuel, chaque femelle qui a encore des portées tire
+ * chaque mois si elle accouche, avec la probabilité acc_rest / (mois
+ * restants): ses mois de mise bas forment un sous-ensemble uniforme des mois
+ * restants de l'année. Le planning tire ce sous-ensemble une seule fois,
+ * quand la femelle reçoit ses portées (anniversaire ou maturité), et range
+ * les mises bas prévues par mois d'âge pour chaque cellule (âge, mois).
+ *
+ * La reproduction du mois lit la table: seules les mises bas prévues de
+ * femelles mortes depuis le planning sont retirées, par un tirage
+ * hypergéométrique (les survivantes forment un sous-ensemble uniforme des
+ * femelles planifiées). Toutes les femelles d'une cellule sont alors rangées
+ * dans femelles_par_accouchements_restants[0]: les modes saut, abondance et
+ * parallèle, qui suivent les portées restantes, ne prennent pas le planning
+ * en charge.
+ */
+
+#ifndef PLANNING_H
+#define PLANNING_H
+
+#include "simulation.h"
+
+/**
+ * @struct planning
+ * @brief Mises bas prévues de chaque cellule (âge, mois)
+ */
+struct planning
+{
+    mpz_t base[AGE_MAX][NB_MONTHS];                // Femelles de la cellule au dernier planning
+    mpz_t prevues[AGE_MAX][NB_MONTHS][NB_MONTHS];  // Mises bas prévues de ces femelles, par mois d'âge
+};
+
+/**
+ * @brief Crée un planning vide
+ * @return Planning à libérer avec liberer_planning
+ */
+planning *planning_creer();
+
+/**
+ * @brief Libère un planning
+ * @param pl Planning à libérer
+ */
+void liberer_planning(planning *pl);
+
+/**
+ * @brief Planifie toutes les cellules d'une population à partir de leurs portées restantes
+ *
+ * Les femelles de chaque cellule sont replanifiées sur les mois restants de
+ * l'année, puis rangées avec les femelles sans portée.
+ *
+ * @param pop Pointeur vers une population dotée d'un planning
+ */
+void planifier_population(population *pop);
+
+/**
+ * @brief Fait suivre le planning d'une cellule par ses survivantes
+ *
+ * Appelée par le vieillissement: la cellule (age, month) reprend le planning
+ * de la cellule du mois précédent, ou un planning vide au mois 0 (les
+ * portées de l'année sont alors réattribuées).
+ *
+ * @param pl Planning
+ * @param age Âge en années de la cellule de destination
+ * @param month Mois de la cellule de destination (0-11)
+ */
+void avancer_planning(planning *pl, int age, int month);
+
+/**
+ * @brief Planifie les femelles qui viennent de recevoir leurs portées
+ *
+ * Les groupes femelles_par_accouchements_restants[acc >= 1] de la cellule
+ * sont répartis sur les mois restants, puis rangés en [0] avec les autres.
+ *
+ * @param pl Planning
+ * @param cell Cellule de destination du vieillissement
+ * @param age Âge en années de la cellule
+ * @param month Mois de la cellule (0-11)
+ * @param anciennes Femelles de la cellule déjà planifiées (survivantes du mois précédent)
+ * @param seuil_gaussien Effectif à partir duquel les tirages sont gaussiens (tables_transition)
+ */
+void planifier_cellule(planning *pl, mois_lapin *cell, int age, int month, mpz_t anciennes,
+                       unsigned long seuil_gaussien);
+
+/**
+ * @brief Reproduction d'un mois par lecture du planning
+ * @param pop Pointeur vers la population
+ * @param new_babies Variable où stocker le nombre total de nouveaux bébés
+ */
+void reproduction_planifiee(population *pop, mpz_t new_babies);
+
+/**
+ * @brief Partage le planning de la classe adulte à l'anniversaire
+ *
+ * Les sortantes emportent vers la ligne age_classe + 1 une part du planning
+ * de la classe (ligne 2 mois 0), le reste rejoint celui des jeunes d'un an.
+ *
+ * @param pl Planning
+ * @param age_classe Dernier âge de la classe adulte
+ * @param sortantes Nombre de femelles qui quittent la classe
+ * @param seuil_gaussien Effectif à partir duquel les tirages sont gaussiens (tables_transition)
+ */
+void anniversaire_planning(planning *pl, int age_classe, mpz_t sortantes, unsigned long seuil_gaussien);
+
+#endif // PLANNING_H
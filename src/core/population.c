@@ -8,6 +8,43 @@
 
 #include "population.h"
 #include "reproduction.h"
+#include "config.h"
+#include "planning.h"
+#include <math.h>
+
+
+/**
+ * @brief Place la population initiale à l'âge de 1 an dans une grille vide
+ *
+ * @param p Population dont tous les compteurs sont nuls
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ */
+static void placer_population_initiale(population *p, const params_t *params, mpz_t nbFemale, mpz_t nbMale)
+{
+    p->params = params;
+    mpz_set(p->lapins_par_age[1][0].nb_male, nbMale);
+    mpz_set(p->composition_males[0][1], nbMale);
+    mpz_set(p->composition_femelles[0][1], nbFemale);
+    unsigned long n_female = mpz_get_ui(nbFemale);
+
+    // Répartition aléatoire des femelles selon leur nombre de portées prévues
+    for (unsigned long i = 0; i < n_female; i++)
+    {
+        int nb_litter = litter_per_year(&params->transitions);
+        mpz_add_ui(p->lapins_par_age[1][0].femelles_par_accouchements_restants[nb_litter], p->lapins_par_age[1][0].femelles_par_accouchements_restants[nb_litter], 1);
+    }
+    totaux_ajouter(&p->totaux, &p->lapins_par_age[1][0], 1);
+
+    // Mode planning: mois de mise bas tirés dès l'attribution des portées
+    p->planning = NULL;
+    if (params->planning_portees)
+    {
+        p->planning = planning_creer();
+        planifier_population(p);
+    }
+}
 
 /**
  * @brief Initialise une nouvelle population de lapins
@@ -16,16 +53,18 @@
  * les compteurs GMP à zéro. Place la population initiale de femelles
  * et mâles dans la tranche d'âge de 1 an.
  *
+ * @param params Jeu de paramètres biologiques (doit rester valide pendant la simulation)
  * @param nbFemale Nombre initial de femelles
  * @param nbMale Nombre initial de mâles
  * @return Pointeur vers la structure population allouée
  */
-population *initialize_population(mpz_t nbFemale, mpz_t nbMale)
+population *initialize_population(const params_t *params, mpz_t nbFemale, mpz_t nbMale)
 {
     population *p = malloc(sizeof(population));
 
     // Initialisation de tous les compteurs GMP pour chaque âge et mois
-    for (int age = 0; age < AGE_MAX; age++)
+    // (la ligne AGE_MAX comprise, afin que la libération soit toujours valide)
+    for (int age = 0; age <= AGE_MAX; age++)
     {
         for (int month = 0; month < NB_MONTHS; month++)
         {
@@ -38,16 +77,23 @@ population *initialize_population(mpz_t nbFemale, mpz_t nbMale)
         }
     }
 
-    // Placement de la population initiale à l'âge de 1 an
-    mpz_set(p->lapins_par_age[1][0].nb_male, nbMale);
-    unsigned long n_female = mpz_get_ui(nbFemale);
-
-    // Répartition aléatoire des femelles selon leur nombre de portées prévues
-    for (unsigned long i = 0; i < n_female; i++)
+    for (int month = 0; month < NB_MONTHS; month++)
     {
-        mpz_add_ui(p->lapins_par_age[1][0].femelles_par_accouchements_restants[litter_per_year()], p->lapins_par_age[1][0].femelles_par_accouchements_restants[litter_per_year()], 1);
+        for (int age = 0; age < AGE_MAX; age++)
+        {
+            mpz_init(p->composition_males[month][age]);
+            mpz_init(p->composition_femelles[month][age]);
+        }
     }
 
+    mpz_inits(p->totaux.bebes, p->totaux.males, NULL);
+    for (int i = 0; i < 10; i++)
+        mpz_init(p->totaux.femelles[i]);
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_init(p->totaux.par_age[age]);
+
+    // Placement de la population initiale à l'âge de 1 an
+    placer_population_initiale(p, params, nbFemale, nbMale);
     return p;
 }
 
@@ -82,28 +128,653 @@ void afficher_pop(population *pop, int mode)
     }
     else
     {
-        // Mode résumé: calcul et affichage des totaux
-        mpz_t somme_babies;
-        mpz_t somme_male;
-        mpz_t somme_female;
-        mpz_init_set_ui(somme_babies, 0);
-        mpz_init_set_ui(somme_male, 0);
-        mpz_init_set_ui(somme_female, 0);
+        // Mode résumé: totaux tenus à jour par le moteur
+        mpz_t somme_babies, somme_male, somme_female;
+        mpz_inits(somme_babies, somme_male, somme_female, NULL);
+        population_totaux(pop, somme_babies, somme_male, somme_female);
+        gmp_printf("babies = %Zd, male = %Zd, females = %Zd\n", somme_babies, somme_male, somme_female);
+        mpz_clears(somme_babies, somme_male, somme_female, NULL);
+    }
+}
+
+/**
+ * @brief Ajoute le contenu d'une cellule aux totaux
+ *
+ * @param tot Totaux à mettre à jour
+ * @param cell Cellule à ajouter
+ * @param age Ligne d'âge de la cellule
+ */
+void totaux_ajouter(totaux_population *tot, const mois_lapin *cell, int age)
+{
+    mpz_add(tot->bebes, tot->bebes, cell->nb_babies);
+    mpz_add(tot->males, tot->males, cell->nb_male);
+    mpz_add(tot->par_age[age], tot->par_age[age], cell->nb_babies);
+    mpz_add(tot->par_age[age], tot->par_age[age], cell->nb_male);
+    for (int i = 0; i < 10; i++)
+    {
+        mpz_add(tot->femelles[i], tot->femelles[i], cell->femelles_par_accouchements_restants[i]);
+        mpz_add(tot->par_age[age], tot->par_age[age], cell->femelles_par_accouchements_restants[i]);
+    }
+}
+
+/**
+ * @brief Retire le contenu d'une cellule des totaux
+ *
+ * @param tot Totaux à mettre à jour
+ * @param cell Cellule à retirer
+ * @param age Ligne d'âge de la cellule
+ */
+static void totaux_retirer(totaux_population *tot, const mois_lapin *cell, int age)
+{
+    mpz_sub(tot->bebes, tot->bebes, cell->nb_babies);
+    mpz_sub(tot->males, tot->males, cell->nb_male);
+    mpz_sub(tot->par_age[age], tot->par_age[age], cell->nb_babies);
+    mpz_sub(tot->par_age[age], tot->par_age[age], cell->nb_male);
+    for (int i = 0; i < 10; i++)
+    {
+        mpz_sub(tot->femelles[i], tot->femelles[i], cell->femelles_par_accouchements_restants[i]);
+        mpz_sub(tot->par_age[age], tot->par_age[age], cell->femelles_par_accouchements_restants[i]);
+    }
+}
+
+/**
+ * @brief Remet les totaux à zéro
+ *
+ * @param tot Totaux à effacer
+ */
+void totaux_effacer(totaux_population *tot)
+{
+    mpz_set_ui(tot->bebes, 0);
+    mpz_set_ui(tot->males, 0);
+    for (int i = 0; i < 10; i++)
+        mpz_set_ui(tot->femelles[i], 0);
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_set_ui(tot->par_age[age], 0);
+}
 
-        // Somme sur tous les âges et mois
-        for (int year = 0; year < AGE_MAX; year++)
+/**
+ * @brief Recalcule les totaux à partir de toute la grille
+ *
+ * Réservé aux moteurs qui réécrivent la grille en bloc (mode saut, relais
+ * du moteur ensemble, relecture de l'historique).
+ *
+ * @param pop Pointeur vers la population
+ */
+void population_recompter(population *pop)
+{
+    totaux_effacer(&pop->totaux);
+    for (int age = 0; age < AGE_MAX; age++)
+        for (int month = 0; month < NB_MONTHS; month++)
+            totaux_ajouter(&pop->totaux, &pop->lapins_par_age[age][month], age);
+}
+
+/**
+ * @brief Recalcule l'effectif des lignes d'âge premiere à derniere
+ *
+ * Les totaux par catégorie ne changent pas quand des lapins passent d'une
+ * ligne à l'autre (classe adulte éclatée ou regroupée).
+ */
+static void recompter_lignes(population *pop, int premiere, int derniere)
+{
+    for (int age = premiere; age <= derniere; age++)
+    {
+        mpz_ptr total = pop->totaux.par_age[age];
+        mpz_set_ui(total, 0);
+        for (int month = 0; month < NB_MONTHS; month++)
         {
-            for (int month = 0; month < 12; month++)
+            mois_lapin *cell = &pop->lapins_par_age[age][month];
+            mpz_add(total, total, cell->nb_babies);
+            mpz_add(total, total, cell->nb_male);
+            for (int i = 0; i < 10; i++)
+                mpz_add(total, total, cell->femelles_par_accouchements_restants[i]);
+        }
+    }
+}
+
+/**
+ * @brief Ajoute les nouveau-nés du mois à la cellule (0, 0)
+ *
+ * @param pop Pointeur vers la population
+ * @param new_babies Nombre de nouveau-nés
+ */
+void population_naissances(population *pop, mpz_t new_babies)
+{
+    mpz_add(pop->lapins_par_age[0][0].nb_babies, pop->lapins_par_age[0][0].nb_babies, new_babies);
+    mpz_add(pop->totaux.bebes, pop->totaux.bebes, new_babies);
+    mpz_add(pop->totaux.par_age[0], pop->totaux.par_age[0], new_babies);
+}
+
+/**
+ * @brief Lit les totaux de bébés, mâles et femelles
+ *
+ * Les totaux sont tenus à jour par le moteur: la lecture ne parcourt pas
+ * la grille.
+ *
+ * @param pop Pointeur vers la population
+ * @param bebes Variable où stocker le nombre de bébés
+ * @param males Variable où stocker le nombre de mâles
+ * @param femelles Variable où stocker le nombre de femelles
+ */
+void population_totaux(population *pop, mpz_t bebes, mpz_t males, mpz_t femelles)
+{
+    mpz_set(bebes, pop->totaux.bebes);
+    mpz_set(males, pop->totaux.males);
+    mpz_set(femelles, pop->totaux.femelles[0]);
+    for (int i = 1; i < 10; i++)
+        mpz_add(femelles, femelles, pop->totaux.femelles[i]);
+}
+
+/**
+ * @brief Calcule la population totale (bébés, mâles et femelles)
+ *
+ * @param pop Pointeur vers la population
+ * @param total Variable où stocker le total
+ */
+void population_totale(population *pop, mpz_t total)
+{
+    mpz_t males, femelles;
+    mpz_inits(males, femelles, NULL);
+    population_totaux(pop, total, males, femelles);
+    mpz_add(total, total, males);
+    mpz_add(total, total, femelles);
+    mpz_clears(males, femelles, NULL);
+}
+
+/**
+ * @brief Rapport a / b de deux entiers GMP en réel, sans débordement
+ */
+static double rapport(mpz_t a, mpz_t b)
+{
+    long exp_a, exp_b;
+    double m_a = mpz_get_d_2exp(&exp_a, a);
+    double m_b = mpz_get_d_2exp(&exp_b, b);
+    return (m_b != 0) ? ldexp(m_a / m_b, exp_a - exp_b) : 0;
+}
+
+/**
+ * @brief Tirage hypergéométrique, individuel ou gaussien selon l'effectif
+ *
+ * @param res Variable où stocker le nombre de succès
+ * @param total Nombre de boules de l'urne
+ * @param succes Nombre de boules gagnantes
+ * @param n Nombre de tirages sans remise
+ * @param seuil_gaussien Nombre de tirages à partir duquel le tirage est gaussien
+ */
+void hypergeometrique(mpz_t res, mpz_t total, mpz_t succes, mpz_t n, unsigned long seuil_gaussien)
+{
+    if (mpz_cmp(succes, total) >= 0 || mpz_cmp(n, total) >= 0)
+    {
+        mpz_set(res, (mpz_cmp(n, succes) < 0) ? n : succes);
+    }
+    else if (mpz_cmp_ui(n, seuil_gaussien) < 0)
+    {
+        // Tirages successifs: la proportion de gagnantes évolue à chaque tirage
+        mpz_t reste_total, reste_succes;
+        mpz_init_set(reste_total, total);
+        mpz_init_set(reste_succes, succes);
+        unsigned long n_ul = mpz_get_ui(n);
+        for (unsigned long i = 0; i < n_ul && mpz_sgn(reste_succes) > 0; i++)
+        {
+            if (bernoulli_seuil(seuil_probabilite(rapport(reste_succes, reste_total))))
+                mpz_sub_ui(reste_succes, reste_succes, 1);
+            mpz_sub_ui(reste_total, reste_total, 1);
+        }
+        mpz_sub(res, succes, reste_succes);
+        mpz_clears(reste_total, reste_succes, NULL);
+    }
+    else
+    {
+        hypergeometric_gaussian(res, total, succes, n);
+    }
+}
+
+/**
+ * @brief Tirage binomial, individuel ou gaussien selon l'effectif
+ *
+ * @param res Variable où stocker le nombre de succès
+ * @param n Nombre d'essais
+ * @param p Probabilité de succès
+ * @param seuil_gaussien Nombre d'essais à partir duquel le tirage est gaussien
+ */
+void tirage_binomial(mpz_t res, mpz_t n, double p, unsigned long seuil_gaussien)
+{
+    if (p <= 0)
+    {
+        mpz_set_ui(res, 0);
+    }
+    else if (p >= 1)
+    {
+        mpz_set(res, n);
+    }
+    else if (mpz_cmp_ui(n, seuil_gaussien) < 0)
+    {
+        unsigned long n_ul = mpz_get_ui(n), succes = 0;
+        uint64_t seuil = seuil_probabilite(p);
+        for (unsigned long i = 0; i < n_ul; i++)
+            succes += bernoulli_seuil(seuil);
+        mpz_set_ui(res, succes);
+    }
+    else
+    {
+        binomial_gaussian(res, n, p);
+    }
+}
+
+/**
+ * @brief Tirage multinomial, individuel ou gaussien selon l'effectif
+ *
+ * @param n Taille de l'échantillon
+ * @param cumul Probabilités cumulées des catégories (la dernière vaut 1)
+ * @param nb Nombre de catégories
+ * @param seuil_gaussien Taille à partir de laquelle le tirage est gaussien
+ * @return Effectifs par catégorie (à libérer avec liberer_effectifs)
+ */
+mpz_t *tirage_multinomial(mpz_t n, const double cumul[], int nb, unsigned long seuil_gaussien)
+{
+    if (nb > 1 && mpz_cmp_ui(n, seuil_gaussien) >= 0)
+        return multinomial_gaussian(n, cumul, nb);
+
+    mpz_t *counts = malloc(sizeof(mpz_t) * nb);
+    if (nb == 1)
+    {
+        mpz_init_set(counts[0], n);
+        return counts;
+    }
+    unsigned long *par_categorie = calloc(nb, sizeof(unsigned long));
+    unsigned long n_ul = mpz_get_ui(n);
+    for (unsigned long i = 0; i < n_ul; i++)
+    {
+        double u = genrand_int32() / (double)SEUIL_CERTAIN;
+        int c = 0;
+        while (c < nb - 1 && u >= cumul[c])
+            c++;
+        par_categorie[c]++;
+    }
+    for (int c = 0; c < nb; c++)
+        mpz_init_set_ui(counts[c], par_categorie[c]);
+    free(par_categorie);
+    return counts;
+}
+
+/**
+ * @brief Libère les effectifs retournés par tirage_multinomial
+ *
+ * @param counts Effectifs à libérer
+ * @param nb Nombre de catégories
+ */
+void liberer_effectifs(mpz_t *counts, int nb)
+{
+    for (int c = 0; c < nb; c++)
+        mpz_clear(counts[c]);
+    free(counts);
+}
+
+/**
+ * @brief Répartit n membres de la classe adulte par âge
+ *
+ * Tirage hypergéométrique multivarié: n individus pris sans remise dans
+ * l'urne des effectifs par âge 1 à age_classe.
+ *
+ * @param tirage Effectifs tirés par âge (indices 1 à age_classe)
+ * @param urne Effectifs par âge de l'urne (indices 1 à age_classe)
+ * @param n Nombre d'individus à répartir
+ * @param age_classe Dernier âge de la classe
+ * @param seuil_gaussien Effectif à partir duquel les tirages sont gaussiens
+ */
+static void repartir_par_age(mpz_t tirage[], mpz_t urne[], mpz_t n, int age_classe, unsigned long seuil_gaussien)
+{
+    mpz_t reste_urne, reste_n;
+    mpz_inits(reste_urne, reste_n, NULL);
+    for (int age = 1; age <= age_classe; age++)
+        mpz_add(reste_urne, reste_urne, urne[age]);
+    mpz_set(reste_n, n);
+
+    for (int age = 1; age < age_classe; age++)
+    {
+        hypergeometrique(tirage[age], reste_urne, urne[age], reste_n, seuil_gaussien);
+        mpz_sub(reste_n, reste_n, tirage[age]);
+        mpz_sub(reste_urne, reste_urne, urne[age]);
+    }
+    mpz_set(tirage[age_classe], reste_n);
+    mpz_clears(reste_urne, reste_n, NULL);
+}
+
+/**
+ * @brief Total des femelles d'une cellule
+ */
+static void total_femelles(mpz_t total, mois_lapin *cell)
+{
+    mpz_set_ui(total, 0);
+    for (int i = 0; i < 10; i++)
+        mpz_add(total, total, cell->femelles_par_accouchements_restants[i]);
+}
+
+/**
+ * @brief Répartit par âge la classe adulte qui vient de passer l'anniversaire
+ *
+ * En fin de vieillissement, la ligne 2 mois 0 contient la classe du mois 11
+ * qui a survécu à l'anniversaire (portées déjà réattribuées) et la ligne 1
+ * mois 0 les jeunes d'un an. Les survivants sont répartis par âge selon la
+ * composition de la classe: ceux de l'âge age_classe sortent vers la ligne
+ * age_classe + 1 (ou meurent au-delà de AGE_MAX), les autres rejoignent les
+ * jeunes. La composition des classes mensuelles avance d'un mois.
+ *
+ * La classe a survécu au mois de l'anniversaire au taux de la classe, alors
+ * que les sortants devaient survivre au taux de l'âge age_classe + 1: ils
+ * sont éclaircis par un tirage binomial au rapport des deux taux. Les mises
+ * bas prévues des sortantes éclaircies sont retirées par le planning comme
+ * celles de toute femelle morte.
+ *
+ * @param pop Pointeur vers la population
+ */
+void anniversaire_classe(population *pop)
+{
+    int age_classe = pop->params->transitions.age_classe;
+    if (!age_classe)
+        return;
+
+    mois_lapin *jeunes = &pop->lapins_par_age[1][0];
+    mois_lapin *classe = &pop->lapins_par_age[2][0];
+    mois_lapin *sortants = (age_classe + 1 < AGE_MAX) ? &pop->lapins_par_age[age_classe + 1][0] : NULL;
+
+    // Totaux: les trois cellules touchées sont retirées puis rajoutées
+    totaux_retirer(&pop->totaux, jeunes, 1);
+    totaux_retirer(&pop->totaux, classe, 2);
+    if (sortants)
+        totaux_retirer(&pop->totaux, sortants, age_classe + 1);
+
+    mpz_t males[AGE_MAX], femelles[AGE_MAX], total, reste_total, reste_sortantes, sortantes, survivants;
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_inits(males[age], femelles[age], NULL);
+    mpz_inits(total, reste_total, reste_sortantes, sortantes, survivants, NULL);
+
+    // Survie des sortants relative à celle déjà appliquée (taux de la classe)
+    const tables_transition *t = &pop->params->transitions;
+    double survie_sortants = (sortants && t->survie_adulte[1] > 0)
+                                 ? t->survie_adulte[age_classe + 1] / t->survie_adulte[1]
+                                 : 0;
+
+    // Mâles: les plus âgés quittent la classe
+    repartir_par_age(males, pop->composition_males[NB_MONTHS - 1], classe->nb_male, age_classe, t->seuil_gaussien);
+    if (sortants)
+    {
+        tirage_binomial(survivants, males[age_classe], survie_sortants, t->seuil_gaussien);
+        mpz_add(sortants->nb_male, sortants->nb_male, survivants);
+    }
+    mpz_sub(classe->nb_male, classe->nb_male, males[age_classe]);
+
+    // Femelles: nombre de sortantes, puis répartition selon les portées restantes
+    total_femelles(total, classe);
+    repartir_par_age(femelles, pop->composition_femelles[NB_MONTHS - 1], total, age_classe, t->seuil_gaussien);
+    mpz_set(reste_total, total);
+    mpz_set(reste_sortantes, femelles[age_classe]);
+    for (int i = 0; i < 10; i++)
+    {
+        mpz_t *cell = &classe->femelles_par_accouchements_restants[i];
+        hypergeometrique(sortantes, reste_total, reste_sortantes, *cell, t->seuil_gaussien);
+        mpz_sub(reste_total, reste_total, *cell);
+        mpz_sub(reste_sortantes, reste_sortantes, sortantes);
+        mpz_sub(*cell, *cell, sortantes);
+        if (sortants)
+        {
+            tirage_binomial(survivants, sortantes, survie_sortants, t->seuil_gaussien);
+            mpz_add(sortants->femelles_par_accouchements_restants[i], sortants->femelles_par_accouchements_restants[i], survivants);
+        }
+    }
+    if (pop->planning)
+        anniversaire_planning(pop->planning, age_classe, femelles[age_classe], t->seuil_gaussien);
+
+    // La classe du mois 11 devient celle du mois 0: jeunes d'un an et âges décalés
+    for (int month = NB_MONTHS - 1; month > 0; month--)
+    {
+        for (int age = 1; age <= age_classe; age++)
+        {
+            mpz_swap(pop->composition_males[month][age], pop->composition_males[month - 1][age]);
+            mpz_swap(pop->composition_femelles[month][age], pop->composition_femelles[month - 1][age]);
+        }
+    }
+    mpz_set(pop->composition_males[0][1], jeunes->nb_male);
+    total_femelles(pop->composition_femelles[0][1], jeunes);
+    for (int age = 2; age <= age_classe; age++)
+    {
+        mpz_set(pop->composition_males[0][age], males[age - 1]);
+        mpz_set(pop->composition_femelles[0][age], femelles[age - 1]);
+    }
+
+    // Fusion avec les jeunes d'un an
+    mpz_add(jeunes->nb_male, jeunes->nb_male, classe->nb_male);
+    mpz_set_ui(classe->nb_male, 0);
+    for (int i = 0; i < 10; i++)
+    {
+        mpz_add(jeunes->femelles_par_accouchements_restants[i], jeunes->femelles_par_accouchements_restants[i], classe->femelles_par_accouchements_restants[i]);
+        mpz_set_ui(classe->femelles_par_accouchements_restants[i], 0);
+    }
+
+    totaux_ajouter(&pop->totaux, jeunes, 1);
+    totaux_ajouter(&pop->totaux, classe, 2);
+    if (sortants)
+        totaux_ajouter(&pop->totaux, sortants, age_classe + 1);
+
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_clears(males[age], femelles[age], NULL);
+    mpz_clears(total, reste_total, reste_sortantes, sortantes, survivants, NULL);
+}
+
+/**
+ * @brief Répartit la classe adulte sur les lignes d'âge 1 à age_classe
+ *
+ * Donne une population aux âges détaillés, de même loi que la population
+ * regroupée (utilisé par le mode saut).
+ *
+ * @param pop Pointeur vers la population
+ */
+void eclater_classe(population *pop)
+{
+    const tables_transition *t = &pop->params->transitions;
+    int age_classe = t->age_classe;
+    if (!age_classe)
+        return;
+
+    mpz_t par_age[AGE_MAX], urne[AGE_MAX], total;
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_inits(par_age[age], urne[age], NULL);
+    mpz_init(total);
+
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        mois_lapin *classe = &pop->lapins_par_age[1][month];
+
+        repartir_par_age(par_age, pop->composition_males[month], classe->nb_male, age_classe, t->seuil_gaussien);
+        for (int age = 1; age <= age_classe; age++)
+            mpz_set(pop->lapins_par_age[age][month].nb_male, par_age[age]);
+
+        // Femelles par âge, puis chaque nombre de portées restantes pris dans cette urne
+        total_femelles(total, classe);
+        repartir_par_age(urne, pop->composition_femelles[month], total, age_classe, t->seuil_gaussien);
+        for (int i = 0; i < 10; i++)
+        {
+            repartir_par_age(par_age, urne, classe->femelles_par_accouchements_restants[i], age_classe,
+                             t->seuil_gaussien);
+            for (int age = 1; age <= age_classe; age++)
             {
-                mois_lapin pop_month = pop->lapins_par_age[year][month];
-                mpz_add(somme_babies, somme_babies, pop_month.nb_babies);
-                mpz_add(somme_male, somme_male, pop_month.nb_male);
-                for (int i = 0; i < 10; i++)
-                {
-                    mpz_add(somme_female, somme_female, pop_month.femelles_par_accouchements_restants[i]);
-                }
+                mpz_sub(urne[age], urne[age], par_age[age]);
+                mpz_set(pop->lapins_par_age[age][month].femelles_par_accouchements_restants[i], par_age[age]);
+            }
+        }
+    }
+
+    recompter_lignes(pop, 1, age_classe);
+
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_clears(par_age[age], urne[age], NULL);
+    mpz_clear(total);
+}
+
+/**
+ * @brief Regroupe les lignes d'âge 1 à age_classe dans la classe adulte
+ *
+ * Les effectifs par âge deviennent la composition connue de chaque classe.
+ *
+ * @param pop Pointeur vers la population
+ */
+void regrouper_classe(population *pop)
+{
+    int age_classe = pop->params->transitions.age_classe;
+    if (!age_classe)
+        return;
+
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        mois_lapin *classe = &pop->lapins_par_age[1][month];
+        for (int age = 1; age <= age_classe; age++)
+        {
+            mois_lapin *cell = &pop->lapins_par_age[age][month];
+            mpz_set(pop->composition_males[month][age], cell->nb_male);
+            total_femelles(pop->composition_femelles[month][age], cell);
+            if (age == 1)
+                continue;
+            mpz_add(classe->nb_male, classe->nb_male, cell->nb_male);
+            mpz_set_ui(cell->nb_male, 0);
+            for (int i = 0; i < 10; i++)
+            {
+                mpz_add(classe->femelles_par_accouchements_restants[i], classe->femelles_par_accouchements_restants[i], cell->femelles_par_accouchements_restants[i]);
+                mpz_set_ui(cell->femelles_par_accouchements_restants[i], 0);
+            }
+        }
+    }
+    recompter_lignes(pop, 1, age_classe);
+}
+
+/**
+ * @brief Remet une population à son état initial pour une nouvelle simulation
+ *
+ * Les compteurs GMP sont remis à zéro sans être libérés: ils gardent la
+ * mémoire allouée par la simulation précédente. La population obtenue est
+ * identique à celle de initialize_population() (mêmes tirages).
+ *
+ * @param pop Population à réutiliser
+ * @param params Jeu de paramètres biologiques de la nouvelle simulation
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ */
+void reinitialiser_population(population *pop, const params_t *params, mpz_t nbFemale, mpz_t nbMale)
+{
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mpz_set_ui(pop->lapins_par_age[age][month].nb_babies, 0);
+            mpz_set_ui(pop->lapins_par_age[age][month].nb_male, 0);
+            for (int i = 0; i < 10; i++)
+                mpz_set_ui(pop->lapins_par_age[age][month].femelles_par_accouchements_restants[i], 0);
+        }
+    }
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        for (int age = 0; age < AGE_MAX; age++)
+        {
+            mpz_set_ui(pop->composition_males[month][age], 0);
+            mpz_set_ui(pop->composition_femelles[month][age], 0);
+        }
+    }
+    totaux_effacer(&pop->totaux);
+    if (pop->planning)
+        liberer_planning(pop->planning);
+
+    placer_population_initiale(pop, params, nbFemale, nbMale);
+}
+
+/**
+ * @brief Copie une population (grille, composition de la classe, totaux et planning)
+ *
+ * @param source Population à copier
+ * @return Copie à libérer avec liberer_population
+ */
+population *copier_population(const population *source)
+{
+    population *p = malloc(sizeof(population));
+    p->params = source->params;
+
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            const mois_lapin *src = &source->lapins_par_age[age][month];
+            mois_lapin *dst = &p->lapins_par_age[age][month];
+            mpz_init_set(dst->nb_babies, src->nb_babies);
+            mpz_init_set(dst->nb_male, src->nb_male);
+            for (int i = 0; i < 10; i++)
+                mpz_init_set(dst->femelles_par_accouchements_restants[i], src->femelles_par_accouchements_restants[i]);
+        }
+    }
+
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        for (int age = 0; age < AGE_MAX; age++)
+        {
+            mpz_init_set(p->composition_males[month][age], source->composition_males[month][age]);
+            mpz_init_set(p->composition_femelles[month][age], source->composition_femelles[month][age]);
+        }
+    }
+
+    mpz_init_set(p->totaux.bebes, source->totaux.bebes);
+    mpz_init_set(p->totaux.males, source->totaux.males);
+    for (int i = 0; i < 10; i++)
+        mpz_init_set(p->totaux.femelles[i], source->totaux.femelles[i]);
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_init_set(p->totaux.par_age[age], source->totaux.par_age[age]);
+
+    p->planning = NULL;
+    if (source->planning)
+    {
+        p->planning = planning_creer();
+        for (int age = 0; age < AGE_MAX; age++)
+        {
+            for (int month = 0; month < NB_MONTHS; month++)
+            {
+                mpz_set(p->planning->base[age][month], source->planning->base[age][month]);
+                for (int j = 0; j < NB_MONTHS; j++)
+                    mpz_set(p->planning->prevues[age][month][j], source->planning->prevues[age][month][j]);
+            }
+        }
+    }
+
+    return p;
+}
+
+/**
+ * @brief Libère une population et tous ses compteurs GMP
+ *
+ * @param pop Pointeur vers la population à libérer
+ */
+void liberer_population(population *pop)
+{
+    if (pop->planning)
+        liberer_planning(pop->planning);
+    mpz_clears(pop->totaux.bebes, pop->totaux.males, NULL);
+    for (int i = 0; i < 10; i++)
+        mpz_clear(pop->totaux.femelles[i]);
+    for (int age = 0; age < AGE_MAX; age++)
+        mpz_clear(pop->totaux.par_age[age]);
+    for (int month = 0; month < NB_MONTHS; month++)
+    {
+        for (int age = 0; age < AGE_MAX; age++)
+        {
+            mpz_clear(pop->composition_males[month][age]);
+            mpz_clear(pop->composition_femelles[month][age]);
+        }
+    }
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mpz_clear(pop->lapins_par_age[age][month].nb_male);
+            mpz_clear(pop->lapins_par_age[age][month].nb_babies);
+            for (int i = 0; i < 10; i++)
+            {
+                mpz_clear(pop->lapins_par_age[age][month].femelles_par_accouchements_restants[i]);
             }
         }
-        gmp_printf("babies = %Zd, male = %Zd, females = %Zd\n", somme_babies, somme_male, somme_female);
     }
+    free(pop);
 }
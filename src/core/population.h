@@ -13,11 +13,12 @@
 
 /**
  * @brief Initialise une nouvelle population de lapins
+ * @param params Jeu de paramètres biologiques
  * @param nbFemale Nombre initial de femelles
  * @param nbMale Nombre initial de mâles
  * @return Pointeur vers la structure population allouée
  */
-population *initialize_population(mpz_t nbFemale, mpz_t nbMale);
+population *initialize_population(const params_t *params, mpz_t nbFemale, mpz_t nbMale);
 
 /**
  * @brief Affiche les statistiques de la population
@@ -26,4 +27,138 @@ population *initialize_population(mpz_t nbFemale, mpz_t nbMale);
  */
 void afficher_pop(population *pop, int mode);
 
+/**
+ * @brief Ajoute le contenu d'une cellule aux totaux
+ * @param tot Totaux à mettre à jour
+ * @param cell Cellule à ajouter
+ * @param age Ligne d'âge de la cellule
+ */
+void totaux_ajouter(totaux_population *tot, const mois_lapin *cell, int age);
+
+/**
+ * @brief Remet les totaux à zéro
+ * @param tot Totaux à effacer
+ */
+void totaux_effacer(totaux_population *tot);
+
+/**
+ * @brief Recalcule les totaux à partir de toute la grille
+ *
+ * Les moteurs qui réécrivent la grille en bloc l'appellent ensuite; le
+ * moteur mensuel tient les totaux à jour sans parcours supplémentaire.
+ *
+ * @param pop Pointeur vers la population
+ */
+void population_recompter(population *pop);
+
+/**
+ * @brief Ajoute les nouveau-nés du mois à la cellule (0, 0)
+ * @param pop Pointeur vers la population
+ * @param new_babies Nombre de nouveau-nés
+ */
+void population_naissances(population *pop, mpz_t new_babies);
+
+/**
+ * @brief Lit les totaux de bébés, mâles et femelles (temps constant)
+ * @param pop Pointeur vers la population
+ * @param bebes Variable où stocker le nombre de bébés
+ * @param males Variable où stocker le nombre de mâles
+ * @param femelles Variable où stocker le nombre de femelles
+ */
+void population_totaux(population *pop, mpz_t bebes, mpz_t males, mpz_t femelles);
+
+/**
+ * @brief Calcule la population totale (bébés, mâles et femelles, temps constant)
+ * @param pop Pointeur vers la population
+ * @param total Variable où stocker le total
+ */
+void population_totale(population *pop, mpz_t total);
+
+/**
+ * @brief Tirage hypergéométrique, individuel ou gaussien selon l'effectif
+ * @param res Variable où stocker le nombre de succès
+ * @param total Nombre de boules de l'urne
+ * @param succes Nombre de boules gagnantes
+ * @param n Nombre de tirages sans remise
+ * @param seuil_gaussien Nombre de tirages à partir duquel le tirage est gaussien
+ */
+void hypergeometrique(mpz_t res, mpz_t total, mpz_t succes, mpz_t n, unsigned long seuil_gaussien);
+
+/**
+ * @brief Tirage binomial, individuel ou gaussien selon l'effectif
+ * @param res Variable où stocker le nombre de succès
+ * @param n Nombre d'essais
+ * @param p Probabilité de succès
+ * @param seuil_gaussien Nombre d'essais à partir duquel le tirage est gaussien
+ */
+void tirage_binomial(mpz_t res, mpz_t n, double p, unsigned long seuil_gaussien);
+
+/**
+ * @brief Tirage multinomial, individuel ou gaussien selon l'effectif
+ * @param n Taille de l'échantillon
+ * @param cumul Probabilités cumulées des catégories (la dernière vaut 1)
+ * @param nb Nombre de catégories
+ * @param seuil_gaussien Taille à partir de laquelle le tirage est gaussien
+ * @return Effectifs par catégorie (à libérer avec liberer_effectifs)
+ */
+mpz_t *tirage_multinomial(mpz_t n, const double cumul[], int nb, unsigned long seuil_gaussien);
+
+/**
+ * @brief Libère les effectifs retournés par tirage_multinomial
+ * @param counts Effectifs à libérer
+ * @param nb Nombre de catégories
+ */
+void liberer_effectifs(mpz_t *counts, int nb);
+
+/**
+ * @brief Répartit par âge la classe adulte qui vient de passer l'anniversaire
+ *
+ * Appelée en fin de vieillissement: les plus âgés de la classe sortent
+ * vers l'âge age_classe + 1, les autres rejoignent les jeunes d'un an.
+ *
+ * @param pop Pointeur vers la population
+ */
+void anniversaire_classe(population *pop);
+
+/**
+ * @brief Répartit la classe adulte sur les lignes d'âge 1 à age_classe
+ * @param pop Pointeur vers la population
+ */
+void eclater_classe(population *pop);
+
+/**
+ * @brief Regroupe les lignes d'âge 1 à age_classe dans la classe adulte
+ * @param pop Pointeur vers la population
+ */
+void regrouper_classe(population *pop);
+
+/**
+ * @brief Remet une population à son état initial pour une nouvelle simulation
+ *
+ * Évite de réallouer les compteurs GMP d'une simulation à la suivante.
+ *
+ * @param pop Population à réutiliser
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ */
+void reinitialiser_population(population *pop, const params_t *params, mpz_t nbFemale, mpz_t nbMale);
+
+/**
+ * @brief Copie une population (grille, composition de la classe, totaux et planning)
+ *
+ * La copie partage les paramètres de la source et évolue ensuite
+ * indépendamment d'elle.
+ *
+ * @param source Population à copier
+ * @return Copie à libérer avec liberer_population
+ */
+population *copier_population(const population *source);
+
+/**
+ * @brief Libère une population et tous ses compteurs GMP
+ * @param pop Pointeur vers la population à libérer
+ */
+void liberer_population(population *pop);
+
 #endif // POPULATION_H
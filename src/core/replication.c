@@ -0,0 +1,491 @@
+/**
+ * @file replication.c
+ * @brief Implémentation des réplications appariées
+ *
+ * Pour comparer deux scénarios, on simule des paires de réplications qui
+ * partagent leurs nombres aléatoires:
+ * - CRN: les deux scénarios utilisent la même graine, les différences
+ *   de bruit entre scénarios se compensent en partie
+ * - Antithétique: chaque graine est aussi jouée avec le flux u -> 1 - u,
+ *   les deux trajectoires obtenues sont négativement corrélées
+ *
+ * La réduction de variance est mesurée en comparant la variance de la
+ * différence par paire à celle qu'aurait donnée le même nombre de
+ * simulations avec des graines indépendantes.
+ *
+ * Le module fournit aussi un lanceur séquentiel qui enchaîne des lots de
+ * réplications parallèles (threads ou processus fils) jusqu'à ce que l'IC
+ * de la statistique suivie atteigne la largeur demandée. Chaque thread peut
+ * y simuler les réplications une par une ou par groupes de NB_VOIES avec le
+ * moteur ensemble.
+ *
+ * Avec un cache actif (replication_utiliser_cache), les simulations du
+ * moteur mensuel déjà faites sont relues au lieu d'être relancées. Avec un
+ * journal actif (replication_utiliser_journal), chaque lot terminé du
+ * lanceur séquentiel est journalisé, et une série reprise après une
+ * interruption relit les lots déjà faits.
+ */
+
+#include "replication.h"
+#include "population.h"
+#include "ensemble.h"
+#include "shards.h"
+#include "cache.h"
+#include "journal.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define DECALAGE_GRAINE 1000003UL // Décalage des graines du scénario B en mode indépendant
+
+// Cache des simulations du moteur mensuel (NULL: pas de cache)
+static cache_resultats *cache_replications = NULL;
+
+/**
+ * @brief Active (ou désactive avec NULL) le cache des simulations du moteur mensuel
+ *
+ * @param cache Cache ouvert par cache_ouvrir
+ */
+void replication_utiliser_cache(cache_resultats *cache)
+{
+    cache_replications = cache;
+}
+
+// Journal des réplications des séries séquentielles (NULL: pas de journal)
+static journal_replications *journal_series = NULL;
+
+/**
+ * @brief Active (ou désactive avec NULL) le journal des séries séquentielles
+ *
+ * @param journal Journal ouvert par journal_ouvrir
+ */
+void replication_utiliser_journal(journal_replications *journal)
+{
+    journal_series = journal;
+}
+
+/**
+ * @brief Lit la population d'une simulation par catégorie
+ *
+ * @param pop Population
+ * @param res Structure où stocker les effectifs
+ */
+static void lire_resultat(population *pop, resultat_simulation *res)
+{
+    mpz_t bebes, males, femelles;
+    mpz_inits(bebes, males, femelles, NULL);
+    population_totaux(pop, bebes, males, femelles);
+    res->bebes = mpz_get_d(bebes);
+    res->males = mpz_get_d(males);
+    res->femelles = mpz_get_d(femelles);
+    res->total = res->bebes + res->males + res->femelles;
+    mpz_clears(bebes, males, femelles, NULL);
+}
+
+/**
+ * @brief Lance une simulation et retourne sa population finale par catégorie
+ *
+ * @param sc Scénario à simuler
+ * @param seed Graine du générateur
+ * @param antithetic 1 pour utiliser le flux antithétique de la graine
+ * @param res Structure où stocker le résultat
+ */
+void simuler_resultat(scenario sc, unsigned long seed, int antithetic, resultat_simulation *res)
+{
+    cache_resultats *cache = cache_replications;
+    if (cache && cache_chercher(cache, sc, seed, antithetic, res, NULL))
+        return;
+
+    init_genrand(seed);
+    set_antithetic(antithetic);
+
+    mpz_t nbFemale, nbMale;
+    mpz_init_set_ui(nbFemale, sc.nb_femelles);
+    mpz_init_set_ui(nbMale, sc.nb_males);
+
+    population *pop;
+    if (cache && sc.annees <= ANNEES_MAX_CACHE)
+    {
+        // Effectifs de chaque année pour le cache (même trajectoire que simulate_population)
+        resultat_simulation *annuels = malloc((sc.annees + 1) * sizeof(resultat_simulation));
+        pop = initialize_population(sc.params, nbFemale, nbMale);
+        lire_resultat(pop, &annuels[0]);
+        for (int y = 0; y < sc.annees; y++)
+        {
+            simulate_year(pop);
+            lire_resultat(pop, &annuels[y + 1]);
+        }
+        cache_enregistrer(cache, sc, seed, antithetic, annuels);
+        free(annuels);
+    }
+    else
+    {
+        pop = simulate_population(sc.params, nbFemale, nbMale, sc.annees);
+    }
+    lire_resultat(pop, res);
+
+    liberer_population(pop);
+    mpz_clears(nbFemale, nbMale, NULL);
+    set_antithetic(0);
+}
+
+/**
+ * @brief Lance une simulation et retourne sa population finale totale
+ *
+ * @param sc Scénario à simuler
+ * @param seed Graine du générateur
+ * @param antithetic 1 pour utiliser le flux antithétique de la graine
+ * @return Population finale totale
+ */
+double simuler_total(scenario sc, unsigned long seed, int antithetic)
+{
+    resultat_simulation res;
+    simuler_resultat(sc, seed, antithetic, &res);
+    return res.total;
+}
+
+/**
+ * @brief Quantile à 97,5% de la loi de Student (IC bilatéral à 95%)
+ *
+ * @param ddl Nombre de degrés de liberté
+ * @return Quantile de Student (1.96 pour les grands échantillons)
+ */
+double quantile_student_95(int ddl)
+{
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+    if (ddl < 1)
+        return INFINITY;
+    if (ddl <= 30)
+        return table[ddl - 1];
+    if (ddl <= 60)
+        return 2.000;
+    if (ddl <= 120)
+        return 1.980;
+    return 1.960;
+}
+
+/**
+ * @brief Calcule la moyenne et la variance empirique (non biaisée) d'un échantillon
+ */
+static void moyenne_variance(const double *x, int n, double *moyenne, double *variance)
+{
+    *moyenne = 0;
+    for (int i = 0; i < n; i++)
+        *moyenne += x[i];
+    *moyenne /= n;
+
+    *variance = 0;
+    for (int i = 0; i < n; i++)
+        *variance += (x[i] - *moyenne) * (x[i] - *moyenne);
+    *variance = (n > 1) ? *variance / (n - 1) : 0;
+}
+
+/**
+ * @brief Compare deux scénarios par réplications appariées
+ *
+ * Pour chaque paire i (graine seed + i):
+ * - Indépendant: A et B utilisent des graines différentes
+ * - CRN: A et B utilisent la même graine
+ * - Antithétique: A et B utilisent la même graine, chacun est simulé avec
+ *   le flux normal et le flux antithétique, et la paire vaut la moyenne des deux
+ *
+ * @param a Premier scénario
+ * @param b Second scénario
+ * @param nb_paires Nombre de paires de réplications (au moins 2)
+ * @param mode Mode d'appariement des graines
+ * @param seed Graine de base
+ * @param res Structure où stocker le résultat
+ * @return 0, -1 si nb_paires < 2 (message sur stderr, res non rempli)
+ */
+int comparer_scenarios(scenario a, scenario b, int nb_paires, mode_replication mode,
+                       unsigned long seed, comparaison *res)
+{
+    // Une seule paire ne donne aucune variance appariée
+    if (nb_paires < 2)
+    {
+        fprintf(stderr, "Erreur : comparaison appariée sur %d paire(s), il en faut au moins 2\n", nb_paires);
+        return -1;
+    }
+
+    int par_paire = (mode == REPLICATION_ANTITHETIQUE) ? 2 : 1;
+    double *brut_a = malloc(nb_paires * par_paire * sizeof(double));
+    double *brut_b = malloc(nb_paires * par_paire * sizeof(double));
+    double *diff = malloc(nb_paires * sizeof(double));
+
+    for (int i = 0; i < nb_paires; i++)
+    {
+        unsigned long seed_a = seed + i;
+        unsigned long seed_b = (mode == REPLICATION_INDEPENDANTE) ? seed_a + DECALAGE_GRAINE : seed_a;
+
+        double somme_a = 0, somme_b = 0;
+        for (int anti = 0; anti < par_paire; anti++)
+        {
+            brut_a[i * par_paire + anti] = simuler_total(a, seed_a, anti);
+            brut_b[i * par_paire + anti] = simuler_total(b, seed_b, anti);
+            somme_a += brut_a[i * par_paire + anti];
+            somme_b += brut_b[i * par_paire + anti];
+        }
+        diff[i] = (somme_a - somme_b) / par_paire;
+    }
+
+    double var_a, var_b;
+    moyenne_variance(brut_a, nb_paires * par_paire, &res->moyenne_a, &var_a);
+    moyenne_variance(brut_b, nb_paires * par_paire, &res->moyenne_b, &var_b);
+    moyenne_variance(diff, nb_paires, &res->difference, &res->variance_paire);
+
+    // Avec des graines indépendantes, une paire de même coût (par_paire runs
+    // de chaque scénario) aurait une variance (var_a + var_b) / par_paire
+    res->nb_paires = nb_paires;
+    res->nb_simulations = 2 * nb_paires * par_paire;
+    res->variance_independante = (var_a + var_b) / par_paire;
+    res->reduction_variance = (res->variance_paire > 0) ? res->variance_independante / res->variance_paire : INFINITY;
+    res->demi_largeur_ic = quantile_student_95(nb_paires - 1) * sqrt(res->variance_paire / nb_paires);
+
+    free(brut_a);
+    free(brut_b);
+    free(diff);
+    return 0;
+}
+
+/**
+ * @brief Affiche le résultat d'une comparaison et la réduction de variance obtenue
+ *
+ * @param res Résultat à afficher
+ * @param mode Mode de réplication utilisé
+ */
+void afficher_comparaison(const comparaison *res, mode_replication mode)
+{
+    static const char *noms[] = {"indépendant", "CRN", "antithétique + CRN"};
+
+    printf("Mode %s : %d paires, %d simulations\n", noms[mode], res->nb_paires, res->nb_simulations);
+    printf("  Moyennes A / B      : %.0f / %.0f lapins\n", res->moyenne_a, res->moyenne_b);
+    printf("  Différence A - B    : %.0f ± %.0f lapins (IC 95%%)\n", res->difference, res->demi_largeur_ic);
+    printf("  Réduction de variance : x%.2f", res->reduction_variance);
+    if (res->reduction_variance > 1)
+        printf(" (même IC avec %.0f%% des simulations)", 100.0 / res->reduction_variance);
+    printf("\n");
+}
+
+/**
+ * @brief Nombre de threads de calcul par défaut (nombre de cœurs en ligne)
+ *
+ * @return Nombre de threads (au moins 1)
+ */
+int nb_threads_defaut()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+}
+
+/**
+ * @brief Lot de réplications partagé entre les threads de calcul
+ */
+typedef struct lot_replications
+{
+    scenario sc;
+    unsigned long seed;
+    resultat_simulation *resultats;
+    atomic_int prochain; // Indice de la prochaine réplication à lancer
+    int fin;             // Indice de fin (exclu) du lot
+    int ensemble;        // 1: réplications prises par groupes de NB_VOIES
+} lot_replications;
+
+/**
+ * @brief Boucle d'un thread de calcul: prend les réplications du lot une par une
+ *
+ * La réplication i utilise toujours la graine seed + i, les résultats ne
+ * dépendent donc pas du nombre de threads. En mode ensemble, le thread prend
+ * NB_VOIES réplications consécutives et les simule dans un même groupe: le
+ * découpage en groupes ne dépend que de la taille des lots.
+ */
+static void *thread_replications(void *arg)
+{
+    lot_replications *lot = arg;
+    int pas = lot->ensemble ? NB_VOIES : 1;
+    int i;
+    while ((i = atomic_fetch_add(&lot->prochain, pas)) < lot->fin)
+    {
+        if (!lot->ensemble)
+        {
+            simuler_resultat(lot->sc, lot->seed + i, 0, &lot->resultats[i]);
+            continue;
+        }
+
+        int nb = (lot->fin - i < NB_VOIES) ? lot->fin - i : NB_VOIES;
+        unsigned long graines[NB_VOIES];
+        for (int v = 0; v < nb; v++)
+            graines[v] = lot->seed + i + v;
+        simuler_ensemble(lot->sc, graines, nb, &lot->resultats[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tâche d'un shard: réplication d'indice debut + t du lot
+ */
+static void tache_replication(long t, void *contexte, resultat_simulation *res)
+{
+    lot_replications *lot = contexte;
+    long i = atomic_load(&lot->prochain) + t; // prochain = début du lot en mode shards
+    simuler_resultat(lot->sc, lot->seed + i, 0, res);
+}
+
+static int comparer_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Estime la statistique suivie et la demi-largeur de son IC à 95%
+ *
+ * - Moyenne: IC de Student
+ * - Quantile: IC par statistiques d'ordre (approximation normale de la
+ *   loi binomiale du nombre d'observations sous le quantile)
+ *
+ * @return 1 si l'IC est défini, 0 si l'échantillon est trop petit
+ */
+static int estimer_precision(const resultat_simulation *res, int n, const precision_cible *cible,
+                             double *estimation, double *demi_largeur)
+{
+    double *x = malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++)
+        x[i] = res[i].total;
+
+    int defini = 0;
+    if (cible->critere == CRITERE_MOYENNE)
+    {
+        double variance;
+        moyenne_variance(x, n, estimation, &variance);
+        *demi_largeur = quantile_student_95(n - 1) * sqrt(variance / n);
+        defini = (n > 1);
+    }
+    else
+    {
+        qsort(x, n, sizeof(double), comparer_doubles);
+        double q = cible->quantile;
+        double marge = 1.96 * sqrt(n * q * (1 - q));
+        int k = (int)floor(n * q);
+        int bas = (int)floor(n * q - marge);
+        int haut = (int)ceil(n * q + marge);
+        *estimation = x[k < n ? k : n - 1];
+        defini = (bas >= 0 && haut < n);
+        *demi_largeur = defini ? (x[haut] - x[bas]) / 2 : INFINITY;
+    }
+
+    free(x);
+    return defini;
+}
+
+/**
+ * @brief Relit un lot entier dans le journal
+ *
+ * Un lot n'est repris que si toutes ses réplications sont journalisées: un
+ * lot interrompu en cours d'écriture est simulé de nouveau.
+ *
+ * @return 1 si le lot a été relu, 0 s'il faut le simuler
+ */
+static int reprendre_lot(journal_replications *journal, uint64_t cle, resultat_simulation *resultats, int debut,
+                         int fin)
+{
+    for (int i = debut; i < fin; i++)
+        if (!journal_chercher(journal, cle, i, &resultats[i]))
+            return 0;
+    journal_compter_reprises(journal, fin - debut);
+    return 1;
+}
+
+/**
+ * @brief Lance des lots de réplications parallèles jusqu'à la précision visée
+ *
+ * Les réplications sont lancées par lots répartis sur les threads de calcul
+ * (ou sur des processus fils si nb_processus > 0, sans moteur ensemble). En
+ * mode ensemble, un lot compte par défaut NB_VOIES réplications par thread.
+ * Après chaque lot, on estime la statistique suivie: on s'arrête dès que la
+ * demi-largeur relative de son IC à 95% est sous la cible (et qu'au moins
+ * min_replications ont été faites), ou quand le budget est épuisé.
+ *
+ * Avec un journal actif, un lot déjà journalisé est relu au lieu d'être
+ * simulé, et chaque lot simulé est journalisé puis forcé sur disque avant le
+ * test d'arrêt.
+ *
+ * @param sc Scénario à simuler
+ * @param cible Règle d'arrêt
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ * @param serie Structure où stocker le résultat
+ */
+void replications_sequentielles(scenario sc, const precision_cible *cible, unsigned long seed,
+                                serie_sequentielle *serie)
+{
+    int nb_threads = (cible->nb_threads > 0) ? cible->nb_threads : nb_threads_defaut();
+    int ensemble = cible->ensemble && cible->nb_processus <= 0;
+    int par_lot = (cible->nb_processus > 0) ? cible->nb_processus : nb_threads * (ensemble ? NB_VOIES : 1);
+    int taille_lot = (cible->taille_lot > 0) ? cible->taille_lot : par_lot;
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+
+    lot_replications lot;
+    lot.sc = sc;
+    lot.seed = seed;
+    lot.ensemble = ensemble;
+    lot.resultats = malloc(cible->budget * sizeof(resultat_simulation));
+    journal_replications *journal = journal_series;
+    uint64_t cle = journal ? journal_cle_serie(sc, seed, ensemble) : 0;
+
+    serie->precision_atteinte = 0;
+    serie->estimation = 0;
+    serie->demi_largeur = INFINITY;
+    int n = 0;
+    while (n < cible->budget)
+    {
+        // Lancement d'un lot
+        lot.fin = (n + taille_lot < cible->budget) ? n + taille_lot : cible->budget;
+        if (!journal || !reprendre_lot(journal, cle, lot.resultats, n, lot.fin))
+        {
+            atomic_init(&lot.prochain, n);
+            if (cible->nb_processus > 0)
+            {
+                if (executer_shards(lot.fin - n, cible->nb_processus, 3, tache_replication, &lot,
+                                    lot.resultats + n, NULL) != 0)
+                {
+                    fprintf(stderr, "Erreur : lot de réplications %d-%d incomplet, arrêt de la série\n",
+                            n, lot.fin - 1);
+                    break;
+                }
+            }
+            else
+            {
+                int nb_taches = ensemble ? (lot.fin - n + NB_VOIES - 1) / NB_VOIES : lot.fin - n;
+                int t_lances = (nb_taches < nb_threads) ? nb_taches : nb_threads;
+                for (int t = 0; t < t_lances; t++)
+                    pthread_create(&threads[t], NULL, thread_replications, &lot);
+                for (int t = 0; t < t_lances; t++)
+                    pthread_join(threads[t], NULL);
+            }
+            if (journal)
+            {
+                for (int i = n; i < lot.fin; i++)
+                    journal_ajouter(journal, cle, i, &lot.resultats[i]);
+                journal_synchroniser(journal);
+            }
+        }
+        n = lot.fin;
+
+        // Test d'arrêt
+        if (n > 0 && estimer_precision(lot.resultats, n, cible, &serie->estimation, &serie->demi_largeur) &&
+            n >= cible->min_replications &&
+            serie->demi_largeur <= cible->demi_largeur_relative * fabs(serie->estimation))
+        {
+            serie->precision_atteinte = 1;
+            break;
+        }
+    }
+
+    serie->resultats = lot.resultats;
+    serie->nb_replications = n;
+    free(threads);
+}
@@ -0,0 +1,192 @@
+/**
+ * @file replication.h
+ * @brief Fichier d'en-tête pour les réplications appariées
+ *
+ * Ce fichier déclare les modes de réplication utilisés pour comparer deux
+ * scénarios avec moins de bruit Monte-Carlo: nombres aléatoires communs (CRN)
+ * et flux antithétiques.
+ */
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "simulation.h"
+
+/**
+ * @enum mode_replication
+ * @brief Manière d'associer les graines des deux scénarios comparés
+ */
+typedef enum mode_replication
+{
+    REPLICATION_INDEPENDANTE, // Graines distinctes pour chaque scénario
+    REPLICATION_CRN,          // Nombres aléatoires communs: même graine pour les deux scénarios
+    REPLICATION_ANTITHETIQUE  // CRN + paire de flux antithétiques (u, 1 - u)
+} mode_replication;
+
+/**
+ * @struct scenario
+ * @brief Condition initiale, durée et paramètres d'une simulation
+ */
+typedef struct scenario
+{
+    int nb_femelles;        // Nombre initial de femelles
+    int nb_males;           // Nombre initial de mâles
+    int annees;             // Durée de la simulation en années
+    const params_t *params; // Paramètres biologiques
+} scenario;
+
+/**
+ * @struct comparaison
+ * @brief Résultat de la comparaison appariée de deux scénarios
+ */
+typedef struct comparaison
+{
+    int nb_paires;                // Nombre de paires de réplications
+    int nb_simulations;           // Nombre total de simulations lancées
+    double moyenne_a;             // Population finale moyenne du scénario A
+    double moyenne_b;             // Population finale moyenne du scénario B
+    double difference;            // Estimation de E[A] - E[B]
+    double demi_largeur_ic;       // Demi-largeur de l'IC à 95% de la différence
+    double variance_paire;        // Variance de la différence par paire
+    double variance_independante; // Même variance avec des graines indépendantes (même budget)
+    double reduction_variance;    // variance_independante / variance_paire
+} comparaison;
+
+/**
+ * @struct resultat_simulation
+ * @brief Population finale d'une réplication
+ */
+typedef struct resultat_simulation
+{
+    double bebes;    // Nombre final de bébés
+    double males;    // Nombre final de mâles
+    double femelles; // Nombre final de femelles
+    double total;    // Population finale totale
+} resultat_simulation;
+
+/**
+ * @enum critere_precision
+ * @brief Statistique dont on contrôle la précision
+ */
+typedef enum critere_precision
+{
+    CRITERE_MOYENNE, // Moyenne de la population finale
+    CRITERE_QUANTILE // Quantile de la population finale
+} critere_precision;
+
+/**
+ * @struct precision_cible
+ * @brief Règle d'arrêt des réplications séquentielles
+ */
+typedef struct precision_cible
+{
+    critere_precision critere;    // Statistique contrôlée
+    double quantile;              // Ordre du quantile (si CRITERE_QUANTILE)
+    double demi_largeur_relative; // Demi-largeur d'IC à 95% visée, relative à l'estimation
+    int min_replications;         // Nombre minimal de réplications avant de tester l'arrêt
+    int budget;                   // Nombre maximal de réplications
+    int taille_lot;               // Réplications lancées en parallèle par lot (0: nombre de threads)
+    int nb_threads;               // Threads de calcul (0: nombre de cœurs)
+    int nb_processus;             // > 0: lots exécutés dans autant de processus fils (shards)
+    int ensemble;                 // 1: threads simulant NB_VOIES réplications à la fois (ensemble.h)
+} precision_cible;
+
+/**
+ * @struct serie_sequentielle
+ * @brief Résultat d'une série de réplications séquentielles
+ */
+typedef struct serie_sequentielle
+{
+    resultat_simulation *resultats; // Résultat de chaque réplication (à libérer)
+    int nb_replications;            // Nombre de réplications utilisées
+    double estimation;              // Moyenne ou quantile estimé
+    double demi_largeur;            // Demi-largeur de l'IC à 95%
+    int precision_atteinte;         // 1 si la précision visée a été atteinte avant le budget
+} serie_sequentielle;
+
+typedef struct cache_resultats cache_resultats; // Cache des résultats (cache.h)
+
+/**
+ * @brief Active (ou désactive avec NULL) le cache des simulations du moteur mensuel
+ *
+ * simuler_resultat() et simuler_total() relisent alors les simulations déjà
+ * faites et enregistrent les autres. Le moteur ensemble n'est pas mis en cache.
+ *
+ * @param cache Cache ouvert par cache_ouvrir
+ */
+void replication_utiliser_cache(cache_resultats *cache);
+
+typedef struct journal_replications journal_replications; // Journal des réplications (journal.h)
+
+/**
+ * @brief Active (ou désactive avec NULL) le journal des séries séquentielles
+ *
+ * replications_sequentielles() relit alors les lots déjà journalisés et
+ * journalise les autres.
+ *
+ * @param journal Journal ouvert par journal_ouvrir
+ */
+void replication_utiliser_journal(journal_replications *journal);
+
+/**
+ * @brief Lance une simulation et retourne sa population finale par catégorie
+ * @param sc Scénario à simuler
+ * @param seed Graine du générateur
+ * @param antithetic 1 pour utiliser le flux antithétique de la graine
+ * @param res Structure où stocker le résultat
+ */
+void simuler_resultat(scenario sc, unsigned long seed, int antithetic, resultat_simulation *res);
+
+/**
+ * @brief Lance une simulation et retourne sa population finale totale
+ * @param sc Scénario à simuler
+ * @param seed Graine du générateur
+ * @param antithetic 1 pour utiliser le flux antithétique de la graine
+ * @return Population finale totale
+ */
+double simuler_total(scenario sc, unsigned long seed, int antithetic);
+
+/**
+ * @brief Quantile à 97,5% de la loi de Student (IC bilatéral à 95%)
+ * @param ddl Nombre de degrés de liberté
+ * @return Quantile de Student
+ */
+double quantile_student_95(int ddl);
+
+/**
+ * @brief Compare deux scénarios par réplications appariées
+ * @param a Premier scénario
+ * @param b Second scénario
+ * @param nb_paires Nombre de paires de réplications (au moins 2)
+ * @param mode Mode d'appariement des graines
+ * @param seed Graine de base (la paire i utilise seed + i)
+ * @param res Structure où stocker le résultat
+ * @return 0, -1 si nb_paires < 2
+ */
+int comparer_scenarios(scenario a, scenario b, int nb_paires, mode_replication mode,
+                       unsigned long seed, comparaison *res);
+
+/**
+ * @brief Affiche le résultat d'une comparaison et la réduction de variance obtenue
+ * @param res Résultat à afficher
+ * @param mode Mode de réplication utilisé
+ */
+void afficher_comparaison(const comparaison *res, mode_replication mode);
+
+/**
+ * @brief Lance des lots de réplications parallèles jusqu'à la précision visée
+ * @param sc Scénario à simuler
+ * @param cible Règle d'arrêt
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ * @param serie Structure où stocker le résultat
+ */
+void replications_sequentielles(scenario sc, const precision_cible *cible, unsigned long seed,
+                                serie_sequentielle *serie);
+
+/**
+ * @brief Nombre de threads de calcul par défaut (nombre de cœurs en ligne)
+ * @return Nombre de threads
+ */
+int nb_threads_defaut();
+
+#endif // REPLICATION_H
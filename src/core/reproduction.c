@@ -9,27 +9,26 @@
  */
 
 #include "reproduction.h"
+#include "config.h"
+#include "planning.h"
 #include "mt19937ar-cok.h"
 #include "gmp.h"
 
-#define GRAND_NB 10000 // Seuil pour utiliser l'approximation gaussienne
-
-extern double prob_litter[];
-
 /**
  * @brief Tire aléatoirement le nombre de portées d'une femelle pour l'année
  *
- * Utilise le tableau de probabilités cumulatives prob_litter[] pour
- * déterminer le nombre de portées (entre 0 et 9).
+ * Compare un entier aléatoire de 32 bits aux seuils cumulés
+ * t->seuil_portees[] pour déterminer le nombre de portées (entre 0 et 9).
  *
+ * @param t Tables de transition
  * @return Nombre de portées pour l'année
  */
-int litter_per_year()
+int litter_per_year(const tables_transition *t)
 {
-    float r = genrand_real1(); // Nombre aléatoire entre 0 et 1
-    for (int i = 1; i <= 9; i++)
+    unsigned long u = genrand_int32();
+    for (int i = 0; i <= 9; i++)
     {
-        if (r <= prob_litter[i])
+        if (u < t->seuil_portees[i])
         {
             return i;
         }
@@ -40,28 +39,155 @@ int litter_per_year()
 /**
  * @brief Tire aléatoirement la taille d'une portée
  *
+ * Les 2 bits de poids fort d'un entier de 32 bits donnent un tirage
+ * exactement uniforme parmi 4 tailles.
+ *
  * @return Nombre de bébés dans la portée (entre 3 et 6)
  */
 int accouchement()
 {
-    return uniform_int(3, 6);
+    return 3 + (int)(genrand_int32() >> 30);
+}
+
+/**
+ * @brief Tire exactement le nombre de bébés de quelques portées
+ *
+ * Une taille de portée vaut 3 + b0 + 2 * b1, b0 et b1 étant deux bits
+ * aléatoires indépendants (comme dans accouchement()): 16 portées par
+ * entier de 32 bits, les bits à 1 comptés par popcount.
+ *
+ * @param nb_portees Nombre de portées
+ * @return Nombre de bébés
+ */
+unsigned long bebes_des_portees(unsigned long nb_portees)
+{
+    unsigned long n = nb_portees;
+    unsigned long bebes = 3 * nb_portees;
+    for (; n >= 16; n -= 16)
+    {
+        uint32_t u = (uint32_t)genrand_int32();
+        bebes += __builtin_popcount(u & 0x55555555u) + 2 * __builtin_popcount(u & 0xAAAAAAAAu);
+    }
+    if (n > 0)
+    {
+        uint32_t u = (uint32_t)genrand_int32() & (uint32_t)((1ULL << (2 * n)) - 1);
+        bebes += __builtin_popcount(u & 0x55555555u) + 2 * __builtin_popcount(u & 0xAAAAAAAAu);
+    }
+    return bebes;
+}
+
+/**
+ * @brief Tire le nombre total de bébés nés de plusieurs portées
+ *
+ * Le total de k portées vaut 3k + B0 + 2 * B1, où B0 et B1 comptent les
+ * bits à 1 des tailles de portée:
+ * - Peu de portées: tirage exact (bebes_des_portees())
+ * - Beaucoup de portées: B0 et B1 binomiales(k, 1/2) indépendantes,
+ *   approximation gaussienne de moyenne 4,5k et de variance 1,25k
+ *
+ * @param bebes Variable où stocker le nombre de bébés
+ * @param nb_portees Nombre de portées
+ * @param seuil_gaussien Nombre de portées à partir duquel le tirage est gaussien
+ */
+void total_bebes(mpz_t bebes, mpz_t nb_portees, unsigned long seuil_gaussien)
+{
+    if (mpz_cmp_ui(nb_portees, seuil_gaussien) < 0)
+    {
+        mpz_set_ui(bebes, bebes_des_portees(mpz_get_ui(nb_portees)));
+        return;
+    }
+
+    mpz_mul_ui(bebes, nb_portees, 3);
+    mpz_t bits;
+    mpz_init(bits);
+    binomial_gaussian(bits, nb_portees, 0.5);
+    mpz_add(bebes, bebes, bits);
+    binomial_gaussian(bits, nb_portees, 0.5);
+    mpz_addmul_ui(bebes, bits, 2);
+    mpz_clear(bits);
+}
+
+/**
+ * @brief Tire les mises bas du mois d'une classe de femelles
+ *
+ * Les femelles de la classe (mois, acc_rest) accouchent chacune avec la
+ * probabilité t->accouchement[month][acc_rest]:
+ * - Petite classe (< t->seuil_gaussien): tirage individuel de chaque femelle
+ * - Grande classe: approximation gaussienne
+ *
+ * @param t Tables de transition
+ * @param femelles Effectif de la classe
+ * @param month Mois (0-11)
+ * @param acc_rest Nombre d'accouchements restants (1-9)
+ * @param nb_accouchements Variable où stocker le nombre de mises bas
+ * @param bebes Variable où stocker le nombre de bébés nés
+ */
+void accouchements_classe(const tables_transition *t, mpz_t femelles, int month, int acc_rest,
+                          mpz_t nb_accouchements, mpz_t bebes)
+{
+    mpz_set_ui(nb_accouchements, 0);
+    mpz_set_ui(bebes, 0);
+
+    if (mpz_cmp_ui(femelles, t->seuil_gaussien) < 0)
+    {
+        // Petite population: simulation individuelle de chaque femelle
+        unsigned long n_females = mpz_get_ui(femelles);
+        uint64_t seuil = t->seuil_accouchement[month][acc_rest];
+        for (unsigned long f = 0; f < n_females; f++)
+        {
+            // Probabilité d'accoucher ce mois
+            if (bernoulli_seuil(seuil))
+            {
+                mpz_add_ui(bebes, bebes, accouchement());
+                mpz_add_ui(nb_accouchements, nb_accouchements, 1);
+            }
+        }
+        return;
+    }
+
+    // Grande population: approximation gaussienne
+    binomial_gaussian(nb_accouchements, femelles, t->accouchement[month][acc_rest]);
+
+    // Limiter nb_accouchements au nombre de femelles disponibles
+    if (mpz_cmp(nb_accouchements, femelles) > 0)
+    {
+        mpz_set(nb_accouchements, femelles);
+    }
+    if (mpz_sgn(nb_accouchements) < 0)
+    {
+        gmp_printf("Erreur négatif %Zd\n", nb_accouchements);
+    }
+
+    // Calcul du nombre total de bébés
+    total_bebes(bebes, nb_accouchements, t->seuil_gaussien);
 }
 
 /**
  * @brief Simule la reproduction de toute la population pour un mois
  *
  * Parcourt toutes les femelles de tous les âges et mois, et détermine
- * lesquelles accouchent ce mois-ci. Deux méthodes sont utilisées:
- * - Simulation individuelle pour les petites populations (< GRAND_NB)
- * - Approximation gaussienne pour les grandes populations
+ * lesquelles accouchent ce mois-ci (voir accouchements_classe). Les
+ * femelles qui accouchent passent à acc_rest - 1 (totaux de la population
+ * compris). En mode planning, les
+ * mises bas du mois sont lues dans le planning (voir planning.h).
  *
  * @param pop Pointeur vers la population
  * @param new_babies Variable où stocker le nombre total de nouveaux bébés
  */
 void reproduction(population *pop, mpz_t new_babies)
 {
+    if (pop->planning)
+    {
+        reproduction_planifiee(pop, new_babies);
+        return;
+    }
+
+    const tables_transition *t = &pop->params->transitions;
     mpz_set_ui(new_babies, 0);
 
+    mpz_t nb_accouchements, bebes;
+    mpz_inits(nb_accouchements, bebes, NULL);
+
     // Parcours de tous les âges et mois
     for (int age = 0; age < AGE_MAX; age++)
     {
@@ -72,65 +198,22 @@ void reproduction(population *pop, mpz_t new_babies)
             // Parcours des femelles selon leur nombre d'accouchements restants
             for (int acc_rest = 1; acc_rest <= 9; acc_rest++)
             {
-                mpz_t females;
-                mpz_init(females);
-                mpz_set(females, pop_month->femelles_par_accouchements_restants[acc_rest]);
-
-                if (mpz_cmp_ui(females, GRAND_NB) < 0)
-                {
-                    // Petite population: simulation individuelle de chaque femelle
-                    unsigned long n_females = mpz_get_ui(females);
-                    for (unsigned long f = 0; f < n_females; f++)
-                    {
-                        // Probabilité d'accoucher ce mois
-                        if (genrand_real1() <= ((float)acc_rest) / (NB_MONTHS - month))
-                        {
-                            mpz_add_ui(new_babies, new_babies, accouchement());
-                            // Déplacement de la femelle vers acc_rest-1
-                            mpz_sub_ui(pop_month->femelles_par_accouchements_restants[acc_rest], pop_month->femelles_par_accouchements_restants[acc_rest], 1);
-                            mpz_add_ui(pop_month->femelles_par_accouchements_restants[acc_rest - 1], pop_month->femelles_par_accouchements_restants[acc_rest - 1], 1);
-                        }
-                    }
-                }
-                else
-                {
-                    // Grande population: approximation gaussienne
-                    mpz_t nb_accouchements;
-                    mpz_init(nb_accouchements);
-                    binomial_gaussian(nb_accouchements, females, ((float)acc_rest) / (NB_MONTHS - month));
-
-                    // Limiter nb_accouchements au nombre de femelles disponibles
-                    if (mpz_cmp(nb_accouchements, females) > 0)
-                    {
-                        mpz_set(nb_accouchements, females);
-                    }
-
-                    // Tirage de la distribution des tailles de portées
-                    mpz_t *counts = multinomial_gaussian(nb_accouchements, prob_litter, 10);
-                    mpz_sub(pop_month->femelles_par_accouchements_restants[acc_rest], pop_month->femelles_par_accouchements_restants[acc_rest], nb_accouchements);
-
-                    if (mpz_sgn(pop_month->femelles_par_accouchements_restants[acc_rest]) < 0)
-                    {
-                        gmp_printf("Erreur négatif %Zd\n", pop_month->femelles_par_accouchements_restants[acc_rest]);
-                    }
-
-                    mpz_add(pop_month->femelles_par_accouchements_restants[acc_rest - 1], pop_month->femelles_par_accouchements_restants[acc_rest - 1], nb_accouchements);
-
-                    // Calcul du nombre total de bébés
-                    for (int i = 0; i < 10; i++)
-                    {
-                        mpz_t temp;
-                        mpz_init(temp);
-                        mpz_mul_ui(temp, counts[i], i);
-                        mpz_add(new_babies, new_babies, temp);
-                        mpz_clear(temp);
-                        mpz_clear(counts[i]);
-                    }
-                    free(counts);
-                    mpz_clear(nb_accouchements);
-                }
-                mpz_clear(females);
+                mpz_ptr females = pop_month->femelles_par_accouchements_restants[acc_rest];
+                if (mpz_sgn(females) == 0)
+                    continue;
+
+                accouchements_classe(t, females, month, acc_rest, nb_accouchements, bebes);
+
+                // Déplacement des femelles qui ont accouché vers acc_rest-1
+                mpz_sub(females, females, nb_accouchements);
+                mpz_add(pop_month->femelles_par_accouchements_restants[acc_rest - 1],
+                        pop_month->femelles_par_accouchements_restants[acc_rest - 1], nb_accouchements);
+                mpz_sub(pop->totaux.femelles[acc_rest], pop->totaux.femelles[acc_rest], nb_accouchements);
+                mpz_add(pop->totaux.femelles[acc_rest - 1], pop->totaux.femelles[acc_rest - 1], nb_accouchements);
+                mpz_add(new_babies, new_babies, bebes);
             }
         }
     }
+
+    mpz_clears(nb_accouchements, bebes, NULL);
 }
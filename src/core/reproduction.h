@@ -10,12 +10,14 @@
 #define REPRODUCTION_H
 
 #include "simulation.h"
+#include "config.h"
 
 /**
  * @brief Tire aléatoirement le nombre de portées d'une femelle pour l'année
+ * @param t Tables de transition
  * @return Nombre de portées (entre 0 et 9)
  */
-int litter_per_year();
+int litter_per_year(const tables_transition *t);
 
 /**
  * @brief Tire aléatoirement la taille d'une portée
@@ -23,6 +25,33 @@ int litter_per_year();
  */
 int accouchement();
 
+/**
+ * @brief Tire exactement le nombre de bébés de quelques portées
+ * @param nb_portees Nombre de portées
+ * @return Nombre de bébés
+ */
+unsigned long bebes_des_portees(unsigned long nb_portees);
+
+/**
+ * @brief Tire le nombre total de bébés nés de plusieurs portées
+ * @param bebes Variable où stocker le nombre de bébés
+ * @param nb_portees Nombre de portées
+ * @param seuil_gaussien Nombre de portées à partir duquel le tirage est gaussien
+ */
+void total_bebes(mpz_t bebes, mpz_t nb_portees, unsigned long seuil_gaussien);
+
+/**
+ * @brief Tire les mises bas du mois d'une classe de femelles
+ * @param t Tables de transition
+ * @param femelles Effectif de la classe
+ * @param month Mois (0-11)
+ * @param acc_rest Nombre d'accouchements restants (1-9)
+ * @param nb_accouchements Variable où stocker le nombre de mises bas
+ * @param bebes Variable où stocker le nombre de bébés nés
+ */
+void accouchements_classe(const tables_transition *t, mpz_t femelles, int month, int acc_rest,
+                          mpz_t nb_accouchements, mpz_t bebes);
+
 /**
  * @brief Simule la reproduction de toute la population pour un mois
  * @param pop Pointeur vers la population
@@ -0,0 +1,625 @@
+/**
+ * @file saut.c
+ * @brief Implémentation du mode à pas de temps grossier (tau-leaping)
+ *
+ * Un saut de L mois traite chaque cellule de la population une seule fois:
+ * - Mâles: survie composée sur les L mois
+ * - Femelles: survie composée jusqu'à l'anniversaire, nombre de mises bas
+ *   des survivantes (loi hypergéométrique: les mois de mise bas forment un
+ *   sous-ensemble uniforme des mois restants), mises bas des mortes en
+ *   moyenne sur leurs mois de vie, puis nouvelles portées à l'anniversaire
+ * - Bébés: mort, maturité au mois i du saut ou bébé à la fin du saut
+ *
+ * Les portées comptées à chaque mois du saut donnent des cohortes de
+ * nouveau-nés, elles-mêmes avancées jusqu'à la fin du saut.
+ */
+
+#include "saut.h"
+#include "config.h"
+#include "population.h"
+#include "reproduction.h"
+#include "replication.h"
+#include <math.h>
+#include <time.h>
+
+/**
+ * @brief État d'un saut en cours
+ */
+typedef struct saut_en_cours
+{
+    const tables_transition *t;
+    int pas;                        // Nombre de mois du saut
+    population *fin;                // Population à la fin du saut
+    mpz_t portees[PAS_SAUT_MAX + 1]; // Portées mises bas à chaque mois du saut (1 à pas)
+    mpz_t anniversaires[AGE_MAX][PAS_SAUT_MAX + 1]; // Femelles fêtant leur anniversaire (âge, mois du saut)
+} saut_en_cours;
+
+/**
+ * @brief Options par défaut du mode saut
+ *
+ * @return Seuil de 10^6 lapins par cellule, sauts de 12 mois
+ */
+options_saut options_saut_defaut()
+{
+    options_saut opt = {1e6, 12};
+    return opt;
+}
+
+/**
+ * @brief Multiplie un entier GMP par un réel et arrondit
+ *
+ * @param res Variable où stocker le résultat
+ * @param n Entier à multiplier
+ * @param x Facteur réel positif
+ */
+static void mpz_mul_reel(mpz_t res, mpz_t n, double x)
+{
+    mpfr_t tmp;
+    mpfr_init(tmp);
+    mpfr_set_z(tmp, n, MPFR_RNDN);
+    mpfr_mul_d(tmp, tmp, x, MPFR_RNDN);
+    mpfr_get_z(res, tmp, MPFR_RNDN);
+    mpfr_clear(tmp);
+}
+
+/**
+ * @brief Nombre de combinaisons C(n, k) en réel
+ */
+static double combinaisons(int n, int k)
+{
+    if (k < 0 || k > n)
+        return 0;
+    double c = 1;
+    for (int i = 1; i <= k; i++)
+        c = c * (n - k + i) / i;
+    return c;
+}
+
+/**
+ * @brief Taux de survie mensuel d'un adulte qui atteint l'âge donné
+ *
+ * @param t Tables de transition
+ * @param age Âge en années atteint à la fin du mois
+ * @return Taux de survie (0 au-delà de l'âge maximum)
+ */
+static double survie_mois(const tables_transition *t, int age)
+{
+    return (age < AGE_MAX) ? t->survie_adulte[age] : 0;
+}
+
+/**
+ * @brief Répartit des portées sur les mois debut+1 à debut+nb du saut
+ *
+ * @param s Saut en cours
+ * @param total Nombre de portées à répartir
+ * @param debut Mois du saut précédant le premier mois concerné
+ * @param nb Nombre de mois concernés
+ * @param poids Poids relatifs des mois (NULL: répartition uniforme)
+ */
+static void repartir_portees(saut_en_cours *s, mpz_t total, int debut, int nb, const double poids[])
+{
+    double somme = 0;
+    for (int i = 1; i <= nb; i++)
+        somme += poids ? poids[i] : 1;
+    if (somme <= 0)
+        return;
+
+    mpz_t reste, part;
+    mpz_init_set(reste, total);
+    mpz_init(part);
+    for (int i = 1; i < nb; i++)
+    {
+        mpz_mul_reel(part, total, (poids ? poids[i] : 1) / somme);
+        if (mpz_cmp(part, reste) > 0)
+            mpz_set(part, reste);
+        mpz_add(s->portees[debut + i], s->portees[debut + i], part);
+        mpz_sub(reste, reste, part);
+    }
+    mpz_add(s->portees[debut + nb], s->portees[debut + nb], reste);
+    mpz_clears(reste, part, NULL);
+}
+
+/**
+ * @brief Avance des mâles adultes jusqu'à la fin du saut
+ *
+ * @param s Saut en cours
+ * @param n Nombre de mâles
+ * @param age Âge en années au mois debut du saut
+ * @param month Mois d'âge au mois debut du saut
+ * @param debut Mois du saut où les mâles sont dans cette cellule
+ */
+static void avancer_males(saut_en_cours *s, mpz_t n, int age, int month, int debut)
+{
+    int reste = s->pas - debut;
+    int age_fin = age + (month + reste) / NB_MONTHS;
+    if (mpz_sgn(n) == 0 || age_fin >= AGE_MAX)
+        return;
+
+    double survie = 1;
+    for (int i = 1; i <= reste; i++)
+        survie *= survie_mois(s->t, age + (month + i) / NB_MONTHS);
+
+    mpz_t survivants;
+    mpz_init(survivants);
+    tirage_binomial(survivants, n, survie, s->t->seuil_gaussien);
+    mois_lapin *dest = &s->fin->lapins_par_age[age_fin][(month + reste) % NB_MONTHS];
+    mpz_add(dest->nb_male, dest->nb_male, survivants);
+    mpz_clear(survivants);
+}
+
+/**
+ * @brief Avance des femelles adultes jusqu'à la fin du saut
+ *
+ * Le saut est découpé à l'anniversaire: seules les survivantes sans portée
+ * restante passent l'anniversaire; elles sont mises de côté par âge et
+ * reçoivent leurs nouvelles portées dans avancer_anniversaires().
+ *
+ * @param s Saut en cours
+ * @param n Nombre de femelles
+ * @param age Âge en années au mois debut du saut
+ * @param month Mois d'âge au mois debut du saut
+ * @param acc Nombre de portées restantes
+ * @param debut Mois du saut où les femelles sont dans cette cellule
+ */
+static void avancer_femelles(saut_en_cours *s, mpz_t n, int age, int month, int acc, int debut)
+{
+    const tables_transition *t = s->t;
+    int reste = s->pas - debut;
+    if (mpz_sgn(n) == 0 || age >= AGE_MAX)
+        return;
+    if (reste == 0)
+    {
+        mpz_t *dest = &s->fin->lapins_par_age[age][month].femelles_par_accouchements_restants[acc];
+        mpz_add(*dest, *dest, n);
+        return;
+    }
+
+    // Segment jusqu'à la fin du saut ou jusqu'à l'anniversaire compris
+    int restants_annee = NB_MONTHS - month;
+    int seg = (reste < restants_annee) ? reste : restants_annee;
+    double cumul[PAS_SAUT_MAX + 1];
+    cumul[0] = 1;
+    for (int i = 1; i <= seg; i++)
+        cumul[i] = cumul[i - 1] * survie_mois(t, age + (month + i) / NB_MONTHS);
+
+    mpz_t survivantes, mortes, portees;
+    mpz_inits(survivantes, mortes, portees, NULL);
+    tirage_binomial(survivantes, n, cumul[seg], s->t->seuil_gaussien);
+    mpz_sub(mortes, n, survivantes);
+
+    // Survivantes: effectif par nombre de portées restantes à la fin du segment
+    mpz_t apres[10];
+    for (int k = 0; k < 10; k++)
+        mpz_init(apres[k]);
+    if (acc >= restants_annee)
+    {
+        // Probabilité 1 chaque mois: une mise bas par mois du segment
+        mpz_set(apres[acc - seg], survivantes);
+        mpz_mul_ui(portees, survivantes, seg);
+    }
+    else
+    {
+        // Loi hypergéométrique du nombre b de mises bas sur seg des mois restants
+        int b_max = (acc < seg) ? acc : seg;
+        double proba_cumul[PAS_SAUT_MAX + 2];
+        double somme = 0;
+        double total = combinaisons(restants_annee, seg);
+        for (int b = 0; b <= b_max; b++)
+        {
+            somme += combinaisons(acc, b) * combinaisons(restants_annee - acc, seg - b) / total;
+            proba_cumul[b] = somme;
+        }
+        proba_cumul[b_max] = 1;
+        mpz_t *counts = tirage_multinomial(survivantes, proba_cumul, b_max + 1, s->t->seuil_gaussien);
+        for (int b = 0; b <= b_max; b++)
+        {
+            mpz_set(apres[acc - b], counts[b]);
+            mpz_addmul_ui(portees, counts[b], b);
+        }
+        liberer_effectifs(counts, b_max + 1);
+    }
+    repartir_portees(s, portees, debut, seg, NULL);
+
+    // Mortes: mises bas au taux mensuel sur les mois vécus dans le segment
+    if (acc > 0 && mpz_sgn(mortes) > 0 && cumul[seg] < 1)
+    {
+        double p = (acc >= restants_annee) ? 1.0 : (double)acc / restants_annee;
+        double vivantes[PAS_SAUT_MAX + 1];
+        double mois_vecus = 0;
+        for (int i = 1; i <= seg; i++)
+        {
+            vivantes[i] = (cumul[i - 1] - cumul[seg]) / (1 - cumul[seg]);
+            mois_vecus += vivantes[i];
+        }
+        mpz_t exposition;
+        mpz_init(exposition);
+        mpz_mul_reel(exposition, mortes, mois_vecus);
+        tirage_binomial(portees, exposition, p, s->t->seuil_gaussien);
+        repartir_portees(s, portees, debut, seg, vivantes);
+        mpz_clear(exposition);
+    }
+
+    if (seg < restants_annee)
+    {
+        // Fin du saut avant l'anniversaire
+        mois_lapin *dest = &s->fin->lapins_par_age[age][month + seg];
+        for (int k = 0; k < 10; k++)
+            mpz_add(dest->femelles_par_accouchements_restants[k], dest->femelles_par_accouchements_restants[k], apres[k]);
+    }
+    else if (age + 1 < AGE_MAX)
+    {
+        // Anniversaire: regroupées par âge, elles recevront ensemble leurs portées
+        mpz_add(s->anniversaires[age + 1][debut + seg], s->anniversaires[age + 1][debut + seg], apres[0]);
+    }
+
+    for (int k = 0; k < 10; k++)
+        mpz_clear(apres[k]);
+    mpz_clears(survivantes, mortes, portees, NULL);
+}
+
+/**
+ * @brief Attribue les portées de l'année aux femelles fêtant leur anniversaire
+ *
+ * Un seul tirage multinomial par âge, au lieu d'un par cellule de départ.
+ *
+ * @param s Saut en cours
+ * @param mois Mois du saut où a lieu l'anniversaire
+ */
+static void avancer_anniversaires(saut_en_cours *s, int mois)
+{
+    for (int age = 1; age < AGE_MAX; age++)
+    {
+        if (mpz_sgn(s->anniversaires[age][mois]) == 0)
+            continue;
+        mpz_t *counts = tirage_multinomial(s->anniversaires[age][mois], s->t->portees_cumul, 10,
+                                           s->t->seuil_gaussien);
+        for (int l = 0; l < 10; l++)
+            avancer_femelles(s, counts[l], age, 0, l, mois);
+        liberer_effectifs(counts, 10);
+    }
+}
+
+/**
+ * @brief Avance des bébés jusqu'à la fin du saut
+ *
+ * Chaque bébé meurt, devient mature à un mois i du saut (il est alors avancé
+ * comme adulte à partir de ce mois) ou reste bébé jusqu'à la fin du saut.
+ *
+ * @param s Saut en cours
+ * @param n Nombre de bébés
+ * @param month Mois d'âge au mois debut du saut
+ * @param debut Mois du saut où les bébés sont dans cette cellule
+ */
+static void avancer_bebes(saut_en_cours *s, mpz_t n, int month, int debut)
+{
+    const tables_transition *t = s->t;
+    int reste = s->pas - debut;
+    if (mpz_sgn(n) == 0)
+        return;
+    if (reste == 0)
+    {
+        mpz_add(s->fin->lapins_par_age[0][month].nb_babies, s->fin->lapins_par_age[0][month].nb_babies, n);
+        return;
+    }
+
+    // Catégories: 0 mort, i = 1..reste mature au mois i, reste + 1 encore bébé
+    double proba[PAS_SAUT_MAX + 2];
+    double encore = 1;
+    for (int i = 1; i <= reste; i++)
+    {
+        int mois_age = month + i;
+        if (mois_age >= NB_MONTHS - 1)
+        {
+            // Au-delà du mois 10 les bébés ne sont plus suivis
+            proba[i] = 0;
+            encore = 0;
+            continue;
+        }
+        proba[i] = encore * t->survie_bebe * t->maturite[mois_age];
+        encore *= t->survie_bebe * (1 - t->maturite[mois_age]);
+    }
+    proba[reste + 1] = encore;
+    proba[0] = 1;
+    for (int i = 1; i <= reste + 1; i++)
+        proba[0] -= proba[i];
+
+    double cumul[PAS_SAUT_MAX + 2];
+    double somme = 0;
+    for (int c = 0; c <= reste + 1; c++)
+    {
+        somme += (proba[c] > 0) ? proba[c] : 0;
+        cumul[c] = somme;
+    }
+    cumul[reste + 1] = 1;
+    mpz_t *counts = tirage_multinomial(n, cumul, reste + 2, t->seuil_gaussien);
+
+    mpz_t males, femelles;
+    mpz_inits(males, femelles, NULL);
+    for (int i = 1; i <= reste; i++)
+    {
+        if (mpz_sgn(counts[i]) == 0)
+            continue;
+        int mois_age = month + i;
+        tirage_binomial(males, counts[i], t->proba_male, t->seuil_gaussien);
+        mpz_sub(femelles, counts[i], males);
+        avancer_males(s, males, 0, mois_age, debut + i);
+
+        // Portées de l'année, diminuées des mois déjà écoulés
+        mpz_t *portees = tirage_multinomial(femelles, t->portees_cumul, 10, t->seuil_gaussien);
+        for (int l = 1; l <= mois_age && l < 10; l++)
+            mpz_add(portees[0], portees[0], portees[l]);
+        avancer_femelles(s, portees[0], 0, mois_age, 0, debut + i);
+        for (int l = mois_age + 1; l < 10; l++)
+            avancer_femelles(s, portees[l], 0, mois_age, l - mois_age, debut + i);
+        liberer_effectifs(portees, 10);
+    }
+    if (month + reste < NB_MONTHS)
+    {
+        mpz_t *dest = &s->fin->lapins_par_age[0][month + reste].nb_babies;
+        mpz_add(*dest, *dest, counts[reste + 1]);
+    }
+    mpz_clears(males, femelles, NULL);
+    liberer_effectifs(counts, reste + 2);
+}
+
+/**
+ * @brief Choisit le nombre de mois du prochain pas
+ *
+ * Une cellule (âge, mois) est petite si elle compte moins de opt->seuil
+ * lapins: ses fluctuations relatives dépassent alors 1 / sqrt(seuil). Les
+ * cellules marginales, qui pèsent moins d'un seuil-ième de la population,
+ * ne bloquent pas le saut: elles y sont avancées par tirages individuels.
+ *
+ * @param pop Population courante
+ * @param opt Réglage du mode saut
+ * @param mois_restants Nombre de mois restant à simuler
+ * @return 1 si une cellule est petite, sinon la longueur du saut
+ */
+int choisir_pas(population *pop, const options_saut *opt, int mois_restants)
+{
+    mpz_t total, cell_total, marginal;
+    mpz_inits(total, cell_total, marginal, NULL);
+    population_totale(pop, total);
+    mpz_set_d(marginal, opt->seuil);
+    mpz_cdiv_q(marginal, total, marginal);
+
+    int petite = 0;
+    for (int age = 0; age < AGE_MAX && !petite; age++)
+    {
+        for (int month = 0; month < NB_MONTHS && !petite; month++)
+        {
+            mois_lapin *cell = &pop->lapins_par_age[age][month];
+            mpz_add(cell_total, cell->nb_babies, cell->nb_male);
+            for (int i = 0; i < 10; i++)
+                mpz_add(cell_total, cell_total, cell->femelles_par_accouchements_restants[i]);
+            if (mpz_cmp_d(cell_total, opt->seuil) < 0 && mpz_cmp(cell_total, marginal) >= 0 && mpz_sgn(cell_total) > 0)
+                petite = 1;
+        }
+    }
+    mpz_clears(total, cell_total, marginal, NULL);
+
+    if (petite)
+        return 1;
+    int pas = opt->pas_max;
+    if (pas > PAS_SAUT_MAX)
+        pas = PAS_SAUT_MAX;
+    if (pas > mois_restants)
+        pas = mois_restants;
+    return (pas > 1) ? pas : 1;
+}
+
+/**
+ * @brief Avance la population de plusieurs mois en un seul saut
+ *
+ * La classe adulte regroupée est d'abord répartie sur les âges détaillés,
+ * puis reformée à la fin du saut.
+ *
+ * Les cellules de départ sont avancées une à une, puis, mois par mois, les
+ * femelles fêtant leur anniversaire et la cohorte de nouveau-nés du mois:
+ * leurs propres portées ne peuvent tomber que sur des mois ultérieurs.
+ *
+ * @param pop Population à faire évoluer
+ * @param pas Nombre de mois (1 à PAS_SAUT_MAX)
+ */
+void avancer_saut(population *pop, int pas)
+{
+    saut_en_cours s;
+    mpz_t zero;
+    mpz_init(zero);
+    s.t = &pop->params->transitions;
+    s.pas = pas;
+    s.fin = initialize_population(pop->params, zero, zero);
+    eclater_classe(pop);
+    for (int i = 0; i <= pas; i++)
+    {
+        mpz_init(s.portees[i]);
+        for (int age = 0; age < AGE_MAX; age++)
+            mpz_init(s.anniversaires[age][i]);
+    }
+
+    for (int age = 0; age < AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *cell = &pop->lapins_par_age[age][month];
+            avancer_males(&s, cell->nb_male, age, month, 0);
+            for (int acc = 0; acc < 10; acc++)
+                avancer_femelles(&s, cell->femelles_par_accouchements_restants[acc], age, month, acc, 0);
+            if (age == 0)
+                avancer_bebes(&s, cell->nb_babies, month, 0);
+        }
+    }
+
+    // Anniversaires et nouveau-nés de chaque mois du saut: les femelles et
+    // bébés avancés à partir du mois i ne comptent des portées qu'après i
+    mpz_t bebes;
+    mpz_init(bebes);
+    for (int i = 1; i <= pas; i++)
+    {
+        avancer_anniversaires(&s, i);
+        total_bebes(bebes, s.portees[i], s.t->seuil_gaussien);
+        avancer_bebes(&s, bebes, 0, i);
+    }
+    mpz_clear(bebes);
+
+    // La population finale remplace la population courante
+    for (int age = 0; age <= AGE_MAX; age++)
+    {
+        for (int month = 0; month < NB_MONTHS; month++)
+        {
+            mois_lapin *cell = &pop->lapins_par_age[age][month];
+            mois_lapin *nouv = &s.fin->lapins_par_age[age][month];
+            mpz_swap(cell->nb_babies, nouv->nb_babies);
+            mpz_swap(cell->nb_male, nouv->nb_male);
+            for (int i = 0; i < 10; i++)
+                mpz_swap(cell->femelles_par_accouchements_restants[i], nouv->femelles_par_accouchements_restants[i]);
+        }
+    }
+
+    regrouper_classe(pop);
+    population_recompter(pop);
+
+    for (int i = 0; i <= pas; i++)
+    {
+        mpz_clear(s.portees[i]);
+        for (int age = 0; age < AGE_MAX; age++)
+            mpz_clear(s.anniversaires[age][i]);
+    }
+    mpz_clear(zero);
+    liberer_population(s.fin);
+}
+
+/**
+ * @brief Simule une population en alternant pas mensuels et sauts
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Réglage du mode saut
+ * @param bilan Structure où stocker la répartition des pas (peut être NULL)
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_saut(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                     const options_saut *opt, bilan_saut *bilan)
+{
+    population *pop = initialize_population(params, nbFemale, nbMale);
+    bilan_saut b = {0, 0, 0};
+
+    int mois_restants = years * NB_MONTHS;
+    while (mois_restants > 0)
+    {
+        int pas = choisir_pas(pop, opt, mois_restants);
+        if (pas == 1)
+        {
+            simulate_month(pop);
+            b.mois_mensuels++;
+        }
+        else
+        {
+            avancer_saut(pop, pas);
+            b.nb_sauts++;
+            b.mois_sautes += pas;
+        }
+        mois_restants -= pas;
+    }
+
+    if (bilan)
+        *bilan = b;
+    return pop;
+}
+
+/**
+ * @brief Lance une simulation avec l'un des deux moteurs
+ *
+ * @param sc Scénario à simuler
+ * @param opt Réglage du mode saut (NULL: moteur mensuel)
+ * @param seed Graine du générateur
+ * @param res Structure où stocker le résultat
+ * @return Durée de la simulation en secondes
+ */
+static double simuler_moteur(scenario sc, const options_saut *opt, unsigned long seed, resultat_simulation *res)
+{
+    struct timespec debut, fin;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    init_genrand(seed);
+
+    mpz_t f, m, bebes, males, femelles;
+    mpz_init_set_ui(f, sc.nb_femelles);
+    mpz_init_set_ui(m, sc.nb_males);
+    mpz_inits(bebes, males, femelles, NULL);
+    population *pop = opt ? simulate_population_saut(sc.params, f, m, sc.annees, opt, NULL)
+                          : simulate_population(sc.params, f, m, sc.annees);
+    population_totaux(pop, bebes, males, femelles);
+    res->bebes = mpz_get_d(bebes);
+    res->males = mpz_get_d(males);
+    res->femelles = mpz_get_d(femelles);
+    res->total = res->bebes + res->males + res->femelles;
+
+    liberer_population(pop);
+    mpz_clears(f, m, bebes, males, femelles, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - debut.tv_sec) + (fin.tv_nsec - debut.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Compare le mode saut au moteur mensuel et affiche l'erreur commise
+ *
+ * Les deux moteurs sont lancés avec les mêmes graines: ils suivent la même
+ * trajectoire jusqu'au premier saut. L'écart relatif des moyennes est donné
+ * avec l'erreur standard des différences appariées; un écart de plusieurs
+ * erreurs standard signale un biais du mode saut.
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Réglage du mode saut
+ * @param nb_rep Nombre de réplications de chaque moteur
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ */
+void rapport_erreur_saut(const params_t *params, int nb_femelles, int nb_males, int years,
+                         const options_saut *opt, int nb_rep, unsigned long seed)
+{
+    static const char *noms[] = {"Bébés", "Mâles", "Femelles", "Total"};
+    scenario sc = {nb_femelles, nb_males, years, params};
+    double somme[2][4] = {{0}}, somme_carres[4] = {0}, somme_ecarts[4] = {0}, duree[2] = {0};
+
+    for (int r = 0; r < nb_rep; r++)
+    {
+        double v[2][4];
+        for (int moteur = 0; moteur < 2; moteur++)
+        {
+            resultat_simulation res;
+            duree[moteur] += simuler_moteur(sc, moteur ? opt : NULL, seed + r, &res);
+            v[moteur][0] = res.bebes;
+            v[moteur][1] = res.males;
+            v[moteur][2] = res.femelles;
+            v[moteur][3] = res.total;
+        }
+        for (int c = 0; c < 4; c++)
+        {
+            somme[0][c] += v[0][c];
+            somme[1][c] += v[1][c];
+            somme_carres[c] += (v[1][c] - v[0][c]) * (v[1][c] - v[0][c]);
+            somme_ecarts[c] += v[1][c] - v[0][c];
+        }
+    }
+
+    // Écart relatif des moyennes et son erreur standard (différences appariées)
+    printf("Mode saut (seuil %.0e, pas de %d mois) contre moteur mensuel : %d réplications, %d ans\n",
+           opt->seuil, opt->pas_max, nb_rep, years);
+    printf("  %-10s %14s %14s %12s %12s\n", "", "mensuel", "saut", "écart rel.", "e.s. rel.");
+    for (int c = 0; c < 4; c++)
+    {
+        double moy_mensuel = somme[0][c] / nb_rep;
+        double moy_saut = somme[1][c] / nb_rep;
+        double moy_ecart = somme_ecarts[c] / nb_rep;
+        double var = (nb_rep > 1) ? (somme_carres[c] - nb_rep * moy_ecart * moy_ecart) / (nb_rep - 1) : 0;
+        double es = (var > 0) ? sqrt(var / nb_rep) : 0;
+        printf("  %s\t%14.4e %14.4e %+11.3f%% %11.3f%%\n", noms[c], moy_mensuel, moy_saut,
+               100 * moy_ecart / moy_mensuel, 100 * es / moy_mensuel);
+    }
+    printf("  Durée : %.2f s (mensuel) / %.2f s (saut), accélération x%.1f\n",
+           duree[0], duree[1], duree[0] / duree[1]);
+}
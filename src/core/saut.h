@@ -0,0 +1,92 @@
+/**
+ * @file saut.h
+ * @brief Fichier d'en-tête du mode à pas de temps grossier (tau-leaping)
+ *
+ * Lorsque toutes les cellules de la population sont très peuplées, les
+ * fluctuations relatives deviennent négligeables et avancer mois par mois
+ * coûte surtout en tirages. Le mode saut avance alors de plusieurs mois
+ * d'un coup à l'aide de probabilités de survie et de naissance composées,
+ * et revient au pas mensuel dès qu'une cellule est petite.
+ */
+
+#ifndef SAUT_H
+#define SAUT_H
+
+#include "simulation.h"
+
+#define PAS_SAUT_MAX 12 // Nombre maximal de mois avancés en un saut
+
+/**
+ * @struct options_saut
+ * @brief Réglage du mode saut
+ */
+typedef struct options_saut
+{
+    double seuil; // Effectif minimal d'une cellule (non marginale) pour autoriser un saut
+    int pas_max;  // Nombre de mois avancés par saut (2 à PAS_SAUT_MAX)
+} options_saut;
+
+/**
+ * @struct bilan_saut
+ * @brief Répartition des mois simulés entre pas mensuels et sauts
+ */
+typedef struct bilan_saut
+{
+    int mois_mensuels; // Mois simulés un par un
+    int nb_sauts;      // Nombre de sauts effectués
+    int mois_sautes;   // Mois couverts par les sauts
+} bilan_saut;
+
+/**
+ * @brief Options par défaut du mode saut
+ * @return Seuil de 10^6 lapins par cellule, sauts de 12 mois
+ */
+options_saut options_saut_defaut();
+
+/**
+ * @brief Choisit le nombre de mois du prochain pas
+ * @param pop Population courante
+ * @param opt Réglage du mode saut
+ * @param mois_restants Nombre de mois restant à simuler
+ * @return 1 si une cellule est petite, sinon la longueur du saut
+ */
+int choisir_pas(population *pop, const options_saut *opt, int mois_restants);
+
+/**
+ * @brief Avance la population de plusieurs mois en un seul saut
+ * @param pop Population à faire évoluer
+ * @param pas Nombre de mois (1 à PAS_SAUT_MAX)
+ */
+void avancer_saut(population *pop, int pas);
+
+/**
+ * @brief Simule une population en alternant pas mensuels et sauts
+ * @param params Jeu de paramètres biologiques
+ * @param nbFemale Nombre initial de femelles
+ * @param nbMale Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Réglage du mode saut
+ * @param bilan Structure où stocker la répartition des pas (peut être NULL)
+ * @return Pointeur vers la population finale
+ */
+population *simulate_population_saut(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years,
+                                     const options_saut *opt, bilan_saut *bilan);
+
+/**
+ * @brief Compare le mode saut au moteur mensuel et affiche l'erreur commise
+ *
+ * Les deux moteurs sont lancés avec les mêmes graines; l'écart relatif des
+ * moyennes est donné avec l'erreur standard des différences appariées.
+ *
+ * @param params Jeu de paramètres biologiques
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param years Nombre d'années à simuler
+ * @param opt Réglage du mode saut
+ * @param nb_rep Nombre de réplications de chaque moteur
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ */
+void rapport_erreur_saut(const params_t *params, int nb_femelles, int nb_males, int years,
+                         const options_saut *opt, int nb_rep, unsigned long seed);
+
+#endif // SAUT_H
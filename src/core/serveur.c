@@ -0,0 +1,544 @@
+/**
+ * @file serveur.c
+ * @brief Implémentation du démon de simulation sur socket Unix
+ *
+ * Un thread par connexion lit les requêtes et les ajoute à une file
+ * commune; les threads de calcul prennent les réplications de la requête
+ * en tête de file une à une et écrivent chaque réponse dès qu'elle est
+ * prête. Une connexion et une requête sont libérées par le dernier thread
+ * qui s'en sert (compteurs de références).
+ */
+
+#define _DEFAULT_SOURCE // lstat, S_ISSOCK
+
+#include "serveur.h"
+#include "population.h"
+#include "replication.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define CACHE_PARAMS 64 // Jeux de paramètres finalisés gardés par le démon
+
+/**
+ * @struct connexion
+ * @brief Connexion d'un client
+ */
+typedef struct connexion
+{
+    int fd;                    // Socket du client
+    pthread_mutex_t ecriture;  // Sérialise les réponses des threads de calcul
+    atomic_int references;     // Lecteur et requêtes en cours
+    atomic_int rompue;         // 1 après une erreur d'écriture: les réplications restantes sont sautées
+} connexion;
+
+/**
+ * @struct requete_en_cours
+ * @brief Requête en file ou en cours de calcul
+ */
+typedef struct requete_en_cours
+{
+    requete_demon req;                 // Requête reçue
+    connexion *cnx;                    // Connexion où répondre
+    const params_t *params;            // Paramètres finalisés
+    int entree_cache;                  // Entrée du cache des paramètres (-1: nominal ou non gardé)
+    uint32_t prochaine;                // Prochaine réplication à distribuer (sous le verrou de la file)
+    atomic_uint restantes;             // Réplications non terminées
+    struct requete_en_cours *suivante; // Requête suivante dans la file
+} requete_en_cours;
+
+/**
+ * @struct entree_params
+ * @brief Jeu de paramètres finalisé gardé entre les requêtes
+ */
+typedef struct entree_params
+{
+    uint64_t empreinte;      // Empreinte des valeurs (params_empreinte)
+    params_t *params;        // Jeu finalisé (NULL: entrée libre)
+    int references;          // Requêtes en cours qui l'utilisent
+    unsigned long dernier;   // Dernier usage (horloge du cache)
+} entree_params;
+
+/**
+ * @struct serveur
+ * @brief État partagé du démon
+ */
+typedef struct serveur
+{
+    const params_t *nominal;             // Paramètres des requêtes sans valeurs
+    pthread_mutex_t verrou;              // Protège la file et le cache
+    pthread_cond_t travail;              // Signale une requête en file
+    requete_en_cours *tete, *queue;      // File des requêtes
+    entree_params cache[CACHE_PARAMS];   // Jeux de paramètres finalisés
+    unsigned long horloge;               // Horloge du cache
+    atomic_ulong nb_requetes;            // Requêtes reçues
+    atomic_ulong nb_replications;        // Réplications simulées
+} serveur;
+
+/**
+ * @struct lecteur
+ * @brief Argument du thread de lecture d'une connexion
+ */
+typedef struct lecteur
+{
+    serveur *s;
+    connexion *cnx;
+} lecteur;
+
+/**
+ * @brief Lit exactement taille octets d'un descripteur
+ *
+ * @param fd Descripteur
+ * @param tampon Destination
+ * @param taille Nombre d'octets
+ * @return 0, -1 en cas d'erreur ou de fin de flux
+ */
+int lire_complet(int fd, void *tampon, size_t taille)
+{
+    char *p = tampon;
+    while (taille > 0)
+    {
+        ssize_t n = read(fd, p, taille);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        taille -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Écrit exactement taille octets sur un socket
+ *
+ * MSG_NOSIGNAL: un client parti ne tue pas le démon par SIGPIPE.
+ *
+ * @param fd Descripteur du socket
+ * @param tampon Source
+ * @param taille Nombre d'octets
+ * @return 0, -1 en cas d'erreur (pair déconnecté)
+ */
+int ecrire_complet(int fd, const void *tampon, size_t taille)
+{
+    const char *p = tampon;
+    while (taille > 0)
+    {
+        ssize_t n = send(fd, p, taille, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        taille -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Recopie les valeurs d'un jeu de paramètres dans une requête
+ *
+ * @param params Jeu de paramètres
+ * @param valeurs Valeurs à remplir
+ */
+void valeurs_depuis_params(const params_t *params, valeurs_demon *valeurs)
+{
+    memcpy(valeurs->poids_portees, params->poids_portees, sizeof(valeurs->poids_portees));
+    memcpy(valeurs->maturite, params->maturite, sizeof(valeurs->maturite));
+    memcpy(valeurs->survie_adulte, params->survie_annuelle_adulte, sizeof(valeurs->survie_adulte));
+    valeurs->survie_bebe = params->survie_bebe;
+    valeurs->proba_male = params->proba_male;
+}
+
+/**
+ * @brief Remplit l'adresse d'un socket Unix
+ *
+ * @param adresse Adresse à remplir
+ * @param chemin Chemin du socket
+ * @return 0, -1 si le chemin est trop long
+ */
+static int adresse_unix(struct sockaddr_un *adresse, const char *chemin)
+{
+    memset(adresse, 0, sizeof(*adresse));
+    adresse->sun_family = AF_UNIX;
+    if (strlen(chemin) >= sizeof(adresse->sun_path))
+        return -1;
+    strcpy(adresse->sun_path, chemin);
+    return 0;
+}
+
+/**
+ * @brief Se connecte au démon
+ *
+ * @param chemin Chemin du socket Unix
+ * @return Descripteur du socket, -1 en cas d'échec
+ */
+int serveur_connecter(const char *chemin)
+{
+    struct sockaddr_un adresse;
+    if (adresse_unix(&adresse, chemin) != 0)
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&adresse, sizeof(adresse)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Rend une référence sur une connexion, la ferme à la dernière
+ */
+static void connexion_rendre(connexion *cnx)
+{
+    if (atomic_fetch_sub(&cnx->references, 1) != 1)
+        return;
+    close(cnx->fd);
+    pthread_mutex_destroy(&cnx->ecriture);
+    free(cnx);
+}
+
+/**
+ * @brief Écrit une réponse sur une connexion
+ */
+static void repondre(connexion *cnx, const reponse_demon *rep)
+{
+    if (atomic_load(&cnx->rompue))
+        return;
+    pthread_mutex_lock(&cnx->ecriture);
+    if (ecrire_complet(cnx->fd, rep, sizeof(*rep)) != 0)
+        atomic_store(&cnx->rompue, 1);
+    pthread_mutex_unlock(&cnx->ecriture);
+}
+
+/**
+ * @brief Écrit la réponse de fin d'une requête (indice DEMON_FIN)
+ */
+static void terminer(connexion *cnx, uint32_t identifiant, int32_t statut)
+{
+    reponse_demon rep = {identifiant, DEMON_FIN, statut, 0, 0, 0, 0, 0};
+    repondre(cnx, &rep);
+}
+
+/**
+ * @brief Jeu de paramètres finalisé pour des valeurs, pris dans le cache ou ajouté au cache
+ *
+ * Sous le verrou du serveur. Quand toutes les entrées servent à des
+ * requêtes en cours, le jeu n'est pas gardé et sera libéré par la requête.
+ *
+ * @param s Serveur
+ * @param valeurs Valeurs de la requête
+ * @param entree Entrée du cache utilisée (-1 si le jeu n'est pas gardé)
+ * @return Jeu finalisé, NULL si les valeurs sont invalides
+ */
+static const params_t *obtenir_params(serveur *s, const valeurs_demon *valeurs, int *entree)
+{
+    params_t *params = params_copier(s->nominal);
+    memcpy(params->poids_portees, valeurs->poids_portees, sizeof(params->poids_portees));
+    memcpy(params->maturite, valeurs->maturite, sizeof(params->maturite));
+    memcpy(params->survie_annuelle_adulte, valeurs->survie_adulte, sizeof(params->survie_annuelle_adulte));
+    params->survie_bebe = valeurs->survie_bebe;
+    params->proba_male = valeurs->proba_male;
+    uint64_t empreinte = params_empreinte(params);
+
+    int libre = -1;
+    s->horloge++;
+    for (int e = 0; e < CACHE_PARAMS; e++)
+    {
+        entree_params *c = &s->cache[e];
+        if (c->params && c->empreinte == empreinte)
+        {
+            c->references++;
+            c->dernier = s->horloge;
+            *entree = e;
+            params_liberer(params);
+            return c->params;
+        }
+        // Entrée vide de préférence, sinon la moins récemment utilisée parmi celles qui ne servent pas
+        if (c->references > 0)
+            continue;
+        if (!c->params)
+        {
+            if (libre < 0 || s->cache[libre].params)
+                libre = e;
+        }
+        else if (libre < 0 || (s->cache[libre].params && c->dernier < s->cache[libre].dernier))
+            libre = e;
+    }
+
+    if (params_finaliser(params) != 0)
+    {
+        params_liberer(params);
+        return NULL;
+    }
+    *entree = libre;
+    if (libre >= 0)
+    {
+        entree_params *c = &s->cache[libre];
+        if (c->params)
+            params_liberer(c->params);
+        *c = (entree_params){empreinte, params, 1, s->horloge};
+    }
+    return params;
+}
+
+/**
+ * @brief Rend les paramètres d'une requête terminée
+ */
+static void rendre_params(serveur *s, requete_en_cours *rq)
+{
+    if (rq->params == s->nominal)
+        return;
+    pthread_mutex_lock(&s->verrou);
+    if (rq->entree_cache >= 0)
+        s->cache[rq->entree_cache].references--;
+    else
+        params_liberer(rq->params);
+    pthread_mutex_unlock(&s->verrou);
+}
+
+/**
+ * @brief Thread de calcul: simule les réplications de la file
+ *
+ * Chaque thread garde sa population et la réinitialise pour chaque
+ * réplication.
+ */
+static void *thread_calcul(void *arg)
+{
+    serveur *s = arg;
+    population *pop = NULL;
+    mpz_t nbFemale, nbMale, bebes, males, femelles;
+    mpz_inits(nbFemale, nbMale, bebes, males, femelles, NULL);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&s->verrou);
+        while (!s->tete)
+            pthread_cond_wait(&s->travail, &s->verrou);
+        requete_en_cours *rq = s->tete;
+        uint32_t indice = rq->prochaine++;
+        if (rq->prochaine == rq->req.nb_replications)
+        {
+            s->tete = rq->suivante;
+            if (!s->tete)
+                s->queue = NULL;
+        }
+        pthread_mutex_unlock(&s->verrou);
+
+        if (!atomic_load(&rq->cnx->rompue))
+        {
+            init_genrand(rq->req.graine + indice);
+            mpz_set_ui(nbFemale, rq->req.nb_femelles);
+            mpz_set_ui(nbMale, rq->req.nb_males);
+            if (pop)
+                reinitialiser_population(pop, rq->params, nbFemale, nbMale);
+            else
+                pop = initialize_population(rq->params, nbFemale, nbMale);
+            for (uint32_t m = 0; m < rq->req.mois; m++)
+                simulate_month(pop);
+
+            population_totaux(pop, bebes, males, femelles);
+            reponse_demon rep = {rq->req.identifiant, indice, DEMON_OK, 0, mpz_get_d(bebes), mpz_get_d(males),
+                                 mpz_get_d(femelles), 0};
+            rep.total = rep.bebes + rep.males + rep.femelles;
+            repondre(rq->cnx, &rep);
+            atomic_fetch_add(&s->nb_replications, 1);
+        }
+
+        if (atomic_fetch_sub(&rq->restantes, 1) == 1)
+        {
+            terminer(rq->cnx, rq->req.identifiant, DEMON_OK);
+            rendre_params(s, rq);
+            connexion_rendre(rq->cnx);
+            free(rq);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Vérifie les bornes d'une requête
+ */
+static int requete_valide(const requete_demon *req)
+{
+    return req->magique == DEMON_MAGIQUE && req->mois <= DEMON_MOIS_MAX && req->nb_replications >= 1 &&
+           req->nb_replications <= DEMON_REPLICATIONS_MAX && req->nb_femelles <= DEMON_EFFECTIF_MAX &&
+           req->nb_males <= DEMON_EFFECTIF_MAX;
+}
+
+/**
+ * @brief Thread de lecture: met en file les requêtes d'une connexion jusqu'à sa fermeture
+ */
+static void *thread_lecteur(void *arg)
+{
+    lecteur *l = arg;
+    serveur *s = l->s;
+    connexion *cnx = l->cnx;
+    free(l);
+
+    requete_demon req;
+    while (lire_complet(cnx->fd, &req, sizeof(req)) == 0)
+    {
+        atomic_fetch_add(&s->nb_requetes, 1);
+        if (!requete_valide(&req))
+        {
+            // Flux désynchronisé ou client d'une autre version: la connexion est abandonnée
+            terminer(cnx, req.identifiant, DEMON_REQUETE_INVALIDE);
+            if (req.magique != DEMON_MAGIQUE)
+                break;
+            continue;
+        }
+
+        requete_en_cours *rq = malloc(sizeof(requete_en_cours));
+        rq->req = req;
+        rq->cnx = cnx;
+        rq->params = s->nominal;
+        rq->entree_cache = -1;
+        rq->prochaine = 0;
+        rq->suivante = NULL;
+        atomic_init(&rq->restantes, req.nb_replications);
+
+        pthread_mutex_lock(&s->verrou);
+        if (req.options & DEMON_VALEURS)
+            rq->params = obtenir_params(s, &req.valeurs, &rq->entree_cache);
+        if (!rq->params)
+        {
+            pthread_mutex_unlock(&s->verrou);
+            terminer(cnx, req.identifiant, DEMON_PARAMS_INVALIDES);
+            free(rq);
+            continue;
+        }
+        atomic_fetch_add(&cnx->references, 1);
+        if (s->queue)
+            s->queue->suivante = rq;
+        else
+            s->tete = rq;
+        s->queue = rq;
+        pthread_cond_broadcast(&s->travail);
+        pthread_mutex_unlock(&s->verrou);
+    }
+    connexion_rendre(cnx);
+    return NULL;
+}
+
+/**
+ * @brief Thread des signaux: attend SIGINT ou SIGTERM et interrompt l'attente des connexions
+ */
+static void *thread_signaux(void *arg)
+{
+    int ecoute = *(int *)arg;
+    sigset_t signaux;
+    sigemptyset(&signaux);
+    sigaddset(&signaux, SIGINT);
+    sigaddset(&signaux, SIGTERM);
+    int signal_recu;
+    sigwait(&signaux, &signal_recu);
+    shutdown(ecoute, SHUT_RDWR);
+    return NULL;
+}
+
+/**
+ * @brief Lance le démon et traite les requêtes jusqu'à SIGINT ou SIGTERM
+ *
+ * @param opt Réglages
+ * @return 0 après un arrêt demandé, -1 si le démon n'a pas pu démarrer (message sur stderr)
+ */
+int serveur_lancer(const options_serveur *opt)
+{
+    struct sockaddr_un adresse;
+    if (adresse_unix(&adresse, opt->chemin) != 0)
+    {
+        fprintf(stderr, "Erreur : chemin de socket trop long : %s\n", opt->chemin);
+        return -1;
+    }
+    int actif = serveur_connecter(opt->chemin);
+    if (actif >= 0)
+    {
+        close(actif);
+        fprintf(stderr, "Erreur : un démon écoute déjà sur %s\n", opt->chemin);
+        return -1;
+    }
+    // Socket orphelin d'un démon arrêté brutalement: seul un socket est supprimé
+    struct stat st;
+    if (lstat(opt->chemin, &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+        {
+            fprintf(stderr, "Erreur : %s existe et n'est pas un socket\n", opt->chemin);
+            return -1;
+        }
+        unlink(opt->chemin);
+    }
+
+    int ecoute = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (ecoute < 0 || bind(ecoute, (struct sockaddr *)&adresse, sizeof(adresse)) != 0 || listen(ecoute, 64) != 0)
+    {
+        fprintf(stderr, "Erreur : impossible d'écouter sur %s : %s\n", opt->chemin, strerror(errno));
+        if (ecoute >= 0)
+            close(ecoute);
+        return -1;
+    }
+
+    // Signaux d'arrêt bloqués dans tous les threads, reçus par thread_signaux
+    sigset_t signaux;
+    sigemptyset(&signaux);
+    sigaddset(&signaux, SIGINT);
+    sigaddset(&signaux, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signaux, NULL);
+
+    serveur *s = calloc(1, sizeof(serveur));
+    s->nominal = opt->nominal;
+    pthread_mutex_init(&s->verrou, NULL);
+    pthread_cond_init(&s->travail, NULL);
+    atomic_init(&s->nb_requetes, 0);
+    atomic_init(&s->nb_replications, 0);
+
+    int nb_threads = (opt->nb_threads > 0) ? opt->nb_threads : nb_threads_defaut();
+    pthread_t thread;
+    for (int t = 0; t < nb_threads; t++)
+    {
+        pthread_create(&thread, NULL, thread_calcul, s);
+        pthread_detach(thread);
+    }
+    pthread_t signaux_thread;
+    pthread_create(&signaux_thread, NULL, thread_signaux, &ecoute);
+    fprintf(stderr, "Démon prêt sur %s (%d threads de calcul)\n", opt->chemin, nb_threads);
+
+    for (;;)
+    {
+        int fd = accept(ecoute, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break; // Socket d'écoute fermé par thread_signaux, ou erreur
+        }
+        connexion *cnx = malloc(sizeof(connexion));
+        cnx->fd = fd;
+        pthread_mutex_init(&cnx->ecriture, NULL);
+        atomic_init(&cnx->references, 1);
+        atomic_init(&cnx->rompue, 0);
+        lecteur *l = malloc(sizeof(lecteur));
+        *l = (lecteur){s, cnx};
+        pthread_create(&thread, NULL, thread_lecteur, l);
+        pthread_detach(thread);
+    }
+
+    pthread_cancel(signaux_thread); // Sans effet après un signal reçu
+    pthread_join(signaux_thread, NULL);
+    close(ecoute);
+    unlink(opt->chemin);
+    fprintf(stderr, "Démon arrêté : %lu requêtes, %lu réplications simulées\n",
+            (unsigned long)atomic_load(&s->nb_requetes), (unsigned long)atomic_load(&s->nb_replications));
+    // Les threads de calcul et les connexions restantes disparaissent avec le processus
+    return 0;
+}
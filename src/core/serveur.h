@@ -0,0 +1,154 @@
+/**
+ * @file serveur.h
+ * @brief Fichier d'en-tête du démon de simulation et de son protocole binaire
+ *
+ * Le démon (bin/demon) écoute sur un socket Unix local et garde tout son
+ * état chaud d'une requête à l'autre: threads de calcul, jeu de paramètres
+ * nominal, jeux de paramètres déjà finalisés (cache par empreinte) et une
+ * population par thread, réinitialisée sans réallouer ses compteurs GMP.
+ * Une requête courte ne paie donc ni le lancement d'un processus, ni le
+ * calcul des tables de transition, ni l'allocation de la grille.
+ *
+ * Protocole (ordre des octets de la machine: le socket est local):
+ * - le client écrit des requete_demon, autant qu'il veut sans attendre
+ *   les réponses (lots)
+ * - pour chaque requête, le démon répond par une reponse_demon par
+ *   réplication, dans l'ordre où elles se terminent (champ indice), puis
+ *   par une reponse_demon d'indice DEMON_FIN qui porte le statut de la
+ *   requête; une requête refusée n'a que cette dernière réponse
+ * - la réplication i d'une requête est la simulation de graine graine + i:
+ *   son résultat est celui de simuler_resultat() pour la même graine
+ */
+
+#ifndef SERVEUR_H
+#define SERVEUR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define DEMON_MAGIQUE 0x3144504cU          // « LPD1 »
+#define DEMON_SOCKET_DEFAUT "/tmp/popsim.sock"
+#define DEMON_VALEURS 1                    // Option: valeurs des paramètres jointes à la requête
+#define DEMON_FIN 0xffffffffU              // Indice de la réponse qui termine une requête
+#define DEMON_MOIS_MAX 1200                // Durée maximale d'une requête (100 ans)
+#define DEMON_REPLICATIONS_MAX 1000000     // Réplications au plus par requête
+#define DEMON_EFFECTIF_MAX 100000000ULL    // Femelles ou mâles au plus au départ
+
+#define DEMON_OK 0                  // Requête traitée
+#define DEMON_REQUETE_INVALIDE (-1) // Requête mal formée ou hors limites
+#define DEMON_PARAMS_INVALIDES (-2) // Valeurs refusées par params_finaliser()
+
+/**
+ * @struct valeurs_demon
+ * @brief Valeurs des paramètres biologiques transmises avec une requête
+ *
+ * Les autres réglages (age_declin, duree_survie_bebe, detail_ages,
+ * planning_portees) sont ceux du jeu nominal du démon.
+ */
+typedef struct valeurs_demon
+{
+    double poids_portees[10];
+    double maturite[NB_MOIS_MATURITE];
+    double survie_adulte[NB_TRANCHES_SURVIE];
+    double survie_bebe;
+    double proba_male;
+} valeurs_demon;
+
+/**
+ * @struct requete_demon
+ * @brief Requête: réplications d'un scénario
+ */
+typedef struct requete_demon
+{
+    uint32_t magique;         // DEMON_MAGIQUE
+    uint32_t identifiant;     // Choisi par le client, recopié dans chaque réponse
+    uint32_t options;         // DEMON_VALEURS ou 0 (paramètres nominaux du démon)
+    uint32_t mois;            // Durée de chaque simulation (0 à DEMON_MOIS_MAX)
+    uint64_t graine;          // Graine de la réplication 0 (réplication i: graine + i)
+    uint64_t nb_femelles;     // Femelles au départ
+    uint64_t nb_males;        // Mâles au départ
+    uint32_t nb_replications; // Réplications (1 à DEMON_REPLICATIONS_MAX)
+    uint32_t reserve;         // Zéro
+    valeurs_demon valeurs;    // Lues seulement avec DEMON_VALEURS
+} requete_demon;
+
+/**
+ * @struct reponse_demon
+ * @brief Réponse: population finale d'une réplication, ou fin de requête
+ */
+typedef struct reponse_demon
+{
+    uint32_t identifiant; // Identifiant de la requête
+    uint32_t indice;      // Indice de la réplication, DEMON_FIN pour la dernière réponse
+    int32_t statut;       // DEMON_OK ou code d'erreur (réponse DEMON_FIN seulement)
+    uint32_t reserve;     // Zéro
+    double bebes;         // Bébés en fin de simulation
+    double males;         // Mâles adultes
+    double femelles;      // Femelles adultes
+    double total;         // Population totale
+} reponse_demon;
+
+_Static_assert(sizeof(valeurs_demon) == 30 * sizeof(double), "valeurs_demon doit rester compacte");
+_Static_assert(sizeof(requete_demon) == 48 + sizeof(valeurs_demon), "taille de requete_demon");
+_Static_assert(sizeof(reponse_demon) == 48, "taille de reponse_demon");
+
+/**
+ * @struct options_serveur
+ * @brief Réglages du démon
+ */
+typedef struct options_serveur
+{
+    const char *chemin;      // Chemin du socket Unix
+    const params_t *nominal; // Paramètres des requêtes sans DEMON_VALEURS
+    int nb_threads;          // Threads de calcul (0: nombre de cœurs)
+} options_serveur;
+
+/**
+ * @brief Lance le démon et traite les requêtes jusqu'à SIGINT ou SIGTERM
+ *
+ * Refuse de démarrer si un autre démon écoute déjà sur le chemin; un
+ * socket orphelin (démon arrêté brutalement) est remplacé, un fichier
+ * d'un autre type au même chemin fait échouer le démarrage. Le socket est
+ * supprimé à l'arrêt, les requêtes en cours sont abandonnées.
+ *
+ * @param opt Réglages
+ * @return 0 après un arrêt demandé, -1 si le démon n'a pas pu démarrer (message sur stderr)
+ */
+int serveur_lancer(const options_serveur *opt);
+
+/**
+ * @brief Se connecte au démon
+ * @param chemin Chemin du socket Unix
+ * @return Descripteur du socket, -1 en cas d'échec
+ */
+int serveur_connecter(const char *chemin);
+
+/**
+ * @brief Lit exactement taille octets d'un descripteur
+ *
+ * @param fd Descripteur
+ * @param tampon Destination
+ * @param taille Nombre d'octets
+ * @return 0, -1 en cas d'erreur ou de fin de flux
+ */
+int lire_complet(int fd, void *tampon, size_t taille);
+
+/**
+ * @brief Écrit exactement taille octets sur un socket
+ *
+ * @param fd Descripteur du socket
+ * @param tampon Source
+ * @param taille Nombre d'octets
+ * @return 0, -1 en cas d'erreur (pair déconnecté)
+ */
+int ecrire_complet(int fd, const void *tampon, size_t taille);
+
+/**
+ * @brief Recopie les valeurs d'un jeu de paramètres dans une requête
+ * @param params Jeu de paramètres
+ * @param valeurs Valeurs à remplir
+ */
+void valeurs_depuis_params(const params_t *params, valeurs_demon *valeurs);
+
+#endif // SERVEUR_H
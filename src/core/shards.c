@@ -0,0 +1,277 @@
+/**
+ * @file shards.c
+ * @brief Implémentation de l'exécution multi-processus des réplications
+ *
+ * Organisation de la mémoire partagée (mmap anonyme partagé):
+ * - une case par tâche: indicateur « terminée » et résultat
+ * - un anneau par shard: le fils y publie l'indice de chaque tâche terminée,
+ *   le parent le consomme au fil de l'eau et fusionne le résultat
+ *
+ * Chaque anneau n'a qu'un producteur (le fils du shard) et un consommateur
+ * (le parent). Si un fils meurt, le parent relance le shard sur la même
+ * plage: les tâches déjà terminées sont sautées, les autres recalculées.
+ */
+
+#define _DEFAULT_SOURCE // usleep, MAP_ANONYMOUS
+
+#include "shards.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TAILLE_ANNEAU 64 // Nombre d'entrées de chaque anneau
+
+/**
+ * @brief Case de résultat d'une tâche en mémoire partagée
+ */
+typedef struct case_tache
+{
+    atomic_int terminee;     // 1 quand res est écrit
+    resultat_simulation res; // Résultat de la tâche
+} case_tache;
+
+/**
+ * @brief Anneau de publication des tâches terminées d'un shard
+ */
+typedef struct anneau
+{
+    atomic_long ecrit;          // Nombre d'entrées publiées par le fils
+    atomic_long lu;             // Nombre d'entrées consommées par le parent
+    long taches[TAILLE_ANNEAU]; // Indices des tâches terminées
+} anneau;
+
+/**
+ * @brief Remet un accumulateur à zéro
+ *
+ * @param acc Accumulateur à initialiser
+ */
+void accumulateur_init(accumulateur *acc)
+{
+    acc->n = 0;
+    acc->somme = 0;
+    acc->somme_carres = 0;
+    acc->min = INFINITY;
+    acc->max = -INFINITY;
+}
+
+/**
+ * @brief Ajoute un résultat à un accumulateur
+ *
+ * @param acc Accumulateur
+ * @param total Population finale totale
+ */
+void accumulateur_ajouter(accumulateur *acc, double total)
+{
+    acc->n++;
+    acc->somme += total;
+    acc->somme_carres += total * total;
+    if (total < acc->min)
+        acc->min = total;
+    if (total > acc->max)
+        acc->max = total;
+}
+
+/**
+ * @brief Fusionne un accumulateur dans un autre
+ *
+ * @param acc Accumulateur destination
+ * @param autre Accumulateur à ajouter
+ */
+void accumulateur_fusionner(accumulateur *acc, const accumulateur *autre)
+{
+    acc->n += autre->n;
+    acc->somme += autre->somme;
+    acc->somme_carres += autre->somme_carres;
+    if (autre->min < acc->min)
+        acc->min = autre->min;
+    if (autre->max > acc->max)
+        acc->max = autre->max;
+}
+
+/**
+ * @brief Corps d'un processus fils: calcule les tâches non terminées de sa plage
+ */
+static void executer_plage(long debut, long fin, fonction_tache tache, void *contexte,
+                           case_tache *cases, anneau *an)
+{
+    for (long t = debut; t < fin; t++)
+    {
+        if (atomic_load_explicit(&cases[t].terminee, memory_order_acquire))
+            continue; // Déjà calculée avant une relance
+
+        tache(t, contexte, &cases[t].res);
+        atomic_store_explicit(&cases[t].terminee, 1, memory_order_release);
+
+        // Publication dans l'anneau (attente si le parent est en retard)
+        long e = atomic_load_explicit(&an->ecrit, memory_order_relaxed);
+        while (e - atomic_load_explicit(&an->lu, memory_order_acquire) >= TAILLE_ANNEAU)
+            usleep(100);
+        an->taches[e % TAILLE_ANNEAU] = t;
+        atomic_store_explicit(&an->ecrit, e + 1, memory_order_release);
+    }
+}
+
+/**
+ * @brief Lance le processus fils d'un shard
+ *
+ * @return PID du fils, -1 en cas d'échec
+ */
+static pid_t lancer_shard(long debut, long fin, fonction_tache tache, void *contexte,
+                          case_tache *cases, anneau *an)
+{
+    fflush(stdout); // Évite que le fils réécrive le tampon du parent
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        executer_plage(debut, fin, tache, contexte, cases, an);
+        _exit(0);
+    }
+    return pid;
+}
+
+/**
+ * @brief Fusionne le résultat d'une tâche s'il ne l'a pas déjà été
+ */
+static void fusionner_tache(long t, case_tache *cases, char *fusionnee,
+                            resultat_simulation *resultats, accumulateur *acc)
+{
+    if (fusionnee[t])
+        return;
+    resultats[t] = cases[t].res;
+    if (acc)
+        accumulateur_ajouter(acc, cases[t].res.total);
+    fusionnee[t] = 1;
+}
+
+/**
+ * @brief Consomme les entrées publiées dans l'anneau d'un shard
+ */
+static void vider_anneau(anneau *an, case_tache *cases, char *fusionnee,
+                         resultat_simulation *resultats, accumulateur *acc)
+{
+    long l = atomic_load_explicit(&an->lu, memory_order_relaxed);
+    long e = atomic_load_explicit(&an->ecrit, memory_order_acquire);
+    for (; l < e; l++)
+    {
+        fusionner_tache(an->taches[l % TAILLE_ANNEAU], cases, fusionnee, resultats, acc);
+    }
+    atomic_store_explicit(&an->lu, l, memory_order_release);
+}
+
+/**
+ * @brief Exécute des tâches dans des processus fils et fusionne leurs résultats
+ *
+ * Les tâches sont découpées en nb_processus plages contiguës. Le parent
+ * consomme les anneaux pendant que les fils calculent, et relance (au plus
+ * max_relances fois) un shard dont le fils s'est terminé anormalement.
+ *
+ * @param nb_taches Nombre de tâches (indices 0 à nb_taches - 1)
+ * @param nb_processus Nombre de processus fils
+ * @param max_relances Nombre maximal de relances d'un même shard
+ * @param tache Fonction calculant une tâche
+ * @param contexte Données passées à la fonction
+ * @param resultats Tableau de nb_taches résultats à remplir
+ * @param acc Accumulateur où fusionner les résultats (peut être NULL)
+ * @return Nombre de tâches non terminées (0 en cas de succès, -1 si erreur système)
+ */
+long executer_shards(long nb_taches, int nb_processus, int max_relances, fonction_tache tache,
+                     void *contexte, resultat_simulation *resultats, accumulateur *acc)
+{
+    if (nb_taches <= 0)
+        return 0;
+    if (nb_processus > nb_taches)
+        nb_processus = (int)nb_taches;
+    if (nb_processus < 1)
+        nb_processus = 1;
+
+    // Zone partagée: cases des tâches puis anneaux des shards
+    size_t taille = nb_taches * sizeof(case_tache) + nb_processus * sizeof(anneau);
+    void *zone = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (zone == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+    case_tache *cases = zone;
+    anneau *anneaux = (anneau *)(cases + nb_taches);
+
+    char *fusionnee = calloc(nb_taches, 1);
+    pid_t *pids = malloc(nb_processus * sizeof(pid_t));
+    int *relances = calloc(nb_processus, sizeof(int));
+    long *debuts = malloc((nb_processus + 1) * sizeof(long));
+    for (int s = 0; s <= nb_processus; s++)
+        debuts[s] = nb_taches * s / nb_processus;
+
+    // Lancement des shards
+    int actifs = 0;
+    for (int s = 0; s < nb_processus; s++)
+    {
+        pids[s] = lancer_shard(debuts[s], debuts[s + 1], tache, contexte, cases, &anneaux[s]);
+        if (pids[s] > 0)
+            actifs++;
+    }
+
+    // Fusion au fil de l'eau et surveillance des fils
+    while (actifs > 0)
+    {
+        for (int s = 0; s < nb_processus; s++)
+            vider_anneau(&anneaux[s], cases, fusionnee, resultats, acc);
+
+        // Seuls les shards sont attendus: les autres fils du processus (gnuplot,
+        // fils d'un programme qui embarque la bibliothèque) gardent leur statut
+        int termine = 0;
+        for (int s = 0; s < nb_processus; s++)
+        {
+            if (pids[s] <= 0)
+                continue;
+            int statut = -1;
+            pid_t pid = waitpid(pids[s], &statut, WNOHANG);
+            if (pid == 0)
+                continue;
+            // pid < 0: fils déjà récolté ailleurs, statut inconnu, traité comme un échec
+            termine = 1;
+            pids[s] = -1;
+            actifs--;
+            if (pid > 0 && WIFEXITED(statut) && WEXITSTATUS(statut) == 0)
+                continue;
+
+            if (relances[s] < max_relances)
+            {
+                fprintf(stderr, "Shard %d interrompu (statut %d), relance %d/%d\n",
+                        s, statut, relances[s] + 1, max_relances);
+                relances[s]++;
+                pids[s] = lancer_shard(debuts[s], debuts[s + 1], tache, contexte, cases, &anneaux[s]);
+                if (pids[s] > 0)
+                    actifs++;
+            }
+            else
+            {
+                fprintf(stderr, "Shard %d abandonné après %d relances\n", s, max_relances);
+            }
+        }
+        if (!termine)
+            usleep(1000);
+    }
+
+    // Dernières entrées, et tâches terminées par un fils mort avant publication
+    long non_terminees = 0;
+    for (int s = 0; s < nb_processus; s++)
+        vider_anneau(&anneaux[s], cases, fusionnee, resultats, acc);
+    for (long t = 0; t < nb_taches; t++)
+    {
+        if (atomic_load(&cases[t].terminee))
+            fusionner_tache(t, cases, fusionnee, resultats, acc);
+        else
+            non_terminees++;
+    }
+
+    free(fusionnee);
+    free(pids);
+    free(relances);
+    free(debuts);
+    munmap(zone, taille);
+
+    return non_terminees;
+}
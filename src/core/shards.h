@@ -0,0 +1,71 @@
+/**
+ * @file shards.h
+ * @brief Fichier d'en-tête pour l'exécution multi-processus des réplications
+ *
+ * Ce fichier déclare le mode « shards »: les réplications sont réparties
+ * par plages entre des processus fils (fork), qui écrivent leurs résultats
+ * en mémoire partagée. Chaque processus a son propre tas GMP et le plantage
+ * d'un fils ne fait pas échouer l'étude: sa plage est relancée.
+ */
+
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include "replication.h"
+
+/**
+ * @brief Calcule le résultat d'une tâche (exécuté dans un processus fils)
+ * @param tache Indice de la tâche
+ * @param contexte Données de l'appelant
+ * @param res Structure où stocker le résultat
+ */
+typedef void (*fonction_tache)(long tache, void *contexte, resultat_simulation *res);
+
+/**
+ * @struct accumulateur
+ * @brief Statistiques cumulées de la population finale totale
+ */
+typedef struct accumulateur
+{
+    long n;              // Nombre de résultats cumulés
+    double somme;        // Somme des totaux
+    double somme_carres; // Somme des carrés des totaux
+    double min;          // Total minimal
+    double max;          // Total maximal
+} accumulateur;
+
+/**
+ * @brief Remet un accumulateur à zéro
+ * @param acc Accumulateur à initialiser
+ */
+void accumulateur_init(accumulateur *acc);
+
+/**
+ * @brief Ajoute un résultat à un accumulateur
+ * @param acc Accumulateur
+ * @param total Population finale totale
+ */
+void accumulateur_ajouter(accumulateur *acc, double total);
+
+/**
+ * @brief Fusionne un accumulateur dans un autre
+ * @param acc Accumulateur destination
+ * @param autre Accumulateur à ajouter
+ */
+void accumulateur_fusionner(accumulateur *acc, const accumulateur *autre);
+
+/**
+ * @brief Exécute des tâches dans des processus fils et fusionne leurs résultats
+ * @param nb_taches Nombre de tâches (indices 0 à nb_taches - 1)
+ * @param nb_processus Nombre de processus fils
+ * @param max_relances Nombre maximal de relances d'un même shard
+ * @param tache Fonction calculant une tâche
+ * @param contexte Données passées à la fonction
+ * @param resultats Tableau de nb_taches résultats à remplir
+ * @param acc Accumulateur où fusionner les résultats (peut être NULL)
+ * @return Nombre de tâches non terminées (0 en cas de succès, -1 si erreur système)
+ */
+long executer_shards(long nb_taches, int nb_processus, int max_relances, fonction_tache tache,
+                     void *contexte, resultat_simulation *resultats, accumulateur *acc);
+
+#endif // SHARDS_H
@@ -33,7 +33,7 @@ void simulate_month(population *pop)
     aging(pop);
 
     // Étape 3: Ajout des nouveaux-nés
-    mpz_set(pop->lapins_par_age[0][0].nb_babies, new_babies);
+    population_naissances(pop, new_babies);
 
     mpz_clear(new_babies);
 }
@@ -60,15 +60,16 @@ void simulate_year(population *pop)
  * sur le nombre d'années spécifié. Affiche les statistiques
  * à la fin de chaque année.
  *
+ * @param params Jeu de paramètres biologiques
  * @param nbFemale Nombre initial de femelles
  * @param nbMale Nombre initial de mâles
  * @param years Nombre d'années à simuler
  * @return Pointeur vers la population finale
  */
-population *simulate_population(mpz_t nbFemale, mpz_t nbMale, int years)
+population *simulate_population(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years)
 {
     // Initialisation de la population de départ
-    population *pop = initialize_population(nbFemale, nbMale);
+    population *pop = initialize_population(params, nbFemale, nbMale);
 
     // Simulation année par année
     for (int y = 0; y < years; y++)
@@ -17,8 +17,11 @@
 #define AGE_MAX 16   // Âge maximum des lapins en années
 #define NB_MONTHS 12 // Nombre de mois dans une année
 
-// Tableau de probabilités pour le nombre de portées par an
-extern double prob_litter[10];
+// Jeu de paramètres biologiques (défini dans config.h)
+typedef struct params_t params_t;
+
+// Planning des mises bas (défini dans planning.h)
+typedef struct planning planning;
 
 /**
  * @struct mois_lapin
@@ -31,19 +34,44 @@ typedef struct mois_lapin
     mpz_t femelles_par_accouchements_restants[10]; // Femelles groupées par nombre d'accouchements restants
 } mois_lapin;
 
+/**
+ * @struct totaux_population
+ * @brief Totaux de la grille, tenus à jour par le moteur
+ *
+ * Les lignes 0 à AGE_MAX - 1 sont comptées (la ligne AGE_MAX reste vide).
+ */
+typedef struct totaux_population
+{
+    mpz_t bebes;            // Bébés (non-matures)
+    mpz_t males;            // Mâles adultes
+    mpz_t femelles[10];     // Femelles par nombre d'accouchements restants
+    mpz_t par_age[AGE_MAX]; // Effectif de chaque ligne d'âge (bébés, mâles et femelles)
+} totaux_population;
+
 /**
  * @struct population
  * @brief Représente l'ensemble de la population de lapins
+ *
+ * Les âges adultes de même dynamique (1 à age_classe, voir config.h) sont
+ * regroupés en une classe rangée à l'âge 1; les lignes 2 à age_classe
+ * restent vides. La composition par âge de chaque classe mensuelle est
+ * connue à un instant antérieur: comme ses membres vivent et se reproduisent
+ * de la même façon quel que soit leur âge, les survivants se répartissent
+ * par âge selon une loi hypergéométrique.
  */
 typedef struct population
 {
     mois_lapin lapins_par_age[AGE_MAX + 1][NB_MONTHS]; // Population organisée par âge et mois
+    const params_t *params;                            // Paramètres biologiques de la simulation
+    mpz_t composition_males[NB_MONTHS][AGE_MAX];       // Classe adulte: mâles par âge (dernier décompte)
+    mpz_t composition_femelles[NB_MONTHS][AGE_MAX];    // Classe adulte: femelles par âge (dernier décompte)
+    planning *planning;                                // Mises bas planifiées (NULL hors mode planning)
+    totaux_population totaux;                          // Totaux de la grille (lecture en temps constant)
 } population;
 
 // Déclarations de fonctions
-void init_prob_litter();
-int litter_per_year();
-population *simulate_population(mpz_t nbFemale, mpz_t nbMale, int years);
-void init_survival_rate();
+void simulate_month(population *pop);
+void simulate_year(population *pop);
+population *simulate_population(const params_t *params, mpz_t nbFemale, mpz_t nbMale, int years);
 
 #endif
\ No newline at end of file
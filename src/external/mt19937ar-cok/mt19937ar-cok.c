@@ -56,8 +56,10 @@
 #define UPPER_MASK 0x80000000UL /* most significant w-r bits */
 #define LOWER_MASK 0x7fffffffUL /* least significant r bits */
 
-static unsigned long mt[N]; /* the array for the state vector  */
-static int mti = N + 1;     /* mti==N+1 means mt[N] is not initialized */
+/* État propre à chaque thread: les réplications parallèles ont chacune leur flux */
+static _Thread_local unsigned long mt[N]; /* the array for the state vector  */
+static _Thread_local int mti = N + 1;     /* mti==N+1 means mt[N] is not initialized */
+static _Thread_local int antithetic = 0;  /* 1: les sorties sont remplacées par 0xffffffff - y */
 
 /* initializes mt[N] with a seed */
 void init_genrand(unsigned long s)
@@ -154,9 +156,35 @@ unsigned long genrand_int32(void)
     y ^= (y << 15) & 0xefc60000UL;
     y ^= (y >> 18);
 
+    /* Flux antithétique : u -> 1 - u pour tous les tirages uniformes */
+    if (antithetic)
+        y = 0xffffffffUL - y;
+
     return y;
 }
 
+/* copie l'état du générateur du thread courant */
+void lire_etat_genrand(etat_genrand *etat)
+{
+    for (int i = 0; i < N; i++)
+        etat->mt[i] = mt[i];
+    etat->mti = mti;
+}
+
+/* remplace l'état du générateur du thread courant */
+void ecrire_etat_genrand(const etat_genrand *etat)
+{
+    for (int i = 0; i < N; i++)
+        mt[i] = etat->mt[i];
+    mti = etat->mti;
+}
+
+/* active (1) ou désactive (0) le flux antithétique */
+void set_antithetic(int enabled)
+{
+    antithetic = enabled ? 1 : 0;
+}
+
 /* generates a random number on [0,0x7fffffff]-interval */
 long genrand_int31(void)
 {
@@ -196,13 +224,18 @@ int uniform_int(int a, int b)
     return a + (int)(genrand_real1() * (b - a + 1));
 }
 
+/* Flux antithétique : u -> 1 - u laisse cos(2 pi u2) inchangé et ne change pas
+   -2 ln(u1) en son symétrique ; l'écart est donc tiré sur le flux direct puis opposé */
 double normal_centree_reduite()
 {
-
+    int oppose = antithetic;
+    antithetic = 0;
     double u1 = genrand_real1();
     double u2 = genrand_real1();
+    antithetic = oppose;
 
-    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    return oppose ? -z : z;
 }
 
 void normal(mpfr_t result, mpfr_t mean, mpfr_t sd)
@@ -243,7 +276,7 @@ void binomial_gaussian(mpz_t result, mpz_t n, double p)
         mpfr_set(x, n_mpfr, MPFR_RNDN);
 
     mpfr_add_d(x, x, 0.5, MPFR_RNDN); // pour arrondi
-    mpfr_get_z(result, x, MPFR_RNDN);
+    mpfr_get_z(result, x, MPFR_RNDD);
 
     // Libération mémoire
     mpfr_clear(mean);
@@ -253,140 +286,81 @@ void binomial_gaussian(mpz_t result, mpz_t n, double p)
     mpfr_clear(n_mpfr);
 }
 
-mpz_t *multinomial_gaussian(mpz_t tEchantillon, double probs_cumul[], int nbCategories)
+/* nombre de succès parmi n tirages sans remise dans une urne de total boules
+   dont succes gagnantes (approximation gaussienne de la loi hypergéométrique) */
+void hypergeometric_gaussian(mpz_t result, mpz_t total, mpz_t succes, mpz_t n)
 {
-    mpz_t *counts = malloc(sizeof(mpz_t) * nbCategories);
-    mpz_t total;
-    mpz_init_set_ui(total, 0);
+    mpfr_t mean, sd, x, tmp, zero;
+    mpfr_inits(mean, sd, tmp, NULL);
+    mpfr_init_set_ui(zero, 0, MPFR_RNDN);
 
-    // Première catégorie
-    double p0 = probs_cumul[0];
+    // mean = n * succes / total
+    mpfr_set_z(mean, n, MPFR_RNDN);
+    mpfr_mul_z(mean, mean, succes, MPFR_RNDN);
+    mpfr_div_z(mean, mean, total, MPFR_RNDN);
+
+    // sd = sqrt(mean * (1 - succes/total) * (total - n) / (total - 1))
+    mpfr_set_z(sd, succes, MPFR_RNDN);
+    mpfr_div_z(sd, sd, total, MPFR_RNDN);
+    mpfr_ui_sub(sd, 1, sd, MPFR_RNDN);
+    mpfr_mul(sd, sd, mean, MPFR_RNDN);
+    mpfr_set_z(tmp, total, MPFR_RNDN);
+    mpfr_sub_z(tmp, tmp, n, MPFR_RNDN);
+    mpfr_mul(sd, sd, tmp, MPFR_RNDN);
+    mpfr_set_z(tmp, total, MPFR_RNDN);
+    mpfr_sub_ui(tmp, tmp, 1, MPFR_RNDN);
+    if (mpfr_cmp(tmp, zero) > 0)
+        mpfr_div(sd, sd, tmp, MPFR_RNDN);
+    if (mpfr_cmp(sd, zero) < 0)
+        mpfr_set(sd, zero, MPFR_RNDN);
+    mpfr_sqrt(sd, sd, MPFR_RNDN);
 
-    mpfr_t mean, variance, sd, p_val, one_minus_p, temp;
-    mpfr_init(mean);
-    mpfr_init(variance);
-    mpfr_init(sd);
-    mpfr_init(p_val);
-    mpfr_init(one_minus_p);
-    mpfr_init(temp);
-
-    // mean = tEchantillon * p0
-    mpfr_set_z(mean, tEchantillon, MPFR_RNDN);
-    mpfr_mul_d(mean, mean, p0, MPFR_RNDN);
-
-    // variance = tEchantillon * p0 * (1.0 - p0)
-    mpfr_set_d(p_val, p0, MPFR_RNDN);
-    mpfr_set_ui(one_minus_p, 1, MPFR_RNDN);
-    mpfr_sub(one_minus_p, one_minus_p, p_val, MPFR_RNDN);
-    mpfr_set_z(variance, tEchantillon, MPFR_RNDN);
-    mpfr_mul(variance, variance, p_val, MPFR_RNDN);
-    mpfr_mul(variance, variance, one_minus_p, MPFR_RNDN);
-    mpfr_sqrt(sd, variance, MPFR_RNDN);
-
-    // Tirage gaussien
-    mpfr_t x;
-    mpfr_init(x);
+    // tirage gaussien
     normal(x, mean, sd);
+    mpfr_add_d(x, x, 0.5, MPFR_RNDN); // pour arrondi
+    mpfr_get_z(result, x, MPFR_RNDD);
+
+    // bornes: max(0, n - (total - succes)) <= result <= min(n, succes)
+    mpz_t borne;
+    mpz_init(borne);
+    mpz_sub(borne, total, succes);
+    mpz_sub(borne, n, borne);
+    if (mpz_cmp(result, borne) < 0)
+        mpz_set(result, borne);
+    if (mpz_sgn(result) < 0)
+        mpz_set_ui(result, 0);
+    if (mpz_cmp(result, n) > 0)
+        mpz_set(result, n);
+    if (mpz_cmp(result, succes) > 0)
+        mpz_set(result, succes);
+
+    mpz_clear(borne);
+    mpfr_clears(mean, sd, x, tmp, zero, NULL);
+}
 
-    // Bornes
-    mpfr_t zero, t_mpfr;
-    mpfr_init_set_ui(zero, 0, MPFR_RNDN);
-    mpfr_init_set_z(t_mpfr, tEchantillon, MPFR_RNDN);
+/* loi multinomiale par binomiales conditionnelles successives: la catégorie i
+   prend une binomiale(reste, p_i / (1 - p_0 - ... - p_{i-1})) des individus
+   non encore placés, la dernière prend le reste. La somme vaut tEchantillon
+   sans correction et chaque marginale garde la variance n p_i (1 - p_i) */
+mpz_t *multinomial_gaussian(mpz_t tEchantillon, const double probs_cumul[], int nbCategories)
+{
+    mpz_t *counts = malloc(sizeof(mpz_t) * nbCategories);
+    mpz_t reste;
+    mpz_init_set(reste, tEchantillon);
 
-    if (mpfr_cmp(x, zero) < 0)
-        mpfr_set(x, zero, MPFR_RNDN);
-    if (mpfr_cmp(x, t_mpfr) > 0)
-        mpfr_set(x, t_mpfr, MPFR_RNDN);
-
-    mpfr_add_d(x, x, 0.5, MPFR_RNDN);
-    mpz_init(counts[0]);
-    mpfr_get_z(counts[0], x, MPFR_RNDN);
-    // S'assurer que counts[0] >= 0
-    if (mpz_sgn(counts[0]) < 0)
-        mpz_set_ui(counts[0], 0);
-    mpz_add(total, total, counts[0]);
-
-    // Autres catégories
-    for (int i = 1; i < nbCategories; i++)
+    for (int i = 0; i < nbCategories; i++)
     {
-        double p = probs_cumul[i] - probs_cumul[i - 1];
-
-        // mean = tEchantillon * p
-        mpfr_set_z(mean, tEchantillon, MPFR_RNDN);
-        mpfr_mul_d(mean, mean, p, MPFR_RNDN);
-
-        // variance = tEchantillon * p * (1.0 - p)
-        mpfr_set_d(p_val, p, MPFR_RNDN);
-        mpfr_set_ui(one_minus_p, 1, MPFR_RNDN);
-        mpfr_sub(one_minus_p, one_minus_p, p_val, MPFR_RNDN);
-        mpfr_set_z(variance, tEchantillon, MPFR_RNDN);
-        mpfr_mul(variance, variance, p_val, MPFR_RNDN);
-        mpfr_mul(variance, variance, one_minus_p, MPFR_RNDN);
-        mpfr_sqrt(sd, variance, MPFR_RNDN);
-
-        // Tirage gaussien
-        normal(x, mean, sd);
-
-        if (mpfr_cmp(x, zero) < 0)
-            mpfr_set(x, zero, MPFR_RNDN);
-
-        mpfr_add_d(x, x, 0.5, MPFR_RNDN);
         mpz_init(counts[i]);
-        mpfr_get_z(counts[i], x, MPFR_RNDN);
-        // S'assurer que counts[i] >= 0
-        if (mpz_sgn(counts[i]) < 0)
-            mpz_set_ui(counts[i], 0);
-        mpz_add(total, total, counts[i]);
+        double p = probs_cumul[i] - (i > 0 ? probs_cumul[i - 1] : 0.0);
+        double p_reste = 1.0 - (i > 0 ? probs_cumul[i - 1] : 0.0);
+
+        if (i == nbCategories - 1 || p >= p_reste)
+            mpz_set(counts[i], reste);
+        else if (p > 0 && mpz_sgn(reste) > 0)
+            binomial_gaussian(counts[i], reste, p / p_reste);
+        mpz_sub(reste, reste, counts[i]);
     }
 
-    // Correction pour que la somme = tEchantillon
-    if (mpz_cmp_ui(total, 0) > 0)
-    {
-        mpfr_t factor;
-        mpfr_init(factor);
-        mpfr_set_z(factor, tEchantillon, MPFR_RNDN);
-        mpfr_set_z(temp, total, MPFR_RNDN);
-        mpfr_div(factor, factor, temp, MPFR_RNDN);
-
-        mpz_set_ui(total, 0);
-        for (int i = 0; i < nbCategories; i++)
-        {
-            mpfr_set_z(temp, counts[i], MPFR_RNDN);
-            mpfr_mul(temp, temp, factor, MPFR_RNDN);
-            mpfr_add_d(temp, temp, 0.5, MPFR_RNDN);
-            mpfr_get_z(counts[i], temp, MPFR_RNDN);
-            // S'assurer que counts[i] >= 0 après rescaling
-            if (mpz_sgn(counts[i]) < 0)
-                mpz_set_ui(counts[i], 0);
-            mpz_add(total, total, counts[i]);
-        }
-
-        // Ajustement final si nécessaire
-        mpz_t diff;
-        mpz_init(diff);
-        mpz_sub(diff, tEchantillon, total);
-        if (mpz_cmp_ui(diff, 0) != 0 && nbCategories > 0)
-        {
-            mpz_add(counts[0], counts[0], diff);
-            // S'assurer que counts[0] reste >= 0 après ajustement
-            if (mpz_sgn(counts[0]) < 0)
-                mpz_set_ui(counts[0], 0);
-        }
-        mpz_clear(diff);
-        mpfr_clear(factor);
-    }
-
-    // Libération mémoire
-    mpfr_clear(mean);
-    mpfr_clear(variance);
-    mpfr_clear(sd);
-    mpfr_clear(p_val);
-    mpfr_clear(one_minus_p);
-    mpfr_clear(temp);
-    mpfr_clear(x);
-    mpfr_clear(zero);
-    mpfr_clear(t_mpfr);
-    mpz_clear(total);
-
+    mpz_clear(reste);
     return counts;
-}
\ No newline at end of file
+}
@@ -1,15 +1,37 @@
 #ifndef MT19937AR_COK_H
 #define MT19937AR_COK_H
 
+#include <stdint.h>
 #include <gmp.h>
 #include <mpfr.h>
 
 void init_genrand(unsigned long s);
+void init_by_array(unsigned long init_key[], int key_length);
+void set_antithetic(int enabled);
 unsigned long genrand_int32(void);
 long genrand_int31(void);
 double genrand_real1(void);
 int uniform_int(int a, int b);
+double normal_centree_reduite(void);
+
+/* état complet du générateur du thread courant (sous-flux indépendants) */
+typedef struct etat_genrand
+{
+    unsigned long mt[624];
+    int mti;
+} etat_genrand;
+
+void lire_etat_genrand(etat_genrand *etat);
+void ecrire_etat_genrand(const etat_genrand *etat);
+
+/* épreuve de Bernoulli: 1 avec probabilité seuil / 2^32 */
+static inline int bernoulli_seuil(uint64_t seuil)
+{
+    return genrand_int32() < seuil;
+}
+
 void binomial_gaussian(mpz_t result, mpz_t n, double p);
-mpz_t *multinomial_gaussian(mpz_t tEchantillon, double probs_cumul[], int nbCategories);
+void hypergeometric_gaussian(mpz_t result, mpz_t total, mpz_t succes, mpz_t n);
+mpz_t *multinomial_gaussian(mpz_t tEchantillon, const double probs_cumul[], int nbCategories);
 
 #endif
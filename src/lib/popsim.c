@@ -0,0 +1,318 @@
+/**
+ * @file popsim.c
+ * @brief Implémentation de la bibliothèque libpopsim
+ *
+ * Une simulation regroupe son jeu de paramètres, sa population GMP, l'état
+ * de son flux MT19937 et ses observateurs. Le générateur du moteur étant
+ * propre à chaque thread, popsim_avancer() y installe l'état de la
+ * simulation le temps des mois simulés, puis le sauve et rétablit celui de
+ * l'appelant.
+ */
+
+#include "popsim.h"
+#include "simulation.h"
+#include "config.h"
+#include "population.h"
+#include "mt19937ar-cok.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(POPSIM_AGE_MAX == AGE_MAX, "POPSIM_AGE_MAX doit valoir AGE_MAX");
+_Static_assert(POPSIM_NB_MOIS == NB_MONTHS, "POPSIM_NB_MOIS doit valoir NB_MONTHS");
+
+/**
+ * @struct observateur_enregistre
+ * @brief Observateur et son contexte
+ */
+typedef struct observateur_enregistre
+{
+    popsim_observateur fonction; // Fonction appelée après chaque mois
+    void *contexte;              // Pointeur transmis à chaque appel
+    int identifiant;             // Identifiant retourné à l'enregistrement
+} observateur_enregistre;
+
+/**
+ * @struct popsim
+ * @brief Simulation: paramètres, population, flux et observateurs
+ */
+struct popsim
+{
+    params_t *params;                      // Jeu de paramètres (possédé)
+    population *pop;                       // Population courante
+    etat_genrand flux;                     // État du flux MT19937 entre deux appels
+    int mois;                              // Mois simulés depuis la création
+    observateur_enregistre *observateurs;  // Observateurs, dans l'ordre d'enregistrement (fonction NULL: retiré)
+    int nb_observateurs;                   // Nombre d'observateurs
+    int notification;                      // 1 pendant les appels des observateurs: retraits différés
+    int capacite_observateurs;             // Taille allouée du tableau
+    int prochain_identifiant;              // Identifiant du prochain observateur
+};
+
+/**
+ * @brief Version de l'interface de la bibliothèque chargée
+ *
+ * @return POPSIM_VERSION
+ */
+int popsim_version(void)
+{
+    return POPSIM_VERSION;
+}
+
+/**
+ * @brief Crée une simulation
+ *
+ * @param fichier_params Fichier de paramètres, NULL pour les valeurs par défaut
+ * @param graine Graine du flux MT19937 de la simulation
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param options Combinaison de POPSIM_DETAIL_AGES et POPSIM_PLANNING
+ * @return Simulation, NULL si les paramètres sont invalides
+ */
+popsim *popsim_creer(const char *fichier_params, unsigned long graine, unsigned long nb_femelles,
+                     unsigned long nb_males, int options)
+{
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return NULL;
+    if (options & (POPSIM_DETAIL_AGES | POPSIM_PLANNING))
+    {
+        params->detail_ages |= (options & POPSIM_DETAIL_AGES) != 0;
+        params->planning_portees |= (options & POPSIM_PLANNING) != 0;
+        if (params_finaliser(params) != 0)
+        {
+            params_liberer(params);
+            return NULL;
+        }
+    }
+
+    popsim *sim = calloc(1, sizeof(popsim));
+    sim->params = params;
+    sim->prochain_identifiant = 1;
+
+    // Population initiale tirée dans le flux de la simulation
+    etat_genrand appelant;
+    lire_etat_genrand(&appelant);
+    init_genrand(graine);
+    mpz_t nbFemale, nbMale;
+    mpz_init_set_ui(nbFemale, nb_femelles);
+    mpz_init_set_ui(nbMale, nb_males);
+    sim->pop = initialize_population(params, nbFemale, nbMale);
+    mpz_clears(nbFemale, nbMale, NULL);
+    lire_etat_genrand(&sim->flux);
+    ecrire_etat_genrand(&appelant);
+    return sim;
+}
+
+/**
+ * @brief Supprime du tableau les observateurs retirés, sans changer l'ordre des autres
+ *
+ * @param sim Simulation
+ */
+static void compacter_observateurs(popsim *sim)
+{
+    int n = 0;
+    for (int i = 0; i < sim->nb_observateurs; i++)
+        if (sim->observateurs[i].fonction)
+            sim->observateurs[n++] = sim->observateurs[i];
+    sim->nb_observateurs = n;
+}
+
+/**
+ * @brief Fait avancer la simulation de plusieurs mois
+ *
+ * @param sim Simulation
+ * @param nb_mois Nombre de mois à simuler
+ * @return Nombre de mois simulés
+ */
+int popsim_avancer(popsim *sim, int nb_mois)
+{
+    etat_genrand appelant;
+    lire_etat_genrand(&appelant);
+    ecrire_etat_genrand(&sim->flux);
+
+    int simules = 0;
+    int arret = 0;
+    while (simules < nb_mois && !arret)
+    {
+        simulate_month(sim->pop);
+        sim->mois++;
+        simules++;
+        // Les observateurs ajoutés pendant les appels ne sont appelés qu'à partir du mois suivant
+        int nb = sim->nb_observateurs;
+        sim->notification = 1;
+        for (int i = 0; i < nb; i++)
+            if (sim->observateurs[i].fonction)
+                arret |= sim->observateurs[i].fonction(sim, sim->mois, sim->observateurs[i].contexte) != 0;
+        sim->notification = 0;
+        compacter_observateurs(sim);
+    }
+
+    lire_etat_genrand(&sim->flux);
+    ecrire_etat_genrand(&appelant);
+    return simules;
+}
+
+/**
+ * @brief Nombre de mois simulés depuis la création
+ *
+ * @param sim Simulation
+ * @return Nombre de mois
+ */
+int popsim_mois(const popsim *sim)
+{
+    return sim->mois;
+}
+
+/**
+ * @brief Effectifs de toute la population (totaux tenus par le moteur)
+ *
+ * @param sim Simulation
+ * @param effectifs Effectifs à remplir
+ */
+void popsim_totaux(const popsim *sim, popsim_effectifs *effectifs)
+{
+    const totaux_population *tot = &sim->pop->totaux;
+    effectifs->bebes = mpz_get_d(tot->bebes);
+    effectifs->males = mpz_get_d(tot->males);
+    effectifs->femelles = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        effectifs->femelles_par_portees[i] = mpz_get_d(tot->femelles[i]);
+        effectifs->femelles += effectifs->femelles_par_portees[i];
+    }
+}
+
+/**
+ * @brief Écrit le total exact de la population en décimal
+ *
+ * @param sim Simulation
+ * @param tampon Tampon de destination
+ * @param taille Taille du tampon
+ * @return Nombre de chiffres du total
+ */
+size_t popsim_total_decimal(const popsim *sim, char *tampon, size_t taille)
+{
+    const totaux_population *tot = &sim->pop->totaux;
+    mpz_t total;
+    mpz_init_set(total, tot->bebes);
+    mpz_add(total, total, tot->males);
+    for (int i = 0; i < 10; i++)
+        mpz_add(total, total, tot->femelles[i]);
+
+    char *texte = mpz_get_str(NULL, 10, total);
+    size_t longueur = strlen(texte);
+    if (taille > 0)
+    {
+        size_t copie = (longueur < taille) ? longueur : taille - 1;
+        memcpy(tampon, texte, copie);
+        tampon[copie] = '\0';
+    }
+    free(texte);
+    mpz_clear(total);
+    return longueur;
+}
+
+/**
+ * @brief Effectifs d'une cellule (âge, mois)
+ *
+ * @param sim Simulation
+ * @param age Âge en années
+ * @param mois Mois d'âge
+ * @param effectifs Effectifs à remplir
+ * @return 0, ou -1 si la cellule n'existe pas
+ */
+int popsim_cellule(const popsim *sim, int age, int mois, popsim_effectifs *effectifs)
+{
+    if (age < 0 || age >= AGE_MAX || mois < 0 || mois >= NB_MONTHS)
+        return -1;
+    const mois_lapin *cellule = &sim->pop->lapins_par_age[age][mois];
+    effectifs->bebes = mpz_get_d(cellule->nb_babies);
+    effectifs->males = mpz_get_d(cellule->nb_male);
+    effectifs->femelles = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        effectifs->femelles_par_portees[i] = mpz_get_d(cellule->femelles_par_accouchements_restants[i]);
+        effectifs->femelles += effectifs->femelles_par_portees[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief Dernier âge regroupé dans la ligne d'âge 1
+ *
+ * @param sim Simulation
+ * @return Âge en années, 0 si les âges sont détaillés
+ */
+int popsim_age_classe(const popsim *sim)
+{
+    return sim->params->transitions.age_classe;
+}
+
+/**
+ * @brief Enregistre un observateur appelé après chaque mois
+ *
+ * @param sim Simulation
+ * @param observateur Fonction à appeler
+ * @param contexte Pointeur transmis à chaque appel
+ * @return Identifiant de l'observateur, -1 en cas d'échec
+ */
+int popsim_ajouter_observateur(popsim *sim, popsim_observateur observateur, void *contexte)
+{
+    if (!observateur)
+        return -1;
+    if (sim->nb_observateurs == sim->capacite_observateurs)
+    {
+        int capacite = sim->capacite_observateurs ? 2 * sim->capacite_observateurs : 4;
+        observateur_enregistre *t = realloc(sim->observateurs, capacite * sizeof(observateur_enregistre));
+        if (!t)
+            return -1;
+        sim->observateurs = t;
+        sim->capacite_observateurs = capacite;
+    }
+    observateur_enregistre *o = &sim->observateurs[sim->nb_observateurs++];
+    o->fonction = observateur;
+    o->contexte = contexte;
+    o->identifiant = sim->prochain_identifiant++;
+    return o->identifiant;
+}
+
+/**
+ * @brief Retire un observateur (les suivants gardent leur ordre)
+ *
+ * Pendant les appels des observateurs, l'observateur est seulement marqué
+ * comme retiré: le tableau n'est compacté qu'après le dernier appel du
+ * mois, et aucun autre observateur n'est sauté.
+ *
+ * @param sim Simulation
+ * @param identifiant Identifiant retourné par popsim_ajouter_observateur
+ * @return 0, ou -1 si l'identifiant est inconnu
+ */
+int popsim_retirer_observateur(popsim *sim, int identifiant)
+{
+    for (int i = 0; i < sim->nb_observateurs; i++)
+    {
+        if (sim->observateurs[i].fonction && sim->observateurs[i].identifiant == identifiant)
+        {
+            sim->observateurs[i].fonction = NULL;
+            if (!sim->notification)
+                compacter_observateurs(sim);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Libère une simulation
+ *
+ * @param sim Simulation
+ */
+void popsim_detruire(popsim *sim)
+{
+    if (!sim)
+        return;
+    liberer_population(sim->pop);
+    params_liberer(sim->params);
+    free(sim->observateurs);
+    free(sim);
+}
@@ -0,0 +1,189 @@
+/**
+ * @file popsim.h
+ * @brief Interface C stable de la bibliothèque libpopsim
+ *
+ * libpopsim permet de lancer des simulations dans le processus appelant, sans
+ * passer par les programmes de bin/ ni analyser leur sortie:
+ * - popsim_creer() crée une simulation (paramètres, graine, population initiale)
+ * - popsim_avancer() la fait avancer de N mois
+ * - popsim_totaux(), popsim_total_decimal() et popsim_cellule() lisent la population
+ * - popsim_ajouter_observateur() enregistre une fonction appelée après chaque mois
+ * - popsim_detruire() libère la simulation
+ *
+ * Chaque simulation garde son propre flux MT19937: deux simulations de même
+ * graine avancées du même nombre de mois sont identiques, quel que soit
+ * l'ordre dans lequel elles sont avancées. Des simulations distinctes peuvent
+ * être avancées en même temps par des threads différents; une même simulation
+ * ne doit l'être que par un thread à la fois.
+ *
+ * Seules les fonctions popsim_* sont exportées par libpopsim.so. Leur
+ * comportement ne change qu'avec POPSIM_VERSION.
+ */
+
+#ifndef POPSIM_H
+#define POPSIM_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POPSIM_VERSION 1 // Version de l'interface
+
+#define POPSIM_DETAIL_AGES 1 // Option: un compteur par âge adulte, sans classe regroupée
+#define POPSIM_PLANNING 2    // Option: mois de mise bas tirés à l'attribution des portées
+
+#define POPSIM_AGE_MAX 16 // Nombre de lignes d'âge (0 à 15 ans)
+#define POPSIM_NB_MOIS 12 // Nombre de mois par ligne d'âge
+
+/**
+ * @brief Simulation opaque
+ */
+typedef struct popsim popsim;
+
+/**
+ * @struct popsim_effectifs
+ * @brief Effectifs d'une cellule ou de toute la population
+ */
+typedef struct popsim_effectifs
+{
+    double bebes;                    // Bébés (non matures)
+    double males;                    // Mâles adultes
+    double femelles;                 // Femelles adultes
+    double femelles_par_portees[10]; // Femelles adultes selon leurs portées restantes dans l'année
+} popsim_effectifs;
+
+/**
+ * @brief Fonction appelée après chaque mois simulé
+ *
+ * La simulation peut être lue (popsim_totaux, popsim_cellule...) mais pas
+ * avancée ni détruite depuis l'observateur. L'observateur peut ajouter ou
+ * retirer des observateurs, lui-même compris (voir popsim_avancer).
+ *
+ * @param sim Simulation observée
+ * @param mois Nombre de mois simulés depuis la création
+ * @param contexte Pointeur fourni à l'enregistrement
+ * @return 0 pour continuer, une autre valeur pour arrêter popsim_avancer() après ce mois
+ */
+typedef int (*popsim_observateur)(const popsim *sim, int mois, void *contexte);
+
+/**
+ * @brief Version de l'interface de la bibliothèque chargée
+ * @return POPSIM_VERSION à la compilation de la bibliothèque
+ */
+int popsim_version(void);
+
+/**
+ * @brief Crée une simulation
+ *
+ * Comme bin/exe: les lapins initiaux ont 1 an et chaque femelle reçoit son
+ * nombre de portées de l'année.
+ *
+ * @param fichier_params Fichier de paramètres (format de params/defaut.conf), NULL pour les valeurs par défaut
+ * @param graine Graine du flux MT19937 de la simulation
+ * @param nb_femelles Nombre initial de femelles
+ * @param nb_males Nombre initial de mâles
+ * @param options Combinaison de POPSIM_DETAIL_AGES et POPSIM_PLANNING (0: réglage de bin/exe)
+ * @return Simulation à libérer avec popsim_detruire, NULL si les paramètres sont invalides
+ */
+popsim *popsim_creer(const char *fichier_params, unsigned long graine, unsigned long nb_femelles,
+                     unsigned long nb_males, int options);
+
+/**
+ * @brief Fait avancer la simulation de plusieurs mois
+ *
+ * Les observateurs sont appelés après chaque mois, dans l'ordre de leur
+ * enregistrement. Un observateur retiré pendant ces appels n'est plus appelé,
+ * y compris ce mois-ci s'il n'a pas encore été appelé; tous les autres le
+ * sont. Un observateur ajouté pendant ces appels l'est à partir du mois
+ * suivant. Le flux MT19937 du thread appelant est rétabli au retour.
+ *
+ * @param sim Simulation
+ * @param nb_mois Nombre de mois à simuler
+ * @return Nombre de mois simulés (moins que nb_mois si un observateur a demandé l'arrêt)
+ */
+int popsim_avancer(popsim *sim, int nb_mois);
+
+/**
+ * @brief Nombre de mois simulés depuis la création
+ * @param sim Simulation
+ * @return Nombre de mois
+ */
+int popsim_mois(const popsim *sim);
+
+/**
+ * @brief Effectifs de toute la population (lecture en temps constant)
+ *
+ * Au-delà de 2^53 lapins, les effectifs sont arrondis: popsim_total_decimal()
+ * donne le total exact.
+ *
+ * @param sim Simulation
+ * @param effectifs Effectifs à remplir
+ */
+void popsim_totaux(const popsim *sim, popsim_effectifs *effectifs);
+
+/**
+ * @brief Écrit le total exact de la population en décimal
+ *
+ * Comme snprintf: le texte est tronqué si le tampon est trop petit.
+ *
+ * @param sim Simulation
+ * @param tampon Tampon de destination (peut être NULL si taille vaut 0)
+ * @param taille Taille du tampon
+ * @return Nombre de chiffres du total (sans le zéro final)
+ */
+size_t popsim_total_decimal(const popsim *sim, char *tampon, size_t taille);
+
+/**
+ * @brief Effectifs d'une cellule (âge, mois)
+ *
+ * Quand les âges adultes sont regroupés (voir popsim_age_classe), la ligne
+ * d'âge 1 contient toute la classe adulte et les lignes suivantes de la
+ * classe sont vides.
+ *
+ * @param sim Simulation
+ * @param age Âge en années (0 à POPSIM_AGE_MAX - 1)
+ * @param mois Mois d'âge (0 à POPSIM_NB_MOIS - 1)
+ * @param effectifs Effectifs à remplir
+ * @return 0, ou -1 si la cellule n'existe pas
+ */
+int popsim_cellule(const popsim *sim, int age, int mois, popsim_effectifs *effectifs);
+
+/**
+ * @brief Dernier âge regroupé dans la ligne d'âge 1
+ * @param sim Simulation
+ * @return Âge en années, 0 si les âges sont détaillés
+ */
+int popsim_age_classe(const popsim *sim);
+
+/**
+ * @brief Enregistre un observateur appelé après chaque mois
+ *
+ * @param sim Simulation
+ * @param observateur Fonction à appeler
+ * @param contexte Pointeur transmis à chaque appel
+ * @return Identifiant de l'observateur (positif), -1 en cas d'échec
+ */
+int popsim_ajouter_observateur(popsim *sim, popsim_observateur observateur, void *contexte);
+
+/**
+ * @brief Retire un observateur
+ *
+ * @param sim Simulation
+ * @param identifiant Identifiant retourné par popsim_ajouter_observateur
+ * @return 0, ou -1 si l'identifiant est inconnu
+ */
+int popsim_retirer_observateur(popsim *sim, int identifiant);
+
+/**
+ * @brief Libère une simulation
+ * @param sim Simulation (NULL accepté)
+ */
+void popsim_detruire(popsim *sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POPSIM_H
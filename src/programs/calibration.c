@@ -0,0 +1,840 @@
+/**
+ * @file calibration.c
+ * @brief Calibration bayésienne approchée (ABC-SMC) des paramètres sur des recensements
+ *
+ * Les paramètres biologiques choisis (fichier --priors, lois a priori
+ * uniformes) sont ajustés à une série de recensements (effectif total à
+ * différents mois) par ABC-SMC (Beaumont et al., 2009):
+ * - la génération 0 tire des particules selon les lois a priori
+ * - la génération t propose des particules en perturbant celles de la
+ *   génération t - 1 (noyau gaussien par composante, de variance double
+ *   de la variance pondérée de la génération précédente) et n'accepte que
+ *   celles dont la simulation reste à une distance au plus epsilon_t des
+ *   recensements; une particule acceptée est pondérée par l'inverse de la
+ *   densité de proposition
+ * - epsilon_t est un quantile (--quantile) des distances de la génération
+ *   précédente
+ *
+ * La distance est l'écart quadratique moyen entre les logarithmes des
+ * effectifs simulés et recensés (log(N + 1)). Sa somme partielle ne fait que
+ * croître au fil des recensements: dès qu'elle dépasse le seuil de la
+ * génération, la simulation est arrêtée et la particule rejetée, sans
+ * simuler les mois restants (rejet précoce).
+ *
+ * Les tentatives sont numérotées et simulées par lots de TENTATIVES_PAR_LOT
+ * sur --threads threads; chacune tire sa proposition et son flux MT19937 de
+ * (graine, génération, numéro). Une génération garde les premières
+ * particules acceptées dans l'ordre des numéros: le résultat ne dépend pas
+ * du nombre de threads.
+ *
+ * Sans --observations, les recensements sont simulés avec les paramètres
+ * nominaux (--params): la calibration doit alors retrouver ces valeurs,
+ * affichées en regard de la loi a posteriori.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "population.h"
+#include "replication.h"
+#include "hachage.h"
+#include "mt19937ar-cok.h"
+#include "outils.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define RECENSEMENTS_MAX 1024   // Recensements au plus dans une série
+#define TENTATIVES_PAR_LOT 256  // Tentatives simulées entre deux décomptes des particules acceptées
+#define TENTATIVES_MAX 1000     // Tentatives au plus par particule et par génération
+#define TAILLE_LIGNE 256
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * @struct recensements
+ * @brief Série de recensements observés
+ */
+typedef struct recensements
+{
+    int nb;                            // Nombre de recensements
+    int mois[RECENSEMENTS_MAX];        // Mois de chaque recensement (strictement croissants, au moins 1)
+    double effectif[RECENSEMENTS_MAX]; // Effectif total recensé
+    double log_effectif[RECENSEMENTS_MAX]; // log(effectif + 1)
+} recensements;
+
+/**
+ * @struct lois_a_priori
+ * @brief Paramètres calibrés et leurs lois a priori uniformes
+ */
+typedef struct lois_a_priori
+{
+    int nb;                         // Nombre de paramètres calibrés
+    int indices[NB_PARAMETRES];     // Indice de chaque paramètre calibré
+    double bas[NB_PARAMETRES];      // Borne basse de la loi uniforme
+    double haut[NB_PARAMETRES];     // Borne haute de la loi uniforme
+} lois_a_priori;
+
+/**
+ * @struct calibration
+ * @brief Réglages communs à toutes les simulations de la calibration
+ */
+typedef struct calibration
+{
+    const params_t *nominal;        // Valeurs des paramètres non calibrés
+    const lois_a_priori *priors;    // Paramètres calibrés
+    const recensements *obs;        // Recensements
+    int nb_femelles, nb_males;      // Population initiale
+    unsigned long graine;           // Graine de la calibration
+} calibration;
+
+/**
+ * @struct particule
+ * @brief Valeurs des paramètres calibrés, poids et distance aux recensements
+ */
+typedef struct particule
+{
+    double valeurs[NB_PARAMETRES]; // Valeur de chaque paramètre calibré (ordre de lois_a_priori)
+    double poids;                  // Poids normalisé
+    double distance;               // Distance de sa simulation aux recensements
+} particule;
+
+/**
+ * @struct generation
+ * @brief Population de particules d'une génération et noyau de perturbation qui en est tiré
+ */
+typedef struct generation
+{
+    particule *particules;         // Particules pondérées
+    int nb;                        // Nombre de particules
+    double *poids_cumules;         // Poids cumulés (tirage d'une particule)
+    double noyau[NB_PARAMETRES];   // Écart-type du noyau de perturbation de chaque paramètre
+} generation;
+
+/**
+ * @struct tentative
+ * @brief Une proposition et le sort de sa simulation
+ */
+typedef struct tentative
+{
+    double valeurs[NB_PARAMETRES]; // Valeurs proposées
+    int acceptee;                  // 1 si la simulation reste à une distance au plus epsilon
+    double distance;               // Distance (INFINITY si rejetée)
+    long mois;                     // Mois simulés (0 hors du support des lois a priori)
+} tentative;
+
+/**
+ * @struct lot_tentatives
+ * @brief Lot de tentatives partagé entre les threads de calcul
+ */
+typedef struct lot_tentatives
+{
+    const calibration *c;          // Réglages
+    const generation *precedente;  // Génération précédente (NULL pour la génération 0)
+    double epsilon;                // Distance maximale acceptée
+    int numero_generation;         // Numéro de la génération
+    long premiere;                 // Numéro de la première tentative du lot
+    tentative *tentatives;         // Tentatives du lot
+    int nb;                        // Nombre de tentatives du lot
+    atomic_int prochaine;          // Prochaine tentative à prendre
+} lot_tentatives;
+
+/**
+ * @brief Lit les lois a priori: une ligne « parametre = bas haut » par paramètre calibré
+ *
+ * Les poids des portées doivent rester positifs, les autres paramètres dans
+ * [0, 1].
+ *
+ * @param chemin Chemin du fichier
+ * @param priors Lois lues
+ * @return 0, -1 si le fichier est invalide (message sur stderr)
+ */
+static int lire_priors(const char *chemin, lois_a_priori *priors)
+{
+    FILE *f = fopen(chemin, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Erreur : impossible d'ouvrir %s\n", chemin);
+        return -1;
+    }
+    priors->nb = 0;
+    char ligne[TAILLE_LIGNE];
+    int num_ligne = 0;
+    while (fgets(ligne, sizeof(ligne), f))
+    {
+        num_ligne++;
+        char cle[64];
+        double bas, haut;
+        if (sscanf(ligne, " %63[]a-z_0-9[]", cle) != 1)
+            continue; // Ligne vide ou commentaire
+        char *egal = strchr(ligne, '=');
+        int j = params_indice(cle);
+        int deja = 0;
+        for (int k = 0; k < priors->nb; k++)
+            deja |= (priors->indices[k] == j);
+        if (!egal || j < 0 || deja || sscanf(egal + 1, "%lf %lf", &bas, &haut) != 2 || bas < 0 ||
+            haut <= bas || (j >= 10 && haut > 1))
+        {
+            fprintf(stderr, "Erreur : %s, ligne %d : paramètre inconnu ou répété, ou plage invalide\n", chemin,
+                    num_ligne);
+            fclose(f);
+            return -1;
+        }
+        priors->indices[priors->nb] = j;
+        priors->bas[priors->nb] = bas;
+        priors->haut[priors->nb] = haut;
+        priors->nb++;
+    }
+    fclose(f);
+    if (priors->nb == 0)
+    {
+        fprintf(stderr, "Erreur : %s ne définit aucun paramètre à calibrer\n", chemin);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lit une série de recensements: une ligne « mois effectif » par recensement
+ *
+ * @param chemin Chemin du fichier
+ * @param obs Recensements lus
+ * @return 0, -1 si le fichier est invalide (message sur stderr)
+ */
+static int lire_recensements(const char *chemin, recensements *obs)
+{
+    FILE *f = fopen(chemin, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Erreur : impossible d'ouvrir %s\n", chemin);
+        return -1;
+    }
+    obs->nb = 0;
+    char ligne[TAILLE_LIGNE];
+    int num_ligne = 0;
+    while (fgets(ligne, sizeof(ligne), f))
+    {
+        num_ligne++;
+        char *debut = ligne + strspn(ligne, " \t");
+        if (*debut == '#' || *debut == '\n' || *debut == '\0')
+            continue;
+        int mois;
+        double effectif;
+        if (obs->nb == RECENSEMENTS_MAX || sscanf(debut, "%d %lf", &mois, &effectif) != 2 || mois < 1 ||
+            effectif < 0 || (obs->nb > 0 && mois <= obs->mois[obs->nb - 1]))
+        {
+            fprintf(stderr, "Erreur : %s, ligne %d : recensement invalide (mois croissants, à partir de 1)\n",
+                    chemin, num_ligne);
+            fclose(f);
+            return -1;
+        }
+        obs->mois[obs->nb] = mois;
+        obs->effectif[obs->nb] = effectif;
+        obs->log_effectif[obs->nb] = log(effectif + 1);
+        obs->nb++;
+    }
+    fclose(f);
+    if (obs->nb == 0)
+    {
+        fprintf(stderr, "Erreur : %s ne contient aucun recensement\n", chemin);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Simule les recensements et retourne leur distance à ceux de la série
+ *
+ * La simulation s'arrête dès que la somme partielle des écarts dépasse
+ * celle qu'autorise epsilon.
+ *
+ * @param c Réglages
+ * @param params Paramètres finalisés
+ * @param epsilon Distance maximale acceptée (INFINITY: pas de rejet précoce)
+ * @param mois_simules Mois effectivement simulés
+ * @return Distance, INFINITY si la simulation a été arrêtée
+ */
+static double simuler_distance(const calibration *c, const params_t *params, double epsilon, long *mois_simules)
+{
+    const recensements *obs = c->obs;
+    double limite = epsilon * epsilon * obs->nb;
+    mpz_t nbFemale, nbMale, total;
+    mpz_init_set_ui(nbFemale, c->nb_femelles);
+    mpz_init_set_ui(nbMale, c->nb_males);
+    mpz_init(total);
+    population *pop = initialize_population(params, nbFemale, nbMale);
+
+    double somme = 0;
+    int m = 0;
+    for (int o = 0; o < obs->nb && somme <= limite; o++)
+    {
+        for (; m < obs->mois[o]; m++)
+            simulate_month(pop);
+        population_totale(pop, total);
+        double ecart = log(mpz_get_d(total) + 1) - obs->log_effectif[o];
+        somme += ecart * ecart;
+    }
+    *mois_simules = m;
+
+    liberer_population(pop);
+    mpz_clears(nbFemale, nbMale, total, NULL);
+    return (somme <= limite) ? sqrt(somme / obs->nb) : INFINITY;
+}
+
+/**
+ * @brief Tirage gaussien centré réduit (Box-Muller)
+ */
+static double gaussienne_splitmix(uint64_t *etat)
+{
+    double u = 1 - uniforme_splitmix(etat);
+    double v = uniforme_splitmix(etat);
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/**
+ * @brief Tire la proposition d'une tentative
+ *
+ * @param lot Lot de la tentative
+ * @param numero Numéro de la tentative dans la génération
+ * @param valeurs Valeurs proposées
+ * @return 1 si la proposition est dans le support des lois a priori, 0 sinon
+ */
+static int proposer(const lot_tentatives *lot, long numero, double valeurs[])
+{
+    const lois_a_priori *priors = lot->c->priors;
+    uint64_t etat = melanger(lot->c->graine ^ melanger(((uint64_t)lot->numero_generation << 40) ^ numero));
+    const generation *g = lot->precedente;
+    if (!g)
+    {
+        for (int k = 0; k < priors->nb; k++)
+            valeurs[k] = priors->bas[k] + (priors->haut[k] - priors->bas[k]) * uniforme_splitmix(&etat);
+        return 1;
+    }
+
+    // Particule tirée selon les poids (recherche dichotomique dans les poids cumulés)
+    double u = uniforme_splitmix(&etat) * g->poids_cumules[g->nb - 1];
+    int bas = 0, haut = g->nb - 1;
+    while (bas < haut)
+    {
+        int milieu = (bas + haut) / 2;
+        if (g->poids_cumules[milieu] > u)
+            haut = milieu;
+        else
+            bas = milieu + 1;
+    }
+    int dans_support = 1;
+    for (int k = 0; k < priors->nb; k++)
+    {
+        valeurs[k] = g->particules[bas].valeurs[k] + g->noyau[k] * gaussienne_splitmix(&etat);
+        dans_support &= (valeurs[k] >= priors->bas[k] && valeurs[k] <= priors->haut[k]);
+    }
+    return dans_support;
+}
+
+/**
+ * @brief Thread de calcul: prend les tentatives du lot jusqu'à épuisement
+ */
+static void *thread_tentatives(void *arg)
+{
+    lot_tentatives *lot = arg;
+    const calibration *c = lot->c;
+    for (;;)
+    {
+        int i = atomic_fetch_add(&lot->prochaine, 1);
+        if (i >= lot->nb)
+            return NULL;
+
+        tentative *t = &lot->tentatives[i];
+        long numero = lot->premiere + i;
+        t->acceptee = 0;
+        t->distance = INFINITY;
+        t->mois = 0;
+        if (!proposer(lot, numero, t->valeurs))
+            continue; // Densité a priori nulle: rejetée sans simulation
+
+        params_t *params = params_copier(c->nominal);
+        for (int k = 0; k < c->priors->nb; k++)
+            *params_adresse(params, c->priors->indices[k]) = t->valeurs[k];
+        if (params_finaliser(params) == 0)
+        {
+            unsigned long cle[3] = {c->graine, (unsigned long)lot->numero_generation, (unsigned long)numero};
+            init_by_array(cle, 3);
+            t->distance = simuler_distance(c, params, lot->epsilon, &t->mois);
+            t->acceptee = (t->distance <= lot->epsilon);
+        }
+        params_liberer(params);
+    }
+}
+
+/**
+ * @brief Simule un lot de tentatives sur plusieurs threads
+ *
+ * @param lot Lot (tentatives, numéro de la première)
+ * @param nb_threads Nombre de threads de calcul
+ */
+static void simuler_lot(lot_tentatives *lot, int nb_threads)
+{
+    atomic_init(&lot->prochaine, 0);
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    for (int t = 0; t < nb_threads; t++)
+        pthread_create(&threads[t], NULL, thread_tentatives, lot);
+    for (int t = 0; t < nb_threads; t++)
+        pthread_join(threads[t], NULL);
+    free(threads);
+}
+
+/**
+ * @brief Pondère les particules d'une génération et calcule le noyau de la suivante
+ *
+ * Poids d'une particule: densité a priori (uniforme: constante sur le
+ * support) sur densité de proposition, mélange des noyaux gaussiens centrés
+ * sur les particules de la génération précédente. Le noyau suivant a pour
+ * variance le double de la variance pondérée des particules.
+ *
+ * @param g Génération à pondérer
+ * @param precedente Génération précédente (NULL pour la génération 0: poids égaux)
+ * @param priors Lois a priori
+ */
+static void ponderer(generation *g, const generation *precedente, const lois_a_priori *priors)
+{
+    double somme = 0;
+    for (int i = 0; i < g->nb; i++)
+    {
+        double densite = 1;
+        if (precedente)
+        {
+            densite = 0;
+            for (int l = 0; l < precedente->nb; l++)
+            {
+                double exposant = 0;
+                for (int k = 0; k < priors->nb; k++)
+                {
+                    double z = (g->particules[i].valeurs[k] - precedente->particules[l].valeurs[k]) /
+                               precedente->noyau[k];
+                    exposant += z * z;
+                }
+                densite += precedente->particules[l].poids * exp(-exposant / 2);
+            }
+        }
+        g->particules[i].poids = 1 / densite;
+        somme += g->particules[i].poids;
+    }
+
+    double cumul = 0;
+    for (int i = 0; i < g->nb; i++)
+    {
+        g->particules[i].poids /= somme;
+        cumul += g->particules[i].poids;
+        g->poids_cumules[i] = cumul;
+    }
+
+    for (int k = 0; k < priors->nb; k++)
+    {
+        double moyenne = 0, var = 0;
+        for (int i = 0; i < g->nb; i++)
+            moyenne += g->particules[i].poids * g->particules[i].valeurs[k];
+        for (int i = 0; i < g->nb; i++)
+        {
+            double ecart = g->particules[i].valeurs[k] - moyenne;
+            var += g->particules[i].poids * ecart * ecart;
+        }
+        // Particules confondues: noyau minimal pour continuer à explorer
+        g->noyau[k] = fmax(sqrt(2 * var), 1e-6 * (priors->haut[k] - priors->bas[k]));
+    }
+}
+
+/**
+ * @brief Quantile des distances d'une génération
+ *
+ * @param g Génération
+ * @param q Ordre du quantile (entre 0 et 1)
+ * @return Quantile
+ */
+static double quantile_distances(const generation *g, double q)
+{
+    double *d = malloc(g->nb * sizeof(double));
+    for (int i = 0; i < g->nb; i++)
+        d[i] = g->particules[i].distance;
+    qsort(d, g->nb, sizeof(double), comparer_reels);
+    double res = d[(int)(q * (g->nb - 1))];
+    free(d);
+    return res;
+}
+
+/**
+ * @struct bilan_generation
+ * @brief Coût d'une génération
+ */
+typedef struct bilan_generation
+{
+    long tentatives;     // Propositions tirées
+    long simulations;    // Propositions simulées (dans le support des lois a priori)
+    double mois;         // Mois simulés
+    double mois_complets; // Mois qu'auraient coûté les simulations sans rejet précoce
+} bilan_generation;
+
+/**
+ * @brief Construit une génération: simule des lots de tentatives jusqu'à nb particules acceptées
+ *
+ * @param c Réglages
+ * @param precedente Génération précédente (NULL pour la génération 0)
+ * @param numero Numéro de la génération
+ * @param epsilon Distance maximale acceptée
+ * @param nb_threads Nombre de threads de calcul
+ * @param g Génération à remplir (nb particules allouées)
+ * @param bilan Coût de la génération
+ * @return 0, -1 si TENTATIVES_MAX tentatives par particule n'ont pas suffi
+ */
+static int construire_generation(const calibration *c, const generation *precedente, int numero, double epsilon,
+                                 int nb_threads, generation *g, bilan_generation *bilan)
+{
+    lot_tentatives lot = {c, precedente, epsilon, numero, 0, NULL, TENTATIVES_PAR_LOT, 0};
+    lot.tentatives = malloc(TENTATIVES_PAR_LOT * sizeof(tentative));
+    memset(bilan, 0, sizeof(bilan_generation));
+    int acceptees = 0;
+    long duree = c->obs->mois[c->obs->nb - 1];
+
+    while (acceptees < g->nb && lot.premiere < (long)TENTATIVES_MAX * g->nb)
+    {
+        simuler_lot(&lot, nb_threads);
+        // Premières particules acceptées dans l'ordre des numéros, le reste du lot est écarté
+        for (int i = 0; i < lot.nb && acceptees < g->nb; i++)
+        {
+            tentative *t = &lot.tentatives[i];
+            bilan->tentatives++;
+            bilan->simulations += (t->mois > 0);
+            bilan->mois += t->mois;
+            bilan->mois_complets += (t->mois > 0) ? duree : 0;
+            if (t->acceptee)
+            {
+                particule *p = &g->particules[acceptees++];
+                memcpy(p->valeurs, t->valeurs, sizeof(p->valeurs));
+                p->distance = t->distance;
+            }
+        }
+        lot.premiere += lot.nb;
+    }
+    free(lot.tentatives);
+    if (acceptees < g->nb)
+        return -1;
+    ponderer(g, precedente, c->priors);
+    return 0;
+}
+
+/**
+ * @brief Alloue une génération de nb particules
+ */
+static void allouer_generation(generation *g, int nb)
+{
+    g->nb = nb;
+    g->particules = malloc(nb * sizeof(particule));
+    g->poids_cumules = malloc(nb * sizeof(double));
+}
+
+/**
+ * @brief Libère les particules d'une génération
+ */
+static void liberer_generation(generation *g)
+{
+    free(g->particules);
+    free(g->poids_cumules);
+}
+
+/**
+ * @struct valeur_ponderee
+ * @brief Valeur d'un paramètre et poids de sa particule (quantiles pondérés)
+ */
+typedef struct valeur_ponderee
+{
+    double valeur;
+    double poids;
+} valeur_ponderee;
+
+/**
+ * @brief Comparaison pour qsort: valeurs croissantes
+ */
+static int comparer_valeurs(const void *a, const void *b)
+{
+    const valeur_ponderee *x = a, *y = b;
+    return (x->valeur > y->valeur) - (x->valeur < y->valeur);
+}
+
+/**
+ * @brief Moyenne, écart-type et intervalle de crédibilité à 95% d'un paramètre
+ *
+ * @param g Génération finale
+ * @param k Indice du paramètre calibré
+ * @param moyenne Moyenne a posteriori
+ * @param ecart_type Écart-type a posteriori
+ * @param bas Quantile 2,5%
+ * @param haut Quantile 97,5%
+ */
+static void resumer_parametre(const generation *g, int k, double *moyenne, double *ecart_type, double *bas,
+                              double *haut)
+{
+    valeur_ponderee *v = malloc(g->nb * sizeof(valeur_ponderee));
+    double m = 0, var = 0;
+    for (int i = 0; i < g->nb; i++)
+    {
+        v[i].valeur = g->particules[i].valeurs[k];
+        v[i].poids = g->particules[i].poids;
+        m += v[i].poids * v[i].valeur;
+    }
+    for (int i = 0; i < g->nb; i++)
+        var += v[i].poids * (v[i].valeur - m) * (v[i].valeur - m);
+    qsort(v, g->nb, sizeof(valeur_ponderee), comparer_valeurs);
+    double cumul = 0;
+    *bas = v[0].valeur;
+    *haut = v[g->nb - 1].valeur;
+    for (int i = 0, bas_trouve = 0; i < g->nb; i++)
+    {
+        cumul += v[i].poids;
+        if (!bas_trouve && cumul >= 0.025)
+            *bas = v[i].valeur, bas_trouve = 1;
+        if (cumul >= 0.975)
+        {
+            *haut = v[i].valeur;
+            break;
+        }
+    }
+    *moyenne = m;
+    *ecart_type = sqrt(var);
+    free(v);
+}
+
+/**
+ * @brief Écrit les particules de la génération finale (une ligne par particule)
+ *
+ * @param chemin Chemin du fichier CSV
+ * @param g Génération finale
+ * @param priors Paramètres calibrés
+ * @return 0, -1 en cas d'erreur (message sur stderr)
+ */
+static int ecrire_posterior(const char *chemin, const generation *g, const lois_a_priori *priors)
+{
+    FILE *f = fopen(chemin, "w");
+    if (!f)
+    {
+        fprintf(stderr, "Erreur : impossible d'écrire %s\n", chemin);
+        return -1;
+    }
+    fprintf(f, "poids,distance");
+    for (int k = 0; k < priors->nb; k++)
+    {
+        char nom[32];
+        params_nom(priors->indices[k], nom, sizeof(nom));
+        fprintf(f, ",%s", nom);
+    }
+    fprintf(f, "\n");
+    for (int i = 0; i < g->nb; i++)
+    {
+        fprintf(f, "%.6g,%.6g", g->particules[i].poids, g->particules[i].distance);
+        for (int k = 0; k < priors->nb; k++)
+            fprintf(f, ",%.6g", g->particules[i].valeurs[k]);
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    return 0;
+}
+
+/**
+ * @brief Simule des recensements synthétiques avec les paramètres nominaux
+ *
+ * @param c Réglages (nominal, population initiale, graine)
+ * @param annees Durée de la série
+ * @param pas Mois entre deux recensements
+ * @param obs Recensements simulés
+ */
+static void recensements_synthetiques(const calibration *c, int annees, int pas, recensements *obs)
+{
+    unsigned long cle[2] = {c->graine, ~0UL};
+    init_by_array(cle, 2);
+    mpz_t nbFemale, nbMale, total;
+    mpz_init_set_ui(nbFemale, c->nb_femelles);
+    mpz_init_set_ui(nbMale, c->nb_males);
+    mpz_init(total);
+    population *pop = initialize_population(c->nominal, nbFemale, nbMale);
+
+    obs->nb = 0;
+    for (int m = 1; m <= annees * NB_MONTHS && obs->nb < RECENSEMENTS_MAX; m++)
+    {
+        simulate_month(pop);
+        if (m % pas == 0)
+        {
+            population_totale(pop, total);
+            obs->mois[obs->nb] = m;
+            obs->effectif[obs->nb] = mpz_get_d(total);
+            obs->log_effectif[obs->nb] = log(obs->effectif[obs->nb] + 1);
+            obs->nb++;
+        }
+    }
+    liberer_population(pop);
+    mpz_clears(nbFemale, nbMale, total, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    // Options: --observations fichier (« mois effectif »), --priors fichier (« parametre = bas haut »),
+    //          --femelles N, --males N (population initiale), --particules N, --generations N,
+    //          --quantile Q, --epsilon X (distance visée), --posterior fichier (CSV), --annees N et
+    //          --pas N (série synthétique), --params fichier, --graine N, --threads N
+    const char *fichier_obs = NULL, *fichier_priors = NULL, *fichier_posterior = NULL, *fichier_params = NULL;
+    int nb_femelles = 20, nb_males = 20, nb_particules = 500, nb_generations = 6, annees = 5, pas = 6;
+    int nb_threads = 0;
+    double quantile = 0.5, epsilon_vise = 0;
+    unsigned long graine = 2024;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--observations") == 0 && i + 1 < argc)
+            fichier_obs = argv[++i];
+        else if (strcmp(argv[i], "--priors") == 0 && i + 1 < argc)
+            fichier_priors = argv[++i];
+        else if (strcmp(argv[i], "--femelles") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_femelles = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--males") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_males = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--particules") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            nb_particules = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            nb_generations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quantile") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0 &&
+                 atof(argv[i + 1]) < 1)
+            quantile = atof(argv[++i]);
+        else if (strcmp(argv[i], "--epsilon") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0)
+            epsilon_vise = atof(argv[++i]);
+        else if (strcmp(argv[i], "--posterior") == 0 && i + 1 < argc)
+            fichier_posterior = argv[++i];
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            annees = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pas") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            pas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            graine = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nb_threads = atoi(argv[++i]);
+        else
+        {
+            printf("Usage : %s [--observations fichier] [--priors fichier] [--femelles N] [--males N]"
+                   " [--particules N] [--generations N] [--quantile Q] [--epsilon X] [--posterior fichier]"
+                   " [--annees N] [--pas N] [--params fichier] [--graine N] [--threads N]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (nb_threads <= 0)
+        nb_threads = nb_threads_defaut();
+
+    // Lois a priori par défaut: survies des bébés et des jeunes adultes
+    lois_a_priori priors = {2, {NB_PARAMETRES - 2, 10 + NB_MOIS_MATURITE - 1}, {0.1, 0.3}, {0.7, 0.9}};
+    if (fichier_priors && lire_priors(fichier_priors, &priors) != 0)
+        return 1;
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    calibration c = {params, &priors, NULL, nb_femelles, nb_males, graine};
+
+    recensements *obs = malloc(sizeof(recensements));
+    if (fichier_obs)
+    {
+        if (lire_recensements(fichier_obs, obs) != 0)
+        {
+            free(obs);
+            params_liberer(params);
+            return 1;
+        }
+    }
+    else
+        recensements_synthetiques(&c, annees, pas, obs);
+    c.obs = obs;
+
+    printf("Calibration ABC-SMC : %d paramètres, %d recensements sur %d mois, %d femelles et %d mâles au départ,"
+           " %d particules, %d threads\n",
+           priors.nb, obs->nb, obs->mois[obs->nb - 1], nb_femelles, nb_males, nb_particules, nb_threads);
+    if (!fichier_obs)
+    {
+        printf("Recensements synthétiques (paramètres nominaux) :");
+        for (int o = 0; o < obs->nb; o++)
+            printf(" %d:%.0f", obs->mois[o], obs->effectif[o]);
+        printf("\n");
+    }
+
+    printf("\n%*s %10s %11s %11s %*s %*s %7s %*s\n", largeur_utf8("gén", 3), "gén", "epsilon", "tentatives",
+           "simulations", largeur_utf8("acceptées", 10), "acceptées", largeur_utf8("mois évités", 11), "mois évités",
+           "ESS", largeur_utf8("durée", 8), "durée");
+    struct timespec debut, debut_total;
+    clock_gettime(CLOCK_MONOTONIC, &debut_total);
+    generation g = {0}, precedente = {0};
+    double epsilon = INFINITY;
+    long simulations_total = 0;
+    int nb_faites = 0;
+    for (int t = 0; t < nb_generations; t++)
+    {
+        allouer_generation(&g, nb_particules);
+        bilan_generation bilan;
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        if (construire_generation(&c, t ? &precedente : NULL, t, epsilon, nb_threads, &g, &bilan) != 0)
+        {
+            printf("Génération %d : moins d'une particule acceptée sur %d tentatives, arrêt à la génération %d\n",
+                   t, TENTATIVES_MAX, t - 1);
+            liberer_generation(&g);
+            g = precedente;
+            break;
+        }
+        simulations_total += bilan.simulations;
+
+        double somme_carres = 0;
+        for (int i = 0; i < g.nb; i++)
+            somme_carres += g.particules[i].poids * g.particules[i].poids;
+        printf("%3d %10.4g %11ld %11ld %9.1f%% %10.0f%% %7.0f %7.1fs\n", t, epsilon, bilan.tentatives,
+               bilan.simulations, 100.0 * g.nb / bilan.tentatives,
+               bilan.mois_complets > 0 ? 100 * (1 - bilan.mois / bilan.mois_complets) : 0, 1 / somme_carres,
+               secondes_depuis(&debut));
+        fflush(stdout);
+
+        if (t > 0)
+            liberer_generation(&precedente);
+        precedente = g;
+        nb_faites = t + 1;
+        if (epsilon <= epsilon_vise)
+            break;
+        epsilon = fmax(quantile_distances(&g, quantile), epsilon_vise);
+    }
+    printf("%ld simulations en %.1f s\n", simulations_total, secondes_depuis(&debut_total));
+
+    if (nb_faites > 0)
+    {
+        printf("\nLoi a posteriori (génération %d)\n", nb_faites - 1);
+        printf("%-18s %15s %10s %*s %21s", "paramètre", "a priori", "moyenne", largeur_utf8("é.-t.", 10),
+               "é.-t.", "IC à 95%");
+        if (!fichier_obs)
+            printf(" %10s", "nominal");
+        printf("\n");
+        for (int k = 0; k < priors.nb; k++)
+        {
+            char nom[32], plage[32], intervalle[48];
+            double moyenne, ecart_type, bas, haut;
+            params_nom(priors.indices[k], nom, sizeof(nom));
+            resumer_parametre(&g, k, &moyenne, &ecart_type, &bas, &haut);
+            snprintf(plage, sizeof(plage), "[%.3g, %.3g]", priors.bas[k], priors.haut[k]);
+            snprintf(intervalle, sizeof(intervalle), "[%.4g, %.4g]", bas, haut);
+            printf("%-18s %15s %10.4g %10.2g %21s", nom, plage, moyenne, ecart_type, intervalle);
+            if (!fichier_obs)
+                printf(" %10.4g", *params_adresse(params, priors.indices[k]));
+            printf("\n");
+        }
+        if (fichier_posterior && ecrire_posterior(fichier_posterior, &g, &priors) == 0)
+            printf("\nParticules pondérées écrites dans %s\n", fichier_posterior);
+        liberer_generation(&g);
+    }
+
+    free(obs);
+    params_liberer(params);
+    return 0;
+}
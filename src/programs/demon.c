@@ -0,0 +1,42 @@
+/**
+ * @file demon.c
+ * @brief Démon de simulation sur socket Unix
+ *
+ * Garde les threads de calcul, les paramètres et les populations entre les
+ * requêtes de bin/popsim_client ou de tout client du protocole de
+ * serveur.h. S'arrête proprement sur SIGINT ou SIGTERM.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "serveur.h"
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    // Options: --socket chemin, --params fichier (paramètres nominaux), --threads N
+    options_serveur opt = {DEMON_SOCKET_DEFAUT, NULL, 0};
+    const char *fichier_params = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            opt.chemin = argv[++i];
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            opt.nb_threads = atoi(argv[++i]);
+        else
+        {
+            printf("Usage : %s [--socket chemin] [--params fichier] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    opt.nominal = params;
+    int res = serveur_lancer(&opt);
+    params_liberer(params);
+    return res ? 1 : 0;
+}
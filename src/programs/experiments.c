@@ -7,38 +7,33 @@
  */
 
 #include "simulation.h"
+#include "config.h"
+#include "replication.h"
+#include "saut.h"
+#include "cache.h"
+#include "journal.h"
 #include <time.h>
 #include <math.h>
-
-/**
- * @brief Structure pour stocker les résultats d'une simulation
- */
-typedef struct
-{
-    unsigned long final_babies;
-    unsigned long final_males;
-    unsigned long final_females;
-    unsigned long total_population;
-} SimulationResult;
+#include <string.h>
 
 /**
  * @brief Calcule les statistiques sur un ensemble de résultats
  */
-void compute_statistics(SimulationResult *results, int num_experiments,
-                        double *mean, double *std_dev, unsigned long *min, unsigned long *max)
+void compute_statistics(resultat_simulation *results, int num_experiments,
+                        double *mean, double *std_dev, double *min, double *max)
 {
     *mean = 0;
-    *min = results[0].total_population;
-    *max = results[0].total_population;
+    *min = results[0].total;
+    *max = results[0].total;
 
     // Calcul de la moyenne
     for (int i = 0; i < num_experiments; i++)
     {
-        *mean += results[i].total_population;
-        if (results[i].total_population < *min)
-            *min = results[i].total_population;
-        if (results[i].total_population > *max)
-            *max = results[i].total_population;
+        *mean += results[i].total;
+        if (results[i].total < *min)
+            *min = results[i].total;
+        if (results[i].total > *max)
+            *max = results[i].total;
     }
     *mean /= num_experiments;
 
@@ -46,7 +41,7 @@ void compute_statistics(SimulationResult *results, int num_experiments,
     double variance = 0;
     for (int i = 0; i < num_experiments; i++)
     {
-        double diff = results[i].total_population - *mean;
+        double diff = results[i].total - *mean;
         variance += diff * diff;
     }
     variance /= num_experiments;
@@ -54,66 +49,42 @@ void compute_statistics(SimulationResult *results, int num_experiments,
 }
 
 /**
- * @brief Lance une série d'expériences avec les mêmes paramètres
+ * @brief Lance une série d'expériences jusqu'à la précision demandée
+ *
+ * Les réplications sont lancées par lots parallèles jusqu'à ce que l'IC à 95%
+ * de la statistique suivie soit assez étroit, ou que le budget soit épuisé.
  */
-void run_experiment_series(int num_females, int num_males, int years, int num_experiments)
+void run_experiment_series(const params_t *params, int num_females, int num_males, int years,
+                           const precision_cible *cible)
 {
     printf("\n==============================================================\n");
     printf("SÉRIE D'EXPÉRIENCES : %d femelles, %d mâles, %d ans\n", num_females, num_males, years);
-    printf("Nombre d'expériences : %d\n", num_experiments);
+    if (cible->critere == CRITERE_MOYENNE)
+        printf("Précision visée : moyenne à ±%.0f%% (IC 95%%), budget %d\n",
+               cible->demi_largeur_relative * 100, cible->budget);
+    else
+        printf("Précision visée : quantile %.2f à ±%.0f%% (IC 95%%), budget %d\n",
+               cible->quantile, cible->demi_largeur_relative * 100, cible->budget);
     printf("==============================================================\n\n");
 
-    SimulationResult *results = malloc(num_experiments * sizeof(SimulationResult));
+    scenario sc = {num_females, num_males, years, params};
+    serie_sequentielle serie;
+    replications_sequentielles(sc, cible, 1000 * years + num_females, &serie);
+    int num_experiments = serie.nb_replications;
+    resultat_simulation *results = serie.resultats;
 
-    // Lancer les expériences
-    for (int exp = 0; exp < num_experiments; exp++)
+    if (num_experiments == 0)
     {
-        printf("Expérience %d/%d...\n", exp + 1, num_experiments);
-
-        mpz_t nbFemale, nbMale;
-        mpz_init_set_ui(nbFemale, num_females);
-        mpz_init_set_ui(nbMale, num_males);
-
-        population *pop = simulate_population(nbFemale, nbMale, years);
-
-        // Collecter les résultats finaux
-        mpz_t total_babies, total_males, total_females;
-        mpz_init_set_ui(total_babies, 0);
-        mpz_init_set_ui(total_males, 0);
-        mpz_init_set_ui(total_females, 0);
-
-        for (int age = 0; age < AGE_MAX; age++)
-        {
-            for (int month = 0; month < NB_MONTHS; month++)
-            {
-                mpz_add(total_babies, total_babies, pop->lapins_par_age[age][month].nb_babies);
-                mpz_add(total_males, total_males, pop->lapins_par_age[age][month].nb_male);
-                for (int i = 0; i < 10; i++)
-                {
-                    mpz_add(total_females, total_females,
-                            pop->lapins_par_age[age][month].femelles_par_accouchements_restants[i]);
-                }
-            }
-        }
-
-        results[exp].final_babies = mpz_get_ui(total_babies);
-        results[exp].final_males = mpz_get_ui(total_males);
-        results[exp].final_females = mpz_get_ui(total_females);
-        results[exp].total_population = results[exp].final_babies +
-                                        results[exp].final_males +
-                                        results[exp].final_females;
-
-        mpz_clear(total_babies);
-        mpz_clear(total_males);
-        mpz_clear(total_females);
-        mpz_clear(nbFemale);
-        mpz_clear(nbMale);
-        free(pop);
+        printf("Erreur : aucune expérience terminée\n");
+        free(results);
+        return;
     }
 
+    printf("Nombre d'expériences utilisées : %d (%s)\n", num_experiments,
+           serie.precision_atteinte ? "précision atteinte" : "budget épuisé");
+
     // Calcul des statistiques
-    double mean, std_dev;
-    unsigned long min, max;
+    double mean, std_dev, min, max;
     compute_statistics(results, num_experiments, &mean, &std_dev, &min, &max);
 
     // Affichage des résultats
@@ -121,45 +92,121 @@ void run_experiment_series(int num_females, int num_males, int years, int num_ex
     printf("Population moyenne :    %.0f lapins\n", mean);
     printf("Écart-type :           %.0f lapins\n", std_dev);
     printf("Coefficient de variation : %.2f%%\n", (std_dev / mean) * 100);
-    printf("Population minimale :  %lu lapins\n", min);
-    printf("Population maximale :  %lu lapins\n", max);
+    printf("Population minimale :  %.0f lapins\n", min);
+    printf("Population maximale :  %.0f lapins\n", max);
+    printf("Estimation suivie :    %.0f ± %.0f lapins (IC 95%%)\n", serie.estimation, serie.demi_largeur);
     printf("\nDétail des expériences :\n");
     for (int i = 0; i < num_experiments; i++)
     {
-        printf("Exp %2d: %10lu lapins (bébés: %7lu, mâles: %7lu, femelles: %7lu)\n",
-               i + 1, results[i].total_population,
-               results[i].final_babies, results[i].final_males, results[i].final_females);
+        printf("Exp %2d: %10.0f lapins (bébés: %7.0f, mâles: %7.0f, femelles: %7.0f)\n",
+               i + 1, results[i].total,
+               results[i].bebes, results[i].males, results[i].femelles);
     }
 
     free(results);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-    // Initialisation
-    init_survival_rate();
-    init_prob_litter();
+    // Options: --processus N (réplications réparties sur N processus fils)
+    //          --params fichier (jeu de paramètres biologiques)
+    //          --ensemble (NB_VOIES réplications par thread, moteur ensemble)
+    //          --cache fichier (simulations du moteur mensuel déjà faites relues dans le fichier)
+    //          --journal fichier (réplications des séries journalisées, reprises après une interruption)
+    int nb_processus = 0;
+    int ensemble = 0;
+    const char *fichier_params = NULL;
+    const char *fichier_cache = NULL;
+    const char *fichier_journal = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--processus") == 0 && i + 1 < argc)
+            nb_processus = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--ensemble") == 0)
+            ensemble = 1;
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            fichier_cache = argv[++i];
+        else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc)
+            fichier_journal = argv[++i];
+        else
+        {
+            printf("Usage : %s [--processus N] [--params fichier] [--ensemble] [--cache fichier] [--journal fichier]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    // Initialisation des paramètres biologiques
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    cache_resultats *cache = NULL;
+    if (fichier_cache)
+    {
+        cache = cache_ouvrir(fichier_cache, CASES_CACHE_DEFAUT);
+        if (!cache)
+        {
+            params_liberer(params);
+            return 1;
+        }
+        replication_utiliser_cache(cache);
+    }
+    journal_replications *journal = NULL;
+    if (fichier_journal)
+    {
+        journal = journal_ouvrir(fichier_journal);
+        if (!journal)
+        {
+            cache_fermer(cache);
+            params_liberer(params);
+            return 1;
+        }
+        replication_utiliser_journal(journal);
+    }
 
     printf("\n╔══════════════════════════════════════════════════════════════╗\n");
     printf("║  EXPÉRIMENTATIONS - SIMULATION POPULATION DE LAPINS         ║\n");
     printf("║  Analyse de la variabilité stochastique                     ║\n");
     printf("╚══════════════════════════════════════════════════════════════╝\n");
 
+    // Règle d'arrêt: moyenne à ±10% près, entre 5 et 40 réplications
+    precision_cible cible = {CRITERE_MOYENNE, 0.5, 0.10, 5, 40, 0, 0, nb_processus, ensemble};
+
     // Expérience 1 : Impact des conditions initiales faibles (risque d'extinction)
     printf("\n\n### EXPÉRIENCE 1 : Conditions initiales faibles ###\n");
-    run_experiment_series(10, 10, 10, 5);
+    run_experiment_series(params, 10, 10, 10, &cible);
 
     // Expérience 2 : Conditions initiales moyennes
     printf("\n\n### EXPÉRIENCE 2 : Conditions initiales moyennes ###\n");
-    run_experiment_series(50, 50, 10, 5);
+    run_experiment_series(params, 50, 50, 10, &cible);
 
     // Expérience 3 : Conditions initiales fortes
     printf("\n\n### EXPÉRIENCE 3 : Conditions initiales fortes ###\n");
-    run_experiment_series(100, 100, 10, 5);
+    run_experiment_series(params, 100, 100, 10, &cible);
 
-    // Expérience 4 : Simulation longue durée
+    // Expérience 4 : Simulation longue durée (médiane, budget réduit)
     printf("\n\n### EXPÉRIENCE 4 : Simulation sur 20 ans ###\n");
-    run_experiment_series(100, 100, 20, 3);
+    precision_cible cible_longue = {CRITERE_QUANTILE, 0.5, 0.20, 3, 12, 0, 0, nb_processus, ensemble};
+    run_experiment_series(params, 100, 100, 20, &cible_longue);
+
+    // Expérience 5 : Comparaison appariée de deux conditions initiales
+    printf("\n\n### EXPÉRIENCE 5 : Comparaison 100x100 vs 50x50 (réduction de variance) ###\n\n");
+    scenario fort = {100, 100, 8, params};
+    scenario moyen = {50, 50, 8, params};
+    mode_replication modes[] = {REPLICATION_INDEPENDANTE, REPLICATION_CRN, REPLICATION_ANTITHETIQUE};
+    for (int m = 0; m < 3; m++)
+    {
+        comparaison res;
+        if (comparer_scenarios(fort, moyen, 6, modes[m], 2024, &res) == 0)
+            afficher_comparaison(&res, modes[m]);
+    }
+
+    // Expérience 6 : Erreur du mode saut (tau-leaping) face au moteur mensuel
+    printf("\n\n### EXPÉRIENCE 6 : Mode saut contre moteur mensuel (25 ans) ###\n\n");
+    options_saut opt = options_saut_defaut();
+    rapport_erreur_saut(params, 100, 100, 25, &opt, 4, 3000);
 
     printf("\n\n═══════════════════════════════════════════════════════════════\n");
     printf("CONCLUSION :\n");
@@ -168,5 +215,22 @@ int main()
     printf("statistiquement significatifs.\n");
     printf("═══════════════════════════════════════════════════════════════\n\n");
 
+    if (journal)
+    {
+        long reprises, ajoutees;
+        journal_statistiques(journal, &reprises, &ajoutees);
+        printf("Journal %s : %ld réplications reprises, %ld ajoutées\n", fichier_journal, reprises, ajoutees);
+        replication_utiliser_journal(NULL);
+        journal_fermer(journal);
+    }
+    if (cache)
+    {
+        long succes, echecs;
+        cache_statistiques(cache, &succes, &echecs);
+        printf("Cache %s : %ld simulations relues, %ld calculées\n", fichier_cache, succes, echecs);
+        replication_utiliser_cache(NULL);
+        cache_fermer(cache);
+    }
+    params_liberer(params);
     return 0;
 }
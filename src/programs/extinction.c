@@ -0,0 +1,145 @@
+/**
+ * @file extinction.c
+ * @brief Probabilité d'extinction précoce d'un petit groupe fondateur
+ *
+ * Estime la probabilité que la population s'éteigne avant l'horizon par
+ * éclatement multiniveau (eclatement.h), affiche la probabilité de passage
+ * de chaque seuil et compare le coût de l'estimation (en mois simulés) à
+ * celui du Monte-Carlo direct de même précision. Avec --naif N, le
+ * Monte-Carlo direct est aussi lancé sur N réplications comme référence.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "replication.h"
+#include "eclatement.h"
+#include "outils.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Lit une liste de seuils séparés par des virgules
+ *
+ * @param texte Liste (ex. « 12,7,4,2,1 »)
+ * @param opt Réglages dont les niveaux sont remplacés
+ * @return 0, -1 si la liste n'est pas strictement décroissante et positive
+ */
+static int lire_niveaux(const char *texte, options_eclatement *opt)
+{
+    opt->nb_niveaux = 0;
+    char *fin;
+    while (*texte && opt->nb_niveaux < NIVEAUX_MAX)
+    {
+        long seuil = strtol(texte, &fin, 10);
+        if (fin == texte || seuil < 1 || (opt->nb_niveaux > 0 && seuil >= opt->niveaux[opt->nb_niveaux - 1]))
+            return -1;
+        opt->niveaux[opt->nb_niveaux++] = seuil;
+        texte = (*fin == ',') ? fin + 1 : fin;
+    }
+    return *texte ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Options: --femelles N, --males N, --annees N (horizon), --effort N (trajectoires par étape),
+    //          --repetitions N, --niveaux a,b,... (seuils d'effectif décroissants), --naif N
+    //          (référence Monte-Carlo direct), --params fichier, --graine N, --threads N
+    int nb_femelles = 4, nb_males = 4, annees = 3;
+    int effort = 0, nb_repetitions = 0, nb_naif = 0, nb_threads = 0;
+    unsigned long graine = 2024;
+    const char *fichier_params = NULL;
+    const char *niveaux = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--femelles") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_femelles = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--males") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_males = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            annees = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--effort") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            effort = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            nb_repetitions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--niveaux") == 0 && i + 1 < argc)
+            niveaux = argv[++i];
+        else if (strcmp(argv[i], "--naif") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            nb_naif = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            graine = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nb_threads = atoi(argv[++i]);
+        else
+        {
+            printf("Usage : %s [--femelles N] [--males N] [--annees N] [--effort N] [--repetitions N]"
+                   " [--niveaux a,b,...] [--naif N] [--params fichier] [--graine N] [--threads N]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    options_eclatement opt = options_eclatement_defaut(nb_femelles + nb_males);
+    if (niveaux && lire_niveaux(niveaux, &opt) != 0)
+    {
+        fprintf(stderr, "Erreur : --niveaux attend des seuils entiers positifs strictement décroissants\n");
+        return 1;
+    }
+    if (effort > 0)
+        opt.effort = effort;
+    if (nb_repetitions > 0)
+        opt.nb_repetitions = nb_repetitions;
+    opt.nb_threads = nb_threads;
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    scenario sc = {nb_femelles, nb_males, annees, params};
+
+    printf("Extinction avant %d ans de %d femelles et %d mâles : éclatement multiniveau,"
+           " %d trajectoires par étape, %d répétitions\n\n",
+           annees, nb_femelles, nb_males, opt.effort, opt.nb_repetitions);
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    estimation_extinction est;
+    extinction_eclatement(sc, &opt, graine, &est);
+    double duree = secondes_depuis(&debut);
+
+    printf("%-24s %12s\n", "Étape", "passage");
+    for (int k = 0; k < est.nb_niveaux; k++)
+    {
+        char etape[48];
+        if (k < opt.nb_niveaux)
+            snprintf(etape, sizeof(etape), "effectif <= %ld", opt.niveaux[k]);
+        else
+            snprintf(etape, sizeof(etape), "extinction");
+        printf("%-24s %12.4g\n", etape, est.passage[k]);
+    }
+    printf("\nProbabilité d'extinction : %.4g ± %.2g (IC 95%%)\n", est.proba, est.demi_largeur);
+    printf("Coût : %.3g mois simulés en %.1f s\n", est.mois_simules, duree);
+
+    // Monte-Carlo direct de même précision: p (1 - p) (1,96 / h)^2 réplications jusqu'à l'horizon
+    if (est.proba > 0 && est.demi_largeur > 0)
+    {
+        double nb_equivalent = est.proba * (1 - est.proba) * pow(1.96 / est.demi_largeur, 2);
+        double mois_equivalents = nb_equivalent * annees * NB_MONTHS;
+        printf("Monte-Carlo direct de même précision : %.3g réplications, %.3g mois simulés (x%.3g)\n",
+               nb_equivalent, mois_equivalents, mois_equivalents / est.mois_simules);
+    }
+
+    if (nb_naif > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        estimation_extinction naif;
+        extinction_naive(sc, nb_naif, nb_threads, graine, &naif);
+        printf("\nRéférence Monte-Carlo direct (%d réplications) : %.4g, IC 95%% [%.2g, %.2g] (Wilson),"
+               " %.3g mois simulés en %.1f s\n",
+               nb_naif, naif.proba, naif.borne_basse, naif.borne_haute, naif.mois_simules, secondes_depuis(&debut));
+    }
+
+    params_liberer(params);
+    return 0;
+}
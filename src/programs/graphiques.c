@@ -9,306 +9,604 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <gmp.h>
 #include <mpfr.h>
 #include "simulation.h"
 #include "config.h"
 #include "population.h"
+#include "shards.h"
+#include "ensemble.h"
+#include "cache.h"
 #include "mt19937ar-cok.h"
 
+// Nombre de processus fils pour les balayages (0: processus unique)
+int nb_processus = 0;
+
+// 1: réplications simulées par groupes de NB_VOIES (moteur ensemble)
+int mode_ensemble = 0;
+
+// Paramètres biologiques utilisés par toutes les simulations
+const params_t *params = NULL;
+
 /**
- * @brief Calcule la population totale
+ * @brief Effectue une simulation et retourne la population finale
+ *
+ * Avec --cache, une simulation déjà faite (même condition, graine et
+ * paramètres, durée au plus égale) est relue dans le cache.
  */
-unsigned long calculer_total(population *pop)
+double simuler_finale(int males, int females, int annees, unsigned long seed)
 {
-    mpz_t total;
-    mpz_init(total);
+    scenario sc = {females, males, annees, params};
+    return simuler_total(sc, seed, 0);
+}
 
-    for (int age = 0; age <= AGE_MAX; age++)
+/**
+ * @brief Simule nb réplications d'une condition et retourne leurs populations finales
+ *
+ * En mode ensemble, les réplications sont simulées par groupes de NB_VOIES.
+ */
+void simuler_finales(int males, int females, int annees, const unsigned long graines[], int nb,
+                     resultat_simulation resultats[])
+{
+    if (!mode_ensemble)
     {
-        for (int mois = 0; mois < NB_MONTHS; mois++)
-        {
-            mpz_add(total, total, pop->lapins_par_age[age][mois].nb_male);
-            mpz_add(total, total, pop->lapins_par_age[age][mois].nb_babies);
-            for (int acc = 0; acc < 10; acc++)
-            {
-                mpz_add(total, total, pop->lapins_par_age[age][mois].femelles_par_accouchements_restants[acc]);
-            }
-        }
+        for (int i = 0; i < nb; i++)
+            resultats[i].total = simuler_finale(males, females, annees, graines[i]);
+        return;
     }
 
-    unsigned long result = mpz_get_ui(total);
-    mpz_clear(total);
-    return result;
+    scenario sc = {females, males, annees, params};
+    for (int i = 0; i < nb; i += NB_VOIES)
+        simuler_ensemble(sc, graines + i, (nb - i < NB_VOIES) ? nb - i : NB_VOIES, resultats + i);
+}
+
+/**
+ * @brief Paramètres du balayage du boxplot
+ */
+typedef struct
+{
+    int (*conditions)[2];
+    int nb_rep;
+    int annees;
+} balayage_boxplot;
+
+/**
+ * @brief Tâche t du boxplot: condition t / nb_rep, réplication t % nb_rep
+ */
+void tache_boxplot(long t, void *contexte, resultat_simulation *res)
+{
+    balayage_boxplot *b = contexte;
+    int cond = (int)(t / b->nb_rep);
+    int rep = (int)(t % b->nb_rep);
+
+    // Seul le total est calculé: les autres champs partent à zéro
+    *res = (resultat_simulation){0};
+
+    // Nombres aléatoires communs: la réplication rep utilise la même
+    // graine pour les trois conditions
+    res->total = simuler_finale(b->conditions[cond][0], b->conditions[cond][1],
+                                b->annees, 10000 + rep);
+}
+
+/**
+ * @struct simulation_figure
+ * @brief Une simulation d'une figure: condition initiale, durée et graine
+ */
+typedef struct simulation_figure
+{
+    int males;
+    int femelles;
+    int annees;
+    unsigned long graine;
+} simulation_figure;
+
+/**
+ * @struct figure
+ * @brief Simulations, résultats et rendu d'un graphique
+ */
+typedef struct figure
+{
+    const char *nom;                  // Nom affiché
+    const char *image;                // Fichier PNG produit
+    int nb;                           // Nombre de simulations
+    simulation_figure *simulations;   // Simulations de la figure
+    resultat_simulation *resultats;   // Population finale de chaque simulation
+    atomic_int restantes;             // Simulations pas encore terminées
+    void (*ecrire)(struct figure *);  // Écrit le .dat et le script gnuplot
+    const char *script;               // Script gnuplot écrit par ecrire
+    FILE *gnuplot;                    // Processus gnuplot en cours (NULL: pas lancé)
+    struct figure *suivante;          // File des figures prêtes pour l'écrivain
+} figure;
+
+/**
+ * @struct tache_figure
+ * @brief Bloc de simulations consécutives d'une figure (même condition et durée)
+ */
+typedef struct tache_figure
+{
+    figure *fig;
+    int debut;
+    int nb;
+} tache_figure;
+
+/**
+ * @struct pipeline
+ * @brief File de tâches des threads de calcul et file de l'écrivain
+ */
+typedef struct pipeline
+{
+    tache_figure *taches;   // Tâches de toutes les figures, les plus longues d'abord
+    int nb_taches;
+    atomic_int prochaine;   // Prochaine tâche à prendre
+    pthread_mutex_t verrou; // Protège la file des figures prêtes
+    pthread_cond_t prete;   // Signale une figure prête
+    figure *pretes;         // Figures dont toutes les simulations sont terminées
+    int a_ecrire;           // Figures que l'écrivain doit encore traiter
+} pipeline;
+
+/**
+ * @brief Remplit la simulation i d'une figure
+ */
+static void definir_simulation(figure *fig, int i, int males, int femelles, int annees, unsigned long graine)
+{
+    fig->simulations[i] = (simulation_figure){males, femelles, annees, graine};
+}
+
+/**
+ * @brief Alloue une figure de nb simulations
+ */
+static void figure_init(figure *fig, const char *nom, const char *image, int nb, void (*ecrire)(figure *))
+{
+    memset(fig, 0, sizeof(*fig));
+    fig->nom = nom;
+    fig->image = image;
+    fig->nb = nb;
+    fig->simulations = malloc(nb * sizeof(simulation_figure));
+    fig->resultats = malloc(nb * sizeof(resultat_simulation));
+    atomic_init(&fig->restantes, nb);
+    fig->ecrire = ecrire;
 }
 
 /**
- * @brief Libère une population
+ * @brief Signale une figure dont toutes les simulations sont terminées
  */
-void liberer_population(population *pop)
+static void figure_prete(pipeline *pl, figure *fig)
 {
-    for (int age = 0; age <= AGE_MAX; age++)
+    pthread_mutex_lock(&pl->verrou);
+    fig->suivante = pl->pretes;
+    pl->pretes = fig;
+    pthread_cond_signal(&pl->prete);
+    pthread_mutex_unlock(&pl->verrou);
+}
+
+/**
+ * @brief Thread de calcul: prend les tâches de la file jusqu'à épuisement
+ */
+static void *thread_calcul(void *arg)
+{
+    pipeline *pl = arg;
+    for (;;)
     {
-        for (int mois = 0; mois < NB_MONTHS; mois++)
+        int i = atomic_fetch_add(&pl->prochaine, 1);
+        if (i >= pl->nb_taches)
+            return NULL;
+
+        tache_figure *t = &pl->taches[i];
+        simulation_figure *sim = &t->fig->simulations[t->debut];
+        unsigned long graines[NB_VOIES];
+        for (int k = 0; k < t->nb; k++)
+            graines[k] = sim[k].graine;
+        simuler_finales(sim->males, sim->femelles, sim->annees, graines, t->nb, &t->fig->resultats[t->debut]);
+
+        if (atomic_fetch_sub(&t->fig->restantes, t->nb) == t->nb)
+            figure_prete(pl, t->fig);
+    }
+}
+
+/**
+ * @brief Écrivain: écrit les données de chaque figure prête et lance son rendu
+ *
+ * gnuplot lit le script par un tube et dessine en arrière-plan pendant que
+ * les autres figures se simulent encore.
+ */
+static void *thread_ecrivain(void *arg)
+{
+    pipeline *pl = arg;
+    pthread_mutex_lock(&pl->verrou);
+    while (pl->a_ecrire > 0)
+    {
+        while (!pl->pretes)
+            pthread_cond_wait(&pl->prete, &pl->verrou);
+        figure *fig = pl->pretes;
+        pl->pretes = fig->suivante;
+        pl->a_ecrire--;
+        pthread_mutex_unlock(&pl->verrou);
+
+        fig->ecrire(fig);
+        printf("  Figure %s : simulations terminées, rendu lancé\n", fig->nom);
+        fflush(stdout);
+        if (fig->script)
         {
-            mpz_clear(pop->lapins_par_age[age][mois].nb_male);
-            mpz_clear(pop->lapins_par_age[age][mois].nb_babies);
-            for (int acc = 0; acc < 10; acc++)
+            fig->gnuplot = popen("gnuplot", "w");
+            if (fig->gnuplot)
             {
-                mpz_clear(pop->lapins_par_age[age][mois].femelles_par_accouchements_restants[acc]);
+                fprintf(fig->gnuplot, "load '%s'\n", fig->script);
+                fflush(fig->gnuplot);
             }
         }
+
+        pthread_mutex_lock(&pl->verrou);
     }
-    free(pop);
+    pthread_mutex_unlock(&pl->verrou);
+    return NULL;
 }
 
 /**
- * @brief Effectue une simulation et retourne la population finale
+ * @brief Ordre des tâches: les plus longues (plus d'années, plus grande population) d'abord
  */
-unsigned long simuler_finale(int males, int females, int annees, unsigned long seed)
+static int comparer_taches(const void *a, const void *b)
 {
-    init_genrand(seed);
-
-    mpz_t m, f;
-    mpz_inits(m, f, NULL);
-    mpz_set_ui(m, males);
-    mpz_set_ui(f, females);
-
-    population *pop = simulate_population(f, m, annees);
-    unsigned long total = calculer_total(pop);
-
-    liberer_population(pop);
-    mpz_clears(m, f, NULL);
+    const simulation_figure *sa = &((const tache_figure *)a)->fig->simulations[((const tache_figure *)a)->debut];
+    const simulation_figure *sb = &((const tache_figure *)b)->fig->simulations[((const tache_figure *)b)->debut];
+    if (sa->annees != sb->annees)
+        return sb->annees - sa->annees;
+    return (sb->males + sb->femelles) - (sa->males + sa->femelles);
+}
 
-    return total;
+/**
+ * @brief Découpe les simulations restantes d'une figure en tâches
+ *
+ * En mode ensemble, les simulations consécutives de même condition et
+ * durée sont regroupées par NB_VOIES.
+ */
+static void ajouter_taches(pipeline *pl, figure *fig)
+{
+    int i = 0;
+    while (i < fig->nb)
+    {
+        simulation_figure *s = &fig->simulations[i];
+        int nb = 1;
+        while (mode_ensemble && nb < NB_VOIES && i + nb < fig->nb && s[nb].males == s->males &&
+               s[nb].femelles == s->femelles && s[nb].annees == s->annees)
+            nb++;
+        pl->taches[pl->nb_taches++] = (tache_figure){fig, i, nb};
+        i += nb;
+    }
 }
 
 /**
- * @brief Génère un graphique boxplot
+ * @brief Ouvre le script gnuplot d'une figure et écrit ses réglages communs
  */
-void graphique_boxplot()
+static FILE *ouvrir_script(figure *fig, const char *script, const char *titre, const char *xlabel,
+                           const char *ylabel)
 {
-    printf("\n=== Génération du boxplot ===\n");
+    FILE *gp = fopen(script, "w");
+    if (!gp)
+        return NULL;
+    fig->script = script;
+    fprintf(gp, "set terminal png size 1200,800 font 'Arial,14'\n");
+    fprintf(gp, "set output '%s'\n", fig->image);
+    fprintf(gp, "set title '%s'\n", titre);
+    fprintf(gp, "set xlabel '%s'\n", xlabel);
+    fprintf(gp, "set ylabel '%s'\n", ylabel);
+    return gp;
+}
 
-    int nb_rep = 15; // Réduit pour éviter problèmes mémoire
-    int annees = 12; // Réduit pour accélérer
-    int conditions[][2] = {{10, 10}, {50, 50}, {100, 100}};
-    const char *labels[] = {"10x10", "50x50", "100x100"};
+// Conditions initiales (mâles, femelles) comparées par les graphiques
+static int conditions[][2] = {{10, 10}, {50, 50}, {100, 100}};
+static const char *labels[] = {"10x10", "50x50", "100x100"};
 
+#define BOXPLOT_REP 15     // Réplications par condition (réduit pour éviter problèmes mémoire)
+#define BOXPLOT_ANNEES 12  // Durée des simulations du boxplot
+#define COMPARAISON_ANNEES 15
+#define VARIABILITE_REP 8
+#define VARIABILITE_ANNEES 12
+
+/**
+ * @brief Écrit les données et le script du boxplot
+ */
+void ecrire_boxplot(figure *fig)
+{
     FILE *f = fopen("boxplot_data.dat", "w");
     if (!f)
         return;
 
     fprintf(f, "# Condition PopFinal\n");
-
     for (int cond = 0; cond < 3; cond++)
     {
-        printf("  Condition %s : ", labels[cond]);
-        for (int rep = 0; rep < nb_rep; rep++)
+        accumulateur acc;
+        accumulateur_init(&acc);
+        for (int rep = 0; rep < BOXPLOT_REP; rep++)
         {
-            if (rep % 10 == 0)
-                printf(".");
-            fflush(stdout);
-
-            unsigned long pop = simuler_finale(
-                conditions[cond][0], conditions[cond][1],
-                annees, 10000 + cond * 1000 + rep);
-            fprintf(f, "%d %lu\n", cond + 1, pop);
+            double total = fig->resultats[cond * BOXPLOT_REP + rep].total;
+            fprintf(f, "%d %.0f\n", cond + 1, total);
+            accumulateur_ajouter(&acc, total);
         }
-        printf(" OK\n");
+        printf("  %s : moyenne %.0f, min %.0f, max %.0f\n", labels[cond], acc.somme / acc.n, acc.min, acc.max);
     }
-
     fclose(f);
 
-    // Script gnuplot
-    FILE *gp = fopen("plot_boxplot.gp", "w");
+    FILE *gp = ouvrir_script(fig, "plot_boxplot.gp", "Distribution des populations finales (20 ans, 30 réplications)",
+                             "Condition initiale", "Population finale");
     if (!gp)
         return;
-
-    fprintf(gp, "set terminal png size 1200,800 font 'Arial,14'\n");
-    fprintf(gp, "set output 'boxplot_populations.png'\n");
-    fprintf(gp, "set title 'Distribution des populations finales (20 ans, 30 réplications)'\n");
-    fprintf(gp, "set ylabel 'Population finale'\n");
-    fprintf(gp, "set xlabel 'Condition initiale'\n");
     fprintf(gp, "set xtics ('10×10' 1, '50×50' 2, '100×100' 3)\n");
     fprintf(gp, "set grid y\n");
     fprintf(gp, "set style fill solid 0.3\n");
     fprintf(gp, "set boxwidth 0.4\n");
     fprintf(gp, "plot 'boxplot_data.dat' using 1:2 with boxplot notitle\n");
-
     fclose(gp);
+}
 
-    if (system("gnuplot plot_boxplot.gp") == 0)
+/**
+ * @brief Prépare le boxplot: 3 conditions, BOXPLOT_REP réplications
+ *
+ * Avec --processus, le balayage est fait tout de suite par des processus
+ * fils, avant le démarrage des threads.
+ *
+ * @return 1 si les simulations sont déjà faites, 0 si elles restent à faire, -1 en cas d'échec
+ */
+int preparer_boxplot(figure *fig)
+{
+    figure_init(fig, "boxplot", "boxplot_populations.png", 3 * BOXPLOT_REP, ecrire_boxplot);
+    for (int cond = 0; cond < 3; cond++)
+        for (int rep = 0; rep < BOXPLOT_REP; rep++)
+            definir_simulation(fig, cond * BOXPLOT_REP + rep, conditions[cond][0], conditions[cond][1],
+                               BOXPLOT_ANNEES, 10000 + rep);
+
+    if (nb_processus <= 0)
+        return 0;
+
+    // Balayage réparti sur des processus fils
+    balayage_boxplot balayage = {conditions, BOXPLOT_REP, BOXPLOT_ANNEES};
+    printf("  Boxplot : %d simulations sur %d processus...", fig->nb, nb_processus);
+    fflush(stdout);
+    if (executer_shards(fig->nb, nb_processus, 3, tache_boxplot, &balayage, fig->resultats, NULL) != 0)
     {
-        printf("✓ Graphique généré : boxplot_populations.png\n");
+        printf(" ÉCHEC\n");
+        return -1;
     }
+    printf(" OK\n");
+    atomic_store(&fig->restantes, 0);
+    return 1;
 }
 
 /**
- * @brief Génère un graphique de comparaison simple
+ * @brief Écrit les données et le script de la comparaison des conditions
  */
-void graphique_comparaison_simple()
+void ecrire_comparaison(figure *fig)
 {
-    printf("\n=== Génération graphique de comparaison ===\n");
-
-    int conditions[][2] = {{10, 10}, {50, 50}, {100, 100}};
-    const char *labels[] = {"10x10", "50x50", "100x100"};
-    int annees_max = 15;
-
     FILE *f = fopen("comparaison_data.dat", "w");
     if (!f)
         return;
 
     fprintf(f, "# Annees Pop_10x10 Pop_50x50 Pop_100x100\n");
-
-    for (int annee = 0; annee <= annees_max; annee++)
+    for (int annee = 0; annee <= COMPARAISON_ANNEES; annee++)
     {
         fprintf(f, "%d", annee);
-
         for (int cond = 0; cond < 3; cond++)
-        {
-            if (annee == 0)
-            {
-                printf("  Condition %s : simulation...", labels[cond]);
-                fflush(stdout);
-            }
-
-            unsigned long pop = simuler_finale(
-                conditions[cond][0], conditions[cond][1],
-                annee, 5000 + cond);
-            fprintf(f, " %lu", pop);
-        }
+            fprintf(f, " %.0f", fig->resultats[annee * 3 + cond].total);
         fprintf(f, "\n");
-
-        if (annee == 0)
-            printf(" OK\n");
     }
-
     fclose(f);
 
-    // Script gnuplot
-    FILE *gp = fopen("plot_comparaison.gp", "w");
+    FILE *gp = ouvrir_script(fig, "plot_comparaison.gp", "Évolution selon les conditions initiales", "Années",
+                             "Population totale");
     if (!gp)
         return;
-
-    fprintf(gp, "set terminal png size 1200,800 font 'Arial,14'\n");
-    fprintf(gp, "set output 'comparaison_populations.png'\n");
-    fprintf(gp, "set title 'Évolution selon les conditions initiales'\n");
-    fprintf(gp, "set xlabel 'Années'\n");
-    fprintf(gp, "set ylabel 'Population totale'\n");
     fprintf(gp, "set grid\n");
     fprintf(gp, "set key top left\n");
     fprintf(gp, "plot 'comparaison_data.dat' u 1:2 w lp lw 2 title '10×10', \\\n");
     fprintf(gp, "     'comparaison_data.dat' u 1:3 w lp lw 2 title '50×50', \\\n");
     fprintf(gp, "     'comparaison_data.dat' u 1:4 w lp lw 2 title '100×100'\n");
-
     fclose(gp);
-
-    if (system("gnuplot plot_comparaison.gp") == 0)
-    {
-        printf("✓ Graphique généré : comparaison_populations.png\n");
-    }
 }
 
 /**
- * @brief Génère un graphique de variabilité
+ * @brief Prépare la comparaison: chaque condition simulée sur 0 à COMPARAISON_ANNEES ans
  */
-void graphique_variabilite()
+void preparer_comparaison(figure *fig)
 {
-    printf("\n=== Génération graphique de variabilité ===\n");
-
-    int nb_rep = 8;      // Réduit de 10 à 8
-    int annees_max = 12; // Réduit de 15 à 12
+    figure_init(fig, "comparaison", "comparaison_populations.png", (COMPARAISON_ANNEES + 1) * 3, ecrire_comparaison);
+    for (int annee = 0; annee <= COMPARAISON_ANNEES; annee++)
+        for (int cond = 0; cond < 3; cond++)
+            // Même graine pour toutes les conditions (nombres aléatoires communs)
+            definir_simulation(fig, annee * 3 + cond, conditions[cond][0], conditions[cond][1], annee, 5000);
+}
 
+/**
+ * @brief Écrit les données et le script de la variabilité
+ */
+void ecrire_variabilite(figure *fig)
+{
     FILE *f = fopen("variabilite_data.dat", "w");
     if (!f)
         return;
 
     fprintf(f, "# Annees");
-    for (int rep = 0; rep < nb_rep; rep++)
-    {
+    for (int rep = 0; rep < VARIABILITE_REP; rep++)
         fprintf(f, " Rep%d", rep + 1);
-    }
     fprintf(f, "\n");
-
-    for (int annee = 0; annee <= annees_max; annee++)
+    for (int annee = 0; annee <= VARIABILITE_ANNEES; annee++)
     {
         fprintf(f, "%d", annee);
-
-        if (annee % 5 == 0)
-        {
-            printf("  Année %d...", annee);
-            fflush(stdout);
-        }
-
-        for (int rep = 0; rep < nb_rep; rep++)
-        {
-            unsigned long pop = simuler_finale(100, 100, annee, 7000 + rep * 100);
-            fprintf(f, " %lu", pop);
-        }
+        for (int rep = 0; rep < VARIABILITE_REP; rep++)
+            fprintf(f, " %.0f", fig->resultats[annee * VARIABILITE_REP + rep].total);
         fprintf(f, "\n");
-
-        if (annee % 5 == 0)
-            printf(" OK\n");
     }
-
     fclose(f);
 
-    // Script gnuplot
-    FILE *gp = fopen("plot_variabilite.gp", "w");
+    FILE *gp = ouvrir_script(fig, "plot_variabilite.gp", "Variabilité stochastique (100×100, 10 réplications)",
+                             "Années", "Population totale");
     if (!gp)
         return;
-
-    fprintf(gp, "set terminal png size 1200,800 font 'Arial,14'\n");
-    fprintf(gp, "set output 'variabilite_populations.png'\n");
-    fprintf(gp, "set title 'Variabilité stochastique (100×100, 10 réplications)'\n");
-    fprintf(gp, "set xlabel 'Années'\n");
-    fprintf(gp, "set ylabel 'Population totale'\n");
     fprintf(gp, "set grid\n");
     fprintf(gp, "set key outside\n");
     fprintf(gp, "plot ");
-
-    for (int rep = 0; rep < nb_rep; rep++)
+    for (int rep = 0; rep < VARIABILITE_REP; rep++)
     {
-        fprintf(gp, "'variabilite_data.dat' u 1:%d w l lw 1.5 title 'Rep %d'",
-                rep + 2, rep + 1);
-        if (rep < nb_rep - 1)
+        fprintf(gp, "'variabilite_data.dat' u 1:%d w l lw 1.5 title 'Rep %d'", rep + 2, rep + 1);
+        if (rep < VARIABILITE_REP - 1)
             fprintf(gp, ", \\\n     ");
     }
     fprintf(gp, "\n");
-
     fclose(gp);
+}
 
-    if (system("gnuplot plot_variabilite.gp") == 0)
-    {
-        printf("✓ Graphique généré : variabilite_populations.png\n");
-    }
+/**
+ * @brief Prépare la variabilité: VARIABILITE_REP réplications 100×100 sur 0 à VARIABILITE_ANNEES ans
+ */
+void preparer_variabilite(figure *fig)
+{
+    figure_init(fig, "variabilité", "variabilite_populations.png", (VARIABILITE_ANNEES + 1) * VARIABILITE_REP,
+                ecrire_variabilite);
+    for (int annee = 0; annee <= VARIABILITE_ANNEES; annee++)
+        for (int rep = 0; rep < VARIABILITE_REP; rep++)
+            definir_simulation(fig, annee * VARIABILITE_REP + rep, 100, 100, annee, 7000 + rep * 100);
 }
 
 /**
  * @brief Programme principal
+ *
+ * Les simulations des trois figures forment une seule file, partagée par
+ * les threads de calcul (les plus longues d'abord). Dès qu'une figure est
+ * complète, l'écrivain écrit ses données et confie son rendu à un processus
+ * gnuplot en arrière-plan.
  */
-int main()
+int main(int argc, char *argv[])
 {
+    // Options: --processus N (balayage du boxplot réparti sur N processus fils)
+    //          --params fichier (jeu de paramètres biologiques)
+    //          --ensemble (réplications simulées par groupes de NB_VOIES)
+    //          --threads N (threads de calcul, nombre de cœurs par défaut)
+    //          --cache fichier (simulations du moteur mensuel déjà faites relues dans le fichier)
+    const char *fichier_params = NULL;
+    const char *fichier_cache = NULL;
+    int nb_threads = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--processus") == 0 && i + 1 < argc)
+            nb_processus = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--ensemble") == 0)
+            mode_ensemble = 1;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nb_threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            fichier_cache = argv[++i];
+        else
+        {
+            printf("Usage : %s [--processus N] [--params fichier] [--ensemble] [--threads N] [--cache fichier]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (nb_threads <= 0)
+        nb_threads = nb_threads_defaut();
+
     printf("╔═══════════════════════════════════════════════╗\n");
     printf("║  Génération de graphiques - Simulation Lapins ║\n");
     printf("╚═══════════════════════════════════════════════╝\n");
 
     // Initialiser les paramètres
-    init_prob_litter();
-    init_survival_rate();
+    params_t *p = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!p)
+        return 1;
+    params = p;
+    cache_resultats *cache = NULL;
+    if (fichier_cache)
+    {
+        cache = cache_ouvrir(fichier_cache, CASES_CACHE_DEFAUT);
+        if (!cache)
+        {
+            params_liberer(p);
+            return 1;
+        }
+        replication_utiliser_cache(cache);
+    }
+
+    // Un gnuplot absent ferme son tube: l'écriture ne doit pas tuer le programme
+    signal(SIGPIPE, SIG_IGN);
+
+    figure figures[3];
+    preparer_comparaison(&figures[0]);
+    preparer_variabilite(&figures[1]);
+    int boxplot = preparer_boxplot(&figures[2]); // Processus fils lancés avant les threads
+
+    pipeline pl = {0};
+    int max_taches = 0;
+    for (int i = 0; i < 3; i++)
+        max_taches += figures[i].nb;
+    pl.taches = malloc(max_taches * sizeof(tache_figure));
+    atomic_init(&pl.prochaine, 0);
+    pthread_mutex_init(&pl.verrou, NULL);
+    pthread_cond_init(&pl.prete, NULL);
+    for (int i = 0; i < 3; i++)
+    {
+        if (i == 2 && boxplot != 0)
+            continue;
+        ajouter_taches(&pl, &figures[i]);
+        pl.a_ecrire++;
+    }
+    qsort(pl.taches, pl.nb_taches, sizeof(tache_figure), comparer_taches);
+    if (boxplot == 1)
+    {
+        pl.a_ecrire++;
+        figure_prete(&pl, &figures[2]);
+    }
 
-    // Générer les graphiques
-    graphique_comparaison_simple();
-    graphique_variabilite();
-    graphique_boxplot();
+    printf("\n%d tâches de simulation sur %d threads...\n", pl.nb_taches, nb_threads);
+    fflush(stdout);
+    pthread_t ecrivain;
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    pthread_create(&ecrivain, NULL, thread_ecrivain, &pl);
+    for (int t = 0; t < nb_threads; t++)
+        pthread_create(&threads[t], NULL, thread_calcul, &pl);
+    for (int t = 0; t < nb_threads; t++)
+        pthread_join(threads[t], NULL);
+    pthread_join(ecrivain, NULL);
+
+    // Attente des rendus gnuplot encore en cours
+    int nb_images = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (figures[i].gnuplot && pclose(figures[i].gnuplot) == 0)
+        {
+            printf("✓ Graphique généré : %s\n", figures[i].image);
+            nb_images++;
+        }
+        else
+        {
+            printf("✗ Graphique non généré : %s (gnuplot disponible ?)\n", figures[i].image);
+        }
+        free(figures[i].simulations);
+        free(figures[i].resultats);
+    }
 
-    printf("\n=== Tous les graphiques générés ! ===\n");
+    if (nb_images == 3)
+        printf("\n=== Tous les graphiques générés ! ===\n");
     printf("\nFichiers PNG créés :\n");
     printf("  • comparaison_populations.png - Comparaison 3 conditions\n");
     printf("  • variabilite_populations.png - Variabilité stochastique\n");
     printf("  • boxplot_populations.png     - Distribution finale\n");
     printf("\nFichiers de données (.dat) et scripts gnuplot (.gp) disponibles.\n");
 
-    return 0;
+    pthread_mutex_destroy(&pl.verrou);
+    pthread_cond_destroy(&pl.prete);
+    free(pl.taches);
+    free(threads);
+    if (cache)
+    {
+        long succes, echecs;
+        cache_statistiques(cache, &succes, &echecs);
+        printf("Cache %s : %ld simulations relues, %ld calculées\n", fichier_cache, succes, echecs);
+        replication_utiliser_cache(NULL);
+        cache_fermer(cache);
+    }
+    params_liberer(p);
+    return boxplot < 0;
 }
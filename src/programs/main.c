@@ -7,35 +7,191 @@
  */
 
 #include "simulation.h"
+#include "config.h"
 #include "population.h"
+#include "saut.h"
+#include "abondance.h"
+#include "historique.h"
+#include "parallele.h"
+#include "compact.h"
+#include <string.h>
 #include <time.h>
 
 /**
  * @brief Fonction principale du programme
  * @return 0 en cas de succès
  */
-int main()
+int main(int argc, char *argv[])
 {
+    // Options: --params fichier, --saut [pas_max], --detail-ages, --abondance [seuil], --annees n,
+    //          --historique fichier, --threads n, --planning, --compact
+    const char *fichier_params = NULL;
+    const char *fichier_historique = NULL;
+    int mode_saut = 0;
+    int detail_ages = 0;
+    int planning_portees = 0;
+    int mode_compact = 0;
+    int mode_abondance = 0;
+    int annees = 100;
+    int nb_threads = 0;
+    options_saut opt = options_saut_defaut();
+    options_abondance opt_abondance = options_abondance_defaut();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+        {
+            fichier_params = argv[++i];
+        }
+        else if (strcmp(argv[i], "--saut") == 0)
+        {
+            mode_saut = 1;
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                opt.pas_max = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--detail-ages") == 0)
+        {
+            detail_ages = 1;
+        }
+        else if (strcmp(argv[i], "--abondance") == 0)
+        {
+            mode_abondance = 1;
+            if (i + 1 < argc && atof(argv[i + 1]) > 0)
+                opt_abondance.seuil = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            annees = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--historique") == 0 && i + 1 < argc)
+        {
+            fichier_historique = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            nb_threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--planning") == 0)
+        {
+            planning_portees = 1;
+        }
+        else if (strcmp(argv[i], "--compact") == 0)
+        {
+            mode_compact = 1;
+        }
+        else
+        {
+            printf("Usage : %s [--params fichier] [--saut [pas_max]] [--detail-ages] [--abondance [seuil]] [--annees n]"
+                   " [--historique fichier] [--threads n] [--planning] [--compact]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (fichier_historique && (mode_saut || mode_abondance))
+    {
+        printf("L'historique enregistre chaque mois: il n'est pas compatible avec --saut et --abondance\n");
+        return 1;
+    }
+    if (nb_threads && (mode_saut || mode_abondance || fichier_historique))
+    {
+        printf("--threads s'applique au moteur mensuel seul (sans --saut, --abondance ni --historique)\n");
+        return 1;
+    }
+    if (mode_compact && (mode_saut || mode_abondance || fichier_historique || nb_threads))
+    {
+        printf("--compact est un moteur à part entière: il n'est pas compatible avec --saut, --abondance,"
+               " --historique ni --threads\n");
+        return 1;
+    }
+    if (opt.pas_max < 2 || opt.pas_max > PAS_SAUT_MAX)
+    {
+        printf("Le pas du mode saut doit être compris entre 2 et %d mois\n", PAS_SAUT_MAX);
+        return 1;
+    }
+
     // Initialisation des taux de survie et probabilités
-    init_survival_rate();
-    init_prob_litter();
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    if (detail_ages || planning_portees)
+    {
+        // Un compteur par âge adulte au lieu de la classe regroupée
+        params->detail_ages |= detail_ages;
+        // Mois de mise bas tirés à l'attribution des portées
+        params->planning_portees |= planning_portees;
+        params_finaliser(params);
+    }
+    if (params->planning_portees && (mode_saut || mode_abondance || nb_threads || mode_compact))
+    {
+        printf("Le planning des mises bas s'applique au moteur mensuel seul (sans --saut, --abondance, --threads"
+               " ni --compact)\n");
+        params_liberer(params);
+        return 1;
+    }
 
     // Initialisation de la population de départ (100 femelles et 100 mâles)
     mpz_t nbFemale, nbMale;
     mpz_init_set_ui(nbFemale, 100);
     mpz_init_set_ui(nbMale, 100);
 
-    // Simulation sur 100 ans
-    population *pop = simulate_population(nbFemale, nbMale, 100);
+    // Mode abondance: compteurs flottants au-delà du seuil
+    if (mode_abondance)
+    {
+        population_abondance *pa = simulate_population_abondance(params, nbFemale, nbMale, annees, &opt_abondance,
+                                                                  mode_saut ? &opt : NULL);
+        printf("\n===== POPULATION FINALE (après %d ans) =====\n", annees);
+        afficher_abondance(pa);
+        mpz_clear(nbFemale);
+        mpz_clear(nbMale);
+        liberer_abondance(pa);
+        params_liberer(params);
+        return 0;
+    }
+
+    // Simulation sur le nombre d'années demandé (100 par défaut)
+    population *pop;
+    if (mode_saut)
+    {
+        bilan_saut bilan;
+        pop = simulate_population_saut(params, nbFemale, nbMale, annees, &opt, &bilan);
+        printf("Mode saut : %d mois pas à pas, %d sauts de %d mois (%d mois)\n",
+               bilan.mois_mensuels, bilan.nb_sauts, opt.pas_max, bilan.mois_sautes);
+    }
+    else if (fichier_historique)
+    {
+        // Grille complète de chaque mois, codée en différences
+        historique *h = historique_creer(INTERVALLE_CLE_DEFAUT);
+        pop = simulate_population_historique(params, nbFemale, nbMale, annees, h);
+        if (historique_sauver(h, fichier_historique) == 0)
+        {
+            printf("Historique : %d mois, %zu octets (%.0f octets par mois) dans %s\n", h->nb_mois,
+                   historique_taille(h), (double)historique_taille(h) / h->nb_mois, fichier_historique);
+        }
+        historique_liberer(h);
+    }
+    else if (nb_threads)
+    {
+        // Un mois réparti sur plusieurs threads, même trajectoire quel que soit leur nombre
+        pop = simulate_population_parallele(params, nbFemale, nbMale, annees, nb_threads);
+    }
+    else if (mode_compact)
+    {
+        // Compteurs de 64 bits en tableaux contigus, relais GMP au-delà de 2^50 lapins
+        pop = simulate_population_compacte(params, nbFemale, nbMale, annees);
+    }
+    else
+    {
+        pop = simulate_population(params, nbFemale, nbMale, annees);
+    }
 
     // Affichage de la population finale
-    printf("\n===== POPULATION FINALE (après 100 ans) =====\n");
+    printf("\n===== POPULATION FINALE (après %d ans) =====\n", annees);
     afficher_pop(pop, 1);
 
     // Nettoyage de la mémoire
     mpz_clear(nbFemale);
     mpz_clear(nbMale);
-    free(pop);
+    liberer_population(pop);
+    params_liberer(params);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+/**
+ * @file mlmc.c
+ * @brief Population finale moyenne par Monte-Carlo multiniveau
+ *
+ * Estime la population finale moyenne du moteur mensuel par Monte-Carlo
+ * multiniveau (multiniveau.h), affiche les statistiques de chaque niveau et
+ * compare le coût de l'estimation à celui de simulations mensuelles seules
+ * de même précision. Avec --reference N, N simulations mensuelles
+ * indépendantes sont aussi lancées comme référence.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "replication.h"
+#include "multiniveau.h"
+#include "outils.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Lit une liste de seuils séparés par des virgules
+ *
+ * @param texte Liste (ex. « 100,1000 »)
+ * @param seuil_fin Seuil gaussien du niveau le plus fin
+ * @param opt Réglages dont les niveaux grossiers sont remplacés
+ * @return 0, -1 si la liste n'est pas strictement croissante, positive et sous seuil_fin
+ */
+static int lire_seuils(const char *texte, unsigned long seuil_fin, options_mlmc *opt)
+{
+    opt->nb_grossiers = 0;
+    char *fin;
+    while (*texte && opt->nb_grossiers < NIVEAUX_MLMC_MAX - 1)
+    {
+        long seuil = strtol(texte, &fin, 10);
+        if (fin == texte || seuil < 1 || (unsigned long)seuil >= seuil_fin ||
+            (opt->nb_grossiers > 0 && (unsigned long)seuil <= opt->seuils[opt->nb_grossiers - 1]))
+            return -1;
+        opt->seuils[opt->nb_grossiers++] = seuil;
+        texte = (*fin == ',') ? fin + 1 : fin;
+    }
+    return (*texte || opt->nb_grossiers == 0) ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Options: --femelles N, --males N, --annees N, --seuils a,b,... (seuils gaussiens croissants
+    //          des niveaux grossiers), --precision h (demi-largeur relative), --initial N,
+    //          --budget N, --reference N, --params fichier, --graine N, --threads N
+    int nb_femelles = 10, nb_males = 10, annees = 10, nb_threads = 0;
+    long nb_reference = 0;
+    unsigned long graine = 2024;
+    const char *fichier_params = NULL;
+    const char *seuils = NULL;
+    options_mlmc opt = options_mlmc_defaut();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--femelles") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_femelles = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--males") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+            nb_males = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            annees = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seuils") == 0 && i + 1 < argc)
+            seuils = argv[++i];
+        else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0)
+            opt.demi_largeur_relative = atof(argv[++i]);
+        else if (strcmp(argv[i], "--initial") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            opt.nb_initial = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc && atol(argv[i + 1]) > 1)
+            opt.budget = atol(argv[++i]);
+        else if (strcmp(argv[i], "--reference") == 0 && i + 1 < argc && atol(argv[i + 1]) > 1)
+            nb_reference = atol(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            graine = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nb_threads = atoi(argv[++i]);
+        else
+        {
+            printf("Usage : %s [--femelles N] [--males N] [--annees N] [--seuils a,b,...] [--precision h]"
+                   " [--initial N] [--budget N] [--reference N] [--params fichier] [--graine N] [--threads N]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    opt.nb_threads = nb_threads;
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    unsigned long seuil_fin = params->seuil_gaussien;
+    if (seuils && lire_seuils(seuils, seuil_fin, &opt) != 0)
+    {
+        fprintf(stderr, "Erreur : --seuils attend des seuils entiers strictement croissants, sous %lu\n", seuil_fin);
+        params_liberer(params);
+        return 1;
+    }
+    scenario sc = {nb_femelles, nb_males, annees, params};
+
+    printf("Population après %d ans de %d femelles et %d mâles : Monte-Carlo multiniveau,"
+           " %d niveaux, demi-largeur visée %.3g%%\n",
+           annees, nb_femelles, nb_males, opt.nb_grossiers + 1, 100 * opt.demi_largeur_relative);
+    printf("(niveau Gs: tirages gaussiens dès s individus, G%lu = moteur mensuel courant)\n\n", seuil_fin);
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    estimation_mlmc est;
+    estimer_mlmc(sc, &opt, graine, &est);
+    double duree = secondes_depuis(&debut);
+
+    // « écart-type » et « coût » comptent un octet de plus que de colonnes (UTF-8)
+    printf("%-20s %10s %14s %15s %13s\n", "Niveau", "N", "moyenne", "écart-type", "coût (ms)");
+    for (int l = 0; l < est.nb_niveaux; l++)
+    {
+        char niveau[64];
+        unsigned long seuil = (l < opt.nb_grossiers) ? opt.seuils[l] : seuil_fin;
+        if (l == 0)
+            snprintf(niveau, sizeof(niveau), "G%lu", seuil);
+        else
+            snprintf(niveau, sizeof(niveau), "G%lu - G%lu", seuil, opt.seuils[l - 1]);
+        const niveau_mlmc *n = &est.niveaux[l];
+        printf("%-20s %10ld %14.6g %14.4g %12.3f\n", niveau, n->nb, n->moyenne, sqrt(n->variance),
+               1e3 * n->cout);
+    }
+    printf("\nPopulation finale moyenne : %.6g ± %.3g (IC 95%%)%s\n", est.moyenne, est.demi_largeur,
+           est.precision_atteinte ? "" : ", budget atteint avant la précision visée");
+    printf("Coût : %.3g s de calcul (%.1f s écoulées)\n", est.cout, duree);
+
+    // Simulations du niveau le plus fin seul de même précision: V (1,96 / h)^2 simulations
+    if (est.demi_largeur > 0)
+    {
+        double nb_equivalent = est.variance_fine * pow(1.96 / est.demi_largeur, 2);
+        double cout_equivalent = nb_equivalent * est.cout_fin;
+        printf("Simulations G%lu seules de même précision : %.3g simulations, %.3g s de calcul (x%.3g)\n",
+               seuil_fin, nb_equivalent, cout_equivalent, cout_equivalent / est.cout);
+    }
+
+    if (nb_reference > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        estimation_mlmc ref;
+        estimer_reference(sc, nb_reference, nb_threads, graine, &ref);
+        printf("\nRéférence (%ld simulations G%lu) : %.6g ± %.3g (IC 95%%), %.3g s de calcul"
+               " (%.1f s écoulées)\n",
+               nb_reference, seuil_fin, ref.moyenne, ref.demi_largeur, ref.cout, secondes_depuis(&debut));
+    }
+
+    params_liberer(params);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file outils.c
+ * @brief Implémentation des fonctions utilitaires communes aux programmes
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime
+
+#include "outils.h"
+
+/**
+ * @brief Durée écoulée depuis un instant
+ * @param debut Instant de départ (CLOCK_MONOTONIC)
+ * @return Durée en secondes
+ */
+double secondes_depuis(const struct timespec *debut)
+{
+    struct timespec fin;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    return (fin.tv_sec - debut->tv_sec) + (fin.tv_nsec - debut->tv_nsec) * 1e-9;
+}
+
+/**
+ * @brief Comparaison de réels pour qsort (ordre croissant)
+ * @param a Premier réel
+ * @param b Second réel
+ * @return Négatif, nul ou positif selon que *a est inférieur, égal ou supérieur à *b
+ */
+int comparer_reels(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Largeur à passer à printf pour aligner un texte UTF-8
+ * @param texte Texte de la colonne
+ * @param largeur Largeur voulue en caractères
+ * @return Largeur à passer à printf
+ */
+int largeur_utf8(const char *texte, int largeur)
+{
+    for (; *texte; texte++)
+        if ((*texte & 0xC0) == 0x80)
+            largeur++;
+    return largeur;
+}
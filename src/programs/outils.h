@@ -0,0 +1,42 @@
+/**
+ * @file outils.h
+ * @brief Fonctions utilitaires communes aux programmes
+ *
+ * Chronométrage, tri de réels et alignement des colonnes de texte UTF-8 des
+ * tableaux affichés par les programmes de validation, de sensibilité, de
+ * calibration, d'extinction et de Monte-Carlo multiniveau.
+ */
+
+#ifndef OUTILS_H
+#define OUTILS_H
+
+#include <time.h>
+
+/**
+ * @brief Durée écoulée depuis un instant
+ * @param debut Instant de départ (CLOCK_MONOTONIC)
+ * @return Durée en secondes
+ */
+double secondes_depuis(const struct timespec *debut);
+
+/**
+ * @brief Comparaison de réels pour qsort (ordre croissant)
+ * @param a Premier réel
+ * @param b Second réel
+ * @return Négatif, nul ou positif selon que *a est inférieur, égal ou supérieur à *b
+ */
+int comparer_reels(const void *a, const void *b);
+
+/**
+ * @brief Largeur à passer à printf pour aligner un texte UTF-8
+ *
+ * printf compte des octets: la largeur est augmentée d'un octet par octet
+ * de continuation (caractère accentué) du texte.
+ *
+ * @param texte Texte de la colonne
+ * @param largeur Largeur voulue en caractères
+ * @return Largeur à passer à printf
+ */
+int largeur_utf8(const char *texte, int largeur);
+
+#endif // OUTILS_H
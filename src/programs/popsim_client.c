@@ -0,0 +1,142 @@
+/**
+ * @file popsim_client.c
+ * @brief Client du démon de simulation: envoie une requête et mesure sa latence
+ *
+ * Envoie --requetes fois la même requête au démon (bin/demon), attend à
+ * chaque fois sa réponse de fin, puis affiche la population finale moyenne
+ * des réplications et la latence des requêtes (temps entre l'envoi et la
+ * réponse de fin, processus et connexion déjà établis).
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "serveur.h"
+#include "outils.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+int main(int argc, char *argv[])
+{
+    // Options: --socket chemin, --femelles N, --males N, --mois N, --replications N, --graine N,
+    //          --params fichier (valeurs envoyées avec la requête), --requetes N, --detail
+    const char *chemin = DEMON_SOCKET_DEFAUT;
+    const char *fichier_params = NULL;
+    int nb_requetes = 1, detail = 0;
+    requete_demon req;
+    memset(&req, 0, sizeof(req));
+    req.magique = DEMON_MAGIQUE;
+    req.mois = 12;
+    req.graine = 2024;
+    req.nb_femelles = 10;
+    req.nb_males = 10;
+    req.nb_replications = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            chemin = argv[++i];
+        else if (strcmp(argv[i], "--femelles") == 0 && i + 1 < argc)
+            req.nb_femelles = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--males") == 0 && i + 1 < argc)
+            req.nb_males = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--mois") == 0 && i + 1 < argc)
+            req.mois = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--replications") == 0 && i + 1 < argc)
+            req.nb_replications = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            req.graine = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--requetes") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            nb_requetes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--detail") == 0)
+            detail = 1;
+        else
+        {
+            printf("Usage : %s [--socket chemin] [--femelles N] [--males N] [--mois N] [--replications N]"
+                   " [--graine N] [--params fichier] [--requetes N] [--detail]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (fichier_params)
+    {
+        params_t *params = params_charger(fichier_params);
+        if (!params)
+            return 1;
+        valeurs_depuis_params(params, &req.valeurs);
+        req.options |= DEMON_VALEURS;
+        params_liberer(params);
+    }
+
+    int fd = serveur_connecter(chemin);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Erreur : aucun démon sur %s (lancer bin/demon)\n", chemin);
+        return 1;
+    }
+
+    double *latences = malloc(nb_requetes * sizeof(double));
+    double somme = 0, somme_carres = 0;
+    long nb_resultats = 0;
+    int statut = DEMON_OK;
+    for (int r = 0; r < nb_requetes && statut == DEMON_OK; r++)
+    {
+        struct timespec debut;
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        req.identifiant = r;
+        if (ecrire_complet(fd, &req, sizeof(req)) != 0)
+        {
+            fprintf(stderr, "Erreur : connexion au démon perdue\n");
+            statut = DEMON_REQUETE_INVALIDE;
+            break;
+        }
+        reponse_demon rep;
+        do
+        {
+            if (lire_complet(fd, &rep, sizeof(rep)) != 0)
+            {
+                fprintf(stderr, "Erreur : connexion au démon perdue\n");
+                rep.indice = DEMON_FIN;
+                rep.statut = DEMON_REQUETE_INVALIDE;
+            }
+            else if (rep.indice != DEMON_FIN && r == 0)
+            {
+                // Résultats de la première requête (les suivantes sont identiques)
+                if (detail)
+                    printf("Réplication %u (graine %llu) : %.0f bébés, %.0f mâles, %.0f femelles, total %.0f\n",
+                           rep.indice, (unsigned long long)(req.graine + rep.indice), rep.bebes, rep.males,
+                           rep.femelles, rep.total);
+                somme += rep.total;
+                somme_carres += rep.total * rep.total;
+                nb_resultats++;
+            }
+        } while (rep.indice != DEMON_FIN);
+        latences[r] = secondes_depuis(&debut);
+        statut = rep.statut;
+    }
+    close(fd);
+
+    if (statut != DEMON_OK)
+    {
+        fprintf(stderr, "Erreur : requête refusée par le démon (%s)\n",
+                statut == DEMON_PARAMS_INVALIDES ? "paramètres invalides" : "requête invalide");
+        free(latences);
+        return 1;
+    }
+
+    double moyenne = somme / nb_resultats;
+    double ecart_type = (nb_resultats > 1) ? sqrt(fmax(somme_carres - nb_resultats * moyenne * moyenne, 0) /
+                                                  (nb_resultats - 1))
+                                           : 0;
+    printf("%llu femelles, %llu mâles, %u mois, %u réplications : population finale moyenne %.6g"
+           " (écart-type %.3g)\n",
+           (unsigned long long)req.nb_femelles, (unsigned long long)req.nb_males, req.mois, req.nb_replications,
+           moyenne, ecart_type);
+    qsort(latences, nb_requetes, sizeof(double), comparer_reels);
+    printf("Latence sur %d requêtes : médiane %.1f µs, min %.1f µs, max %.1f µs\n", nb_requetes,
+           latences[nb_requetes / 2] * 1e6, latences[0] * 1e6, latences[nb_requetes - 1] * 1e6);
+    free(latences);
+    return 0;
+}
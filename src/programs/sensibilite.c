@@ -0,0 +1,487 @@
+/**
+ * @file sensibilite.c
+ * @brief Analyse de sensibilité des sorties aux paramètres biologiques
+ *
+ * Chaque paramètre biologique (poids des portées, maturité par mois d'âge,
+ * survie adulte par tranche, survie des bébés, proportion de mâles) varie
+ * sur une plage autour de sa valeur nominale: plus ou moins --plage en
+ * valeur relative, ou [0, PLAGE_ABSOLUE] pour une valeur nominale nulle,
+ * dans les bornes admises par params_finaliser(). Deux analyses sont faites:
+ * - Différences finies: effet moyen sur la sortie du passage de la borne
+ *   basse à la borne haute de la plage, les autres paramètres restant
+ *   nominaux. Les deux simulations d'une réplication partagent leur graine
+ *   (nombres aléatoires communs): la variance de leur écart est bien plus
+ *   faible que celle de deux simulations indépendantes (colonne « gain NAC »).
+ * - Indices de Sobol: indices du premier ordre et totaux, par les
+ *   estimateurs de Saltelli (S1) et de Jansen (ST), tous les paramètres
+ *   tirés uniformément sur leur plage. Les simulations d'un même point
+ *   d'échantillon (matrices A, B et A_B^j) partagent aussi leur graine.
+ *
+ * Les simulations sont indépendantes: elles sont réparties entre --threads
+ * threads, chacun avec son propre flux MT19937 et ses propres paramètres.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "population.h"
+#include "replication.h"
+#include "hachage.h"
+#include "mt19937ar-cok.h"
+#include "outils.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define PLAGE_ABSOLUE 0.05 // Plage d'un paramètre de valeur nominale nulle
+#define POPULATION_INITIALE 100 // Femelles et mâles au départ
+
+/**
+ * @brief Sortie de la simulation étudiée
+ */
+typedef enum sortie_etudiee
+{
+    SORTIE_CROISSANCE, // Taux de croissance annuel sur la seconde moitié de la durée
+    SORTIE_POPULATION  // Logarithme de la population finale
+} sortie_etudiee;
+
+/**
+ * @struct etude
+ * @brief Réglages communs à toutes les simulations de l'analyse
+ */
+typedef struct etude
+{
+    const params_t *nominal; // Paramètres nominaux
+    int annees;              // Durée de chaque simulation
+    sortie_etudiee sortie;   // Sortie étudiée
+    double plage;            // Demi-largeur relative de la plage des paramètres
+} etude;
+
+/**
+ * @struct evaluation
+ * @brief Une simulation: valeurs des paramètres, graine et sortie obtenue
+ */
+typedef struct evaluation
+{
+    double valeurs[NB_PARAMETRES]; // Valeurs des paramètres étudiés
+    unsigned long graine;          // Graine du flux MT19937
+    double sortie;                 // Sortie de la simulation (remplie par les threads)
+} evaluation;
+
+/**
+ * @struct file_evaluations
+ * @brief Évaluations partagées entre les threads de calcul
+ */
+typedef struct file_evaluations
+{
+    const etude *e;         // Réglages de l'étude
+    evaluation *evals;      // Évaluations à faire
+    int nb;                 // Nombre d'évaluations
+    atomic_int prochaine;   // Prochaine évaluation à prendre
+} file_evaluations;
+
+/**
+ * @brief Plage de variation du paramètre j, bornée aux valeurs admises
+ *
+ * Les poids des portées sont positifs, les autres paramètres sont des
+ * probabilités.
+ *
+ * @param e Étude
+ * @param j Indice du paramètre
+ * @param bas Borne basse de la plage
+ * @param haut Borne haute de la plage
+ */
+static void plage_parametre(const etude *e, int j, double *bas, double *haut)
+{
+    double v = *params_adresse((params_t *)e->nominal, j);
+    double h = (v != 0) ? e->plage * fabs(v) : PLAGE_ABSOLUE;
+    *bas = fmax(v - h, 0);
+    *haut = (j < 10) ? v + h : fmin(v + h, 1);
+}
+
+/**
+ * @brief Simule une évaluation et retourne la sortie étudiée
+ *
+ * Le flux MT19937 est réinitialisé au début de chaque mois par la clé
+ * (graine, mois). Deux simulations de même graine mais de paramètres
+ * différents ne consomment pas le même nombre de tirages: sans cette
+ * resynchronisation, leurs flux se décaleraient dès le premier écart et les
+ * nombres aléatoires ne seraient plus communs que pendant quelques mois.
+ *
+ * @param e Étude
+ * @param params Paramètres finalisés de l'évaluation
+ * @param graine Graine de la simulation
+ * @return Taux de croissance annuel ou logarithme de la population finale
+ */
+static double simuler_sortie(const etude *e, const params_t *params, unsigned long graine)
+{
+    unsigned long cle[2] = {graine, 0};
+    init_by_array(cle, 2);
+    mpz_t nbFemale, nbMale, total;
+    mpz_init_set_ui(nbFemale, POPULATION_INITIALE);
+    mpz_init_set_ui(nbMale, POPULATION_INITIALE);
+    mpz_init(total);
+    population *pop = initialize_population(params, nbFemale, nbMale);
+
+    int milieu = e->annees / 2;
+    double total_milieu = 0;
+    for (int m = 0; m < e->annees * NB_MONTHS; m++)
+    {
+        if (m == milieu * NB_MONTHS)
+        {
+            population_totale(pop, total);
+            total_milieu = mpz_get_d(total);
+        }
+        cle[1] = m + 1;
+        init_by_array(cle, 2);
+        simulate_month(pop);
+    }
+    population_totale(pop, total);
+    double total_final = mpz_get_d(total);
+
+    liberer_population(pop);
+    mpz_clears(nbFemale, nbMale, total, NULL);
+
+    // +1: une population éteinte garde une sortie finie
+    if (e->sortie == SORTIE_POPULATION)
+        return log(total_final + 1);
+    return log((total_final + 1) / (total_milieu + 1)) / (e->annees - milieu);
+}
+
+/**
+ * @brief Thread de calcul: prend les évaluations de la file jusqu'à épuisement
+ */
+static void *thread_evaluations(void *arg)
+{
+    file_evaluations *f = arg;
+    for (;;)
+    {
+        int i = atomic_fetch_add(&f->prochaine, 1);
+        if (i >= f->nb)
+            return NULL;
+
+        evaluation *ev = &f->evals[i];
+        params_t *params = params_copier(f->e->nominal);
+        for (int j = 0; j < NB_PARAMETRES; j++)
+            *params_adresse(params, j) = ev->valeurs[j];
+        // Plages déjà bornées aux valeurs admises: la finalisation ne peut échouer
+        params_finaliser(params);
+        ev->sortie = simuler_sortie(f->e, params, ev->graine);
+        params_liberer(params);
+    }
+}
+
+/**
+ * @brief Simule toutes les évaluations sur plusieurs threads
+ *
+ * @param e Étude
+ * @param evals Évaluations
+ * @param nb Nombre d'évaluations
+ * @param nb_threads Nombre de threads de calcul
+ */
+static void evaluer(const etude *e, evaluation *evals, int nb, int nb_threads)
+{
+    file_evaluations f = {e, evals, nb, 0};
+    atomic_init(&f.prochaine, 0);
+    pthread_t *threads = malloc(nb_threads * sizeof(pthread_t));
+    for (int t = 0; t < nb_threads; t++)
+        pthread_create(&threads[t], NULL, thread_evaluations, &f);
+    for (int t = 0; t < nb_threads; t++)
+        pthread_join(threads[t], NULL);
+    free(threads);
+}
+
+/**
+ * @brief Moyenne et écart-type de la moyenne d'une série
+ *
+ * @param x Valeurs
+ * @param n Nombre de valeurs (au moins 2)
+ * @param moyenne Moyenne
+ * @param erreur Écart-type de la moyenne
+ */
+static void moyenne_erreur(const double *x, int n, double *moyenne, double *erreur)
+{
+    double somme = 0, somme_carres = 0;
+    for (int i = 0; i < n; i++)
+        somme += x[i];
+    *moyenne = somme / n;
+    for (int i = 0; i < n; i++)
+        somme_carres += (x[i] - *moyenne) * (x[i] - *moyenne);
+    *erreur = sqrt(somme_carres / (n - 1) / n);
+}
+
+/**
+ * @brief Variance empirique d'une série
+ */
+static double variance(const double *x, int n)
+{
+    double moyenne, erreur;
+    moyenne_erreur(x, n, &moyenne, &erreur);
+    return erreur * erreur * n;
+}
+
+/**
+ * @struct sensibilite
+ * @brief Sensibilité de la sortie à un paramètre
+ */
+typedef struct sensibilite
+{
+    int indice;          // Indice du paramètre
+    double bas, haut;    // Plage du paramètre
+    double effet;        // Écart moyen de la sortie entre les bornes de la plage
+    double effet_erreur; // Écart-type de l'effet moyen
+    double gain_nac;     // Variance de l'écart sans graines communes / avec
+    double s1, s1_erreur; // Indice de Sobol du premier ordre et son écart-type
+    double st, st_erreur; // Indice de Sobol total et son écart-type
+} sensibilite;
+
+/**
+ * @brief Différences finies à nombres aléatoires communs
+ *
+ * La réplication r simule les deux bornes de chaque plage avec la graine
+ * graine + r.
+ *
+ * @param e Étude
+ * @param nb_rep Réplications par paramètre
+ * @param graine Graine de la première réplication
+ * @param nb_threads Nombre de threads de calcul
+ * @param sens Sensibilités à compléter (une par paramètre)
+ */
+static void differences_finies(const etude *e, int nb_rep, unsigned long graine, int nb_threads,
+                               sensibilite sens[])
+{
+    int nb = NB_PARAMETRES * nb_rep * 2;
+    evaluation *evals = malloc(nb * sizeof(evaluation));
+    double nominal[NB_PARAMETRES];
+    for (int j = 0; j < NB_PARAMETRES; j++)
+        nominal[j] = *params_adresse((params_t *)e->nominal, j);
+
+    for (int j = 0; j < NB_PARAMETRES; j++)
+        for (int r = 0; r < nb_rep; r++)
+            for (int b = 0; b < 2; b++)
+            {
+                evaluation *ev = &evals[(j * nb_rep + r) * 2 + b];
+                memcpy(ev->valeurs, nominal, sizeof(nominal));
+                ev->valeurs[j] = b ? sens[j].haut : sens[j].bas;
+                ev->graine = graine + r;
+            }
+    evaluer(e, evals, nb, nb_threads);
+
+    double *ecarts = malloc(nb_rep * sizeof(double));
+    double *bas = malloc(nb_rep * sizeof(double));
+    double *haut = malloc(nb_rep * sizeof(double));
+    for (int j = 0; j < NB_PARAMETRES; j++)
+    {
+        for (int r = 0; r < nb_rep; r++)
+        {
+            bas[r] = evals[(j * nb_rep + r) * 2].sortie;
+            haut[r] = evals[(j * nb_rep + r) * 2 + 1].sortie;
+            ecarts[r] = haut[r] - bas[r];
+        }
+        moyenne_erreur(ecarts, nb_rep, &sens[j].effet, &sens[j].effet_erreur);
+        double var_ecart = variance(ecarts, nb_rep);
+        sens[j].gain_nac = (var_ecart > 0) ? (variance(bas, nb_rep) + variance(haut, nb_rep)) / var_ecart : NAN;
+    }
+    free(ecarts);
+    free(bas);
+    free(haut);
+    free(evals);
+}
+
+/**
+ * @brief Indices de Sobol du premier ordre et totaux
+ *
+ * Le point i de l'échantillon simule les lignes i de A, de B et des d
+ * matrices A_B^j (A dont la colonne j vient de B) avec la graine graine + i.
+ *
+ * @param e Étude
+ * @param nb_points Points de l'échantillon
+ * @param graine Graine de l'échantillon et des simulations
+ * @param nb_threads Nombre de threads de calcul
+ * @param sens Sensibilités à compléter (une par paramètre)
+ * @param moyenne Moyenne de la sortie sur A et B
+ * @param var Variance de la sortie sur A et B
+ */
+static void indices_sobol(const etude *e, int nb_points, unsigned long graine, int nb_threads,
+                          sensibilite sens[], double *moyenne, double *var)
+{
+    const int par_point = NB_PARAMETRES + 2; // A, B puis A_B^j
+    int nb = nb_points * par_point;
+    evaluation *evals = malloc(nb * sizeof(evaluation));
+    uint64_t etat = graine;
+
+    for (int i = 0; i < nb_points; i++)
+    {
+        evaluation *a = &evals[i * par_point];
+        evaluation *b = a + 1;
+        for (int j = 0; j < NB_PARAMETRES; j++)
+        {
+            a->valeurs[j] = sens[j].bas + (sens[j].haut - sens[j].bas) * uniforme_splitmix(&etat);
+            b->valeurs[j] = sens[j].bas + (sens[j].haut - sens[j].bas) * uniforme_splitmix(&etat);
+        }
+        for (int j = 0; j < NB_PARAMETRES; j++)
+        {
+            evaluation *ab = a + 2 + j;
+            memcpy(ab->valeurs, a->valeurs, sizeof(a->valeurs));
+            ab->valeurs[j] = b->valeurs[j];
+        }
+        for (int k = 0; k < par_point; k++)
+            a[k].graine = graine + i;
+    }
+    evaluer(e, evals, nb, nb_threads);
+
+    double *ab_sorties = malloc(2 * nb_points * sizeof(double));
+    for (int i = 0; i < nb_points; i++)
+    {
+        ab_sorties[2 * i] = evals[i * par_point].sortie;
+        ab_sorties[2 * i + 1] = evals[i * par_point + 1].sortie;
+    }
+    double erreur;
+    moyenne_erreur(ab_sorties, 2 * nb_points, moyenne, &erreur);
+    *var = variance(ab_sorties, 2 * nb_points);
+
+    double *premier = malloc(nb_points * sizeof(double));
+    double *total = malloc(nb_points * sizeof(double));
+    for (int j = 0; j < NB_PARAMETRES; j++)
+    {
+        for (int i = 0; i < nb_points; i++)
+        {
+            double fa = evals[i * par_point].sortie;
+            double fb = evals[i * par_point + 1].sortie;
+            double fab = evals[i * par_point + 2 + j].sortie;
+            premier[i] = (fb - *moyenne) * (fab - fa); // Saltelli (2010), sortie centrée
+            total[i] = (fa - fab) * (fa - fab) / 2;    // Jansen (1999)
+        }
+        moyenne_erreur(premier, nb_points, &sens[j].s1, &sens[j].s1_erreur);
+        moyenne_erreur(total, nb_points, &sens[j].st, &sens[j].st_erreur);
+        double v = (*var > 0) ? *var : 1;
+        sens[j].s1 /= v;
+        sens[j].s1_erreur /= v;
+        sens[j].st /= v;
+        sens[j].st_erreur /= v;
+    }
+    free(premier);
+    free(total);
+    free(ab_sorties);
+    free(evals);
+}
+
+// Critère de classement du rapport: 1 pour l'indice total, 0 pour l'effet
+static int classer_par_sobol = 0;
+
+/**
+ * @brief Comparaison pour qsort: sensibilité décroissante
+ */
+static int comparer_sensibilites(const void *a, const void *b)
+{
+    const sensibilite *x = a, *y = b;
+    double cx = classer_par_sobol ? x->st : fabs(x->effet);
+    double cy = classer_par_sobol ? y->st : fabs(y->effet);
+    return (cx < cy) - (cx > cy);
+}
+
+int main(int argc, char *argv[])
+{
+    // Options: --sortie croissance|population, --annees N, --plage X, --replications N
+    //          (différences finies), --sobol N (points, 0: pas d'indices), --params fichier,
+    //          --graine N, --threads N
+    etude e = {NULL, 6, SORTIE_CROISSANCE, 0.1};
+    int nb_rep = 16;
+    int nb_points = 64;
+    int nb_threads = 0;
+    unsigned long graine = 2024;
+    const char *fichier_params = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sortie") == 0 && i + 1 < argc && strcmp(argv[i + 1], "croissance") == 0)
+            e.sortie = SORTIE_CROISSANCE, i++;
+        else if (strcmp(argv[i], "--sortie") == 0 && i + 1 < argc && strcmp(argv[i + 1], "population") == 0)
+            e.sortie = SORTIE_POPULATION, i++;
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            e.annees = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--plage") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0)
+            e.plage = atof(argv[++i]);
+        else if (strcmp(argv[i], "--replications") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            nb_rep = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sobol") == 0 && i + 1 < argc && (atoi(argv[i + 1]) > 1 || strcmp(argv[i + 1], "0") == 0))
+            nb_points = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            graine = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nb_threads = atoi(argv[++i]);
+        else
+        {
+            printf("Usage : %s [--sortie croissance|population] [--annees N] [--plage X] [--replications N]"
+                   " [--sobol N] [--params fichier] [--graine N] [--threads N]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (nb_threads <= 0)
+        nb_threads = nb_threads_defaut();
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    e.nominal = params;
+
+    sensibilite sens[NB_PARAMETRES];
+    for (int j = 0; j < NB_PARAMETRES; j++)
+    {
+        memset(&sens[j], 0, sizeof(sensibilite));
+        sens[j].indice = j;
+        plage_parametre(&e, j, &sens[j].bas, &sens[j].haut);
+    }
+
+    const char *nom_sortie = (e.sortie == SORTIE_CROISSANCE) ? "taux de croissance annuel (seconde moitié)"
+                                                             : "log de la population finale";
+    printf("Sensibilité du %s : %dx%d lapins, %d ans, plage ±%.0f%%, %d paramètres, %d threads\n",
+           nom_sortie, POPULATION_INITIALE, POPULATION_INITIALE, e.annees, e.plage * 100, NB_PARAMETRES,
+           nb_threads);
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    differences_finies(&e, nb_rep, graine, nb_threads, sens);
+    double duree_df = secondes_depuis(&debut);
+    printf("Différences finies : %d simulations en %.1f s\n", NB_PARAMETRES * nb_rep * 2, duree_df);
+
+    double moyenne = 0, var = 0;
+    if (nb_points > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        indices_sobol(&e, nb_points, graine + 1000000UL, nb_threads, sens, &moyenne, &var);
+        printf("Indices de Sobol : %d simulations en %.1f s (sortie : moyenne %.4g, écart-type %.4g)\n",
+               nb_points * (NB_PARAMETRES + 2), secondes_depuis(&debut), moyenne, sqrt(var));
+        classer_par_sobol = 1;
+    }
+
+    qsort(sens, NB_PARAMETRES, sizeof(sensibilite), comparer_sensibilites);
+    printf("\nClassement par %s\n", classer_par_sobol ? "indice de Sobol total" : "effet sur la plage");
+    printf("%4s %-*s %19s %10s %*s %8s", "rang", largeur_utf8("paramètre", 18), "paramètre", "plage", "effet",
+           largeur_utf8("é.-t.", 10), "é.-t.", "gain NAC");
+    if (nb_points > 0)
+        printf(" %7s %*s %7s %*s", "S1", largeur_utf8("é.-t.", 7), "é.-t.", "ST", largeur_utf8("é.-t.", 7), "é.-t.");
+    printf("\n");
+    for (int k = 0; k < NB_PARAMETRES; k++)
+    {
+        sensibilite *s = &sens[k];
+        char nom[32], plage[32];
+        params_nom(s->indice, nom, sizeof(nom));
+        snprintf(plage, sizeof(plage), "[%.4g, %.4g]", s->bas, s->haut);
+        printf("%4d %-18s %19s %10.3g %10.2g", k + 1, nom, plage, s->effet, s->effet_erreur);
+        if (isnan(s->gain_nac))
+            printf(" %8s", "-"); // Sortie insensible au paramètre sur cette durée
+        else
+            printf(" %8.1f", s->gain_nac);
+        if (nb_points > 0)
+            printf(" %7.3f %7.3f %7.3f %7.3f", s->s1, s->s1_erreur, s->st, s->st_erreur);
+        printf("\n");
+    }
+
+    params_liberer(params);
+    return 0;
+}
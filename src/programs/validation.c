@@ -0,0 +1,898 @@
+/**
+ * @file validation.c
+ * @brief Validation des tirages approchés: exactitude contre débit
+ *
+ * Le moteur mensuel remplace les tirages individuels par des approximations
+ * gaussiennes dès qu'un effectif atteint son seuil_gaussien. Ce programme mesure
+ * ce que coûte cette approximation:
+ * - Chaque loi approchée (binomiale, hypergéométrique, multinomiale, total de
+ *   bébés) est tirée sur une grille de paramètres et comparée à sa loi exacte
+ *   (test de Kolmogorov-Smirnov, écart de la moyenne et de la variance), avec
+ *   le temps par tirage de la version gaussienne et de la version individuelle
+ * - Les populations finales de plusieurs réglages des moteurs (seuil gaussien
+ *   par défaut ou abaissé, planning des mises bas, moteurs compact, saut,
+ *   abondance, ensemble et parallèle) sont comparées à une référence tout en
+ *   tirages individuels (test de Kolmogorov-Smirnov à deux
+ *   échantillons et écart des moyennes)
+ * - Les écarts gaussiens des flux direct et antithétique d'une graine doivent
+ *   former des paires de somme nulle
+ * - Les survivants de fondateurs sans naissances, suivis au-delà du dernier
+ *   âge de la classe adulte regroupée, sont comparés à ceux des âges
+ *   détaillés
+ *
+ * Le tableau obtenu permet d'accepter ou de rejeter une optimisation d'un
+ * tirage sur des données: elle doit garder la ligne « OK » et réduire le
+ * temps par tirage.
+ */
+
+#include "simulation.h"
+#include "config.h"
+#include "population.h"
+#include "reproduction.h"
+#include "replication.h"
+#include "compact.h"
+#include "saut.h"
+#include "abondance.h"
+#include "ensemble.h"
+#include "parallele.h"
+#include "mt19937ar-cok.h"
+#include "outils.h"
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define KS_CRITIQUE 1.628      // Valeur critique de Kolmogorov-Smirnov au risque de 1%
+#define Z_CRITIQUE 3.29        // Écart normalisé de la moyenne rejeté (bilatéral, risque 0,1%)
+#define FENETRE_ECARTS_TYPES 12 // Demi-largeur de la fenêtre de la loi exacte, en écarts-types
+#define BUDGET_EXACT 20000000.0 // Individus tirés au plus pour chronométrer une version exacte
+#define LARGEUR_LOI_MAX 100000000L // Valeurs au plus dans la fenêtre d'une loi exacte
+#define SEUIL_SAUT_VALIDATION 1000.0 // Effectif de cellule autorisant un saut (moteur saut)
+#define SEUIL_ABONDANCE_VALIDATION 1e5 // Population totale où la validation passe aux compteurs flottants
+
+/**
+ * @struct loi_exacte
+ * @brief Fonction de répartition exacte d'une loi discrète sur une fenêtre
+ *
+ * La masse hors de [debut, debut + largeur) est négligeable (au-delà de
+ * FENETRE_ECARTS_TYPES écarts-types).
+ */
+typedef struct loi_exacte
+{
+    long debut;        // Première valeur de la fenêtre
+    long largeur;      // Nombre de valeurs de la fenêtre
+    double *repart;    // repart[i] = P(X <= debut + i)
+    double moyenne;    // Espérance exacte
+    double variance;   // Variance exacte
+} loi_exacte;
+
+/**
+ * @struct ligne_tableau
+ * @brief Résultat d'un test de tirage
+ */
+typedef struct ligne_tableau
+{
+    double z;          // Écart normalisé de la moyenne empirique
+    double rapport_var; // Variance empirique / variance exacte
+    double d;          // Statistique de Kolmogorov-Smirnov
+    double d_critique; // Valeur critique au risque de 1%
+    double ns_gauss;   // Temps par tirage de l'approximation gaussienne (ns)
+    double ns_exact;   // Temps par tirage de la version individuelle (ns)
+} ligne_tableau;
+
+/**
+ * @brief Logarithme du coefficient binomial C(n, k)
+ */
+static double log_combinaisons(double n, double k)
+{
+    return lgamma(n + 1) - lgamma(k + 1) - lgamma(n - k + 1);
+}
+
+/**
+ * @brief Prépare la fenêtre d'une loi exacte autour de son espérance
+ *
+ * @param loi Loi à initialiser (repart alloué, à remplir par l'appelant)
+ * @param moyenne Espérance
+ * @param variance Variance
+ * @param min Plus petite valeur du support
+ * @param max Plus grande valeur du support
+ */
+static void fenetre_loi(loi_exacte *loi, double moyenne, double variance, long min, long max)
+{
+    double marge = FENETRE_ECARTS_TYPES * sqrt(variance) + 1;
+    long debut = (long)floor(moyenne - marge);
+    long fin = (long)ceil(moyenne + marge);
+    loi->debut = debut < min ? min : debut;
+    loi->largeur = (fin > max ? max : fin) - loi->debut + 1;
+    loi->repart = calloc(loi->largeur, sizeof(double));
+    loi->moyenne = moyenne;
+    loi->variance = variance;
+}
+
+/**
+ * @brief Cumule les probabilités de la fenêtre en fonction de répartition
+ * @param loi Loi dont repart contient les probabilités ponctuelles
+ */
+static void cumuler_loi(loi_exacte *loi)
+{
+    for (long i = 1; i < loi->largeur; i++)
+        loi->repart[i] += loi->repart[i - 1];
+}
+
+/**
+ * @brief Loi binomiale exacte B(n, p)
+ */
+static loi_exacte loi_binomiale(long n, double p)
+{
+    loi_exacte loi;
+    fenetre_loi(&loi, n * p, n * p * (1 - p), 0, n);
+    for (long i = 0; i < loi.largeur; i++)
+    {
+        long k = loi.debut + i;
+        loi.repart[i] = exp(log_combinaisons(n, k) + k * log(p) + (n - k) * log1p(-p));
+    }
+    cumuler_loi(&loi);
+    return loi;
+}
+
+/**
+ * @brief Loi hypergéométrique exacte: succès parmi n tirages sans remise
+ *
+ * @param total Nombre de boules de l'urne
+ * @param succes Nombre de boules gagnantes
+ * @param n Nombre de tirages
+ */
+static loi_exacte loi_hypergeometrique(long total, long succes, long n)
+{
+    double q = (double)succes / total;
+    loi_exacte loi;
+    long min = n - (total - succes) > 0 ? n - (total - succes) : 0;
+    fenetre_loi(&loi, n * q, n * q * (1 - q) * (total - n) / (total - 1.0), min, n < succes ? n : succes);
+    double log_norme = log_combinaisons(total, n);
+    for (long i = 0; i < loi.largeur; i++)
+    {
+        long k = loi.debut + i;
+        loi.repart[i] = exp(log_combinaisons(succes, k) + log_combinaisons(total - succes, n - k) - log_norme);
+    }
+    cumuler_loi(&loi);
+    return loi;
+}
+
+/**
+ * @brief Loi exacte des bits de k portées: B0 + 2 * B1, B0 et B1 binomiales(k, 1/2)
+ *
+ * Le total de bébés vaut 3k plus cette quantité (voir total_bebes()).
+ *
+ * @return Loi exacte, de fenêtre vide (repart NULL) si sa largeur dépasse LARGEUR_LOI_MAX
+ */
+static loi_exacte loi_bits_portees(long k)
+{
+    loi_exacte b = loi_binomiale(k, 0.5);
+    loi_exacte loi = {0};
+    if (b.largeur < 1 || b.largeur > LARGEUR_LOI_MAX)
+    {
+        fprintf(stderr, "Erreur : fenêtre de %ld valeurs pour la loi des bits de %ld portées\n", b.largeur, k);
+        free(b.repart);
+        return loi;
+    }
+    double *ponctuelle = malloc((size_t)b.largeur * sizeof(double));
+    for (long i = 0; i < b.largeur; i++)
+        ponctuelle[i] = b.repart[i] - (i ? b.repart[i - 1] : 0);
+
+    loi.debut = 3 * b.debut;
+    loi.largeur = 3 * (b.largeur - 1) + 1;
+    loi.repart = calloc((size_t)loi.largeur, sizeof(double));
+    loi.moyenne = 1.5 * k;
+    loi.variance = 1.25 * k;
+    for (long i = 0; i < b.largeur; i++)
+        for (long j = 0; j < b.largeur; j++)
+            loi.repart[i + 2 * j] += ponctuelle[i] * ponctuelle[j];
+    cumuler_loi(&loi);
+
+    free(ponctuelle);
+    free(b.repart);
+    return loi;
+}
+
+/**
+ * @brief Compare un échantillon à une loi exacte
+ *
+ * Les deux fonctions de répartition sont en escalier sur les entiers: leur
+ * plus grand écart est atteint en une valeur de la fenêtre.
+ *
+ * @param loi Loi exacte
+ * @param tirages Échantillon
+ * @param nb Taille de l'échantillon
+ * @param ligne Ligne où stocker z, rapport_var, d et d_critique
+ */
+static void comparer_loi(const loi_exacte *loi, const long *tirages, int nb, ligne_tableau *ligne)
+{
+    long *effectifs = calloc(loi->largeur, sizeof(long));
+    long dessous = 0;
+    double somme = 0, somme_carres = 0;
+    for (int i = 0; i < nb; i++)
+    {
+        long k = tirages[i] - loi->debut;
+        if (k < 0)
+            dessous++;
+        else if (k < loi->largeur)
+            effectifs[k]++;
+        double ecart = tirages[i] - loi->moyenne;
+        somme += ecart;
+        somme_carres += ecart * ecart;
+    }
+
+    double d = (double)dessous / nb;
+    long cumul = dessous;
+    for (long k = 0; k < loi->largeur; k++)
+    {
+        cumul += effectifs[k];
+        double ecart = fabs((double)cumul / nb - loi->repart[k]);
+        if (ecart > d)
+            d = ecart;
+    }
+    if (cumul < nb && 1 - loi->repart[loi->largeur - 1] < (double)(nb - cumul) / nb)
+        d = fmax(d, (double)(nb - cumul) / nb);
+
+    double moyenne_ecart = somme / nb;
+    ligne->z = moyenne_ecart / sqrt(loi->variance / nb);
+    ligne->rapport_var = (somme_carres / nb - moyenne_ecart * moyenne_ecart) / loi->variance;
+    ligne->d = d;
+    ligne->d_critique = KS_CRITIQUE / sqrt(nb);
+    free(effectifs);
+}
+
+/**
+ * @brief Affiche l'en-tête du tableau des tirages
+ */
+static void entete_tirages()
+{
+    printf("%-16s %-*s %8s %8s %8s %8s %10s %10s %8s\n", "Loi", largeur_utf8("Paramètres", 28), "Paramètres",
+           "z moy.", "var/att.", "D KS", "D crit.", "ns gauss.", "ns exact", "verdict");
+}
+
+/**
+ * @brief Affiche une ligne du tableau des tirages
+ * @return 1 si la loi approchée est rejetée
+ */
+static int afficher_ligne(const char *loi, const char *parametres, const ligne_tableau *l)
+{
+    int rejet = l->d > l->d_critique || fabs(l->z) > Z_CRITIQUE;
+    printf("%-*s %-*s %8.2f %8.3f %8.4f %8.4f %10.0f %10.0f %8s\n", largeur_utf8(loi, 16), loi,
+           largeur_utf8(parametres, 28), parametres, l->z, l->rapport_var, l->d, l->d_critique, l->ns_gauss,
+           l->ns_exact, rejet ? "REJET" : "OK");
+    return rejet;
+}
+
+/**
+ * @brief Nombre de tirages exacts chronométrés pour un coût de n individus par tirage
+ */
+static int tirages_exacts(int nb, double n)
+{
+    int budget = (int)(BUDGET_EXACT / n);
+    return budget < 1 ? 1 : (budget < nb ? budget : nb);
+}
+
+/**
+ * @brief Teste binomial_gaussian contre la loi binomiale exacte
+ *
+ * La version exacte est celle du moteur sous le seuil gaussien: une épreuve
+ * de Bernoulli par individu.
+ *
+ * @return 1 si la loi approchée est rejetée
+ */
+static int tester_binomiale(long n, double p, int nb)
+{
+    long *tirages = malloc(nb * sizeof(long));
+    mpz_t taille, res;
+    mpz_init_set_ui(taille, n);
+    mpz_init(res);
+    ligne_tableau ligne;
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb; i++)
+    {
+        binomial_gaussian(res, taille, p);
+        tirages[i] = mpz_get_si(res);
+    }
+    ligne.ns_gauss = secondes_depuis(&debut) * 1e9 / nb;
+
+    int nb_exacts = tirages_exacts(nb, n);
+    uint64_t seuil = seuil_probabilite(p);
+    volatile long puits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb_exacts; i++)
+    {
+        long succes = 0;
+        for (long j = 0; j < n; j++)
+            succes += bernoulli_seuil(seuil);
+        puits += succes;
+    }
+    ligne.ns_exact = secondes_depuis(&debut) * 1e9 / nb_exacts;
+
+    loi_exacte loi = loi_binomiale(n, p);
+    comparer_loi(&loi, tirages, nb, &ligne);
+    char parametres[64];
+    snprintf(parametres, sizeof(parametres), "n=%.0e p=%g", (double)n, p);
+    int rejet = afficher_ligne("binomiale", parametres, &ligne);
+
+    free(loi.repart);
+    free(tirages);
+    mpz_clears(taille, res, NULL);
+    return rejet;
+}
+
+/**
+ * @brief Teste hypergeometric_gaussian contre la loi hypergéométrique exacte
+ *
+ * La version exacte est hypergeometrique() avec le seuil gaussien relevé:
+ * tirages successifs sans remise.
+ *
+ * @return 1 si la loi approchée est rejetée
+ */
+static int tester_hypergeometrique(long total, long succes, long n, int nb)
+{
+    long *tirages = malloc(nb * sizeof(long));
+    mpz_t t, s, k, res;
+    mpz_init_set_ui(t, total);
+    mpz_init_set_ui(s, succes);
+    mpz_init_set_ui(k, n);
+    mpz_init(res);
+    ligne_tableau ligne;
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb; i++)
+    {
+        hypergeometric_gaussian(res, t, s, k);
+        tirages[i] = mpz_get_si(res);
+    }
+    ligne.ns_gauss = secondes_depuis(&debut) * 1e9 / nb;
+
+    int nb_exacts = tirages_exacts(nb, n);
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb_exacts; i++)
+        hypergeometrique(res, t, s, k, ULONG_MAX);
+    ligne.ns_exact = secondes_depuis(&debut) * 1e9 / nb_exacts;
+
+    loi_exacte loi = loi_hypergeometrique(total, succes, n);
+    comparer_loi(&loi, tirages, nb, &ligne);
+    char parametres[64];
+    snprintf(parametres, sizeof(parametres), "N=%.0e K=%.0e n=%.0e", (double)total, (double)succes, (double)n);
+    int rejet = afficher_ligne("hypergéom.", parametres, &ligne);
+
+    free(loi.repart);
+    free(tirages);
+    mpz_clears(t, s, k, res, NULL);
+    return rejet;
+}
+
+/**
+ * @brief Teste multinomial_gaussian sur la loi du nombre de portées par an
+ *
+ * Chaque catégorie i suit exactement une binomiale(n, p_i): une ligne est
+ * affichée par catégorie de probabilité non nulle. La version
+ * exacte tire le nombre de portées de chaque femelle (litter_per_year()).
+ *
+ * @return Nombre de catégories rejetées
+ */
+static int tester_multinomiale(const tables_transition *t, long n, int nb)
+{
+    long(*tirages)[10] = malloc(nb * sizeof(*tirages));
+    long *colonne = malloc(nb * sizeof(long));
+    mpz_t taille;
+    mpz_init_set_ui(taille, n);
+    ligne_tableau ligne;
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb; i++)
+    {
+        mpz_t *counts = multinomial_gaussian(taille, t->portees_cumul, 10);
+        for (int c = 0; c < 10; c++)
+        {
+            tirages[i][c] = mpz_get_si(counts[c]);
+            mpz_clear(counts[c]);
+        }
+        free(counts);
+    }
+    double ns_gauss = secondes_depuis(&debut) * 1e9 / nb;
+
+    int nb_exacts = tirages_exacts(nb, n);
+    volatile long puits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb_exacts; i++)
+        for (long j = 0; j < n; j++)
+            puits += litter_per_year(t);
+    double ns_exact = secondes_depuis(&debut) * 1e9 / nb_exacts;
+
+    int rejets = 0;
+    for (int c = 0; c < 10; c++)
+    {
+        double p = t->portees_cumul[c] - (c ? t->portees_cumul[c - 1] : 0);
+        if (p <= 0 || p >= 1)
+            continue;
+        for (int i = 0; i < nb; i++)
+            colonne[i] = tirages[i][c];
+        loi_exacte loi = loi_binomiale(n, p);
+        comparer_loi(&loi, colonne, nb, &ligne);
+        ligne.ns_gauss = ns_gauss;
+        ligne.ns_exact = ns_exact;
+        char parametres[64];
+        snprintf(parametres, sizeof(parametres), "n=%.0e portées=%d p=%.3f", (double)n, c, p);
+        rejets += afficher_ligne("multinomiale", parametres, &ligne);
+        free(loi.repart);
+    }
+
+    free(colonne);
+    free(tirages);
+    mpz_clear(taille);
+    return rejets;
+}
+
+/**
+ * @brief Teste total_bebes() au-delà du seuil gaussien contre sa loi exacte
+ *
+ * La version approchée est total_bebes() avec un seuil gaussien nul, la
+ * version exacte avec le seuil relevé: deux bits aléatoires par portée, 16
+ * portées par entier de 32 bits.
+ *
+ * @return 1 si la loi approchée est rejetée
+ */
+static int tester_total_bebes(long k, int nb)
+{
+    long *tirages = malloc(nb * sizeof(long));
+    mpz_t portees, bebes;
+    mpz_init_set_ui(portees, k);
+    mpz_init(bebes);
+    ligne_tableau ligne;
+
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb; i++)
+    {
+        total_bebes(bebes, portees, 0);
+        tirages[i] = mpz_get_si(bebes) - 3 * k;
+    }
+    ligne.ns_gauss = secondes_depuis(&debut) * 1e9 / nb;
+
+    int nb_exacts = tirages_exacts(nb, k / 16.0);
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (int i = 0; i < nb_exacts; i++)
+        total_bebes(bebes, portees, ULONG_MAX);
+    ligne.ns_exact = secondes_depuis(&debut) * 1e9 / nb_exacts;
+
+    loi_exacte loi = loi_bits_portees(k);
+    if (!loi.repart)
+    {
+        free(tirages);
+        mpz_clears(portees, bebes, NULL);
+        return 1;
+    }
+    comparer_loi(&loi, tirages, nb, &ligne);
+    char parametres[64];
+    snprintf(parametres, sizeof(parametres), "k=%.0e portées", (double)k);
+    int rejet = afficher_ligne("total bébés", parametres, &ligne);
+
+    free(loi.repart);
+    free(tirages);
+    mpz_clears(portees, bebes, NULL);
+    return rejet;
+}
+
+/**
+ * @brief Vérifie que le flux antithétique oppose les écarts gaussiens
+ *
+ * Les tirages de normal_centree_reduite() sur le flux direct et sur le flux
+ * antithétique d'une même graine forment des paires de somme nulle: les
+ * approximations gaussiennes des deux réplications d'une paire sont alors
+ * symétriques autour de leur moyenne.
+ *
+ * @param nb Nombre de paires
+ * @param graine Graine des deux flux
+ * @return 1 si une paire ne s'annule pas
+ */
+static int tester_antithetique(int nb, unsigned long graine)
+{
+    double *directs = malloc(nb * sizeof(double));
+    init_genrand(graine);
+    for (int i = 0; i < nb; i++)
+        directs[i] = normal_centree_reduite();
+
+    init_genrand(graine);
+    set_antithetic(1);
+    int nb_non_nulles = 0;
+    for (int i = 0; i < nb; i++)
+        nb_non_nulles += (directs[i] + normal_centree_reduite() != 0);
+    set_antithetic(0);
+    free(directs);
+
+    printf("\nFlux antithétique : %d paires d'écarts gaussiens, %d de somme non nulle, %s\n", nb, nb_non_nulles,
+           nb_non_nulles ? "REJET" : "OK");
+    return nb_non_nulles > 0;
+}
+
+/**
+ * @brief Statistique de Kolmogorov-Smirnov à deux échantillons
+ *
+ * @param a Premier échantillon, trié
+ * @param na Taille du premier échantillon
+ * @param b Second échantillon, trié
+ * @param nb Taille du second échantillon
+ * @return Plus grand écart entre les deux fonctions de répartition empiriques
+ */
+static double ks_deux_echantillons(const double *a, int na, const double *b, int nb)
+{
+    double d = 0;
+    int i = 0, j = 0;
+    while (i < na && j < nb)
+    {
+        double v = a[i] < b[j] ? a[i] : b[j];
+        while (i < na && a[i] == v)
+            i++;
+        while (j < nb && b[j] == v)
+            j++;
+        double ecart = fabs((double)i / na - (double)j / nb);
+        if (ecart > d)
+            d = ecart;
+    }
+    return d;
+}
+
+/**
+ * @enum moteur_valide
+ * @brief Moteur dont les populations finales sont comparées à la référence exacte
+ */
+typedef enum moteur_valide
+{
+    MOTEUR_MENSUEL,   // Moteur mensuel GMP (simuler_total)
+    MOTEUR_COMPACT,   // Moteur compact (compteurs de 64 bits)
+    MOTEUR_SAUT,      // Mode saut (tau-leaping), sauts autorisés dès SEUIL_SAUT_VALIDATION
+    MOTEUR_ABONDANCE, // Compteurs flottants dès SEUIL_ABONDANCE_VALIDATION lapins
+    MOTEUR_LOG,       // Compteurs flottants en logarithmes dès SEUIL_ABONDANCE_VALIDATION lapins
+    MOTEUR_ENSEMBLE,  // Moteur ensemble (NB_VOIES réplications en voies vectorielles)
+    MOTEUR_PARALLELE  // Moteur mensuel parallèle (tous les cœurs)
+} moteur_valide;
+
+/**
+ * @struct reglage_moteur
+ * @brief Réglage d'un moteur comparé à la référence exacte
+ */
+typedef struct reglage_moteur
+{
+    const char *nom;       // Libellé du tableau
+    unsigned long seuil;   // Seuil gaussien
+    int planning;          // 1: planning des mises bas
+    moteur_valide moteur;  // Moteur simulé
+} reglage_moteur;
+
+/**
+ * @brief Lance une simulation avec un moteur GMP ou flottant et retourne sa population finale totale
+ *
+ * Les populations de la validation restent loin des seuils par défaut des
+ * modes saut et abondance: ils sont abaissés pour que les sauts et les
+ * compteurs flottants servent dès les premiers mois.
+ *
+ * @param sc Scénario à simuler
+ * @param moteur Moteur (tous sauf MOTEUR_ENSEMBLE)
+ * @param seed Graine du générateur
+ * @return Population finale totale
+ */
+static double simuler_total_moteur(scenario sc, moteur_valide moteur, unsigned long seed)
+{
+    if (moteur == MOTEUR_MENSUEL)
+        return simuler_total(sc, seed, 0);
+
+    init_genrand(seed);
+    mpz_t nbFemale, nbMale, total;
+    mpz_init_set_ui(nbFemale, sc.nb_femelles);
+    mpz_init_set_ui(nbMale, sc.nb_males);
+    mpz_init(total);
+    double resultat;
+    if (moteur == MOTEUR_ABONDANCE || moteur == MOTEUR_LOG)
+    {
+        options_abondance opt = options_abondance_defaut();
+        opt.seuil = SEUIL_ABONDANCE_VALIDATION;
+        if (moteur == MOTEUR_LOG)
+            opt.seuil_log = SEUIL_ABONDANCE_VALIDATION;
+        population_abondance *pa = simulate_population_abondance(sc.params, nbFemale, nbMale, sc.annees, &opt, NULL);
+        resultat = (double)expl(log_total_abondance(pa));
+        liberer_abondance(pa);
+    }
+    else
+    {
+        population *pop;
+        if (moteur == MOTEUR_COMPACT)
+        {
+            pop = simulate_population_compacte(sc.params, nbFemale, nbMale, sc.annees);
+        }
+        else if (moteur == MOTEUR_SAUT)
+        {
+            options_saut opt = options_saut_defaut();
+            opt.seuil = SEUIL_SAUT_VALIDATION;
+            pop = simulate_population_saut(sc.params, nbFemale, nbMale, sc.annees, &opt, NULL);
+        }
+        else
+        {
+            pop = simulate_population_parallele(sc.params, nbFemale, nbMale, sc.annees, 0);
+        }
+        population_totale(pop, total);
+        resultat = mpz_get_d(total);
+        liberer_population(pop);
+    }
+    mpz_clears(nbFemale, nbMale, total, NULL);
+    return resultat;
+}
+
+/**
+ * @brief Simule les réplications d'un réglage et retourne leurs populations finales triées
+ *
+ * La série simule avec une copie des paramètres du scénario dont seul le
+ * seuil gaussien change.
+ *
+ * @param sc Scénario (ses paramètres fixent le mode planning)
+ * @param seuil Seuil gaussien de la série
+ * @param moteur Moteur simulé
+ * @param nb_rep Nombre de réplications
+ * @param seed Graine de base (la réplication i utilise seed + i)
+ * @param totaux Tableau de nb_rep populations finales
+ * @return Durée moyenne d'une réplication en secondes
+ */
+static double simuler_reglage(scenario sc, unsigned long seuil, moteur_valide moteur, int nb_rep, unsigned long seed,
+                              double *totaux)
+{
+    params_t *reglage = params_copier(sc.params);
+    reglage->seuil_gaussien = seuil;
+    params_finaliser(reglage);
+    sc.params = reglage;
+    struct timespec debut;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    if (moteur == MOTEUR_ENSEMBLE)
+    {
+        for (int r = 0; r < nb_rep; r += NB_VOIES)
+        {
+            int nb = (nb_rep - r < NB_VOIES) ? nb_rep - r : NB_VOIES;
+            unsigned long graines[NB_VOIES];
+            resultat_simulation res[NB_VOIES];
+            for (int i = 0; i < nb; i++)
+                graines[i] = seed + r + i;
+            simuler_ensemble(sc, graines, nb, res);
+            for (int i = 0; i < nb; i++)
+                totaux[r + i] = res[i].total;
+        }
+    }
+    else
+    {
+        for (int r = 0; r < nb_rep; r++)
+            totaux[r] = simuler_total_moteur(sc, moteur, seed + r);
+    }
+    double duree = secondes_depuis(&debut) / nb_rep;
+    params_liberer(reglage);
+    qsort(totaux, nb_rep, sizeof(double), comparer_reels);
+    return duree;
+}
+
+/**
+ * @brief Moyenne et variance empirique d'un échantillon
+ */
+static void moments(const double *x, int n, double *moyenne, double *variance)
+{
+    double s = 0, s2 = 0;
+    for (int i = 0; i < n; i++)
+        s += x[i];
+    *moyenne = s / n;
+    for (int i = 0; i < n; i++)
+        s2 += (x[i] - *moyenne) * (x[i] - *moyenne);
+    *variance = n > 1 ? s2 / (n - 1) : 0;
+}
+
+/**
+ * @brief Compare les populations finales de plusieurs réglages à la référence exacte
+ *
+ * La référence tire chaque individu séparément (seuil gaussien infini). Les
+ * séries utilisent des graines disjointes: les échantillons sont
+ * indépendants et le test à deux échantillons s'applique.
+ *
+ * @param graine Graine de base: la série r utilise les graines graine + 10^6 * r + i
+ * @return Nombre de réglages rejetés
+ */
+static int valider_moteur(const params_t *params, int nb_femelles, int nb_males, int annees, int nb_rep,
+                          unsigned long graine)
+{
+    params_t *params_planning = params_copier(params);
+    params_planning->planning_portees = 1;
+    params_finaliser(params_planning);
+
+    const reglage_moteur reglages[] = {
+        {"seuil 10000 (défaut)", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_MENSUEL},
+        {"seuil 1000", 1000, 0, MOTEUR_MENSUEL},
+        {"seuil 100", 100, 0, MOTEUR_MENSUEL},
+        {"planning, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 1, MOTEUR_MENSUEL},
+        {"planning, seuil 100", 100, 1, MOTEUR_MENSUEL},
+        {"compact, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_COMPACT},
+        {"compact, seuil 100", 100, 0, MOTEUR_COMPACT},
+        {"saut, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_SAUT},
+        {"saut, seuil 100", 100, 0, MOTEUR_SAUT},
+        {"abondance, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_ABONDANCE},
+        {"abondance, seuil 100", 100, 0, MOTEUR_ABONDANCE},
+        {"abondance log, seuil 100", 100, 0, MOTEUR_LOG},
+        {"ensemble, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_ENSEMBLE},
+        {"ensemble, seuil 100", 100, 0, MOTEUR_ENSEMBLE},
+        {"parallèle, seuil 10000", SEUIL_GAUSSIEN_DEFAUT, 0, MOTEUR_PARALLELE},
+    };
+    int nb_reglages = sizeof(reglages) / sizeof(reglages[0]);
+
+    printf("\nPopulations finales contre la référence exacte : %dx%d, %d ans, %d réplications par réglage\n",
+           nb_femelles, nb_males, annees, nb_rep);
+
+    scenario sc = {nb_femelles, nb_males, annees, params};
+    double *reference = malloc(nb_rep * sizeof(double));
+    double *totaux = malloc(nb_rep * sizeof(double));
+    double duree_ref = simuler_reglage(sc, ULONG_MAX, MOTEUR_MENSUEL, nb_rep, graine, reference);
+    double moy_ref, var_ref;
+    moments(reference, nb_rep, &moy_ref, &var_ref);
+
+    printf("%-*s %14s %*s %8s %8s %8s %*s %8s\n", largeur_utf8("Réglage", 24), "Réglage", "moyenne",
+           largeur_utf8("é.-t. rel.", 10), "é.-t. rel.", "z moy.", "D KS", "D crit.", largeur_utf8("ms/rép.", 10),
+           "ms/rép.", "verdict");
+    printf("%-*s %14.0f %10.4f %8s %8s %8s %10.1f %8s\n", largeur_utf8("exact (référence)", 24), "exact (référence)",
+           moy_ref, sqrt(var_ref) / moy_ref, "-", "-", "-", duree_ref * 1e3, "-");
+
+    double d_critique = KS_CRITIQUE * sqrt(2.0 / nb_rep);
+    int rejets = 0;
+    for (int r = 0; r < nb_reglages; r++)
+    {
+        scenario sc_reglage = {nb_femelles, nb_males, annees, reglages[r].planning ? params_planning : params};
+        double duree = simuler_reglage(sc_reglage, reglages[r].seuil, reglages[r].moteur, nb_rep,
+                                       graine + 1000000UL * (r + 1), totaux);
+        double moy, var;
+        moments(totaux, nb_rep, &moy, &var);
+        double z = (moy - moy_ref) / sqrt((var + var_ref) / nb_rep);
+        double d = ks_deux_echantillons(reference, nb_rep, totaux, nb_rep);
+        int rejet = d > d_critique || fabs(z) > Z_CRITIQUE;
+        rejets += rejet;
+        printf("%-*s %14.0f %10.4f %8.2f %8.4f %8.4f %10.1f %8s\n", largeur_utf8(reglages[r].nom, 24),
+               reglages[r].nom, moy, sqrt(var) / moy, z, d, d_critique, duree * 1e3, rejet ? "REJET" : "OK");
+    }
+
+    free(reference);
+    free(totaux);
+    params_liberer(params_planning);
+    return rejets;
+}
+
+/**
+ * @brief Compare la classe adulte regroupée aux âges détaillés
+ *
+ * Sans naissances (toutes les femelles reçoivent 0 portée), les fondateurs
+ * vieillissent jusqu'à age_classe + 2 ans: ils passent l'anniversaire où la
+ * tranche la plus âgée quitte la classe, puis survivent un an au taux de
+ * l'âge suivant. Les survivants des deux modes doivent suivre la même loi.
+ *
+ * @param params Paramètres (leur survie fixe la classe)
+ * @param nb_fondateurs Fondateurs de chaque sexe
+ * @param nb_rep Réplications par mode
+ * @param graine Graine de base (séries disjointes)
+ * @return 1 si la classe regroupée est rejetée, 0 sinon
+ */
+static int valider_classe(const params_t *params, int nb_fondateurs, int nb_rep, unsigned long graine)
+{
+    params_t *regroupe = params_copier(params);
+    for (int i = 0; i < 10; i++)
+        regroupe->poids_portees[i] = (i == 0);
+    regroupe->detail_ages = 0;
+    params_finaliser(regroupe);
+    int age_classe = regroupe->transitions.age_classe;
+    if (!age_classe)
+    {
+        printf("\nClasse adulte regroupée : aucune (âges de survie tous différents), comparaison omise\n");
+        params_liberer(regroupe);
+        return 0;
+    }
+    params_t *detaille = params_copier(regroupe);
+    detaille->detail_ages = 1;
+    params_finaliser(detaille);
+
+    int annees = age_classe + 2;
+    printf("\nClasse adulte regroupée (âges 1 à %d) contre âges détaillés : %dx%d fondateurs sans naissances,"
+           " %d ans, %d réplications\n",
+           age_classe, nb_fondateurs, nb_fondateurs, annees, nb_rep);
+
+    double *reference = malloc(nb_rep * sizeof(double));
+    double *totaux = malloc(nb_rep * sizeof(double));
+    scenario sc_detaille = {nb_fondateurs, nb_fondateurs, annees, detaille};
+    scenario sc_regroupe = {nb_fondateurs, nb_fondateurs, annees, regroupe};
+    double duree_ref = simuler_reglage(sc_detaille, detaille->seuil_gaussien, MOTEUR_MENSUEL, nb_rep, graine, reference);
+    double duree = simuler_reglage(sc_regroupe, regroupe->seuil_gaussien, MOTEUR_MENSUEL, nb_rep, graine + 1000000UL, totaux);
+    double moy_ref, var_ref, moy, var;
+    moments(reference, nb_rep, &moy_ref, &var_ref);
+    moments(totaux, nb_rep, &moy, &var);
+    double z = (moy - moy_ref) / sqrt((var + var_ref) / nb_rep);
+    double d = ks_deux_echantillons(reference, nb_rep, totaux, nb_rep);
+    double d_critique = KS_CRITIQUE * sqrt(2.0 / nb_rep);
+    int rejet = d > d_critique || fabs(z) > Z_CRITIQUE;
+
+    printf("%-*s %14s %*s %8s %8s %8s %*s %8s\n", largeur_utf8("Mode", 24), "Mode", "survivants",
+           largeur_utf8("é.-t. rel.", 10), "é.-t. rel.", "z moy.", "D KS", "D crit.", largeur_utf8("ms/rép.", 10),
+           "ms/rép.", "verdict");
+    printf("%-*s %14.1f %10.4f %8s %8s %8s %10.1f %8s\n", largeur_utf8("âges détaillés (réf.)", 24),
+           "âges détaillés (réf.)", moy_ref, sqrt(var_ref) / moy_ref, "-", "-", "-", duree_ref * 1e3, "-");
+    printf("%-*s %14.1f %10.4f %8.2f %8.4f %8.4f %10.1f %8s\n", largeur_utf8("classe regroupée", 24),
+           "classe regroupée", moy, sqrt(var) / moy, z, d, d_critique, duree * 1e3, rejet ? "REJET" : "OK");
+
+    free(reference);
+    free(totaux);
+    params_liberer(detaille);
+    params_liberer(regroupe);
+    return rejet;
+}
+
+int main(int argc, char *argv[])
+{
+    // Options: --tirages N (échantillon de chaque loi), --replications N (par réglage du moteur),
+    //          --annees N, --params fichier, --graine N
+    int nb_tirages = 20000;
+    int nb_rep = 200;
+    int annees = 3;
+    unsigned long graine = 2024;
+    const char *fichier_params = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--tirages") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            nb_tirages = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--replications") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 1)
+            nb_rep = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--annees") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            annees = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc)
+            fichier_params = argv[++i];
+        else if (strcmp(argv[i], "--graine") == 0 && i + 1 < argc)
+            graine = strtoul(argv[++i], NULL, 10);
+        else
+        {
+            printf("Usage : %s [--tirages N] [--replications N] [--annees N] [--params fichier] [--graine N]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    params_t *params = fichier_params ? params_charger(fichier_params) : params_defaut();
+    if (!params)
+        return 1;
+    const tables_transition *t = &params->transitions;
+    init_genrand(graine);
+
+    printf("Tirages approchés contre lois exactes : %d tirages par ligne, rejet si D > D crit. (risque 1%%)"
+           " ou |z| > %.2f\n\n",
+           nb_tirages, Z_CRITIQUE);
+    entete_tirages();
+    int rejets = 0;
+
+    static const long tailles[] = {10000, 100000, 1000000};
+    static const double probas[] = {0.01, 0.1, 0.5, 0.9};
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            rejets += tester_binomiale(tailles[i], probas[j], nb_tirages);
+
+    // Sorties de la classe adulte (anniversaire) et survivantes planifiées
+    rejets += tester_hypergeometrique(100000, 50000, 10000, nb_tirages);
+    rejets += tester_hypergeometrique(1000000, 100000, 20000, nb_tirages);
+    rejets += tester_hypergeometrique(1000000, 900000, 500000, nb_tirages);
+    rejets += tester_hypergeometrique(100000, 2000, 50000, nb_tirages);
+
+    rejets += tester_multinomiale(t, 10000, nb_tirages);
+    rejets += tester_multinomiale(t, 1000000, nb_tirages);
+
+    rejets += tester_total_bebes(10000, nb_tirages);
+    rejets += tester_total_bebes(1000000, nb_tirages);
+
+    rejets += tester_antithetique(nb_tirages, graine);
+
+    rejets += valider_moteur(params, 1000, 1000, annees, nb_rep, graine);
+    rejets += valider_classe(params, 1000000, nb_rep, graine + 100000000UL);
+
+    printf("\n%d ligne(s) rejetée(s)\n", rejets);
+    params_liberer(params);
+    return rejets ? 2 : 0;
+}